@@ -0,0 +1,104 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "AllocationCounter.h"
+
+#ifdef VPAINT_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<quint64> numAllocations(0);
+
+inline void countAllocation()
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+}
+
+#ifdef __GLIBC__
+
+// Interpose the glibc allocator. operator new calls malloc(), so it does not
+// need to be replaced.
+extern "C"
+{
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t n, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+
+void * malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void * calloc(size_t n, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(n, size);
+}
+
+void * realloc(void * ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+}
+
+#else
+
+void * operator new(std::size_t size)
+{
+    countAllocation();
+    if (size == 0)
+        size = 1;
+    while (true)
+    {
+        void * ptr = std::malloc(size);
+        if (ptr)
+            return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+#endif // __GLIBC__
+
+bool AllocationCounter::isEnabled()
+{
+    return true;
+}
+
+quint64 AllocationCounter::count()
+{
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+#else // VPAINT_COUNT_ALLOCATIONS
+
+bool AllocationCounter::isEnabled()
+{
+    return false;
+}
+
+quint64 AllocationCounter::count()
+{
+    return 0;
+}
+
+#endif // VPAINT_COUNT_ALLOCATIONS
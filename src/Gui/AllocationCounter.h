@@ -0,0 +1,37 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/*
+ * AllocationCounter.h
+ *
+ * Process-wide count of heap allocations, used by InputReplayer to report
+ * the number of allocations performed by each replayed event.
+ *
+ * Counting is only compiled in when VPAINT_COUNT_ALLOCATIONS is defined,
+ * i.e. when building with "qmake CONFIG+=count_allocations". With glibc,
+ * malloc(), calloc() and realloc() are counted, which includes allocations
+ * made by Qt containers and Eigen. Elsewhere, only operator new is counted.
+ *
+ */
+
+namespace AllocationCounter
+{
+// Returns whether allocations are counted in this build
+bool isEnabled();
+
+// Returns the number of allocations since the program started (always zero
+// if not enabled)
+quint64 count();
+}
+
+#endif // ALLOCATIONCOUNTER_H
@@ -9,6 +9,7 @@
 #include "BackgroundRenderer.h"
 
 #include "Background.h"
+#include "../MemoryUsage.h"
 
 #include <QGLContext>
 
@@ -18,7 +19,8 @@ BackgroundRenderer::BackgroundRenderer(
         QObject * parent) :
     QObject(parent),
     background_(background),
-    context_(context)
+    context_(context),
+    textureBytes_(0)
 {
     connect(background_, SIGNAL(cacheCleared()), this, SLOT(clearCache_()));
 }
@@ -36,6 +38,12 @@ void BackgroundRenderer::clearCache_()
 
     // Clear map
     texIds_.clear();
+    textureBytes_ = 0;
+}
+
+void BackgroundRenderer::addMemoryUsage(MemoryUsage & usage) const
+{
+    usage.add("Background", "Textures", textureBytes_, texIds_.size());
 }
 
 GLuint BackgroundRenderer::texId_(int frame)
@@ -58,6 +66,9 @@ GLuint BackgroundRenderer::texId_(int frame)
         {
             // Load texture to GPU.
             texIds_[frame] = context_->bindTexture(img);
+
+            // Estimated GPU memory: RGBA8, plus one third for mipmaps
+            textureBytes_ += (qint64) img.width() * img.height() * 4 * 4 / 3;
         }
     }
 
@@ -17,6 +17,7 @@
 
 class Background;
 class QGLContext;
+class MemoryUsage;
 
 class BackgroundRenderer: public QObject
 {
@@ -52,6 +53,9 @@ public:
               double xSceneMin, double xSceneMax,
               double ySceneMin, double ySceneMax);
 
+    // Adds the estimated memory held by cached textures
+    void addMemoryUsage(MemoryUsage & usage) const;
+
 private slots:
     void clearCache_();
 
@@ -61,6 +65,7 @@ private:
 
     GLuint texId_(int frame);
     QMap<int, GLuint> texIds_;
+    qint64 textureBytes_;
 };
 
 #endif // BACKGROUND_RENDERER_H
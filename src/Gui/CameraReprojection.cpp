@@ -0,0 +1,78 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "CameraReprojection.h"
+
+#include <QtGlobal>
+
+CameraReprojection::CameraReprojection(const GLWidget_Camera2D & from,
+                                       const GLWidget_Camera2D & to,
+                                       double width, double height) :
+    width_(width),
+    height_(height)
+{
+    // Window coordinates are p = zoom * q + (x,y), where q is in scene
+    // coordinates. Hence pTo = (zoomTo / zoomFrom) * (pFrom - (xFrom,yFrom)) + (xTo,yTo)
+    scale_ = to.zoom() / from.zoom();
+    dx_ = to.x() - scale_ * from.x();
+    dy_ = to.y() - scale_ * from.y();
+}
+
+QPointF CameraReprojection::map(const QPointF & p) const
+{
+    return QPointF(scale_ * p.x() + dx_, scale_ * p.y() + dy_);
+}
+
+QRectF CameraReprojection::mappedViewport() const
+{
+    return QRectF(map(QPointF(0, 0)), map(QPointF(width_, height_)));
+}
+
+QList<QRectF> CameraReprojection::exposedRegions() const
+{
+    QList<QRectF> res;
+    QRectF viewport(0, 0, width_, height_);
+    QRectF covered = mappedViewport().intersected(viewport);
+    if(covered.isEmpty())
+    {
+        if(!viewport.isEmpty())
+            res << viewport;
+        return res;
+    }
+
+    // Bands above and below the covered rect span the whole width, and
+    // bands on its left and right span its height
+    QRectF bands[4] = {
+        QRectF(QPointF(0, 0), QPointF(width_, covered.top())),
+        QRectF(QPointF(0, covered.bottom()), QPointF(width_, height_)),
+        QRectF(QPointF(0, covered.top()), QPointF(covered.left(), covered.bottom())),
+        QRectF(QPointF(covered.right(), covered.top()), QPointF(width_, covered.bottom())) };
+    for(int i=0; i<4; ++i)
+    {
+        if(!bands[i].isEmpty())
+            res << bands[i];
+    }
+    return res;
+}
+
+double CameraReprojection::exposedFraction() const
+{
+    double viewportArea = width_ * height_;
+    if(viewportArea <= 0)
+        return 0;
+
+    double exposedArea = 0;
+    foreach(const QRectF & rect, exposedRegions())
+        exposedArea += rect.width() * rect.height();
+    return exposedArea / viewportArea;
+}
+
+bool CameraReprojection::isAcceptable(double maxScale) const
+{
+    return scale_ <= maxScale && scale_ * maxScale >= 1.0;
+}
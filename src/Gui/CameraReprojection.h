@@ -0,0 +1,77 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef CAMERAREPROJECTION_H
+#define CAMERAREPROJECTION_H
+
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+
+#include "GLWidget_Camera2D.h"
+
+/*
+ * CameraReprojection.h
+ *
+ * Maps an image of the scene rendered with a given 2D camera to the window
+ * coordinates of another 2D camera. Since 2D cameras only translate and
+ * scale, the map is a uniform scaling followed by a translation:
+ *
+ *     pTo = scale * pFrom + (dx, dy)
+ *
+ * This is used by View to redraw the last rendered image during camera
+ * navigation, instead of redrawing all cells on every mouse move. The
+ * regions of the viewport not covered by the reprojected image are given
+ * by exposedRegions().
+ *
+ * This class doesn't depend on OpenGL.
+ *
+ */
+
+class CameraReprojection
+{
+public:
+    // Reprojection from the viewport of camera "from" to the viewport of
+    // camera "to", both of size width x height
+    CameraReprojection(const GLWidget_Camera2D & from,
+                       const GLWidget_Camera2D & to,
+                       double width, double height);
+
+    // Parameters of the map
+    double scale() const { return scale_; }
+    double dx() const { return dx_; }
+    double dy() const { return dy_; }
+
+    // Maps a point from the window coordinates of "from" to the window
+    // coordinates of "to"
+    QPointF map(const QPointF & p) const;
+
+    // Viewport of "from", in the window coordinates of "to"
+    QRectF mappedViewport() const;
+
+    // Non-overlapping rectangles covering the part of the viewport of "to"
+    // which is not covered by mappedViewport(). Empty rectangles are omitted.
+    QList<QRectF> exposedRegions() const;
+
+    // Total area of exposedRegions(), as a fraction of the area of the
+    // viewport. Returns 0 if the viewport is empty
+    double exposedFraction() const;
+
+    // Whether the reprojected image is a good enough approximation, that is,
+    // whether it is neither magnified nor minified by more than maxScale
+    bool isAcceptable(double maxScale) const;
+
+private:
+    double scale_;
+    double dx_;
+    double dy_;
+    double width_;
+    double height_;
+};
+
+#endif // CAMERAREPROJECTION_H
@@ -7,7 +7,7 @@
 // directory of this distribution and at http://opensource.org/licenses/MIT
 
 #include "CssColor.h"
-#include <QStringList>
+#include "StringTokenizer.h"
 #include <cmath>
 
 CssColor::CssColor(int r, int g, int b, double a) :
@@ -22,6 +22,12 @@ CssColor::CssColor(const QString & c) :
     fromString(c);
 }
 
+CssColor::CssColor(const QStringRef & c) :
+    r_(0), g_(0), b_(0), a_(1.0)
+{
+    fromString(c);
+}
+
 CssColor::CssColor(const double * c)
 {
     setRgbaF(c[0], c[1], c[2], c[3]);
@@ -77,21 +83,24 @@ void CssColor::setRgbaF(double r, double g, double b, double a)
 
 void CssColor::fromString(const QString & c)
 {
-    // Remove all whitespaces, e.g.:
-    //   "  rgba ( 127,0  , 255, 1.0) " -> "rgba(127,0,255,1.0)"
-    QString d;
-    for(int i=0; i<c.length(); ++i)
-        if(!c.at(i).isSpace())
-            d += c.at(i);
+    fromString(QStringRef(&c));
+}
 
-    // Get relevant data: "rgba(127,0,255,1.0)" -> "127,0,255,1.0"
-    d.remove(0,5).chop(1);
+void CssColor::fromString(const QStringRef & c)
+{
+    // Split at '(', ')', ',' or any whitespace, e.g.:
+    //   "  rgba ( 127,0  , 255, 1.0) " -> [ "rgba" ; "127" ; "0" ; "255" ; "1.0" ]
+    StringTokenizer tokenizer(c, "(),");
 
-    // Split: "127,0,255,1.0" -> [ "127" ; "0" ; "255" ; "1.0" ]
-    QStringList l = d.split(',');
+    // Skip "rgba"
+    tokenizer.next();
 
     // Write data to members
-    setRgba(l[0].toInt(), l[1].toInt(), l[2].toInt(), l[3].toDouble());
+    int r = tokenizer.next().toInt();
+    int g = tokenizer.next().toInt();
+    int b = tokenizer.next().toInt();
+    double a = tokenizer.next().toDouble();
+    setRgba(r, g, b, a);
 }
 
 QString CssColor::toString() const
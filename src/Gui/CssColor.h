@@ -19,6 +19,7 @@ public:
     // Constructors
     CssColor(int r=0, int g=0, int b=0, double a=1.0); // expects RGB in [0,255] and A in [0,1]
     CssColor(const QString & c);                       // expects string of the form "rgba(r,b,b,a)", same ranges as above
+    CssColor(const QStringRef & c);                    // same as above
     CssColor(const double * c);                        // expects an array of size 4 with RGBA values all in [0,1]
 
     // Get
@@ -50,6 +51,7 @@ public:
     // String input/output as "rgba(r,g,b,a)"
     QString toString() const;
     void fromString(const QString & c);
+    void fromString(const QStringRef & c);
 
 private:
     int r_, g_, b_; // [0  , 255]
@@ -30,6 +30,11 @@ DevSettings::DevSettings()
     addSection("Rendering");
 
     createCheckBox("draw edge orientation", false);
+    createCheckBox("fast navigation", true);
+    createSpinBox("playback cache (MB)", 0, 4096, 256);
+    createSpinBox("dirty region redraw (max %)", 0, 100, 50);
+    createSpinBox("geometry budget (MB)", 0, 65536, 2048);
+    createSpinBox("geometry paging margin (frames)", 0, 1000, 10);
 
     createSpinBox("num sub", 0, 10, 2);
     createDoubleSpinBox("ds", 0, 10, 2);
@@ -59,6 +64,14 @@ int DevSettings::getInt(const QString & name)
         return s->spinBoxes_[name]->value();
 }
 
+void DevSettings::setInt(const QString & name, int value)
+{
+    if(!s || !s->spinBoxes_.contains(name))
+        qDebug() << "Settings: " << name << "not found";
+    else
+        s->spinBoxes_[name]->setValue(value);
+}
+
 double DevSettings::getDouble(const QString & name)
 {
     if(!s || !s->doubleSpinBoxes_.contains(name))
@@ -33,6 +33,7 @@ public:
     DevSettings();
     static bool getBool(const QString & name);
     static int getInt(const QString & name);
+    static void setInt(const QString & name, int value); // emits changed()
     static double getDouble(const QString & name);
     static DevSettings * instance()
         {return s;}
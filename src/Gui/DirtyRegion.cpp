@@ -0,0 +1,129 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "DirtyRegion.h"
+
+#include <cmath>
+
+namespace
+{
+qint64 area_(const QRect & r)
+{
+    return (qint64) r.width() * r.height();
+}
+}
+
+DirtyRegion::DirtyRegion(int width, int height) :
+    width_(width),
+    height_(height)
+{
+}
+
+int DirtyRegion::maxNumRects()
+{
+    return 8;
+}
+
+void DirtyRegion::addRect(const QRectF & rect, double margin)
+{
+    // Clip to the viewport, and round outward so that partially covered
+    // pixels are redrawn too
+    int left   = std::floor(qBound(0.0, rect.left()   - margin, (double) width_));
+    int top    = std::floor(qBound(0.0, rect.top()    - margin, (double) height_));
+    int right  = std::ceil (qBound(0.0, rect.right()  + margin, (double) width_));
+    int bottom = std::ceil (qBound(0.0, rect.bottom() + margin, (double) height_));
+    if(right > left && bottom > top)
+        merge_(QRect(left, top, right - left, bottom - top));
+}
+
+void DirtyRegion::addSceneRect(const QRectF & rect, const GLWidget_Camera2D & camera, double margin)
+{
+    // Window coordinates are p = zoom * q + (x,y), see CameraReprojection
+    double zoom = camera.zoom();
+    addRect(QRectF(zoom * rect.left() + camera.x(),
+                   zoom * rect.top() + camera.y(),
+                   zoom * rect.width(),
+                   zoom * rect.height()),
+            margin);
+}
+
+void DirtyRegion::addAll()
+{
+    addRect(QRectF(0, 0, width_, height_));
+}
+
+void DirtyRegion::merge_(QRect rect)
+{
+    // Merge with all the rectangles it overlaps, transitively
+    for(int i=0; i<rects_.size(); )
+    {
+        if(rects_[i].intersects(rect))
+        {
+            rect = rect.united(rects_[i]);
+            rects_.removeAt(i);
+            i = 0;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    rects_ << rect;
+
+    // Too many rectangles: merge the pair which adds the less area
+    if(rects_.size() > maxNumRects())
+    {
+        int bestI = 0;
+        int bestJ = 1;
+        qint64 bestCost = -1;
+        for(int i=0; i<rects_.size(); ++i)
+        {
+            for(int j=i+1; j<rects_.size(); ++j)
+            {
+                qint64 cost = area_(rects_[i].united(rects_[j])) - area_(rects_[i]) - area_(rects_[j]);
+                if(bestCost < 0 || cost < bestCost)
+                {
+                    bestI = i;
+                    bestJ = j;
+                    bestCost = cost;
+                }
+            }
+        }
+        QRect united = rects_[bestI].united(rects_[bestJ]);
+        rects_.removeAt(bestJ);
+        rects_.removeAt(bestI);
+        merge_(united);
+    }
+}
+
+double DirtyRegion::coveredFraction() const
+{
+    qint64 viewportArea = (qint64) width_ * height_;
+    if(viewportArea <= 0)
+        return 0;
+
+    // Rectangles don't overlap, since overlapping ones are merged
+    qint64 area = 0;
+    foreach(const QRect & r, rects_)
+        area += area_(r);
+    return (double) area / viewportArea;
+}
+
+QRectF DirtyRegion::sceneRect(const QRect & rect, const GLWidget_Camera2D & camera)
+{
+    double zoom = camera.zoom();
+    return QRectF((rect.x() - camera.x()) / zoom,
+                  (rect.y() - camera.y()) / zoom,
+                  rect.width() / zoom,
+                  rect.height() / zoom);
+}
+
+QRect DirtyRegion::glRect(const QRect & rect) const
+{
+    return QRect(rect.x(), height_ - rect.y() - rect.height(), rect.width(), rect.height());
+}
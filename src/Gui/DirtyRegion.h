@@ -0,0 +1,76 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef DIRTYREGION_H
+#define DIRTYREGION_H
+
+#include <QList>
+#include <QRect>
+#include <QRectF>
+
+#include "GLWidget_Camera2D.h"
+
+/*
+ * DirtyRegion.h
+ *
+ * Part of the viewport of a View which must be redrawn, given as a few
+ * rectangles in window coordinates. This is used by View to redraw only
+ * the regions of the cells whose drawing changed over the last rendered
+ * image of the scene, instead of redrawing all cells.
+ *
+ * Rectangles are clipped to the viewport, rounded outward to whole pixels,
+ * and overlapping rectangles are merged into their union. When there are
+ * more than maxNumRects() rectangles, the two whose union is the smallest
+ * are merged, since each rectangle is redrawn in a separate pass.
+ *
+ * This class doesn't depend on OpenGL.
+ *
+ */
+
+class DirtyRegion
+{
+public:
+    // Empty region of a viewport of size width x height
+    DirtyRegion(int width, int height);
+
+    // Adds a rectangle given in window coordinates, grown by margin pixels
+    // in all four directions
+    void addRect(const QRectF & rect, double margin = 0);
+
+    // Adds a rectangle given in scene coordinates, as seen by the given
+    // camera, grown by margin pixels in all four directions
+    void addSceneRect(const QRectF & rect, const GLWidget_Camera2D & camera, double margin = 0);
+
+    // Adds the whole viewport
+    void addAll();
+
+    // Rectangles covering the region, in window coordinates (y axis down)
+    const QList<QRect> & rects() const { return rects_; }
+    bool isEmpty() const { return rects_.isEmpty(); }
+
+    // Area of the region, as a fraction of the area of the viewport
+    double coveredFraction() const;
+
+    // Rectangle in scene coordinates seen through the given rectangle of
+    // the viewport by the given camera
+    static QRectF sceneRect(const QRect & rect, const GLWidget_Camera2D & camera);
+
+    // Rectangle in OpenGL window coordinates (y axis up), e.g. for glScissor()
+    QRect glRect(const QRect & rect) const;
+
+    static int maxNumRects();
+
+private:
+    int width_;
+    int height_;
+    QList<QRect> rects_;
+
+    void merge_(QRect rect);
+};
+
+#endif // DIRTYREGION_H
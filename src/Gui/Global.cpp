@@ -34,6 +34,7 @@
 Global * global_ = 0;
 Global * global() { return global_; }
 void Global::initialize(MainWindow * w) { global_ = new Global(w); }
+void Global::initializeHeadless() { global_ = new Global(0); }
 
 Global::Global(MainWindow * w) :
     toolMode_(SELECT),
@@ -72,9 +73,35 @@ Global::Global(MainWindow * w) :
     // Status bar help
     statusBarHelp_ = new QLabel();
     statusBarHelp_->setText("Find help here.");
-    w->statusBar()->addWidget(statusBarHelp_);
+    if(w)
+        w->statusBar()->addWidget(statusBarHelp_);
     connect(this, SIGNAL(keyboardModifiersChanged()), this, SLOT(updateStatusBarHelp()));
 
+    // Without main window, createToolBars() is never called
+    if(!w)
+        createHeadlessToolOptions_();
+}
+
+void Global::createHeadlessToolOptions_()
+{
+    actionUseTabletPressure_ = new QAction(this);
+    actionUseTabletPressure_->setCheckable(true);
+    actionUseTabletPressure_->setChecked(true);
+
+    edgeWidth_ = new SpinBox();
+    edgeWidth_->setValue(settings().edgeWidth());
+    connect(edgeWidth_, SIGNAL(valueChanged(double)), this, SLOT(setEdgeWidth_(double)));
+
+    actionPlanarMapMode_ = new QAction(this);
+    actionPlanarMapMode_->setCheckable(true);
+    actionPlanarMapMode_->setChecked(true);
+
+    actionSnapMode_ = new QAction(this);
+    actionSnapMode_->setCheckable(true);
+    actionSnapMode_->setChecked(true);
+    actionSnapThreshold_ = new QAction(this);
+
+    toolMode_ = SKETCH;
 }
 
 bool Global::deleteIsolatedVertices()
@@ -473,22 +500,23 @@ Global::DisplayMode Global::displayMode() const
 
 View * Global::activeView() const
 {
-    return mainWindow()->activeView();
+    return mainWindow() ? mainWindow()->activeView() : 0;
 }
 
 View * Global::hoveredView() const
 {
-    return mainWindow()->hoveredView();
+    return mainWindow() ? mainWindow()->hoveredView() : 0;
 }
 
 Time Global::activeTime() const
 {
-    return activeView()->activeTime();
+    View * view = activeView();
+    return view ? view->activeTime() : Time();
 }
 
 Timeline * Global::timeline() const
 {
-    return mainWindow()->timeline();
+    return mainWindow() ? mainWindow()->timeline() : 0;
 }
 
 void Global::setDisplayMode(Global::DisplayMode mode)
@@ -505,7 +533,7 @@ void Global::setDisplayMode(Global::DisplayMode mode)
 
 bool Global::showCanvas() const
 {
-    return mainWindow()->isShowCanvasChecked();
+    return mainWindow() && mainWindow()->isShowCanvasChecked();
 }
 
 void Global::togglePlanarMapMode()
@@ -575,7 +603,7 @@ void Global::setDraggingPivot(bool b)
 
 Global::ToolMode Global::toolMode() const
 {
-    if(mainWindow()->isEditCanvasSizeVisible())
+    if(mainWindow() && mainWindow()->isEditCanvasSizeVisible())
     {
         return EDIT_CANVAS_SIZE;
     }
@@ -587,6 +615,13 @@ Global::ToolMode Global::toolMode() const
 
 void Global::setToolMode(Global::ToolMode mode)
 {
+    // Without main window, there are no actions or scene to update
+    if(!mainWindow())
+    {
+        toolMode_ = mode;
+        return;
+    }
+
     // Check consistency with action state
     if(!toolModeActions[mode]->isChecked())
         toolModeActions[mode]->setChecked(true);
@@ -861,11 +896,23 @@ bool Global::planarMapMode() const
     return actionPlanarMapMode_->isChecked();
 }
 
+void Global::setPlanarMapMode(bool b)
+{
+    actionPlanarMapMode_->setChecked(b);
+    togglePlanarMapMode();
+}
+
 bool Global::snapMode() const
 {
     return actionSnapMode_->isChecked();
 }
 
+void Global::setSnapMode(bool b)
+{
+    actionSnapMode_->setChecked(b);
+    toggleSnapping();
+}
+
 double Global::snapThreshold() const
 {
     return snapThreshold_->value();
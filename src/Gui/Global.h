@@ -53,6 +53,11 @@ public:
     static void initialize(MainWindow * w);
     Global(MainWindow * w);
 
+    // Initialization without main window, used by the input replayer and the
+    // unit tests. Tool options are kept but not displayed, there are no views
+    // and no timeline, and the active time is always zero
+    static void initializeHeadless();
+
     // Tool Mode
     void createToolBars();
     enum ToolMode {
@@ -82,9 +87,11 @@ public:
 
     // Planar map mode
     bool planarMapMode() const;
+    void setPlanarMapMode(bool b);
 
     // snapping
     bool snapMode() const;
+    void setSnapMode(bool b);
     double snapThreshold() const;
     void setSnapThreshold(double newSnapThreshold);
 
@@ -179,6 +186,9 @@ private slots:
 
 
 private:
+    // Tool options when there is no main window
+    void createHeadlessToolOptions_();
+
     // Tools
     ToolModeAction * toolModeActions [NUMBER_OF_TOOL_MODES];
 
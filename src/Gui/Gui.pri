@@ -0,0 +1,293 @@
+# Copyright (C) 2012-2016 The VPaint Developers.
+# See the COPYRIGHT file at the top-level directory of this distribution
+# and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+#
+# This file is part of VPaint, a vector graphics editor. It is subject to the
+# license terms and conditions in the LICENSE.MIT file found in the top-level
+# directory of this distribution and at http://opensource.org/licenses/MIT
+
+# Sources of VPaint, except main.cpp, and the configuration they require.
+# Included by Gui.pro, and by the unit tests which need the whole application
+# code (e.g., to create a VAC). File paths are relative to this file.
+
+# Qt configuration
+CONFIG += qt c++11
+QT += opengl network
+
+# App version
+MYVAR = 1.6
+VERSION = $$MYVAR
+DEFINES += APP_VERSION=\\\"$$VERSION\\\"
+
+# App resources
+RESOURCES += $$PWD/resources.qrc
+
+# Names for control/command modifier key
+macx: DEFINES += ACTION_MODIFIER_NAME_SHORT=\\\"Cmd\\\" ACTION_MODIFIER_NAME=\\\"Command\\\"
+else: DEFINES += ACTION_MODIFIER_NAME_SHORT=\\\"Ctrl\\\" ACTION_MODIFIER_NAME=\\\"Control\\\"
+
+# Count heap allocations, reported by "VPaint --replay" (see AllocationCounter.h)
+# Enable with: qmake CONFIG+=count_allocations
+count_allocations: DEFINES += VPAINT_COUNT_ALLOCATIONS
+
+
+###############################################################################
+#                     UNSHIPPED EXTERNAL LIBRARIES
+
+# GLU
+unix:!macx: LIBS += -lGLU
+
+
+###############################################################################
+#                      SHIPPED EXTERNAL LIBRARIES
+
+# Add shipped external libraries to includepath and dependpath
+INCLUDEPATH += $$PWD/../Third/
+DEPENDPATH += $$PWD/../Third/
+!win32: QMAKE_CXXFLAGS += $$QMAKE_CFLAGS_ISYSTEM $$PWD/../Third/
+
+# Define RELEASE_OR_DEBUG convenient variable
+CONFIG(release, debug|release): RELEASE_OR_DEBUG = release
+CONFIG(debug,   debug|release): RELEASE_OR_DEBUG = debug
+
+# GLEW, built in the build directory of ../Third/GLEW
+GLEW_OUT_PWD = $$shadowed($$PWD/../Third/GLEW)
+win32 {
+    LIBS += -L$$GLEW_OUT_PWD/$$RELEASE_OR_DEBUG/ -lGLEW
+    win32-g++: PRE_TARGETDEPS += $$GLEW_OUT_PWD/$$RELEASE_OR_DEBUG/libGLEW.a
+    else:      PRE_TARGETDEPS += $$GLEW_OUT_PWD/$$RELEASE_OR_DEBUG/GLEW.lib
+}
+else:unix {
+    LIBS += -L$$GLEW_OUT_PWD/ -lGLEW
+    PRE_TARGETDEPS += $$GLEW_OUT_PWD/libGLEW.a
+}
+
+
+###############################################################################
+#                            APP SOURCE FILES
+
+HEADERS += $$PWD/MainWindow.h \
+    $$PWD/SaveAndLoad.h \
+    $$PWD/Picking.h \
+    $$PWD/Random.h \
+    $$PWD/GLUtils.h \
+    $$PWD/GLWidget.h \
+    $$PWD/GLWidget_Settings.h \
+    $$PWD/GLWidget_Camera.h \
+    $$PWD/GLWidget_Camera2D.h \
+    $$PWD/GLWidget_Material.h \
+    $$PWD/GLWidget_Light.h \
+    $$PWD/GeometryUtils.h \
+    $$PWD/SceneObject.h \
+    $$PWD/SceneObject_Example.h \
+    $$PWD/SceneObjectVisitor.h \
+    $$PWD/KeyFrame.h \
+    $$PWD/Scene.h \
+    $$PWD/MultiView.h \
+    $$PWD/View.h \
+    $$PWD/View3D.h \
+    $$PWD/Timeline.h \
+    $$PWD/Global.h \
+    $$PWD/ColorSelector.h \
+    $$PWD/SpinBox.h \
+    $$PWD/VectorAnimationComplex/Cell.h \
+    $$PWD/VectorAnimationComplex/SplitMap.h \
+    $$PWD/VectorAnimationComplex/Eigen.h \
+    $$PWD/VectorAnimationComplex/Intersection.h \
+    $$PWD/VectorAnimationComplex/KeyFace.h \
+    $$PWD/VectorAnimationComplex/KeyEdge.h \
+    $$PWD/VectorAnimationComplex/Halfedge.h \
+    $$PWD/VectorAnimationComplex/ForwardDeclaration.h \
+    $$PWD/VectorAnimationComplex/KeyCell.h \
+    $$PWD/VectorAnimationComplex/FaceCell.h \
+    $$PWD/VectorAnimationComplex/EdgeCell.h \
+    $$PWD/VectorAnimationComplex/VertexCell.h \
+    $$PWD/VectorAnimationComplex/KeyVertex.h \
+    $$PWD/VectorAnimationComplex/EdgeGeometry.h \
+    $$PWD/VectorAnimationComplex/CellList.h \
+    $$PWD/VectorAnimationComplex/CellVisitor.h \
+    $$PWD/VectorAnimationComplex/Operators.h \
+    $$PWD/VectorAnimationComplex/Operator.h \
+    $$PWD/VectorAnimationComplex/SculptCurve.h \
+    $$PWD/VectorAnimationComplex/ProperCycle.h \
+    $$PWD/VectorAnimationComplex/ProperPath.h \
+    $$PWD/VectorAnimationComplex/CycleHelper.h \
+    $$PWD/VectorAnimationComplex/ZOrderedCells.h \
+    $$PWD/VectorAnimationComplex/EdgeSample.h \
+    $$PWD/VectorAnimationComplex/Algorithms.h \
+    $$PWD/VectorAnimationComplex/SmartKeyEdgeSet.h \
+    $$PWD/OpenGL.h \
+    $$PWD/VectorAnimationComplex/Triangles.h \
+    $$PWD/SelectionInfoWidget.h \
+    $$PWD/SelectionSummary.h \
+    $$PWD/IdListCopier.h \
+    $$PWD/VectorAnimationComplex/Cycle.h \
+    $$PWD/VectorAnimationComplex/Path.h \
+    $$PWD/VectorAnimationComplex/AnimatedVertex.h \
+    $$PWD/VectorAnimationComplex/AnimatedCycle.h \
+    $$PWD/VectorAnimationComplex/CellLinkedList.h \
+    $$PWD/VectorAnimationComplex/HalfedgeBase.h \
+    $$PWD/VectorAnimationComplex/KeyHalfedge.h \
+    $$PWD/ViewSettings.h \
+    $$PWD/View3DSettings.h \
+    $$PWD/ObjectPropertiesWidget.h \
+    $$PWD/AnimatedCycleWidget.h \
+    $$PWD/VectorAnimationComplex/CellObserver.h \
+    $$PWD/Color.h \
+    $$PWD/DevSettings.h \
+    $$PWD/Settings.h \
+    $$PWD/SettingsDialog.h \
+    $$PWD/VectorAnimationComplex/InbetweenCell.h \
+    $$PWD/VectorAnimationComplex/InbetweenEdge.h \
+    $$PWD/VectorAnimationComplex/InbetweenFace.h \
+    $$PWD/VectorAnimationComplex/InbetweenHalfedge.h \
+    $$PWD/VectorAnimationComplex/InbetweenVertex.h \
+    $$PWD/VectorAnimationComplex/VAC.h \
+    $$PWD/XmlStreamWriter.h \
+    $$PWD/XmlStreamReader.h \
+    $$PWD/CssColor.h \
+    $$PWD/StringTokenizer.h \
+    $$PWD/TimeDef.h \
+    $$PWD/EditCanvasSizeDialog.h \
+    $$PWD/ExportPngDialog.h \
+    $$PWD/AboutDialog.h \
+    $$PWD/ViewMacOsX.h \
+    $$PWD/Application.h \
+    $$PWD/Background/Background.h \
+    $$PWD/Background/BackgroundData.h \
+    $$PWD/Background/BackgroundRenderer.h \
+    $$PWD/Background/BackgroundWidget.h \
+    $$PWD/Background/BackgroundUrlValidator.h \
+    $$PWD/IO/FileVersionConverter.h \
+    $$PWD/IO/XmlStreamTraverser.h \
+    $$PWD/IO/XmlStreamConverter.h \
+    $$PWD/IO/XmlStreamConverters/XmlStreamConverter_1_0_to_1_6.h \
+    $$PWD/IO/FileVersionConverterDialog.h \
+    $$PWD/IO/CompressedDocument.h \
+    $$PWD/UpdateCheckDialog.h \
+    $$PWD/Version.h \
+    $$PWD/UpdateCheck.h \
+    $$PWD/VectorAnimationComplex/BoundingBox.h \
+    $$PWD/VectorAnimationComplex/TransformTool.h \
+    $$PWD/ViewActions.h \
+    $$PWD/InputTrace.h \
+    $$PWD/InputReplayer.h \
+    $$PWD/AllocationCounter.h \
+    $$PWD/MemoryUsage.h \
+    $$PWD/MemoryUsageDialog.h \
+    $$PWD/VectorAnimationComplex/KeyframeCorrespondence.h \
+    $$PWD/VectorAnimationComplex/TessellationCache.h \
+    $$PWD/VectorAnimationComplex/SpaceTimeSurface.h \
+    $$PWD/CameraReprojection.h \
+    $$PWD/PlaybackCache.h \
+    $$PWD/PlaybackCacheIndex.h \
+    $$PWD/DirtyRegion.h \
+    $$PWD/SceneImageKey.h \
+    $$PWD/VectorAnimationComplex/GeometryPager.h
+
+SOURCES += $$PWD/SaveAndLoad.cpp \
+    $$PWD/Picking.cpp \
+    $$PWD/Random.cpp \
+    $$PWD/GLUtils.cpp  \
+    $$PWD/GLWidget.cpp  \
+    $$PWD/GLWidget_Settings.cpp \
+    $$PWD/MainWindow.cpp \
+    $$PWD/GeometryUtils.cpp \
+    $$PWD/SceneObject.cpp \
+    $$PWD/SceneObjectVisitor.cpp \
+    $$PWD/KeyFrame.cpp \
+    $$PWD/Scene.cpp \
+    $$PWD/MultiView.cpp \
+    $$PWD/View.cpp \
+    $$PWD/View3D.cpp \
+    $$PWD/Timeline.cpp \
+    $$PWD/Global.cpp \
+    $$PWD/ColorSelector.cpp \
+    $$PWD/SpinBox.cpp \
+    $$PWD/VectorAnimationComplex/Intersection.cpp \
+    $$PWD/VectorAnimationComplex/Cell.cpp \
+    $$PWD/VectorAnimationComplex/KeyCell.cpp \
+    $$PWD/VectorAnimationComplex/KeyFace.cpp \
+    $$PWD/VectorAnimationComplex/KeyEdge.cpp \
+    $$PWD/VectorAnimationComplex/Halfedge.cpp \
+    $$PWD/VectorAnimationComplex/FaceCell.cpp \
+    $$PWD/VectorAnimationComplex/EdgeCell.cpp \
+    $$PWD/VectorAnimationComplex/VertexCell.cpp \
+    $$PWD/VectorAnimationComplex/KeyVertex.cpp \
+    $$PWD/VectorAnimationComplex/EdgeGeometry.cpp \
+    $$PWD/VectorAnimationComplex/CellVisitor.cpp \
+    $$PWD/VectorAnimationComplex/Operators.cpp \
+    $$PWD/VectorAnimationComplex/Operator.cpp \
+    $$PWD/VectorAnimationComplex/ProperCycle.cpp \
+    $$PWD/VectorAnimationComplex/ProperPath.cpp \
+    $$PWD/VectorAnimationComplex/CycleHelper.cpp \
+    $$PWD/VectorAnimationComplex/ZOrderedCells.cpp \
+    $$PWD/VectorAnimationComplex/EdgeSample.cpp \
+    $$PWD/VectorAnimationComplex/Cycle.cpp \
+    $$PWD/VectorAnimationComplex/Algorithms.cpp \
+    $$PWD/VectorAnimationComplex/SmartKeyEdgeSet.cpp \
+    $$PWD/VectorAnimationComplex/Triangles.cpp \
+    $$PWD/SelectionInfoWidget.cpp \
+    $$PWD/SelectionSummary.cpp \
+    $$PWD/IdListCopier.cpp \
+    $$PWD/VectorAnimationComplex/Path.cpp \
+    $$PWD/VectorAnimationComplex/AnimatedVertex.cpp \
+    $$PWD/VectorAnimationComplex/AnimatedCycle.cpp \
+    $$PWD/VectorAnimationComplex/CellLinkedList.cpp \
+    $$PWD/VectorAnimationComplex/HalfedgeBase.cpp \
+    $$PWD/VectorAnimationComplex/KeyHalfedge.cpp \
+    $$PWD/ViewSettings.cpp \
+    $$PWD/View3DSettings.cpp \
+    $$PWD/ObjectPropertiesWidget.cpp \
+    $$PWD/AnimatedCycleWidget.cpp \
+    $$PWD/VectorAnimationComplex/CellObserver.cpp \
+    $$PWD/Color.cpp \
+    $$PWD/DevSettings.cpp \
+    $$PWD/Settings.cpp \
+    $$PWD/SettingsDialog.cpp \
+    $$PWD/VectorAnimationComplex/InbetweenCell.cpp \
+    $$PWD/VectorAnimationComplex/InbetweenEdge.cpp \
+    $$PWD/VectorAnimationComplex/InbetweenFace.cpp \
+    $$PWD/VectorAnimationComplex/InbetweenHalfedge.cpp \
+    $$PWD/VectorAnimationComplex/InbetweenVertex.cpp \
+    $$PWD/VectorAnimationComplex/VAC.cpp \
+    $$PWD/XmlStreamWriter.cpp \
+    $$PWD/XmlStreamReader.cpp \
+    $$PWD/CssColor.cpp \
+    $$PWD/StringTokenizer.cpp \
+    $$PWD/TimeDef.cpp \
+    $$PWD/EditCanvasSizeDialog.cpp \
+    $$PWD/ExportPngDialog.cpp \
+    $$PWD/AboutDialog.cpp \
+    $$PWD/ViewMacOsX.cpp \
+    $$PWD/Application.cpp \
+    $$PWD/Background/Background.cpp \
+    $$PWD/Background/BackgroundData.cpp \
+    $$PWD/Background/BackgroundRenderer.cpp \
+    $$PWD/Background/BackgroundWidget.cpp \
+    $$PWD/Background/BackgroundUrlValidator.cpp \
+    $$PWD/IO/FileVersionConverter.cpp \
+    $$PWD/IO/XmlStreamTraverser.cpp \
+    $$PWD/IO/XmlStreamConverter.cpp \
+    $$PWD/IO/XmlStreamConverters/XmlStreamConverter_1_0_to_1_6.cpp \
+    $$PWD/IO/FileVersionConverterDialog.cpp \
+    $$PWD/IO/CompressedDocument.cpp \
+    $$PWD/UpdateCheckDialog.cpp \
+    $$PWD/Version.cpp \
+    $$PWD/UpdateCheck.cpp \
+    $$PWD/VectorAnimationComplex/BoundingBox.cpp \
+    $$PWD/VectorAnimationComplex/TransformTool.cpp \
+    $$PWD/InputTrace.cpp \
+    $$PWD/InputReplayer.cpp \
+    $$PWD/AllocationCounter.cpp \
+    $$PWD/MemoryUsage.cpp \
+    $$PWD/MemoryUsageDialog.cpp \
+    $$PWD/VectorAnimationComplex/KeyframeCorrespondence.cpp \
+    $$PWD/VectorAnimationComplex/TessellationCache.cpp \
+    $$PWD/VectorAnimationComplex/SpaceTimeSurface.cpp \
+    $$PWD/CameraReprojection.cpp \
+    $$PWD/PlaybackCache.cpp \
+    $$PWD/PlaybackCacheIndex.cpp \
+    $$PWD/DirtyRegion.cpp \
+    $$PWD/SceneImageKey.cpp \
+    $$PWD/VectorAnimationComplex/GeometryPager.cpp
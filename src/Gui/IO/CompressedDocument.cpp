@@ -0,0 +1,271 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "CompressedDocument.h"
+
+#include <QtEndian>
+#include <cstring>
+
+namespace
+{
+// zlib level. On the dense number lists of VEC documents, level 1 is about
+// four times faster than the default level 6, for a 5% larger output. This
+// matters since autosave blocks the GUI
+const int compressionLevel = 1;
+}
+
+CompressedDevice::CompressedDevice(QIODevice * device) :
+    QIODevice(),
+    device_(device),
+    bufferPos_(0),
+    isFinished_(false),
+    hasError_(false)
+{
+}
+
+CompressedDevice::~CompressedDevice()
+{
+    if (isOpen())
+        close();
+}
+
+QByteArray CompressedDevice::magic()
+{
+    return QByteArray("\x89VECZ\r\n\x1a", 8);
+}
+
+int CompressedDevice::chunkSize()
+{
+    return 1 << 20;
+}
+
+bool CompressedDevice::isCompressed(QIODevice * device)
+{
+    return device->peek(magic().size()) == magic();
+}
+
+bool CompressedDevice::open(OpenMode mode)
+{
+    buffer_.clear();
+    bufferPos_ = 0;
+    isFinished_ = false;
+    hasError_ = false;
+
+    if (mode & ReadOnly)
+    {
+        if (device_->read(magic().size()) != magic())
+            return false;
+        return QIODevice::open(ReadOnly | Unbuffered);
+    }
+    else if (mode & WriteOnly)
+    {
+        if (device_->write(magic()) != magic().size())
+            return false;
+        buffer_.reserve(chunkSize());
+        return QIODevice::open(WriteOnly | Unbuffered);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+void CompressedDevice::close()
+{
+    if (openMode() & WriteOnly)
+    {
+        if (writeChunk_())
+        {
+            const uchar terminator[4] = {0, 0, 0, 0};
+            if (device_->write((const char *) terminator, 4) != 4)
+                setError_("Couldn't write compressed document terminator");
+        }
+    }
+
+    buffer_.clear();
+    bufferPos_ = 0;
+    QIODevice::close();
+}
+
+bool CompressedDevice::isSequential() const
+{
+    return true;
+}
+
+bool CompressedDevice::atEnd() const
+{
+    if (openMode() & ReadOnly)
+        return (isFinished_ || hasError_) && bufferPos_ >= buffer_.size();
+    else
+        return QIODevice::atEnd();
+}
+
+qint64 CompressedDevice::bytesAvailable() const
+{
+    return (buffer_.size() - bufferPos_) + QIODevice::bytesAvailable();
+}
+
+qint64 CompressedDevice::readData(char * data, qint64 maxSize)
+{
+    qint64 numRead = 0;
+    while (numRead < maxSize)
+    {
+        // Decompress next chunk if the current one is consumed
+        if (bufferPos_ >= buffer_.size() && !readChunk_())
+            break;
+
+        qint64 n = qMin(maxSize - numRead, (qint64) (buffer_.size() - bufferPos_));
+        std::memcpy(data + numRead, buffer_.constData() + bufferPos_, n);
+        bufferPos_ += n;
+        numRead += n;
+    }
+
+    if (numRead == 0 && hasError_)
+        return -1;
+    else
+        return numRead;
+}
+
+qint64 CompressedDevice::writeData(const char * data, qint64 maxSize)
+{
+    qint64 numWritten = 0;
+    while (numWritten < maxSize)
+    {
+        int n = qMin(maxSize - numWritten, (qint64) (chunkSize() - buffer_.size()));
+        buffer_.append(data + numWritten, n);
+        numWritten += n;
+
+        if (buffer_.size() == chunkSize() && !writeChunk_())
+            return -1;
+    }
+    return numWritten;
+}
+
+bool CompressedDevice::readChunk_()
+{
+    buffer_.resize(0);
+    bufferPos_ = 0;
+    if (isFinished_ || hasError_)
+        return false;
+
+    // Compressed size
+    QByteArray header = device_->read(4);
+    if (header.size() != 4)
+    {
+        setError_("Unexpected end of compressed document");
+        return false;
+    }
+    quint32 n = qFromBigEndian<quint32>((const uchar *) header.constData());
+    if (n == 0)
+    {
+        isFinished_ = true;
+        return false;
+    }
+    if (n > (quint32) (2 * chunkSize()))
+    {
+        setError_("Invalid chunk size in compressed document");
+        return false;
+    }
+
+    // Compressed data
+    QByteArray compressed = device_->read(n);
+    if (compressed.size() != (int) n)
+    {
+        setError_("Unexpected end of compressed document");
+        return false;
+    }
+    buffer_ = qUncompress(compressed);
+    if (buffer_.isEmpty())
+    {
+        setError_("Corrupted chunk in compressed document");
+        return false;
+    }
+
+    return true;
+}
+
+bool CompressedDevice::writeChunk_()
+{
+    if (hasError_)
+        return false;
+    if (buffer_.isEmpty())
+        return true;
+
+    QByteArray compressed = qCompress(buffer_, compressionLevel);
+    uchar header[4];
+    qToBigEndian<quint32>(compressed.size(), header);
+    if (device_->write((const char *) header, 4) != 4 ||
+        device_->write(compressed) != compressed.size())
+    {
+        setError_("Couldn't write compressed document");
+        return false;
+    }
+
+    // Keeps the capacity reserved in open()
+    buffer_.resize(0);
+    return true;
+}
+
+void CompressedDevice::setError_(const QString & message)
+{
+    hasError_ = true;
+    setErrorString(message);
+}
+
+DocumentInputFile::DocumentInputFile(const QString & filePath) :
+    file_(filePath),
+    decompressor_(&file_),
+    device_(0)
+{
+    // Opened in binary mode first, since compressed documents are binary
+    if (!file_.open(QFile::ReadOnly))
+        return;
+
+    if (CompressedDevice::isCompressed(&file_))
+    {
+        if (decompressor_.open(QIODevice::ReadOnly))
+            device_ = &decompressor_;
+    }
+    else
+    {
+        file_.setTextModeEnabled(true);
+        device_ = &file_;
+    }
+}
+
+DocumentOutputFile::DocumentOutputFile(const QString & filePath, bool compress) :
+    file_(filePath),
+    compressor_(&file_),
+    device_(0)
+{
+    if (compress)
+    {
+        if (file_.open(QIODevice::WriteOnly | QFile::Truncate) &&
+            compressor_.open(QIODevice::WriteOnly))
+        {
+            device_ = &compressor_;
+        }
+    }
+    else
+    {
+        if (file_.open(QIODevice::WriteOnly | QFile::Truncate | QFile::Text))
+            device_ = &file_;
+    }
+}
+
+bool DocumentOutputFile::close()
+{
+    bool success = isOpen();
+    if (compressor_.isOpen())
+    {
+        compressor_.close();
+        success = success && !compressor_.hasError();
+    }
+    file_.close();
+    return success && file_.error() == QFile::NoError;
+}
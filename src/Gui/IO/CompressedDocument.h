@@ -0,0 +1,117 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef COMPRESSED_DOCUMENT_H
+#define COMPRESSED_DOCUMENT_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QByteArray>
+
+/// \class CompressedDevice
+/// Streams deflate-compressed data to or from another device.
+///
+/// This is the container of compressed VEC documents (*.vecz). The XML is
+/// exactly the same as in a *.vec file, but it is split into chunks of at
+/// most chunkSize() bytes which are compressed independently:
+///
+///     magic        8 bytes, see magic()
+///     chunk*       4 bytes big-endian compressed size n > 0, then n bytes
+///                  of qCompress() output (deflate, with its size header)
+///     terminator   4 bytes equal to zero
+///
+/// This way, writing never holds more than one chunk in memory, and reading
+/// decompresses chunks one at a time, as they are consumed by the
+/// XmlStreamReader.
+///
+/// The magic starts with a byte which is not valid at the beginning of an
+/// XML document, so compressed documents can be detected by content,
+/// whatever their file extension.
+
+class CompressedDevice: public QIODevice
+{
+public:
+    // The underlying device must already be open, and must outlive this one
+    CompressedDevice(QIODevice * device);
+    ~CompressedDevice();
+
+    // Open in ReadOnly or WriteOnly mode. Opening for reading fails if the
+    // underlying device doesn't start with the magic
+    bool open(OpenMode mode);
+
+    // Flushes the last chunk and writes the terminator when writing.
+    // Use hasError() afterwards to know whether all the data was written
+    void close();
+    bool hasError() const { return hasError_; }
+
+    // Reimplemented from QIODevice
+    bool isSequential() const;
+    bool atEnd() const;
+    qint64 bytesAvailable() const;
+
+    // Returns whether the data at the current position of device is a
+    // compressed document. Does not consume any data
+    static bool isCompressed(QIODevice * device);
+
+    static QByteArray magic();
+    static int chunkSize();
+
+protected:
+    qint64 readData(char * data, qint64 maxSize);
+    qint64 writeData(const char * data, qint64 maxSize);
+
+private:
+    QIODevice * device_;
+    QByteArray buffer_; // uncompressed chunk being read or written
+    int bufferPos_;     // read position in buffer_
+    bool isFinished_;   // terminator read
+    bool hasError_;
+
+    bool readChunk_();
+    bool writeChunk_();
+    void setError_(const QString & message);
+};
+
+/// \class DocumentInputFile
+/// Opens a VEC document for reading, and decompresses it on the fly if it
+/// is compressed. Use device() to create the XmlStreamReader.
+class DocumentInputFile
+{
+public:
+    DocumentInputFile(const QString & filePath);
+
+    bool isOpen() const { return device_ != 0; }
+    bool isCompressed() const { return device_ == &decompressor_; }
+    QIODevice * device() const { return device_; }
+
+private:
+    QFile file_;
+    CompressedDevice decompressor_;
+    QIODevice * device_;
+};
+
+/// \class DocumentOutputFile
+/// Opens a VEC document for writing, optionally compressed. Use device() to
+/// create the XmlStreamWriter, then close() to know whether all the data
+/// was successfully written.
+class DocumentOutputFile
+{
+public:
+    DocumentOutputFile(const QString & filePath, bool compress);
+
+    bool isOpen() const { return device_ != 0; }
+    QIODevice * device() const { return device_; }
+    bool close();
+
+private:
+    QFile file_;
+    CompressedDevice compressor_;
+    QIODevice * device_;
+};
+
+#endif // COMPRESSED_DOCUMENT_H
@@ -9,6 +9,7 @@
 #include "FileVersionConverter.h"
 
 #include "FileVersionConverterDialog.h"
+#include "CompressedDocument.h"
 #include "XmlStreamReader.h"
 #include "XmlStreamWriter.h"
 #include "Global.h"
@@ -47,13 +48,13 @@ int FileVersionConverter::fileMinor() const
 
 void FileVersionConverter::readVersion_()
 {
-    // Open file
-    QFile file(filePath_);
-    if (!file.open(QFile::ReadOnly | QFile::Text))
+    // Open file, possibly compressed
+    DocumentInputFile file(filePath_);
+    if (!file.isOpen())
         return;
 
     // Parse XML to get version
-    XmlStreamReader xml(&file);
+    XmlStreamReader xml(file.device());
     if (xml.readNextStartElement() &&
         xml.name() == "vec" &&
         xml.attributes().hasAttribute("version"))
@@ -71,9 +72,6 @@ void FileVersionConverter::readVersion_()
             fileMinor_ = list[1].toInt();
         }
     }
-
-    // Close file
-    file.close();
 }
 
 bool FileVersionConverter::convertToVersion(
@@ -0,0 +1,77 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "IdListCopier.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QTimer>
+
+#include "VectorAnimationComplex/Cell.h"
+
+namespace
+{
+// Number of ids appended per event loop iteration, which takes about a
+// millisecond
+const int numIdsPerChunk = 10000;
+}
+
+IdListCopier::IdListCopier(QObject * parent) :
+    QObject(parent),
+    numAppended_(0)
+{
+    timer_ = new QTimer(this);
+    timer_->setInterval(0);
+    connect(timer_, SIGNAL(timeout()), this, SLOT(appendChunk_()));
+}
+
+void IdListCopier::copy(const VectorAnimationComplex::CellSet & cells)
+{
+    // Cells may be deleted before the copy is done, so only their ids are kept
+    ids_.clear();
+    ids_.reserve(cells.size());
+    foreach(VectorAnimationComplex::Cell * cell, cells)
+        ids_ << cell->id();
+
+    numAppended_ = 0;
+    text_.clear();
+    text_.reserve(8 * ids_.size());
+    timer_->start();
+}
+
+bool IdListCopier::isCopying() const
+{
+    return timer_->isActive();
+}
+
+void IdListCopier::appendIds(const QVector<int> & ids, int begin, int end, QString & text)
+{
+    for(int i=begin; i<end; ++i)
+    {
+        if(i > 0)
+            text += QString(", ");
+        text += QString::number(ids[i]);
+    }
+}
+
+void IdListCopier::appendChunk_()
+{
+    int end = qMin(numAppended_ + numIdsPerChunk, ids_.size());
+    appendIds(ids_, numAppended_, end, text_);
+    numAppended_ = end;
+
+    if(numAppended_ == ids_.size())
+    {
+        timer_->stop();
+        QApplication::clipboard()->setText(text_);
+        int numIds = ids_.size();
+        ids_.clear();
+        text_.clear();
+        emit finished(numIds);
+    }
+}
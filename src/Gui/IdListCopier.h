@@ -0,0 +1,62 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef IDLISTCOPIER_H
+#define IDLISTCOPIER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "VectorAnimationComplex/CellList.h"
+
+class QTimer;
+
+/*
+ * IdListCopier.h
+ *
+ * Copies the ids of a set of cells to the clipboard, as a comma-separated
+ * list. The widgets displaying the selection only show its first ids; this
+ * is how users get all of them.
+ *
+ * The ids are taken when copy() is called, but the text is built a chunk
+ * at a time from the event loop, so that copying hundreds of thousands of
+ * ids doesn't freeze the user interface. finished() is emitted once the
+ * text is on the clipboard.
+ *
+ */
+
+class IdListCopier: public QObject
+{
+    Q_OBJECT
+
+public:
+    IdListCopier(QObject * parent = 0);
+
+    // Starts copying the ids of the given cells, cancelling the copy in
+    // progress if any
+    void copy(const VectorAnimationComplex::CellSet & cells);
+    bool isCopying() const;
+
+    // Appends ids[begin..end) to text, separated by ", "
+    static void appendIds(const QVector<int> & ids, int begin, int end, QString & text);
+
+signals:
+    void finished(int numIds);
+
+private slots:
+    void appendChunk_();
+
+private:
+    QTimer * timer_;
+    QVector<int> ids_;
+    int numAppended_;
+    QString text_;
+};
+
+#endif // IDLISTCOPIER_H
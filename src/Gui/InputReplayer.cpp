@@ -0,0 +1,347 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "InputReplayer.h"
+
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+#include "ViewActions.h"
+#include "AllocationCounter.h"
+#include "MemoryUsage.h"
+#include "Global.h"
+#include "DevSettings.h"
+#include "Scene.h"
+#include "XmlStreamReader.h"
+#include "IO/CompressedDocument.h"
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/Cell.h"
+#include "VectorAnimationComplex/GeometryPager.h"
+
+namespace
+{
+// Returns the p-th percentile of sorted values, in microseconds
+double percentile(const QVector<qint64> & sortedValues, double p)
+{
+    if (sortedValues.isEmpty())
+        return 0;
+
+    int i = std::floor(p * (sortedValues.size() - 1) + 0.5);
+    return sortedValues[i] * 1.0e-3;
+}
+}
+
+InputReplayer::InputReplayer(Scene * scene) :
+    scene_(scene),
+    lastSketchX_(0),
+    lastSketchY_(0),
+    numReplayed_(0),
+    numSkipped_(0),
+    totalTime_(0)
+{
+}
+
+bool InputReplayer::openDocument(const QString & filePath)
+{
+    DocumentInputFile file(filePath);
+    if (!file.isOpen())
+        return false;
+
+    // Same as MainWindow::read(), except that the playback settings are
+    // ignored, and that the file must already be in the current version
+    XmlStreamReader xml(file.device());
+    if (!xml.readNextStartElement() || xml.name() != "vec")
+        return false;
+
+    int numLayer = 0;
+    while (xml.readNextStartElement())
+    {
+        if (xml.name() == "canvas")
+        {
+            scene_->readCanvas(xml);
+        }
+        else if (xml.name() == "layer" && numLayer == 0)
+        {
+            ++numLayer;
+            scene_->read(xml);
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+
+    return true;
+}
+
+void InputReplayer::replay(const InputTrace & trace)
+{
+    // Tool state at the start of the recording
+    global()->setPlanarMapMode(trace.planarMapMode());
+    global()->setSnapMode(trace.snapMode());
+    VectorAnimationComplex::GeometryPager::instance()->resetCounters();
+
+    QElapsedTimer timer;
+    for (const InputTrace::Event & e: trace.events())
+    {
+        // Restore the state the event depends on. This is not measured.
+        VectorAnimationComplex::VAC * vac = scene_->vectorAnimationComplex();
+        if (global()->toolMode() != e.toolMode)
+            global()->setToolMode((Global::ToolMode) e.toolMode);
+        global()->setSnapThreshold(e.snapThreshold);
+        global()->setSculptRadius(e.sculptRadius);
+        vac->setHoveredCell(e.hoveredCellId < 0 ? 0 : vac->getCell(e.hoveredCellId));
+        vac->updateGeometryPaging(); // as drawing would do
+
+        // Replay event
+        quint64 numAllocations = AllocationCounter::count();
+        timer.start();
+        QString name = replayEvent_(e);
+        qint64 latency = timer.nsecsElapsed();
+        numAllocations = AllocationCounter::count() - numAllocations;
+
+        // Accumulate statistics
+        if (name.isEmpty())
+        {
+            ++numSkipped_;
+        }
+        else
+        {
+            ++numReplayed_;
+            totalTime_ += latency;
+            Statistics & statistics = statistics_[name];
+            if (statistics.latencies.isEmpty())
+                statistics.numAllocations = 0;
+            statistics.latencies << latency;
+            statistics.numAllocations += numAllocations;
+        }
+    }
+}
+
+QString InputReplayer::replayEvent_(const InputTrace::Event & e)
+{
+    VectorAnimationComplex::VAC * vac = scene_->vectorAnimationComplex();
+    Time t(e.time);
+
+    switch (e.type)
+    {
+    case InputTrace::PressEvent:
+        switch (e.action)
+        {
+        case SKETCH_ACTION:
+            lastSketchX_ = e.x;
+            lastSketchY_ = e.y;
+            vac->beginSketchEdge(e.x, e.y, e.penWidth, t);
+            return "sketch begin";
+        case DRAG_AND_DROP_ACTION:
+            vac->prepareDragAndDrop(e.x, e.y, t);
+            return "drag and drop begin";
+        case RECTANGLE_OF_SELECTION_ACTION:
+            vac->beginRectangleOfSelection(e.x, e.y, t);
+            return "rectangle of selection begin";
+        case SCULPT_DEFORM_ACTION:
+            vac->beginSculptDeform(e.x, e.y);
+            return "sculpt deform begin";
+        case SCULPT_CHANGE_WIDTH_ACTION:
+            vac->beginSculptEdgeWidth(e.x, e.y);
+            return "sculpt width begin";
+        case SCULPT_SMOOTH_ACTION:
+            vac->beginSculptSmooth(e.x, e.y);
+            return "sculpt smooth begin";
+        }
+        break;
+
+    case InputTrace::MoveEvent:
+        switch (e.action)
+        {
+        case SKETCH_ACTION:
+            // View ignores moves which do not change the mouse position
+            if (e.x == lastSketchX_ && e.y == lastSketchY_)
+                break;
+            lastSketchX_ = e.x;
+            lastSketchY_ = e.y;
+            vac->continueSketchEdge(e.x, e.y, e.penWidth);
+            return "sketch move";
+        case DRAG_AND_DROP_ACTION:
+            vac->performDragAndDrop(e.x, e.y);
+            return "drag and drop move";
+        case RECTANGLE_OF_SELECTION_ACTION:
+            vac->continueRectangleOfSelection(e.x, e.y);
+            return "rectangle of selection move";
+        case SCULPT_DEFORM_ACTION:
+            vac->continueSculptDeform(e.x, e.y);
+            return "sculpt deform move";
+        case SCULPT_CHANGE_WIDTH_ACTION:
+            vac->continueSculptEdgeWidth(e.x, e.y);
+            return "sculpt width move";
+        case SCULPT_SMOOTH_ACTION:
+            vac->continueSculptSmooth(e.x, e.y);
+            return "sculpt smooth move";
+        }
+        break;
+
+    case InputTrace::ReleaseEvent:
+        switch (e.action)
+        {
+        case SKETCH_ACTION:
+            vac->endSketchEdge();
+            return "sketch end";
+        case DRAG_AND_DROP_ACTION:
+            vac->completeDragAndDrop();
+            return "drag and drop end";
+        case RECTANGLE_OF_SELECTION_ACTION:
+            vac->endRectangleOfSelection();
+            return "rectangle of selection end";
+        case SCULPT_CHANGE_RADIUS_ACTION:
+            vac->updateSculpt(e.x, e.y, t);
+            return "sculpt radius end";
+        case SCULPT_DEFORM_ACTION:
+            vac->endSculptDeform();
+            vac->updateSculpt(e.x, e.y, t);
+            return "sculpt deform end";
+        case SCULPT_CHANGE_WIDTH_ACTION:
+            vac->endSculptEdgeWidth();
+            vac->updateSculpt(e.x, e.y, t);
+            return "sculpt width end";
+        case SCULPT_SMOOTH_ACTION:
+            vac->endSculptSmooth();
+            vac->updateSculpt(e.x, e.y, t);
+            return "sculpt smooth end";
+        }
+        break;
+
+    case InputTrace::ClicEvent:
+        switch (e.action)
+        {
+        case SPLIT_ACTION:
+            if (e.hoveredCellId < 0 && e.toolMode != Global::SKETCH)
+                break;
+            vac->split(e.x, e.y, t, true);
+            return "split";
+        case PAINT_ACTION:
+            vac->paint(e.x, e.y, t);
+            return "paint";
+        }
+        break;
+
+    case InputTrace::HoverEvent:
+        if (e.toolMode == Global::SCULPT)
+        {
+            vac->updateSculpt(e.x, e.y, t);
+            return "sculpt hover";
+        }
+        else if (e.toolMode == Global::PAINT)
+        {
+            vac->updateToBePaintedFace(e.x, e.y, t);
+            return "paint hover";
+        }
+        break;
+    }
+
+    return QString();
+}
+
+QString InputReplayer::report() const
+{
+    QString res;
+    QTextStream out(&res);
+
+    out << "Replayed " << numReplayed_ << " events ("
+        << numSkipped_ << " skipped) in "
+        << QString::number(totalTime_ * 1.0e-6, 'f', 1) << " ms\n";
+    if (!AllocationCounter::isEnabled())
+        out << "Allocations are not counted in this build (see AllocationCounter.h)\n";
+    out << "\n";
+
+    const int nameWidth = 30;
+    const int columnWidth = 11;
+    out << QString("event").leftJustified(nameWidth)
+        << QString("count").rightJustified(columnWidth)
+        << QString("p50 (us)").rightJustified(columnWidth)
+        << QString("p90 (us)").rightJustified(columnWidth)
+        << QString("p99 (us)").rightJustified(columnWidth)
+        << QString("max (us)").rightJustified(columnWidth)
+        << QString("allocs/evt").rightJustified(columnWidth) << "\n";
+
+    for (auto it = statistics_.begin(); it != statistics_.end(); ++it)
+    {
+        QVector<qint64> latencies = it.value().latencies;
+        std::sort(latencies.begin(), latencies.end());
+        int n = latencies.size();
+        double allocationsPerEvent = (double) it.value().numAllocations / n;
+
+        out << it.key().leftJustified(nameWidth)
+            << QString::number(n).rightJustified(columnWidth)
+            << QString::number(percentile(latencies, 0.50), 'f', 1).rightJustified(columnWidth)
+            << QString::number(percentile(latencies, 0.90), 'f', 1).rightJustified(columnWidth)
+            << QString::number(percentile(latencies, 0.99), 'f', 1).rightJustified(columnWidth)
+            << QString::number(percentile(latencies, 1.00), 'f', 1).rightJustified(columnWidth)
+            << QString::number(allocationsPerEvent, 'f', 1).rightJustified(columnWidth) << "\n";
+    }
+
+    // Samples of key edges paged back in by the events, which is included in
+    // their latency (see VAC::updateGeometryPaging())
+    const VectorAnimationComplex::GeometryPager::Counters & paging =
+            VectorAnimationComplex::GeometryPager::instance()->counters();
+    out << "\nGeometry paging: " << paging.numPageOuts << " page-outs, "
+        << paging.numPageIns << " page-ins";
+    if (paging.numPageIns > 0)
+        out << ", page-in mean " << QString::number(paging.pageInTime * 1.0e-3 / paging.numPageIns, 'f', 1)
+            << " us, max " << QString::number(paging.maxPageInTime * 1.0e-3, 'f', 1) << " us";
+    out << "\n";
+
+    // Memory held by the scene at the end of the replay
+    MemoryUsage usage;
+    scene_->addMemoryUsage(usage);
+    VectorAnimationComplex::GeometryPager::instance()->addMemoryUsage(usage);
+    out << "\n" << usage.report();
+
+    return res;
+}
+
+int InputReplayer::runFromCommandLine(const QStringList & arguments)
+{
+    QTextStream err(stderr);
+    QTextStream out(stdout);
+
+    int i = arguments.indexOf("--replay");
+    if (i < 0 || i+1 >= arguments.size())
+    {
+        err << "Usage: VPaint --replay trace.vptrace [document.vec]\n";
+        return 1;
+    }
+    QString tracePath = arguments[i+1];
+    QString documentPath = (i+2 < arguments.size()) ? arguments[i+2] : QString();
+
+    // No main window is created: the tool options are held by a headless
+    // global(), and there are no views, timeline or autosave
+    Global::initializeHeadless();
+    DevSettings devSettings;
+    Scene scene;
+    InputReplayer replayer(&scene);
+
+    if (!documentPath.isEmpty() && !replayer.openDocument(documentPath))
+    {
+        err << "Error: couldn't open document " << documentPath << "\n";
+        return 1;
+    }
+
+    InputTrace trace;
+    if (!trace.load(tracePath))
+    {
+        err << "Error: couldn't read trace " << tracePath << "\n";
+        return 1;
+    }
+
+    replayer.replay(trace);
+    out << replayer.report();
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef INPUTREPLAYER_H
+#define INPUTREPLAYER_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "InputTrace.h"
+
+class Scene;
+
+/*
+ * InputReplayer.h
+ *
+ * Replays an InputTrace on a scene which is not displayed in any view, by
+ * calling the same VAC methods as View does, and measures the latency and
+ * number of allocations (see AllocationCounter.h) of each event. No main
+ * window is created (see Global::initializeHeadless()).
+ *
+ * Picking is not available without a view: the hovered cell of each event
+ * is taken from the trace instead, which is only meaningful if the trace is
+ * replayed on the document it was recorded on. Events which only depend on
+ * picking (click selection, transform widgets) are skipped.
+ *
+ * Usage from the command line:
+ *     VPaint --replay trace.vptrace [document.vec]
+ *
+ */
+
+class InputReplayer
+{
+public:
+    // The replayer does not take ownership of the scene
+    InputReplayer(Scene * scene);
+
+    // Reads a document into the scene. Returns false on failure
+    bool openDocument(const QString & filePath);
+
+    // Replays all events of the trace, accumulating statistics
+    void replay(const InputTrace & trace);
+
+    // Text report of the accumulated statistics, with one row per event kind
+    QString report() const;
+
+    // Headless entry point for "--replay". Returns the process exit code
+    static int runFromCommandLine(const QStringList & arguments);
+
+private:
+    Scene * scene_;
+
+    // Replays an event. Returns the name of the measured event kind, or an
+    // empty string if the event was skipped
+    QString replayEvent_(const InputTrace::Event & e);
+    double lastSketchX_;
+    double lastSketchY_;
+
+    // Statistics per event kind
+    struct Statistics
+    {
+        QVector<qint64> latencies; // nanoseconds
+        quint64 numAllocations;
+    };
+    QMap<QString, Statistics> statistics_;
+    int numReplayed_;
+    int numSkipped_;
+    qint64 totalTime_; // nanoseconds
+};
+
+#endif // INPUTREPLAYER_H
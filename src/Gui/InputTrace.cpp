@@ -0,0 +1,160 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "InputTrace.h"
+
+#include <QFile>
+#include <QDataStream>
+
+#include "Global.h"
+
+namespace
+{
+// File header
+const quint32 traceMagicNumber = 0x56505452; // "VPTR"
+const quint16 traceVersion = 1;
+}
+
+InputTrace * InputTrace::recorder_ = 0;
+
+InputTrace::InputTrace() :
+    planarMapMode_(true),
+    snapMode_(true)
+{
+}
+
+void InputTrace::startRecording()
+{
+    delete recorder_;
+    recorder_ = new InputTrace();
+    recorder_->planarMapMode_ = global()->planarMapMode();
+    recorder_->snapMode_ = global()->snapMode();
+    recorder_->timer_.start();
+}
+
+InputTrace * InputTrace::stopRecording()
+{
+    InputTrace * res = recorder_;
+    recorder_ = 0;
+    return res;
+}
+
+InputTrace * InputTrace::recorder()
+{
+    return recorder_;
+}
+
+void InputTrace::record(EventType type, int action, double x, double y, Time time,
+                        double penWidth, int hoveredCellId)
+{
+    Event e;
+    e.type = type;
+    e.toolMode = global()->toolMode();
+    e.action = action;
+    e.x = x;
+    e.y = y;
+    e.time = time.floatTime();
+    e.timestamp = timer_.isValid() ? timer_.elapsed() : 0;
+    e.penWidth = penWidth;
+    e.snapThreshold = global()->snapThreshold();
+    e.sculptRadius = global()->sculptRadius();
+    e.hoveredCellId = hoveredCellId;
+    events_ << e;
+}
+
+const QVector<InputTrace::Event> & InputTrace::events() const
+{
+    return events_;
+}
+
+bool InputTrace::planarMapMode() const
+{
+    return planarMapMode_;
+}
+
+bool InputTrace::snapMode() const
+{
+    return snapMode_;
+}
+
+bool InputTrace::save(const QString & filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QFile::Truncate))
+        return false;
+
+    // Floating point values are stored in single precision, which is more
+    // than enough for scene coordinates recorded from mouse positions
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out << traceMagicNumber << traceVersion;
+    out << (quint8) planarMapMode_ << (quint8) snapMode_;
+    out << (quint32) events_.size();
+    for (const Event & e: events_)
+    {
+        out << (quint8) e.type << (quint8) e.toolMode << (quint16) e.action
+            << (qint32) e.hoveredCellId << (quint32) e.timestamp
+            << e.x << e.y << e.time
+            << e.penWidth << e.snapThreshold << e.sculptRadius;
+    }
+
+    return out.status() == QDataStream::Ok;
+}
+
+bool InputTrace::load(const QString & filePath)
+{
+    events_.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magicNumber;
+    quint16 version;
+    in >> magicNumber >> version;
+    if (magicNumber != traceMagicNumber || version > traceVersion)
+        return false;
+
+    quint8 planarMapMode, snapMode;
+    quint32 numEvents;
+    in >> planarMapMode >> snapMode >> numEvents;
+    planarMapMode_ = planarMapMode;
+    snapMode_ = snapMode;
+
+    for (quint32 i=0; i<numEvents && in.status() == QDataStream::Ok; ++i)
+    {
+        quint8 type, toolMode;
+        quint16 action;
+        qint32 hoveredCellId;
+        quint32 timestamp;
+        Event e;
+        in >> type >> toolMode >> action >> hoveredCellId >> timestamp
+           >> e.x >> e.y >> e.time
+           >> e.penWidth >> e.snapThreshold >> e.sculptRadius;
+        e.type = (EventType) type;
+        e.toolMode = toolMode;
+        e.action = action;
+        e.hoveredCellId = hoveredCellId;
+        e.timestamp = timestamp;
+        events_ << e;
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        events_.clear();
+        return false;
+    }
+
+    return true;
+}
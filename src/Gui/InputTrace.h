@@ -0,0 +1,95 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef INPUTTRACE_H
+#define INPUTTRACE_H
+
+#include <QVector>
+#include <QString>
+#include <QElapsedTimer>
+
+#include "TimeDef.h"
+
+/*
+ * InputTrace.h
+ *
+ * A recording of the tool-level input events received by the 2D views, i.e.
+ * after the mouse events have been converted into actions (sketch, sculpt,
+ * rectangle of selection, etc.) and scene coordinates. Each event stores
+ * the tool state it depends on (pen width, snap threshold, sculpt radius,
+ * hovered cell), so that it can be replayed without any window by
+ * InputReplayer, e.g. to benchmark the interactive code paths.
+ *
+ * Traces are saved in a compact binary file (about 40 bytes per event).
+ *
+ * Usage:
+ *     InputTrace::startRecording();
+ *     ... // views call InputTrace::recorder()->record(...)
+ *     InputTrace * trace = InputTrace::stopRecording();
+ *     trace->save(filePath);
+ *     delete trace;
+ *
+ */
+
+class InputTrace
+{
+public:
+    enum EventType
+    {
+        PressEvent = 0, // View::PMRPressEvent()
+        MoveEvent,      // View::PMRMoveEvent()
+        ReleaseEvent,   // View::PMRReleaseEvent()
+        ClicEvent,      // View::ClicEvent()
+        HoverEvent      // View::MoveEvent(), i.e. mouse move without action
+    };
+
+    struct Event
+    {
+        EventType type;
+        int toolMode;         // Global::ToolMode
+        int action;           // View action, e.g. SKETCH_ACTION
+        double x, y;          // scene coordinates
+        double time;          // Time::floatTime() of the view
+        qint64 timestamp;     // milliseconds since the recording started
+        double penWidth;      // effective pen width, including tablet pressure
+        double snapThreshold;
+        double sculptRadius;
+        int hoveredCellId;    // -1 if none
+    };
+
+    // Creates an empty trace
+    InputTrace();
+
+    // Global recorder. recorder() returns null when not recording
+    static void startRecording();
+    static InputTrace * stopRecording(); // ownership passed to caller
+    static InputTrace * recorder();
+
+    // Appends an event
+    void record(EventType type, int action, double x, double y, Time time,
+                double penWidth, int hoveredCellId);
+
+    // Recorded events and tool state at the start of the recording
+    const QVector<Event> & events() const;
+    bool planarMapMode() const;
+    bool snapMode() const;
+
+    // Save and load. Return false on failure
+    bool save(const QString & filePath) const;
+    bool load(const QString & filePath);
+
+private:
+    QVector<Event> events_;
+    bool planarMapMode_;
+    bool snapMode_;
+    QElapsedTimer timer_;
+
+    static InputTrace * recorder_;
+};
+
+#endif // INPUTTRACE_H
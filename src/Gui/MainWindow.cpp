@@ -21,12 +21,18 @@
 #include "EditCanvasSizeDialog.h"
 #include "ExportPngDialog.h"
 #include "AboutDialog.h"
+#include "MemoryUsageDialog.h"
+#include "MemoryUsage.h"
 #include "SelectionInfoWidget.h"
+#include "InputTrace.h"
 #include "Background/BackgroundWidget.h"
 #include "VectorAnimationComplex/VAC.h"
 #include "VectorAnimationComplex/InbetweenFace.h"
+#include "VectorAnimationComplex/TessellationCache.h"
+#include "VectorAnimationComplex/GeometryPager.h"
 
 #include "IO/FileVersionConverter.h"
+#include "IO/CompressedDocument.h"
 #include "XmlStreamWriter.h"
 #include "XmlStreamReader.h"
 #include "SaveAndLoad.h"
@@ -59,6 +65,7 @@ MainWindow::MainWindow() :
     multiView_(0),
 
     aboutDialog_(0),
+    memoryUsageDialog_(0),
 
     gettingStarted_(0),
     userManual_(0),
@@ -69,7 +76,6 @@ MainWindow::MainWindow() :
 
     fileHeader_("---------- Vec File ----------"),
     documentFilePath_(),
-    autosaveFilename_("0.vec"),
     autosaveTimer_(),
     autosaveIndex_(0),
     autosaveOn_(true),
@@ -109,6 +115,7 @@ MainWindow::MainWindow() :
     connect(multiView_, SIGNAL(allViewsNeedToUpdate()), timeline_,SLOT(update()));
     connect(multiView_, SIGNAL(allViewsNeedToUpdate()), this, SLOT(update()));
     connect(multiView_, SIGNAL(allViewsNeedToUpdatePicking()), this, SLOT(updatePicking()));
+    connect(multiView_, SIGNAL(allViewsNeedToUpdateOverlay()), this, SLOT(updateOverlay()));
     setCentralWidget(multiView_); // views are drawn
     connect(multiView_, SIGNAL(activeViewChanged()), this, SLOT(updateViewMenu()));
     connect(multiView_, SIGNAL(activeViewChanged()), timeline_, SLOT(update()));
@@ -177,7 +184,8 @@ MainWindow::MainWindow() :
 
 void MainWindow::updateObjectProperties()
 {
-    inspector->setObjects(scene()->getVAC_()->selectedCells());
+    VectorAnimationComplex::VAC * vac = scene()->getVAC_();
+    inspector->setObjects(vac->selectedCells(), vac->selectionSummary());
 }
 
 View * MainWindow::activeView() const
@@ -202,7 +210,18 @@ bool MainWindow::isShowCanvasChecked() const
 }
 void MainWindow::autosave()
 {
-    save_(autosaveDir_.absoluteFilePath(autosaveFilename_));
+    // Compressed autosaved documents are named N.vecz, like other compressed
+    // documents. If the setting changed, the previous autosave is replaced
+    bool compress = global()->settings().compressAutosave();
+    autosaveDir_.remove(autosaveFilename_(!compress));
+
+    bool relativeRemap = false;
+    save_(autosaveDir_.absoluteFilePath(autosaveFilename_(compress)), relativeRemap, compress);
+}
+
+QString MainWindow::autosaveFilename_(bool compressed) const
+{
+    return QString::number(autosaveIndex_) + (compressed ? ".vecz" : ".vec");
 }
 
 void MainWindow::autosaveBegin()
@@ -230,7 +249,7 @@ void MainWindow::autosaveBegin()
         else
         {
             QStringList nameFilters;
-            nameFilters << "*.vec";
+            nameFilters << "*.vec" << "*.vecz";
             autosaveDir_.setNameFilters(nameFilters);
             QFileInfoList fileInfoList = autosaveDir_.entryInfoList(QDir::Files, QDir::Name);
             if(fileInfoList.isEmpty())
@@ -243,7 +262,7 @@ void MainWindow::autosaveBegin()
                 QStringList splitted = filename.split('.');
                 if(splitted.size() < 2)
                 {
-                    qDebug() << "Warning: autosaved file matching *.vec has been found, but failed to be split into %1.vec";
+                    qDebug() << "Warning: autosaved file matching *.vec or *.vecz has been found, but failed to be split into %1.vec or %1.vecz";
                     autosaveIndex_ = 0;
                 }
                 else
@@ -252,13 +271,10 @@ void MainWindow::autosaveBegin()
                     autosaveIndex_ = lastIndex + 1;
                 }
             }
-            autosaveFilename_.setNum(autosaveIndex_);
-            autosaveFilename_ += QString(".vec");
-            while(autosaveDir_.exists(autosaveFilename_))
+            while(autosaveDir_.exists(autosaveFilename_(false)) ||
+                  autosaveDir_.exists(autosaveFilename_(true)))
             {
                 autosaveIndex_++;
-                autosaveFilename_.setNum(autosaveIndex_);
-                autosaveFilename_ += QString(".vec");
             }
         }
     }
@@ -290,7 +306,7 @@ void MainWindow::autosaveBegin()
                                         QMessageBox::Yes|QMessageBox::No);
         if (reply == QMessageBox::Yes)
         {
-            doOpen(autosaveFilename_);
+            doOpen(autosaveFilename_(global()->settings().compressAutosave()));
         }
     }
     settings.setValue("has-crashed",true);
@@ -305,7 +321,8 @@ void MainWindow::autosaveEnd()
 {
     if(autosaveOn_)
     {
-        autosaveDir_.remove(autosaveFilename_);
+        autosaveDir_.remove(autosaveFilename_(false));
+        autosaveDir_.remove(autosaveFilename_(true));
     }
 }
 
@@ -537,6 +554,17 @@ void MainWindow::update()
     }
 }
 
+void MainWindow::updateOverlay()
+{
+    multiView_->updateOverlay();
+
+    // The 3D view draws hovered cells highlighted, but has no cached image
+    if(view3D_ && view3D_->isVisible())
+    {
+        view3D_->update();
+    }
+}
+
 void MainWindow::updatePicking()
 {
     multiView_->updatePicking();
@@ -612,7 +640,7 @@ void MainWindow::open()
     if (maybeSave_())
     {
         // Browse for a file to open
-        QString filePath = QFileDialog::getOpenFileName(this, tr("Open"), global()->documentDir().path(), tr("Vec files (*.vec)"));
+        QString filePath = QFileDialog::getOpenFileName(this, tr("Open"), global()->documentDir().path(), tr("Vec files (*.vec *.vecz)"));
 
         // Open file
         if (!filePath.isEmpty())
@@ -628,7 +656,9 @@ bool MainWindow::save()
     }
     else
     {
-        bool success = save_(documentFilePath_);
+        bool relativeRemap = false;
+        bool compress = documentFilePath_.endsWith(".vecz", Qt::CaseInsensitive);
+        bool success = save_(documentFilePath_, relativeRemap, compress);
 
         if(success)
         {
@@ -651,11 +681,13 @@ bool MainWindow::saveAs()
     if (filename.isEmpty())
         return false;
 
-    if(!filename.endsWith(".vec"))
+    // Documents saved as *.vecz are compressed
+    bool compress = filename.endsWith(".vecz", Qt::CaseInsensitive);
+    if(!filename.endsWith(".vec") && !compress)
         filename.append(".vec");
 
     bool relativeRemap = true;
-    bool success = save_(filename, relativeRemap);
+    bool success = save_(filename, relativeRemap, compress);
 
     if(success)
     {
@@ -807,8 +839,9 @@ void MainWindow::open_(const QString & filePath)
     // Open (possibly converted) file
     if (conversionSuccessful)
     {
-        QFile file(filePath);
-        if (!file.open(QFile::ReadOnly | QFile::Text))
+        // Compressed documents are decompressed on the fly
+        DocumentInputFile file(filePath);
+        if (!file.isOpen())
         {
             qDebug() << "Error: cannot open file";
             QMessageBox::warning(this, tr("Error"), tr("Error: couldn't open file %1").arg(filePath));
@@ -821,22 +854,19 @@ void MainWindow::open_(const QString & filePath)
         setDocumentFilePath_(filePath);
 
         // Create XML stream reader and proceed
-        XmlStreamReader xml(&file);
+        XmlStreamReader xml(file.device());
         read(xml);
 
-        // Close file
-        file.close();
-
         // Add to undo stack
         resetUndoStack_();
     }
 }
 
-bool MainWindow::save_(const QString & filePath, bool relativeRemap)
+bool MainWindow::save_(const QString & filePath, bool relativeRemap, bool compress)
 {
     // Open file to save to
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QFile::Truncate | QFile::Text))
+    DocumentOutputFile file(filePath, compress);
+    if (!file.isOpen())
     {
         qWarning("Couldn't write file.");
         return false;
@@ -845,7 +875,7 @@ bool MainWindow::save_(const QString & filePath, bool relativeRemap)
     // Remap relative paths if need be
     if (relativeRemap)
     {
-        QFileInfo fileInfo(file);
+        QFileInfo fileInfo(filePath);
         QDir oldDocumentDir = global()->documentDir();
         QDir newDocumentDir = fileInfo.dir();
         if (oldDocumentDir != newDocumentDir)
@@ -856,14 +886,11 @@ bool MainWindow::save_(const QString & filePath, bool relativeRemap)
     }
 
     // Write to file
-    XmlStreamWriter xmlStream(&file);
+    XmlStreamWriter xmlStream(file.device());
     write(xmlStream);
 
-    // Close file
-    file.close();
-
-    // Success
-    return true;
+    // Close file. This flushes the last compressed chunk
+    return file.close();
 }
 
 void MainWindow::read_DEPRECATED(QTextStream & in)
@@ -1265,6 +1292,64 @@ void MainWindow::updateViewMenu()
     actionOnionSkinning->setChecked(multiView_->activeView()->viewSettings().onionSkinningIsEnabled());
 }
 
+void MainWindow::recordInputTrace(bool record)
+{
+    if(record)
+    {
+        InputTrace::startRecording();
+        statusBar()->showMessage(tr("Recording input trace"));
+    }
+    else
+    {
+        InputTrace * trace = InputTrace::stopRecording();
+        if(!trace)
+            return;
+
+        QString filePath = QFileDialog::getSaveFileName(this, tr("Save Input Trace"),
+                                                        global()->documentDir().path(),
+                                                        tr("Input traces (*.vptrace)"));
+        if(!filePath.isEmpty())
+        {
+            if(!filePath.endsWith(".vptrace"))
+                filePath.append(".vptrace");
+
+            if(trace->save(filePath))
+                statusBar()->showMessage(tr("Input trace saved: %1 events").arg(trace->events().size()));
+            else
+                QMessageBox::warning(this, tr("Error"), tr("Error: couldn't write file %1").arg(filePath));
+        }
+        delete trace;
+    }
+}
+
+void MainWindow::addMemoryUsage(MemoryUsage & usage) const
+{
+    scene_->addMemoryUsage(usage);
+    multiView_->addMemoryUsage(usage);
+    VectorAnimationComplex::TessellationCache::instance()->addMemoryUsage(usage);
+    VectorAnimationComplex::GeometryPager::instance()->addMemoryUsage(usage);
+
+    // The caches of undo items are reported separately: they are only
+    // populated if the item was drawn before being pushed to the stack
+    MemoryUsage undoUsage;
+    foreach(UndoItem p, undoStack_)
+    {
+        p.second->addMemoryUsage(undoUsage);
+    }
+    usage.addAsSubsystem("Undo stack", undoUsage);
+}
+
+void MainWindow::openMemoryUsage()
+{
+    if(!memoryUsageDialog_)
+        memoryUsageDialog_ = new MemoryUsageDialog(this);
+    else
+        memoryUsageDialog_->refresh();
+
+    memoryUsageDialog_->show();
+    memoryUsageDialog_->raise();
+}
+
 /*********************************************************************
  *                             Actions
  */
@@ -1488,6 +1573,15 @@ void MainWindow::createActions()
     connect(actionOpenClose3D, SIGNAL(triggered()), this, SLOT(openClose3D()));
     connect(view3D_, SIGNAL(closed()), this, SLOT(view3DActionSetUnchecked()));
 
+    actionRecordInputTrace = new QAction(tr("Record Input Trace [Beta]"), this);
+    actionRecordInputTrace->setCheckable(true);
+    actionRecordInputTrace->setStatusTip(tr("Record sketching, sculpting and selection events, to be replayed with \"VPaint --replay\" for benchmarking"));
+    connect(actionRecordInputTrace, SIGNAL(triggered(bool)), this, SLOT(recordInputTrace(bool)));
+
+    actionOpenMemoryUsage = new QAction(tr("Memory Usage [Beta]"), this);
+    actionOpenMemoryUsage->setStatusTip(tr("Show the memory held by caches, per subsystem"));
+    connect(actionOpenMemoryUsage, SIGNAL(triggered()), this, SLOT(openMemoryUsage()));
+
 
     // Splitting
     actionSplitClose = new QAction(tr("Close active view"), this);
@@ -1681,6 +1775,13 @@ void MainWindow::createActions()
     actionInbetweenSelection->setShortcutContext(Qt::ApplicationShortcut);
     connect(actionInbetweenSelection, SIGNAL(triggered()), scene_, SLOT(inbetweenSelection()));
 
+    // Inbetween keyframes
+    actionInbetweenKeyframes = new QAction(tr("Inbetween keyframes [Beta]"), this);
+    actionInbetweenKeyframes->setStatusTip(tr("Automatically match the selected cells of two frames, and inbetween each matching pair."));
+    actionInbetweenKeyframes->setShortcut(QKeySequence(Qt::SHIFT + Qt::Key_I));
+    actionInbetweenKeyframes->setShortcutContext(Qt::ApplicationShortcut);
+    connect(actionInbetweenKeyframes, SIGNAL(triggered()), scene_, SLOT(inbetweenKeyframes()));
+
     // Create inbetween Face
     actionCreateInbetweenFace = new QAction(tr("Create inbetween face [Beta]"), this);
     actionCreateInbetweenFace->setStatusTip(tr("Open the animated cycle editor to create a new inbetween face."));
@@ -1789,6 +1890,8 @@ void MainWindow::createMenus()
         advancedViewMenu->addAction(dockAnimatedCycleEditor->toggleViewAction());
         advancedViewMenu->addAction(actionOpenClose3D);
         advancedViewMenu->addAction(actionOpenView3DSettings);
+        advancedViewMenu->addAction(actionRecordInputTrace);
+        advancedViewMenu->addAction(actionOpenMemoryUsage);
     }
 
     menuBar()->addMenu(menuView);
@@ -1828,6 +1931,7 @@ void MainWindow::createMenus()
     menuAnimation->addAction(actionMotionPaste);
     menuAnimation->addAction(actionKeyframeSelection);
     menuAnimation->addAction(actionInbetweenSelection);
+    menuAnimation->addAction(actionInbetweenKeyframes);
     menuAnimation->addAction(actionCreateInbetweenFace);
     menuBar()->addMenu(menuAnimation);
 
@@ -31,6 +31,8 @@ class QTextStream;
 class EditCanvasSizeDialog;
 class ExportPngDialog;
 class AboutDialog;
+class MemoryUsageDialog;
+class MemoryUsage;
 class BackgroundWidget;
 
 namespace VectorAnimationComplex
@@ -55,6 +57,9 @@ public:
     View * hoveredView() const;
     Timeline * timeline() const;
 
+    // Memory held by the scene, the views, and the undo stack
+    void addMemoryUsage(MemoryUsage & usage) const;
+
     bool isShowCanvasChecked() const;
     bool isEditCanvasSizeVisible() const;
 
@@ -67,6 +72,7 @@ protected:
 public slots:
     // ---- update what is displayed on screen ----
     void update();
+    void updateOverlay();
     void updatePicking();
 
     void updateObjectProperties();
@@ -117,6 +123,9 @@ private slots:
 
     void updateViewMenu();
 
+    void recordInputTrace(bool record);
+    void openMemoryUsage();
+
     // ---- Selection ----
     // -> deferred to Scene
 
@@ -146,6 +155,8 @@ private:
     MultiView * multiView_;
     // Help
     AboutDialog * aboutDialog_;
+    // Debug
+    MemoryUsageDialog * memoryUsageDialog_;
     bool showAboutDialogAtStartup_;
     QTextBrowser * gettingStarted_;
     QTextBrowser * userManual_;
@@ -160,7 +171,6 @@ private:
     // I/O
     QString fileHeader_;
     QString documentFilePath_;
-    QString autosaveFilename_;
     QTimer autosaveTimer_;
     int autosaveIndex_;
     bool autosaveOn_;
@@ -171,7 +181,7 @@ private:
     void updateWindowTitle_();
     void setDocumentFilePath_(const QString & filePath);
     bool maybeSave_();
-    bool save_(const QString & filePath, bool relativeRemap = false);
+    bool save_(const QString & filePath, bool relativeRemap = false, bool compress = false);
     bool doExportSVG(const QString & filename);
     bool doExportPNG(const QString & filename);
     void read_DEPRECATED(QTextStream & in);
@@ -180,6 +190,7 @@ private:
     void write(XmlStreamWriter & xml);
     void autosaveBegin();
     void autosaveEnd();
+    QString autosaveFilename_(bool compressed) const; // N.vec or N.vecz
     // Copy-pasting
     VectorAnimationComplex::VAC * clipboard_;
     // 3D view
@@ -232,6 +243,8 @@ private:
       QAction * actionToggleOutlineOnly;
       QAction * actionOpenView3DSettings;
       QAction * actionOpenClose3D;
+      QAction * actionRecordInputTrace;
+      QAction * actionOpenMemoryUsage;
       QAction * actionSplitVertical;
       QAction * actionSplitHorizontal;
       QAction * actionSplitClose;
@@ -263,6 +276,7 @@ private:
     // ANIMATION
     QMenu * menuAnimation;
       QAction * actionInbetweenSelection;
+      QAction * actionInbetweenKeyframes;
       QAction * actionKeyframeSelection;
       QAction * actionMotionPaste;
       QAction * actionCreateInbetweenFace;
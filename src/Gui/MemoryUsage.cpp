@@ -0,0 +1,99 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "MemoryUsage.h"
+
+#include <QTextStream>
+
+void MemoryUsage::add(const QString & subsystem, const QString & category,
+                      qint64 numBytes, qint64 numItems)
+{
+    Entry & e = entries_[subsystem][category];
+    e.numBytes += numBytes;
+    e.numItems += numItems;
+}
+
+void MemoryUsage::addAsSubsystem(const QString & subsystem, const MemoryUsage & other)
+{
+    for (auto it = other.entries_.begin(); it != other.entries_.end(); ++it)
+    {
+        for (auto jt = it.value().begin(); jt != it.value().end(); ++jt)
+        {
+            add(subsystem, jt.key(), jt.value().numBytes, jt.value().numItems);
+        }
+    }
+}
+
+qint64 MemoryUsage::totalBytes() const
+{
+    qint64 res = 0;
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+        res += totalBytes(it.key());
+    return res;
+}
+
+qint64 MemoryUsage::totalBytes(const QString & subsystem) const
+{
+    qint64 res = 0;
+    const QMap<QString, Entry> categories = entries_.value(subsystem);
+    for (auto it = categories.begin(); it != categories.end(); ++it)
+        res += it.value().numBytes;
+    return res;
+}
+
+MemoryUsage::Entry MemoryUsage::entry(const QString & subsystem, const QString & category) const
+{
+    return entries_.value(subsystem).value(category);
+}
+
+QList<QString> MemoryUsage::subsystems() const
+{
+    return entries_.keys();
+}
+
+QList<QString> MemoryUsage::categories(const QString & subsystem) const
+{
+    return entries_.value(subsystem).keys();
+}
+
+QString MemoryUsage::report() const
+{
+    QString res;
+    QTextStream out(&res);
+
+    const int nameWidth = 40;
+    const int columnWidth = 12;
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        out << it.key().leftJustified(nameWidth)
+            << toString(totalBytes(it.key())).rightJustified(columnWidth) << "\n";
+        for (auto jt = it.value().begin(); jt != it.value().end(); ++jt)
+        {
+            out << ("    " + jt.key()).leftJustified(nameWidth)
+                << toString(jt.value().numBytes).rightJustified(columnWidth)
+                << QString::number(jt.value().numItems).rightJustified(columnWidth)
+                << " items\n";
+        }
+    }
+    out << QString("Total").leftJustified(nameWidth)
+        << toString(totalBytes()).rightJustified(columnWidth) << "\n";
+
+    return res;
+}
+
+QString MemoryUsage::toString(qint64 numBytes)
+{
+    if (numBytes < 1024)
+        return QString("%1 B").arg(numBytes);
+    else if (numBytes < 1024 * 1024)
+        return QString("%1 KB").arg(numBytes / 1024.0, 0, 'f', 1);
+    else if (numBytes < 1024 * 1024 * 1024)
+        return QString("%1 MB").arg(numBytes / (1024.0 * 1024.0), 0, 'f', 1);
+    else
+        return QString("%1 GB").arg(numBytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
+}
@@ -0,0 +1,89 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <QMap>
+#include <QString>
+#include <QList>
+#include <vector>
+
+/*
+ * MemoryUsage.h
+ *
+ * Byte-level accounting of the memory held by caches and stores, organized
+ * by subsystem (e.g., "Cell caches") and category within a subsystem (e.g.,
+ * "KeyEdge triangles").
+ *
+ * Nothing is tracked while the program runs: objects add their current
+ * usage when asked to, e.g. by VAC::addMemoryUsage(), which is a traversal
+ * of the data without any allocation per item. Sizes are computed from
+ * element counts and container capacities, and therefore ignore allocator
+ * overhead.
+ *
+ */
+
+class MemoryUsage
+{
+public:
+    struct Entry
+    {
+        Entry() : numBytes(0), numItems(0) {}
+        qint64 numBytes;
+        qint64 numItems;
+    };
+
+    // Adds numBytes, held by numItems items, to the given category
+    void add(const QString & subsystem, const QString & category,
+             qint64 numBytes, qint64 numItems = 1);
+
+    // Adds all categories of other to the given subsystem, merging
+    // categories with the same name
+    void addAsSubsystem(const QString & subsystem, const MemoryUsage & other);
+
+    // Queries
+    qint64 totalBytes() const;
+    qint64 totalBytes(const QString & subsystem) const;
+    Entry entry(const QString & subsystem, const QString & category) const;
+    QList<QString> subsystems() const;
+    QList<QString> categories(const QString & subsystem) const;
+
+    // Human readable report, one line per category
+    QString report() const;
+
+    // Helpers computing the memory held by containers. They do not include
+    // the size of the container object itself, which is assumed to be
+    // accounted for by its owner
+    template <class T, class A>
+    static qint64 bytes(const std::vector<T,A> & v)
+    {
+        return (qint64) v.capacity() * sizeof(T);
+    }
+    template <class T>
+    static qint64 bytes(const QList<T> & list)
+    {
+        // QList stores pointers to heap-allocated items, unless items are
+        // small and movable. We assume the former, which is an upper bound
+        return (qint64) list.size() * (sizeof(void*) + sizeof(T));
+    }
+    template <class K, class V>
+    static qint64 mapNodeBytes(const QMap<K,V> & map)
+    {
+        // QMap nodes store two children, the parent and color, key and value
+        return (qint64) map.size() * (3 * sizeof(void*) + sizeof(K) + sizeof(V));
+    }
+
+    // Human readable byte count, e.g. "12.3 MB"
+    static QString toString(qint64 numBytes);
+
+private:
+    QMap<QString, QMap<QString, Entry> > entries_;
+};
+
+#endif // MEMORYUSAGE_H
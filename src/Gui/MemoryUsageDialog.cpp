@@ -0,0 +1,50 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+
+#include "MemoryUsageDialog.h"
+
+#include "MainWindow.h"
+#include "MemoryUsage.h"
+
+#include <QVBoxLayout>
+#include <QPlainTextEdit>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QFontDatabase>
+
+MemoryUsageDialog::MemoryUsageDialog(MainWindow * mainWindow) :
+    QDialog(mainWindow),
+    mainWindow_(mainWindow)
+{
+    setWindowTitle(tr("Memory Usage"));
+    setMinimumSize(600, 500);
+
+    textEdit_ = new QPlainTextEdit();
+    textEdit_->setReadOnly(true);
+    textEdit_->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    QDialogButtonBox * buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    QPushButton * refreshButton = buttonBox->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+    connect(refreshButton, SIGNAL(clicked()), this, SLOT(refresh()));
+    connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    QVBoxLayout * layout = new QVBoxLayout();
+    layout->addWidget(textEdit_);
+    layout->addWidget(buttonBox);
+    setLayout(layout);
+
+    refresh();
+}
+
+void MemoryUsageDialog::refresh()
+{
+    MemoryUsage usage;
+    mainWindow_->addMemoryUsage(usage);
+    textEdit_->setPlainText(usage.report());
+}
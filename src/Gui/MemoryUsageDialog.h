@@ -0,0 +1,34 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+
+#ifndef MEMORYUSAGEDIALOG_H
+#define MEMORYUSAGEDIALOG_H
+
+#include <QDialog>
+
+class QPlainTextEdit;
+class MainWindow;
+
+// Debug dialog displaying MainWindow::addMemoryUsage() as text
+class MemoryUsageDialog: public QDialog
+{
+    Q_OBJECT
+
+public:
+    MemoryUsageDialog(MainWindow * mainWindow);
+
+public slots:
+    void refresh();
+
+private:
+    MainWindow * mainWindow_;
+    QPlainTextEdit * textEdit_;
+};
+
+#endif // MEMORYUSAGEDIALOG_H
@@ -12,6 +12,7 @@
 #include "Scene.h"
 #include "Timeline.h"
 #include "Global.h"
+#include "MemoryUsage.h"
 
 #include <QKeyEvent>
 #include <QtDebug>
@@ -86,9 +87,9 @@ MultiView::MultiView(Scene *scene, QWidget *parent) :
     setLayout(layout);
 
     // Redraw views when necessary
-    // This line is necessary since some mouse cursor are drawn by VAC->draw()
+    // This line is necessary since some mouse cursor are drawn by VAC->drawOverlay()
     // and depends on which view is hovered, if any
-    connect(this, SIGNAL(hoveredViewChanged()), this, SIGNAL(allViewsNeedToUpdate()));
+    connect(this, SIGNAL(hoveredViewChanged()), this, SIGNAL(allViewsNeedToUpdateOverlay()));
 }
 
 View * MultiView::createView_()
@@ -106,6 +107,7 @@ View * MultiView::createView_()
 
     connect(view, SIGNAL(allViewsNeedToUpdate()), this, SIGNAL(allViewsNeedToUpdate()));
     connect(view, SIGNAL(allViewsNeedToUpdatePicking()), this, SIGNAL(allViewsNeedToUpdatePicking()));
+    connect(view, SIGNAL(allViewsNeedToUpdateOverlay()), this, SIGNAL(allViewsNeedToUpdateOverlay()));
     connect(view, SIGNAL(mousePressed(GLWidget*)), this, SLOT(setActive(GLWidget*)));
     connect(view, SIGNAL(mouseEntered(GLWidget*)), this, SLOT(setHovered(GLWidget*)));
     connect(view, SIGNAL(mouseLeft(GLWidget*)), this, SLOT(unsetHovered(GLWidget*)));
@@ -140,6 +142,14 @@ void MultiView::deleteView_(View * view)
     }
 }
 
+void MultiView::addMemoryUsage(MemoryUsage & usage) const
+{
+    foreach (ViewWidget * viewWidget, views_)
+    {
+        viewFromViewWidget_(viewWidget)->addMemoryUsage(usage);
+    }
+}
+
 void MultiView::setActiveView(View * view)
 {
     if(view && (activeView_!=view))
@@ -394,6 +404,16 @@ void MultiView::update()
     }
 }
 
+void MultiView::updateOverlay()
+{
+    foreach(ViewWidget * viewWidget, views_)
+    {
+        View * view = viewFromViewWidget_(viewWidget);
+        if(view->isVisible())
+            view->updateOverlay();
+    }
+}
+
 void MultiView::updatePicking()
 {
     foreach(ViewWidget * viewWidget, views_)
@@ -18,6 +18,7 @@ class View;
 class ViewMacOsX;
 class QSplitter;
 class GLWidget;
+class MemoryUsage;
 
 // typedef to solve the MacOSX / Win+Linux discrepency
 #ifdef Q_OS_MAC
@@ -46,8 +47,12 @@ public:
 
     void setActiveView(View * view);
 
+    // Memory held by all views
+    void addMemoryUsage(MemoryUsage & usage) const;
+
 public slots:
     void update();        // update only the views in MultiView (not the 3D view)
+    void updateOverlay(); // update only the overlays of the views in MultiView (not the 3D view)
     void updatePicking(); // update only the views in MultiView (not the 3D view)
 
     void zoomIn();
@@ -71,6 +76,7 @@ public slots:
 signals:
     void allViewsNeedToUpdate();        // update all views (including these and the 3D view)
     void allViewsNeedToUpdatePicking(); // update all views (including these and the 3D view)
+    void allViewsNeedToUpdateOverlay(); // update overlays of all views (and the 3D view, which has no overlay)
     void activeViewChanged();
     void hoveredViewChanged();
     void cameraChanged();
@@ -17,6 +17,20 @@
 #include "VectorAnimationComplex/InbetweenFace.h"
 #include "Global.h"
 #include "MainWindow.h"
+#include "Scene.h"
+#include "SelectionSummary.h"
+#include "IdListCopier.h"
+
+namespace
+{
+// Number of ids shown when the list of ids is collapsed
+const int numIdPerLine = 5;
+
+// Maximum number of ids shown when the list of ids is expanded. Larger lists
+// would make the label too slow to lay out, and too long to be of any use.
+// All of them can be copied to the clipboard instead
+const int maxNumIdMore = 500;
+}
 
 ObjectPropertiesWidget::ObjectPropertiesWidget()
 {
@@ -37,6 +51,12 @@ ObjectPropertiesWidget::ObjectPropertiesWidget()
     idMoreLessButton_ = new QPushButton(moreText_);
     idMoreLessButton_->setMaximumHeight(15);
     connect(idMoreLessButton_, SIGNAL(clicked()), this, SLOT(idMoreLessSlot()));
+    copyIdsButton_ = new QPushButton(tr("copy all"));
+    copyIdsButton_->setMaximumHeight(15);
+    copyIdsButton_->setToolTip(tr("Copy the IDs of all selected objects to the clipboard"));
+    connect(copyIdsButton_, SIGNAL(clicked()), this, SLOT(copyIds()));
+    idListCopier_ = new IdListCopier(this);
+    connect(idListCopier_, SIGNAL(finished(int)), this, SLOT(idsCopied(int)));
     QHBoxLayout * idLayout = new QHBoxLayout();
     idLayout->addWidget(idLabel);
     idLayout->setAlignment(idLabel, Qt::AlignTop);
@@ -44,6 +64,8 @@ ObjectPropertiesWidget::ObjectPropertiesWidget()
     idLayout->setAlignment(id_, Qt::AlignTop);
     idLayout->addWidget(idMoreLessButton_);
     idLayout->setAlignment(idMoreLessButton_, Qt::AlignTop);
+    idLayout->addWidget(copyIdsButton_);
+    idLayout->setAlignment(copyIdsButton_, Qt::AlignTop);
     idLayout->addStretch();
 
     // -- inbetween closed edge --
@@ -106,7 +128,7 @@ ObjectPropertiesWidget::ObjectPropertiesWidget()
     setLayout(mainLayout_);
 
     // -- Set that no object is selected --
-    setObjects(VectorAnimationComplex::CellSet());
+    setObjects(VectorAnimationComplex::CellSet(), SelectionSummary());
 }
 
 ObjectPropertiesWidget::~ObjectPropertiesWidget()
@@ -282,11 +304,11 @@ void ObjectPropertiesWidget::setObject(InbetweenFace * inbetweenFace)
     setAnimatedCycle(0);
 }
 
-void ObjectPropertiesWidget::setObjects(const VectorAnimationComplex::CellSet & cells)
+void ObjectPropertiesWidget::setObjects(const VectorAnimationComplex::CellSet & cells, const SelectionSummary & summary)
 {
     // Always visible info
-    setType(getStringType(cells));
-    setId(cells);
+    setType(getStringType(summary));
+    setId(cells, summary);
 
     // Hide all other selection-dependent info
     hideInbetweenClosedEdgeWidgets();
@@ -332,49 +354,17 @@ QString ObjectPropertiesWidget::getStringType(VectorAnimationComplex::Cell * cel
         return tr("unknown object");
 }
 
-QString ObjectPropertiesWidget::getStringType(const VectorAnimationComplex::CellSet & cells)
+QString ObjectPropertiesWidget::getStringType(const SelectionSummary & summary)
 {
-    //VectorAnimationComplex::KeyVertexSet kv = cells;
-    //VectorAnimationComplex::KeyEdgeSet ke = cells;
-    //VectorAnimationComplex::KeyFaceSet kf = cells;
-    //VectorAnimationComplex::InbetweenVertexSet sv = cells;
-    //VectorAnimationComplex::InbetweenEdgeSet se = cells;
-    //VectorAnimationComplex::InbetweenFaceSet sf = cells;
-
     // Count cells
-    int nkv = 0;
-    int nkoe = 0;
-    int nkce = 0;
-    int nkf = 0;
-    int nsv = 0;
-    int nsoe = 0;
-    int nsce = 0;
-    int nsf = 0;
-    foreach(VectorAnimationComplex::Cell * cell, cells)
-    {
-        if(cell->toKeyVertex())
-            ++nkv;
-        else if(cell->toKeyEdge())
-        {
-            if(cell->toKeyEdge()->isClosed())
-                ++nkce;
-            else
-                ++nkoe;
-        }
-        else if(cell->toKeyFace())
-            ++nkf;
-        else if(cell->toInbetweenVertex())
-            ++nsv;
-        else if(cell->toInbetweenEdge())
-        {
-            if(cell->toInbetweenEdge()->isClosed())
-                ++nsce;
-            else
-                ++nsoe;
-        }
-        else if(cell->toInbetweenFace())
-            ++nsf;
-    }
+    int nkv = summary.count(SelectionSummary::KeyVertexType);
+    int nkoe = summary.count(SelectionSummary::KeyOpenEdgeType);
+    int nkce = summary.count(SelectionSummary::KeyClosedEdgeType);
+    int nkf = summary.count(SelectionSummary::KeyFaceType);
+    int nsv = summary.count(SelectionSummary::InbetweenVertexType);
+    int nsoe = summary.count(SelectionSummary::InbetweenOpenEdgeType);
+    int nsce = summary.count(SelectionSummary::InbetweenClosedEdgeType);
+    int nsf = summary.count(SelectionSummary::InbetweenFaceType);
 
     // Set string according to count
     QStringList stringList;
@@ -427,46 +417,54 @@ void ObjectPropertiesWidget::setType(const QString & type)
     type_->setText(type);
 }
 
-void ObjectPropertiesWidget::setId(const VectorAnimationComplex::CellSet & cells)
+void ObjectPropertiesWidget::setId(const VectorAnimationComplex::CellSet & cells, const SelectionSummary & summary)
 {
-    int numIdPerLine = 5;
+    // Both lists are capped, so that they only depend on the first ids
+    QVector<int> ids = SelectionSummary::firstIds(cells, maxNumIdMore);
+    int numCells = summary.numCells();
 
     idLess_ = QString("");
     idMore_ = QString("");
-    idMoreLessButton_->hide();
-
-    int i = 0; // count cells
-    int j = 0; // num on line
-    foreach(VectorAnimationComplex::Cell * cell, cells)
+    for(int i=0; i<ids.size(); ++i)
     {
-        j = i % numIdPerLine;
         if(i==0)
         {
-            idMore_ += QString().setNum(cell->id());
-            idLess_ += QString().setNum(cell->id());
+            idMore_ += QString().setNum(ids[i]);
+            idLess_ += QString().setNum(ids[i]);
         }
-        else if(j==0)
+        else if(i % numIdPerLine == 0)
         {
-            idMore_ += QString(",\n") + QString().setNum(cell->id());
-
-            if(i == numIdPerLine)
-            {
-                idLess_ += QString(",...");
-                idMoreLessButton_->show();
-            }
+            idMore_ += QString(",\n") + QString().setNum(ids[i]);
         }
         else
         {
-            idMore_ += QString(", ") + QString().setNum(cell->id());
+            idMore_ += QString(", ") + QString().setNum(ids[i]);
 
             if(i < numIdPerLine)
             {
-                idLess_ += QString(", ") + QString().setNum(cell->id());
+                idLess_ += QString(", ") + QString().setNum(ids[i]);
             }
+        }
+    }
 
+    if(numCells > numIdPerLine)
+    {
+        idLess_ += QString(",...");
+        idMoreLessButton_->show();
+    }
+    else
+    {
+        idMoreLessButton_->hide();
+    }
 
-        }
-        ++i;
+    if(numCells > ids.size())
+    {
+        idMore_ += QString(",...\n") + tr("(%1 more)").arg(numCells - ids.size());
+        copyIdsButton_->show();
+    }
+    else
+    {
+        copyIdsButton_->hide();
     }
 
     setIdFromString();
@@ -485,6 +483,23 @@ void ObjectPropertiesWidget::setIdFromString()
     update();
 }
 
+void ObjectPropertiesWidget::copyIds()
+{
+    VectorAnimationComplex::VAC * vac = global()->mainWindow()->scene()->vectorAnimationComplex();
+    if(vac)
+    {
+        idListCopier_->copy(vac->selectedCells());
+        copyIdsButton_->setText(tr("copying..."));
+        copyIdsButton_->setEnabled(false);
+    }
+}
+
+void ObjectPropertiesWidget::idsCopied(int /*numIds*/)
+{
+    copyIdsButton_->setText(tr("copy all"));
+    copyIdsButton_->setEnabled(true);
+}
+
 void ObjectPropertiesWidget::idMoreLessSlot()
 {
     if(idMoreLessButton_->text() ==  moreText_)
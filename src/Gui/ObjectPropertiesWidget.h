@@ -21,6 +21,9 @@
 #include "VectorAnimationComplex/CellList.h"
 #include "AnimatedCycleWidget.h"
 
+class SelectionSummary;
+class IdListCopier;
+
 class ObjectPropertiesWidget: public QWidget
 {
     Q_OBJECT
@@ -29,10 +32,12 @@ public:
     ObjectPropertiesWidget();
     ~ObjectPropertiesWidget();
 
-    void setObjects(const VectorAnimationComplex::CellSet & cells);
+    void setObjects(const VectorAnimationComplex::CellSet & cells, const SelectionSummary & summary);
 
 private slots:
     void idMoreLessSlot();
+    void copyIds();
+    void idsCopied(int numIds);
     void toggleAnimatedCycleShowHide();
     void setAnimatedCycle(int i);
     void animatedCycleEdit();
@@ -46,9 +51,9 @@ private slots:
 private:
 
     QString getStringType(VectorAnimationComplex::Cell * cell);
-    QString getStringType(const VectorAnimationComplex::CellSet & cells);
+    QString getStringType(const SelectionSummary & summary);
     void setType(const QString & type);
-    void setId(const VectorAnimationComplex::CellSet & cells);
+    void setId(const VectorAnimationComplex::CellSet & cells, const SelectionSummary & summary);
     void setIdFromString();
 
     QVBoxLayout * mainLayout_;
@@ -59,6 +64,8 @@ private:
     QString lessText_;
     QString idMore_;
     QPushButton * idMoreLessButton_;
+    QPushButton * copyIdsButton_;
+    IdListCopier * idListCopier_;
 
     // Inbetween edge
     void setObject(InbetweenEdge * inbetweenEdge);
@@ -0,0 +1,157 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "PlaybackCache.h"
+#include "MemoryUsage.h"
+
+PlaybackCache::PlaybackCache() :
+    maxBytes_(256 * 1024 * 1024),
+    fboId_(0),
+    width_(0),
+    height_(0)
+{
+}
+
+PlaybackCache::Settings::Settings() :
+    toolMode(-1),
+    displayMode(-1),
+    settingsGeneration(-1)
+{
+}
+
+bool PlaybackCache::Settings::operator==(const Settings & other) const
+{
+    return toolMode == other.toolMode &&
+           displayMode == other.displayMode &&
+           settingsGeneration == other.settingsGeneration;
+}
+
+PlaybackCache::~PlaybackCache()
+{
+    clear();
+}
+
+void PlaybackCache::setMaxBytes(qint64 maxBytes)
+{
+    maxBytes_ = maxBytes;
+    updateBudget_();
+}
+
+void PlaybackCache::updateBudget_()
+{
+    QList<GLuint> removedTextures;
+    index_.setBudget(maxBytes_, bytesPerFrame_(), removedTextures);
+    deleteTextures_(removedTextures);
+}
+
+void PlaybackCache::deleteTextures_(const QList<GLuint> & textureIds)
+{
+    foreach(GLuint textureId, textureIds)
+        glDeleteTextures(1, &textureId);
+}
+
+void PlaybackCache::setViewport(const GLWidget_Camera2D & camera, int width, int height, const Settings & settings)
+{
+    if(camera.x() != camera_.x() ||
+       camera.y() != camera_.y() ||
+       camera.zoom() != camera_.zoom() ||
+       width != width_ || height != height_ || settings != settings_)
+    {
+        clear();
+        camera_ = camera;
+        width_ = width;
+        height_ = height;
+        settings_ = settings;
+        updateBudget_();
+    }
+}
+
+qint64 PlaybackCache::bytesPerFrame_() const
+{
+    return 4 * (qint64) width_ * height_;
+}
+
+GLuint PlaybackCache::texture(int frame, quint64 frameRevision)
+{
+    return index_.texture(frame, frameRevision);
+}
+
+bool PlaybackCache::contains(int frame, quint64 frameRevision) const
+{
+    return index_.contains(frame, frameRevision);
+}
+
+GLuint PlaybackCache::newTexture_()
+{
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return textureId;
+}
+
+void PlaybackCache::capture(int frame, quint64 revision)
+{
+    if(width_ <= 0 || height_ <= 0 || maxNumFrames() == 0)
+        return;
+
+    // Same as View::captureSceneImage_(): the window framebuffer is
+    // multisampled, so it is resolved by blitting it to a framebuffer object
+    if(!(GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object))
+        return;
+    if(!fboId_)
+        glGenFramebuffers(1, &fboId_);
+
+    // Reuse the texture of the outdated image of this frame if any, or of
+    // the least recently used image if the budget is reached
+    GLuint textureId = index_.takeTextureFor(frame);
+    if(!textureId)
+        textureId = newTexture_();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fboId_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, textureId, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if(status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteTextures(1, &textureId);
+        return;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    index_.insert(frame, textureId, revision);
+}
+
+void PlaybackCache::clear()
+{
+    QList<GLuint> removedTextures;
+    index_.clear(removedTextures);
+    deleteTextures_(removedTextures);
+
+    if(fboId_)
+    {
+        glDeleteFramebuffers(1, &fboId_);
+        fboId_ = 0;
+    }
+}
+
+void PlaybackCache::addMemoryUsage(MemoryUsage & usage) const
+{
+    if(numFrames() > 0)
+        usage.add("Views", "Playback cache", numFrames() * bytesPerFrame_(), numFrames());
+}
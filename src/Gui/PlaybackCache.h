@@ -0,0 +1,111 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef PLAYBACKCACHE_H
+#define PLAYBACKCACHE_H
+
+#include "OpenGL.h"
+#include "GLWidget_Camera2D.h"
+#include "PlaybackCacheIndex.h"
+
+#include <QList>
+
+class MemoryUsage;
+
+/*
+ * PlaybackCache.h
+ *
+ * Rendered images of the frames of a View, kept as OpenGL textures so that
+ * playback can draw a cached frame as a single textured quad instead of
+ * drawing all its cells, which includes evaluating inbetween cells.
+ *
+ * Frames are captured from the window framebuffer of the view, just after
+ * the scene was drawn, either during playback or when the view renders
+ * frames ahead of playback (see View::prerenderPlaybackFrame_()).
+ *
+ * Each image remembers the revision of the VAC it was rendered with (see
+ * VAC::revision()). An image is only returned if this revision is at least
+ * the revision of its frame (see VAC::frameRevision()), that is, if none of
+ * the cells visible at this frame changed since the image was rendered.
+ *
+ * Images are only valid for a given camera, viewport size and settings
+ * (see Settings). Changing any of these clears the cache. Images of frames
+ * drawn with onion skins depend on other frames, so they must not be
+ * cached.
+ *
+ * The total size of the images is bounded by maxBytes(). When the budget
+ * is reached, the least recently used image is recycled (see
+ * PlaybackCacheIndex.h).
+ *
+ * Must be used with the OpenGL context of the view current.
+ *
+ */
+
+class PlaybackCache
+{
+public:
+    PlaybackCache();
+    ~PlaybackCache();
+
+    // Memory budget, in bytes. Zero disables the cache
+    qint64 maxBytes() const { return maxBytes_; }
+    void setMaxBytes(qint64 maxBytes);
+
+    // Everything affecting the images other than the camera, the viewport
+    // size and the cells
+    struct Settings
+    {
+        Settings();
+
+        int toolMode;           // affects the color of selected cells
+        int displayMode;        // ViewSettings::DisplayMode
+        int settingsGeneration; // changes with any view or dev setting
+
+        bool operator==(const Settings & other) const;
+        bool operator!=(const Settings & other) const { return !(*this == other); }
+    };
+
+    // Clears the cache if the camera, viewport size or settings differ
+    // from the ones of the cached images
+    void setViewport(const GLWidget_Camera2D & camera, int width, int height, const Settings & settings);
+
+    // Maximum number of images fitting in the memory budget for the
+    // current viewport size
+    int maxNumFrames() const { return index_.maxNumFrames(); }
+    int numFrames() const { return index_.numFrames(); }
+
+    // Texture of the image of the given frame, or 0 if it is not cached or
+    // out of date. Marks the image as recently used
+    GLuint texture(int frame, quint64 frameRevision);
+    bool contains(int frame, quint64 frameRevision) const;
+
+    // Copies the viewport of the window framebuffer, which must contain the
+    // scene drawn at the given frame with the given VAC revision
+    void capture(int frame, quint64 revision);
+
+    // Removes all images. Textures are deleted
+    void clear();
+
+    void addMemoryUsage(MemoryUsage & usage) const;
+
+private:
+    PlaybackCacheIndex index_;
+    qint64 maxBytes_;
+    GLuint fboId_;
+    GLWidget_Camera2D camera_;
+    int width_;
+    int height_;
+    Settings settings_;
+
+    qint64 bytesPerFrame_() const;
+    void updateBudget_();
+    GLuint newTexture_();
+    static void deleteTextures_(const QList<GLuint> & textureIds);
+};
+
+#endif // PLAYBACKCACHE_H
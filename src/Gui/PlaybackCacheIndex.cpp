@@ -0,0 +1,99 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "PlaybackCacheIndex.h"
+
+PlaybackCacheIndex::PlaybackCacheIndex() :
+    maxBytes_(0),
+    bytesPerFrame_(0)
+{
+}
+
+void PlaybackCacheIndex::setBudget(qint64 maxBytes, qint64 bytesPerFrame, QList<unsigned int> & removedTextures)
+{
+    maxBytes_ = maxBytes;
+    bytesPerFrame_ = bytesPerFrame;
+    unsigned int textureId;
+    while(numFrames() > maxNumFrames() && takeLeastRecentlyUsed_(textureId))
+        removedTextures << textureId;
+}
+
+int PlaybackCacheIndex::maxNumFrames() const
+{
+    return bytesPerFrame_ > 0 ? maxBytes_ / bytesPerFrame_ : 0;
+}
+
+unsigned int PlaybackCacheIndex::texture(int frame, quint64 frameRevision)
+{
+    auto it = entries_.find(frame);
+    if(it == entries_.end() || it->revision < frameRevision)
+        return 0;
+
+    lru_.splice(lru_.begin(), lru_, it->lruIt);
+    return it->textureId;
+}
+
+bool PlaybackCacheIndex::contains(int frame, quint64 frameRevision) const
+{
+    auto it = entries_.find(frame);
+    return it != entries_.end() && it->revision >= frameRevision;
+}
+
+unsigned int PlaybackCacheIndex::takeTextureFor(int frame)
+{
+    unsigned int textureId = 0;
+    auto it = entries_.find(frame);
+    if(it != entries_.end())
+    {
+        textureId = it->textureId;
+        lru_.erase(it->lruIt);
+        entries_.erase(it);
+    }
+    else if(numFrames() >= maxNumFrames())
+    {
+        takeLeastRecentlyUsed_(textureId);
+    }
+    return textureId;
+}
+
+void PlaybackCacheIndex::insert(int frame, unsigned int textureId, quint64 revision)
+{
+    lru_.push_front(frame);
+    Entry & entry = entries_[frame];
+    entry.textureId = textureId;
+    entry.revision = revision;
+    entry.lruIt = lru_.begin();
+}
+
+bool PlaybackCacheIndex::takeLeastRecentlyUsed_(unsigned int & textureId)
+{
+    if(lru_.empty())
+        return false;
+
+    int frame = lru_.back();
+    lru_.pop_back();
+    textureId = entries_[frame].textureId;
+    entries_.remove(frame);
+    return true;
+}
+
+void PlaybackCacheIndex::clear(QList<unsigned int> & removedTextures)
+{
+    foreach(const Entry & entry, entries_)
+        removedTextures << entry.textureId;
+    entries_.clear();
+    lru_.clear();
+}
+
+QList<int> PlaybackCacheIndex::frames() const
+{
+    QList<int> res;
+    for(int frame : lru_)
+        res << frame;
+    return res;
+}
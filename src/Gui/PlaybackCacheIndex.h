@@ -0,0 +1,80 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef PLAYBACKCACHEINDEX_H
+#define PLAYBACKCACHEINDEX_H
+
+#include <QMap>
+#include <QList>
+#include <list>
+
+/*
+ * PlaybackCacheIndex.h
+ *
+ * Bookkeeping of the images of a PlaybackCache, without any OpenGL call:
+ * which frames have an image, the VAC revision each image was rendered
+ * with, and the order in which the images were used. Images are identified
+ * by the name of their texture, which PlaybackCache creates and deletes.
+ *
+ * The number of images is bounded by the memory budget. When the index is
+ * full, the texture of the least recently used image is recycled for the
+ * next image. Functions removing images return their textures, so that
+ * they can be deleted.
+ *
+ */
+
+class PlaybackCacheIndex
+{
+public:
+    PlaybackCacheIndex();
+
+    // Memory budget, and size of each image, in bytes. Removes the least
+    // recently used images if they don't fit in the new budget
+    void setBudget(qint64 maxBytes, qint64 bytesPerFrame, QList<unsigned int> & removedTextures);
+
+    // Maximum number of images fitting in the memory budget
+    int maxNumFrames() const;
+    int numFrames() const { return entries_.size(); }
+
+    // Texture of the image of the given frame, or 0 if it is not cached or
+    // out of date. Marks the image as recently used
+    unsigned int texture(int frame, quint64 frameRevision);
+    bool contains(int frame, quint64 frameRevision) const;
+
+    // Removes the image that a new image of the given frame replaces: the
+    // outdated image of this frame if any, or else the least recently used
+    // image if the index is full. Returns its texture, or 0 if none
+    unsigned int takeTextureFor(int frame);
+
+    // Adds the image of the given frame as the most recently used one. The
+    // frame must not have an image already (see takeTextureFor())
+    void insert(int frame, unsigned int textureId, quint64 revision);
+
+    // Removes all images
+    void clear(QList<unsigned int> & removedTextures);
+
+    // Frames from the most to the least recently used
+    QList<int> frames() const;
+
+private:
+    struct Entry
+    {
+        unsigned int textureId;
+        quint64 revision;
+        std::list<int>::iterator lruIt;
+    };
+    QMap<int, Entry> entries_;
+    std::list<int> lru_; // most recently used first
+
+    qint64 maxBytes_;
+    qint64 bytesPerFrame_;
+
+    bool takeLeastRecentlyUsed_(unsigned int & textureId);
+};
+
+#endif // PLAYBACKCACHEINDEX_H
@@ -22,6 +22,7 @@
 
 #include "OpenGL.h"
 #include "Global.h"
+#include "MemoryUsage.h"
 
 Scene::Scene() :
     left_(0),
@@ -107,8 +108,10 @@ void Scene::copyFrom(Scene * other)
     // Block signals
     blockSignals(true);
 
-    // Reset to default
-    clear(true);
+    // Reset to default. The background is not reset: this would discard
+    // its cache (e.g., loaded images), which setData() below preserves if
+    // the background of other has the same data, such as on undo/redo
+    deleteSceneObjects_();
 
     // Copy VAC
     foreach(SceneObject *sceneObject, other->sceneObjects_)
@@ -136,7 +139,7 @@ void Scene::copyFrom(Scene * other)
     }
 }
 
-void Scene::clear(bool silent)
+void Scene::deleteSceneObjects_()
 {
     VectorAnimationComplex::VAC * vac = getVAC_();
     if(vac)
@@ -145,6 +148,11 @@ void Scene::clear(bool silent)
     foreach(SceneObject *sceneObject, sceneObjects_)
         delete sceneObject;
     sceneObjects_.clear();
+}
+
+void Scene::clear(bool silent)
+{
+    deleteSceneObjects_();
 
     // XXX Shouldn't this clear left/top/width/height too?
 
@@ -366,6 +374,14 @@ void Scene::draw(Time time, ViewSettings & viewSettings)
     }
 }
 
+void Scene::drawOverlay(Time time, ViewSettings & viewSettings)
+{
+    foreach(SceneObject *sceneObject, sceneObjects_)
+    {
+        sceneObject->drawOverlay(time, viewSettings);
+    }
+}
+
 void Scene::drawPick(Time time, ViewSettings & viewSettings)
 {
     for(int i=0; i<sceneObjects_.size(); i++)
@@ -564,6 +580,13 @@ VectorAnimationComplex::VAC * Scene::vectorAnimationComplex()
     return getVAC_();
 }
 
+void Scene::addMemoryUsage(MemoryUsage & usage)
+{
+    VectorAnimationComplex::VAC * vac = vectorAnimationComplex();
+    if (vac)
+        vac->addMemoryUsage(usage);
+}
+
 void Scene::addSceneObject(SceneObject * sceneObject, bool silent)
 {
     sceneObjects_ << sceneObject;
@@ -1031,6 +1054,22 @@ void Scene::inbetweenSelection()
     }
 }
 
+void Scene::inbetweenKeyframes()
+{
+    if(!sceneObjects_.isEmpty())
+    {
+        // todo:  get  the  selected  one  instead  of  the  first
+        VectorAnimationComplex::VAC * vac =
+            dynamic_cast<VectorAnimationComplex::VAC *>
+            (sceneObjects_[0]);
+
+        if(vac)
+        {
+            vac->inbetweenKeyframes();
+        }
+    }
+}
+
 void Scene::keyframeSelection()
 {
     if(!sceneObjects_.isEmpty())
@@ -31,6 +31,7 @@ class VAC;
 class InbetweenFace;
 }
 class QDir;
+class MemoryUsage;
 
 class Scene: public QObject
 {
@@ -51,6 +52,7 @@ public:
     // Drawing (assumes a 2D OpenGL context is setup)
     void drawCanvas(ViewSettings & viewSettings);
     void draw(Time time, ViewSettings & viewSettings);
+    void drawOverlay(Time time, ViewSettings & viewSettings);
     void drawPick(Time time, ViewSettings & viewSettings);
 
     // XXX todo: there should be draw3D here too (not only in VAC),
@@ -80,6 +82,9 @@ public:
 
     // Scene Objects getters
     VectorAnimationComplex::VAC * vectorAnimationComplex();
+
+    // Memory held by the scene objects and their caches
+    void addMemoryUsage(MemoryUsage & usage);
     
     // GUI
     void populateToolBar(QToolBar * toolBar);
@@ -132,6 +137,7 @@ public slots:
 
     // ----- animation -----
     void inbetweenSelection();
+    void inbetweenKeyframes();
     void keyframeSelection();
     void motionPaste(VectorAnimationComplex::VAC* & clipboard);
 
@@ -168,6 +174,7 @@ signals:
     
 private:
     void addSceneObject(SceneObject * sceneObject, bool silent = false);
+    void deleteSceneObjects_();
     QList<SceneObject*> sceneObjects_;
 
     int indexHovered_;
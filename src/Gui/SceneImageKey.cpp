@@ -0,0 +1,35 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "SceneImageKey.h"
+
+SceneImageKey::SceneImageKey() :
+    width(0),
+    height(0),
+    vac(0),
+    toolMode(-1)
+{
+}
+
+bool SceneImageKey::isReprojectableTo(const SceneImageKey & other) const
+{
+    return width == other.width &&
+           height == other.height &&
+           time == other.time &&
+           vac == other.vac &&
+           toolMode == other.toolMode &&
+           canvas == other.canvas;
+}
+
+bool SceneImageKey::operator==(const SceneImageKey & other) const
+{
+    return isReprojectableTo(other) &&
+           camera.x() == other.camera.x() &&
+           camera.y() == other.camera.y() &&
+           camera.zoom() == other.camera.zoom();
+}
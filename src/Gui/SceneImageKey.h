@@ -0,0 +1,60 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef SCENEIMAGEKEY_H
+#define SCENEIMAGEKEY_H
+
+#include <QRectF>
+
+#include "GLWidget_Camera2D.h"
+#include "TimeDef.h"
+
+namespace VectorAnimationComplex { class VAC; }
+
+/*
+ * SceneImageKey.h
+ *
+ * What the image of the last full redraw of a View depends on, apart from
+ * the cells, the settings and the background: the viewport size, the
+ * camera, the time, the VAC, the tool mode (which changes the color of
+ * selected cells) and the canvas.
+ *
+ * When only the overlays changed, the image is drawn back as is if it was
+ * drawn with the same key as the current drawing. During navigation
+ * gestures, it is reprojected if only the camera differs. Changes of cells
+ * are tracked by the VAC revision instead (see View::drawSceneImage_()),
+ * and changes of settings or of the background discard the image.
+ *
+ * This class doesn't depend on OpenGL.
+ *
+ */
+
+struct SceneImageKey
+{
+    SceneImageKey();
+
+    int width;
+    int height;
+    GLWidget_Camera2D camera;
+    Time time;
+    VectorAnimationComplex::VAC * vac;
+    int toolMode;
+    QRectF canvas; // null if the canvas isn't shown
+
+    // Whether an image drawn with this key can be drawn back as is for a
+    // drawing with the other key
+    bool operator==(const SceneImageKey & other) const;
+    bool operator!=(const SceneImageKey & other) const { return !(*this == other); }
+
+    // Whether an image drawn with this key can be reprojected for a
+    // drawing with the other key, that is, if they differ at most by
+    // their camera (see CameraReprojection.h)
+    bool isReprojectableTo(const SceneImageKey & other) const;
+};
+
+#endif // SCENEIMAGEKEY_H
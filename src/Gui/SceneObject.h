@@ -32,6 +32,10 @@ public:
     virtual QString stringType() {return "SceneObject";}
     
     virtual void draw(Time /*time*/, ViewSettings & /*viewSettings*/) {}
+    // Hover feedback, cursors and tool widgets, drawn on top of the main
+    // drawing. Views may redraw it alone over a cached image of draw(), so
+    // what draw() renders must not depend on the mouse position
+    virtual void drawOverlay(Time /*time*/, ViewSettings & /*viewSettings*/) {}
     virtual void drawPick(Time /*time*/, ViewSettings & /*viewSettings*/) {}
 
     // Selecting and Highlighting
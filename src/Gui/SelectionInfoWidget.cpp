@@ -13,8 +13,18 @@
 #include "Global.h"
 #include "MainWindow.h"
 #include "Scene.h"
+#include "SelectionSummary.h"
+#include "IdListCopier.h"
 #include "VectorAnimationComplex/VAC.h"
 
+namespace
+{
+// Maximum number of ids displayed. Displaying all of them would freeze the
+// user interface when thousands of cells are selected, but they can be
+// copied to the clipboard
+const int maxNumIds = 20;
+}
+
 SelectionInfoWidget::SelectionInfoWidget(QWidget *parent) :
     QWidget(parent)
 {
@@ -22,6 +32,11 @@ SelectionInfoWidget::SelectionInfoWidget(QWidget *parent) :
     mainLayout_ = new QGridLayout();
     labelSelected_ = new QLabel();
     mainLayout_->addWidget(labelSelected_,0,0);
+    copyIdsButton_ = new QPushButton(tr("Copy all IDs"));
+    connect(copyIdsButton_, SIGNAL(clicked()), this, SLOT(copyIds_()));
+    mainLayout_->addWidget(copyIdsButton_,1,0);
+    idListCopier_ = new IdListCopier(this);
+    connect(idListCopier_, SIGNAL(finished(int)), this, SLOT(idsCopied_(int)));
     setLayout(mainLayout_);
 
     updateInfo();
@@ -31,17 +46,42 @@ SelectionInfoWidget::SelectionInfoWidget(QWidget *parent) :
 void SelectionInfoWidget::updateInfo()
 {
     QString text;
+    bool isTruncated = false;
 
     using namespace VectorAnimationComplex;
     VAC * vac = global()->mainWindow()->scene()->vectorAnimationComplex();
     if(vac)
     {
-        foreach(Cell * c, vac->selectedCells())
+        QVector<int> ids = SelectionSummary::firstIds(vac->selectedCells(), maxNumIds);
+        for(int i=0; i<ids.size(); ++i)
         {
-            text += QString::number(c->id());
+            text += QString::number(ids[i]);
             text += " ";
         }
+        int numCells = vac->selectionSummary().numCells();
+        if(numCells > ids.size())
+        {
+            text += QString("... (%1 cells)").arg(numCells);
+            isTruncated = true;
+        }
     }
 
     labelSelected_->setText(text);
+    copyIdsButton_->setVisible(isTruncated);
+}
+
+void SelectionInfoWidget::copyIds_()
+{
+    VectorAnimationComplex::VAC * vac = global()->mainWindow()->scene()->vectorAnimationComplex();
+    if(vac)
+    {
+        idListCopier_->copy(vac->selectedCells());
+        copyIdsButton_->setEnabled(false);
+    }
+}
+
+void SelectionInfoWidget::idsCopied_(int numIds)
+{
+    copyIdsButton_->setEnabled(true);
+    copyIdsButton_->setToolTip(tr("%1 IDs copied to the clipboard").arg(numIds));
 }
@@ -14,6 +14,8 @@
 #include <QLabel>
 
 class Scene;
+class QPushButton;
+class IdListCopier;
 
 class SelectionInfoWidget : public QWidget
 {
@@ -26,8 +28,14 @@ signals:
 public slots:
     void updateInfo();
 
+private slots:
+    void copyIds_();
+    void idsCopied_(int numIds);
+
 private:
     QLabel * labelSelected_;
+    QPushButton * copyIdsButton_;
+    IdListCopier * idListCopier_;
     QGridLayout * mainLayout_;
 };
 
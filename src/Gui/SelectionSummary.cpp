@@ -0,0 +1,74 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "SelectionSummary.h"
+
+#include "VectorAnimationComplex/Cell.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/InbetweenEdge.h"
+
+SelectionSummary::SelectionSummary()
+{
+    clear();
+}
+
+SelectionSummary::CellType SelectionSummary::type_(VectorAnimationComplex::Cell * cell)
+{
+    using namespace VectorAnimationComplex;
+
+    if(cell->toKeyVertex())
+        return KeyVertexType;
+    else if(KeyEdge * kedge = cell->toKeyEdge())
+        return kedge->isClosed() ? KeyClosedEdgeType : KeyOpenEdgeType;
+    else if(cell->toKeyFace())
+        return KeyFaceType;
+    else if(cell->toInbetweenVertex())
+        return InbetweenVertexType;
+    else if(InbetweenEdge * sedge = cell->toInbetweenEdge())
+        return sedge->isClosed() ? InbetweenClosedEdgeType : InbetweenOpenEdgeType;
+    else
+        return InbetweenFaceType;
+}
+
+void SelectionSummary::add(VectorAnimationComplex::Cell * cell)
+{
+    ++numCells_;
+    ++counts_[type_(cell)];
+}
+
+void SelectionSummary::remove(VectorAnimationComplex::Cell * cell)
+{
+    --numCells_;
+    --counts_[type_(cell)];
+}
+
+void SelectionSummary::clear()
+{
+    numCells_ = 0;
+    for(int i=0; i<NumCellTypes; ++i)
+        counts_[i] = 0;
+}
+
+int SelectionSummary::numCells() const
+{
+    return numCells_;
+}
+
+int SelectionSummary::count(CellType type) const
+{
+    return counts_[type];
+}
+
+QVector<int> SelectionSummary::firstIds(const VectorAnimationComplex::CellSet & cells, int maxIds)
+{
+    QVector<int> res;
+    res.reserve(qMin(maxIds, cells.size()));
+    for(auto it = cells.begin(); it != cells.end() && res.size() < maxIds; ++it)
+        res << (*it)->id();
+    return res;
+}
@@ -0,0 +1,67 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef SELECTIONSUMMARY_H
+#define SELECTIONSUMMARY_H
+
+#include <QVector>
+
+#include "VectorAnimationComplex/CellList.h"
+
+/*
+ * SelectionSummary.h
+ *
+ * The number of selected cells of each type. It is maintained incrementally
+ * by the VAC as cells are added to or removed from the selection (see
+ * VAC::selectionSummary()), so that widgets displaying it never iterate
+ * over the selected cells.
+ *
+ * The list of ids is not part of the summary: use firstIds() to get a
+ * bounded number of them.
+ *
+ */
+
+class SelectionSummary
+{
+public:
+    enum CellType
+    {
+        KeyVertexType = 0,
+        KeyClosedEdgeType,
+        KeyOpenEdgeType,
+        KeyFaceType,
+        InbetweenVertexType,
+        InbetweenClosedEdgeType,
+        InbetweenOpenEdgeType,
+        InbetweenFaceType,
+        NumCellTypes
+    };
+
+    // Empty summary
+    SelectionSummary();
+
+    // Update the summary. The type of a cell must not change between the
+    // calls to add() and remove()
+    void add(VectorAnimationComplex::Cell * cell);
+    void remove(VectorAnimationComplex::Cell * cell);
+    void clear();
+
+    // Number of cells, in total and per type
+    int numCells() const;
+    int count(CellType type) const;
+
+    // Ids of at most maxIds cells of the given set, in iteration order
+    static QVector<int> firstIds(const VectorAnimationComplex::CellSet & cells, int maxIds);
+
+private:
+    static CellType type_(VectorAnimationComplex::Cell * cell);
+    int numCells_;
+    int counts_[NumCellTypes];
+};
+
+#endif // SELECTIONSUMMARY_H
@@ -21,6 +21,7 @@ void Settings::readFromDisk(QSettings & settings)
     showAboutDialogAtStartup_ = settings.value("general-showaboutdialogatstartup", true).toBool();
     keepOldVersion_ = settings.value("general-keepoldversion", true).toBool();
     dontNotifyConversion_ = settings.value("general-dontnotifyconversion", false).toBool();
+    compressAutosave_ = settings.value("general-compressautosave", true).toBool();
     checkVersion_ = Version(settings.value("general-checkversion", qApp->applicationVersion()).toString());
 }
 
@@ -30,6 +31,7 @@ void Settings::writeToDisk(QSettings & settings)
     settings.setValue("general-showaboutdialogatstartup", showAboutDialogAtStartup_);
     settings.setValue("general-keepoldversion", keepOldVersion_);
     settings.setValue("general-dontnotifyconversion", dontNotifyConversion_);
+    settings.setValue("general-compressautosave", compressAutosave_);
     settings.setValue("general-checkversion", checkVersion_.toString());
 }
 
@@ -48,6 +50,10 @@ void Settings::setKeepOldVersion(bool value) { keepOldVersion_ = value; }
 bool Settings::dontNotifyConversion() const { return dontNotifyConversion_; }
 void Settings::setDontNotifyConversion(bool value) { dontNotifyConversion_ = value; }
 
+// Autosave
+bool Settings::compressAutosave() const { return compressAutosave_; }
+void Settings::setCompressAutosave(bool value) { compressAutosave_ = value; }
+
 // Check version
 Version Settings::checkVersion() const { return checkVersion_; }
 void Settings::setCheckVersion(Version value) { checkVersion_ = value; }
@@ -39,6 +39,10 @@ public:
     bool dontNotifyConversion() const;
     void setDontNotifyConversion(bool value);
 
+    // Autosave
+    bool compressAutosave() const;
+    void setCompressAutosave(bool value);
+
     // Check version
     Version checkVersion() const;
     void setCheckVersion(Version value);
@@ -48,6 +52,7 @@ private:
     bool showAboutDialogAtStartup_;
     bool keepOldVersion_;
     bool dontNotifyConversion_;
+    bool compressAutosave_;
     Version checkVersion_;
 };
 
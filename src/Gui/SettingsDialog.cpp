@@ -21,11 +21,13 @@ SettingsDialog::SettingsDialog(QWidget * parent) :
     // Create all widgets
     edgeWidth_ = new QDoubleSpinBox();
     edgeWidth_->setRange(0.0, 999.99);
+    compressAutosave_ = new QCheckBox(tr("Compress autosaved documents"));
 
 
     // setup layout
     QVBoxLayout * mainLayout = new QVBoxLayout(this);
     mainLayout->addWidget(edgeWidth_);
+    mainLayout->addWidget(compressAutosave_);
 
     // Preference dialog buttons
     dialogButtons_ = new QDialogButtonBox(QDialogButtonBox::Ok |
@@ -45,12 +47,14 @@ Settings SettingsDialog::preferencesFromWidgetValues() const
 {
     Settings preferences = preferencesBak;
     preferences.setEdgeWidth( edgeWidth_->value() );
+    preferences.setCompressAutosave( compressAutosave_->isChecked() );
     return preferences;
 }
 
 void SettingsDialog::setWidgetValuesFromPreferences(const Settings & preferences)
 {
     edgeWidth_->setValue( preferences.edgeWidth() );
+    compressAutosave_->setChecked( preferences.compressAutosave() );
 }
 
 
@@ -14,6 +14,7 @@
 
 #include <QDialogButtonBox>
 #include <QDoubleSpinBox>
+#include <QCheckBox>
 
 class SettingsDialog: public QDialog
 {
@@ -43,6 +44,7 @@ private:
     void setWidgetValuesFromPreferences(const Settings & preferences);
 
     QDoubleSpinBox * edgeWidth_;
+    QCheckBox * compressAutosave_;
 
 
     QDialogButtonBox * dialogButtons_;
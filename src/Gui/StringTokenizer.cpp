@@ -0,0 +1,113 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "StringTokenizer.h"
+
+StringTokenizer::StringTokenizer(const QStringRef & str, const char * delimiters) :
+    str_(str),
+    delimiters_(delimiters),
+    pos_(0)
+{
+}
+
+StringTokenizer::StringTokenizer(const QString * str, const char * delimiters) :
+    str_(str),
+    delimiters_(delimiters),
+    pos_(0)
+{
+}
+
+bool StringTokenizer::isDelimiter_(QChar c) const
+{
+    if(c.isSpace())
+        return true;
+
+    ushort u = c.unicode();
+    if(u < 128)
+    {
+        for(const char * d = delimiters_; *d; ++d)
+            if(u == static_cast<ushort>(*d))
+                return true;
+    }
+
+    return false;
+}
+
+int StringTokenizer::skipDelimiters_(int i) const
+{
+    const int n = str_.length();
+    const QChar * data = str_.unicode();
+    while(i < n && isDelimiter_(data[i]))
+        ++i;
+    return i;
+}
+
+int StringTokenizer::skipToken_(int i) const
+{
+    const int n = str_.length();
+    const QChar * data = str_.unicode();
+    while(i < n && !isDelimiter_(data[i]))
+        ++i;
+    return i;
+}
+
+bool StringTokenizer::atEnd()
+{
+    pos_ = skipDelimiters_(pos_);
+    return pos_ >= str_.length();
+}
+
+QStringRef StringTokenizer::next()
+{
+    if(atEnd())
+        return QStringRef();
+
+    int begin = pos_;
+    pos_ = skipToken_(pos_);
+    return str_.mid(begin, pos_ - begin);
+}
+
+int StringTokenizer::countRemaining() const
+{
+    int res = 0;
+    int i = skipDelimiters_(pos_);
+    while(i < str_.length())
+    {
+        ++res;
+        i = skipDelimiters_(skipToken_(i));
+    }
+    return res;
+}
+
+QStringRef StringTokenizer::nextEnclosed(QChar open, QChar close)
+{
+    const int n = str_.length();
+    const QChar * data = str_.unicode();
+
+    int begin = pos_;
+    while(begin < n && data[begin] != open)
+        ++begin;
+
+    int end = begin + 1;
+    while(end < n && data[end] != close)
+        ++end;
+
+    if(end >= n)
+    {
+        pos_ = n;
+        return QStringRef();
+    }
+
+    pos_ = end + 1;
+    return str_.mid(begin, pos_ - begin);
+}
+
+void StringTokenizer::rewind()
+{
+    pos_ = 0;
+}
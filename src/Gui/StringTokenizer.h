@@ -0,0 +1,68 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef STRINGTOKENIZER_H
+#define STRINGTOKENIZER_H
+
+#include <QStringRef>
+
+/*
+ * StringTokenizer.h
+ *
+ * Splits a string into tokens without allocating any memory. Tokens are
+ * returned as QStringRef pointing into the original UTF-16 buffer, which
+ * must therefore outlive the tokenizer and the returned tokens.
+ *
+ * Whitespace characters are always delimiters. Additional delimiters can be
+ * given as a null-terminated string of ASCII characters. Empty tokens are
+ * skipped, i.e. this behaves like QString::split() with a character class
+ * regular expression and QString::SkipEmptyParts. Example:
+ *
+ *   StringTokenizer tokenizer(str, ",[]");
+ *   while(!tokenizer.atEnd())
+ *   {
+ *       QStringRef token = tokenizer.next();
+ *       ...
+ *   }
+ *
+ */
+
+class StringTokenizer
+{
+public:
+    StringTokenizer(const QStringRef & str, const char * delimiters = "");
+    StringTokenizer(const QString * str, const char * delimiters = "");
+
+    // Returns whether there are no more tokens to read
+    bool atEnd();
+
+    // Returns the next token, or a null QStringRef if there are none
+    QStringRef next();
+
+    // Returns the number of tokens not read yet
+    int countRemaining() const;
+
+    // Returns the next substring starting with 'open' and ending with
+    // the first subsequent 'close', both included, or a null QStringRef if
+    // there are none. Delimiters are ignored.
+    QStringRef nextEnclosed(QChar open, QChar close);
+
+    // Go back to the beginning of the string
+    void rewind();
+
+private:
+    bool isDelimiter_(QChar c) const;
+    int skipDelimiters_(int i) const;
+    int skipToken_(int i) const;
+
+    QStringRef str_;
+    const char * delimiters_;
+    int pos_;
+};
+
+#endif // STRINGTOKENIZER_H
@@ -24,7 +24,10 @@
 #include <QMouseEvent>
 #include <QtDebug>
 
+#include <cmath>
+
 #include "Scene.h"
+#include "Background/Background.h"
 #include "View.h"
 #include "Global.h"
 
@@ -277,6 +280,12 @@ void Timeline_HBar::mouseReleaseEvent (QMouseEvent * event)
         w_->scene_->getVAC_()->completeTemporalDragAndDrop();
         setCursor(QCursor(Qt::ArrowCursor));
     }
+    else if(event->button() == Qt::LeftButton &&
+            w_->thumbnailStrip_->hasPreviewFrame())
+    {
+        w_->goToFrame(global()->activeView(), w_->thumbnailStrip_->previewFrame());
+        w_->thumbnailStrip_->clearPreviewFrame();
+    }
     repaint();
 }
 
@@ -296,11 +305,15 @@ void Timeline_HBar::mouseMoveEvent (QMouseEvent * event)
         else
             highlightedFrame_ = (event->x() + w_->totalPixelOffset_)/10-1;
         
-        // Select time
+        // Select time. If thumbnails are shown, only preview the frame
+        // until the mouse is released
         if(event->buttons() & Qt::LeftButton &&
            hasHighlightedFrame_ )
         {
-            w_->goToFrame(global()->activeView(), highlightedFrame_);
+            if(w_->thumbnailStrip_->isVisible())
+                w_->thumbnailStrip_->setPreviewFrame(highlightedFrame_);
+            else
+                w_->goToFrame(global()->activeView(), highlightedFrame_);
         }
 
         // Temporal Drag and drop
@@ -312,6 +325,8 @@ void Timeline_HBar::mouseMoveEvent (QMouseEvent * event)
     }
     
     repaint();
+    if(isScrolling_)
+        w_->thumbnailStrip_->update();
 }
 
 void Timeline_HBar::leaveEvent (QEvent * /*event*/)
@@ -320,6 +335,232 @@ void Timeline_HBar::leaveEvent (QEvent * /*event*/)
     repaint();
 }
 
+Timeline_ThumbnailStrip::Timeline_ThumbnailStrip(Timeline * w) :
+    QWidget(w),
+    w_(w),
+    hasPreviewFrame_(false),
+    previewFrame_(0)
+{
+    // set the recommended size
+    setMinimumSize(500, 40);
+    setMaximumSize(5000, 40);
+
+    // set the background color
+    setAutoFillBackground(true);
+    QPalette palette(QColor(120,120,120), QColor(120,120,120));
+    setPalette(palette);
+
+    // render missing thumbnails when idle
+    renderTimer_ = new QTimer(this);
+    renderTimer_->setSingleShot(true);
+    renderTimer_->setInterval(0);
+    connect(renderTimer_, SIGNAL(timeout()), this, SLOT(renderNextThumbnail_()));
+}
+
+int Timeline_ThumbnailStrip::thumbnailHeight_() const
+{
+    return height() - 4;
+}
+
+int Timeline_ThumbnailStrip::thumbnailWidth_() const
+{
+    // Same aspect ratio as the canvas
+    double aspectRatio = 1.0;
+    if(w_->scene_->height() > 0)
+        aspectRatio = w_->scene_->width() / w_->scene_->height();
+    int width = std::floor(aspectRatio * thumbnailHeight_() + 0.5);
+    return qBound(8, width, 400);
+}
+
+int Timeline_ThumbnailStrip::framesPerThumbnail_() const
+{
+    // Each frame is 10 pixels wide in the timeline bar. Keep 2 pixels
+    // between thumbnails
+    return (thumbnailWidth_() + 2 + 9) / 10;
+}
+
+void Timeline_ThumbnailStrip::checkCanvas_()
+{
+    Scene * scene = w_->scene_;
+    QRectF canvas(scene->left(), scene->top(), scene->width(), scene->height());
+    if(canvas != canvas_)
+    {
+        thumbnails_.clear();
+        canvas_ = canvas;
+    }
+}
+
+bool Timeline_ThumbnailStrip::isUpToDate_(int frame) const
+{
+    auto it = thumbnails_.find(frame);
+    return it != thumbnails_.end() &&
+           it->revision >= w_->scene_->getVAC_()->frameRevision(frame);
+}
+
+QImage Timeline_ThumbnailStrip::thumbnail_(int frame, bool renderIfNeeded)
+{
+    checkCanvas_();
+    if(!renderIfNeeded || isUpToDate_(frame))
+        return thumbnails_.value(frame).image; // possibly out of date
+
+    View * view = global()->activeView();
+    if(!view)
+        return QImage();
+
+    Thumbnail & thumbnail = thumbnails_[frame];
+    thumbnail.revision = w_->scene_->getVAC_()->revision();
+    thumbnail.image = view->drawToImage(
+                Time(frame),
+                canvas_.x(), canvas_.y(), canvas_.width(), canvas_.height(),
+                thumbnailWidth_(), thumbnailHeight_(),
+                false);
+    return thumbnail.image;
+}
+
+QImage Timeline_ThumbnailStrip::nearestThumbnail_(int frame) const
+{
+    if(thumbnails_.isEmpty())
+        return QImage();
+
+    // First cached frame >= frame, compared with the one before it
+    auto it = thumbnails_.lowerBound(frame);
+    if(it == thumbnails_.end())
+        --it;
+    else if(it != thumbnails_.begin() && it.key() != frame)
+    {
+        auto previous = it - 1;
+        if(frame - previous.key() < it.key() - frame)
+            it = previous;
+    }
+    return it->image;
+}
+
+void Timeline_ThumbnailStrip::pruneThumbnails_()
+{
+    // Keep the thumbnails of frames near the visible ones
+    const int maxNumThumbnails = 1000;
+    if(thumbnails_.size() <= maxNumThumbnails)
+        return;
+
+    int margin = w_->lastVisibleFrame_ - w_->firstVisibleFrame_;
+    int first = w_->firstVisibleFrame_ - margin;
+    int last = w_->lastVisibleFrame_ + margin;
+    auto it = thumbnails_.begin();
+    while(it != thumbnails_.end())
+    {
+        if(it.key() < first || it.key() > last)
+            it = thumbnails_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void Timeline_ThumbnailStrip::clear()
+{
+    thumbnails_.clear();
+    update();
+}
+
+void Timeline_ThumbnailStrip::setPreviewFrame(int frame)
+{
+    hasPreviewFrame_ = true;
+    previewFrame_ = frame;
+    update();
+}
+
+void Timeline_ThumbnailStrip::clearPreviewFrame()
+{
+    hasPreviewFrame_ = false;
+    update();
+}
+
+void Timeline_ThumbnailStrip::paintEvent (QPaintEvent * /*event*/)
+{
+    QPainter painter(this);
+    int offset = w_->totalPixelOffset_;
+    int w = thumbnailWidth_();
+    int h = thumbnailHeight_();
+
+    // Visible thumbnails, at frames multiple of n so that they don't change
+    // when the timeline is scrolled
+    int n = framesPerThumbnail_();
+    int firstVisibleFrame = std::floor(offset / 10.0);
+    int lastVisibleFrame = std::floor((offset + width()) / 10.0);
+    int firstFrame = n * (int) std::floor(firstVisibleFrame / (double) n);
+    bool hasMissingThumbnails = false;
+    for(int frame = firstFrame; frame <= lastVisibleFrame; frame += n)
+    {
+        QRect rect(10*frame - offset + 1, 2, w, h);
+        painter.fillRect(rect, Qt::white);
+        QImage image = thumbnail_(frame, false);
+        if(!image.isNull())
+            painter.drawImage(rect, image);
+        if(!isUpToDate_(frame))
+            hasMissingThumbnails = true;
+    }
+
+    // Thumbnail of the frame being scrubbed, centered on the frame. Drawing
+    // is never blocked by rendering: if it is missing or out of date, the
+    // nearest cached thumbnail is shown until it is rendered when idle
+    if(hasPreviewFrame_)
+    {
+        int x = 10*previewFrame_ - offset + 5 - w/2;
+        QRect rect(qBound(0, x, width() - w), 2, w, h);
+        painter.fillRect(rect, Qt::white);
+        checkCanvas_();
+        QImage image = nearestThumbnail_(previewFrame_);
+        if(!isUpToDate_(previewFrame_))
+            hasMissingThumbnails = true;
+        if(!image.isNull())
+            painter.drawImage(rect, image);
+        painter.setPen(Qt::red);
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(rect.adjusted(0, 0, -1, -1));
+    }
+
+    // border
+    painter.setPen(QColor(50,50,50));
+    painter.drawLine(0, 0, width() - 1, 0);
+    painter.drawLine(0, height()-1, width() - 1, height()-1);
+    painter.drawLine(0, 1, 0, height()-2);
+    painter.drawLine(width()-1, 1, width()-1, height()-2);
+
+    if(hasMissingThumbnails && !w_->isPlaying())
+        renderTimer_->start();
+}
+
+void Timeline_ThumbnailStrip::renderNextThumbnail_()
+{
+    if(!isVisible() || w_->isPlaying())
+        return;
+
+    // Render the thumbnail of the frame being scrubbed first, then the first
+    // visible thumbnail which is missing or out of date. Repainting schedules
+    // the next one
+    if(hasPreviewFrame_ && !isUpToDate_(previewFrame_))
+    {
+        thumbnail_(previewFrame_, true);
+        pruneThumbnails_();
+        update();
+        return;
+    }
+    int offset = w_->totalPixelOffset_;
+    int n = framesPerThumbnail_();
+    int firstVisibleFrame = std::floor(offset / 10.0);
+    int lastVisibleFrame = std::floor((offset + width()) / 10.0);
+    int firstFrame = n * (int) std::floor(firstVisibleFrame / (double) n);
+    for(int frame = firstFrame; frame <= lastVisibleFrame; frame += n)
+    {
+        if(!isUpToDate_(frame))
+        {
+            thumbnail_(frame, true);
+            pruneThumbnails_();
+            update();
+            return;
+        }
+    }
+}
+
 
 PlaybackSettings::PlaybackSettings()
 {
@@ -505,6 +746,19 @@ Timeline::Timeline(Scene *scene, QWidget *parent) :
     // Horizontal bar (must be first cause some setValue() call hbar_->update())
     hbar_ = new Timeline_HBar(this);
 
+    // Thumbnails above the horizontal bar, hidden by default
+    thumbnailStrip_ = new Timeline_ThumbnailStrip(this);
+    thumbnailStrip_->hide();
+    thumbnailsButton_ = new QPushButton(tr("Thumbnails"));
+    thumbnailsButton_->setCheckable(true);
+    thumbnailsButton_->setMaximumSize(80,32);
+    connect(thumbnailsButton_, SIGNAL(toggled(bool)),
+            thumbnailStrip_, SLOT(setVisible(bool)));
+    connect(scene_->background(), SIGNAL(changed()),
+            thumbnailStrip_, SLOT(clear()));
+    connect(scene_, SIGNAL(selectionChanged()),
+            thumbnailStrip_, SLOT(clear()));
+
     // Open settings
     QPushButton * settingsButton = new QPushButton(tr("Settings"));
     settingsButton->setMaximumSize(64,32);
@@ -595,12 +849,19 @@ Timeline::Timeline(Scene *scene, QWidget *parent) :
     controlButtons_->addWidget(lastFrameButton_);
     controlButtons_->setSizeConstraint(QLayout::SetFixedSize);
 
+    // Layout of thumbnails and horizontal bar
+    QVBoxLayout * barLayout = new QVBoxLayout();
+    barLayout->setSpacing(0);
+    barLayout->addWidget(thumbnailStrip_);
+    barLayout->addWidget(hbar_);
+
     // Global layout
     QHBoxLayout * layout = new QHBoxLayout();
     layout->addWidget(settingsButton);
+    layout->addWidget(thumbnailsButton_);
     layout->addLayout(controlButtons_);
     layout->addWidget(firstFrameSpinBox_);
-    layout->addWidget(hbar_);
+    layout->addLayout(barLayout);
     layout->addWidget(lastFrameSpinBox_);
     setLayout(layout);
 }
@@ -663,6 +924,7 @@ void Timeline::setT2(double t2)
 void Timeline::paintEvent(QPaintEvent * event)
 {
     hbar_->update();
+    thumbnailStrip_->update();
     QWidget::paintEvent(event);
 }
 
@@ -15,7 +15,10 @@
 #include <QElapsedTimer>
 #include <QList>
 #include <QSet>
+#include <QMap>
 #include <QColor>
+#include <QImage>
+#include <QRectF>
 #include "TimeDef.h"
 
 class QPushButton;
@@ -57,6 +60,75 @@ private:
     QList<QColor> colors_;
 };
 
+// Paint miniature renders of the frames above the timeline bar.
+// It's a friend of Timeline: can access all members of it
+//
+// Thumbnails are rendered with View::drawToImage() at low resolution, the
+// same way as PNG export, one at a time when the event loop is idle, and
+// never during playback. They are cached by frame, and rendered again when
+// one of the cells existing at their frame changes (see
+// VAC::frameRevision()).
+//
+// Only one frame every few frames has a thumbnail, so that thumbnails don't
+// overlap. While scrubbing the timeline bar, the thumbnail of the frame
+// under the mouse is shown instead of redrawing the views at full
+// resolution, and the views go to this frame when the mouse is released.
+// Until this thumbnail is rendered, the cached thumbnail of the nearest
+// frame is shown in its place.
+class Timeline_ThumbnailStrip: public QWidget
+{
+    Q_OBJECT
+
+public:
+    Timeline_ThumbnailStrip(Timeline * w);
+
+    // Frame previewed while scrubbing, if any
+    void setPreviewFrame(int frame);
+    void clearPreviewFrame();
+    bool hasPreviewFrame() const { return hasPreviewFrame_; }
+    int previewFrame() const { return previewFrame_; }
+
+public slots:
+    void clear();
+
+protected:
+    virtual void paintEvent (QPaintEvent * event);
+
+private slots:
+    void renderNextThumbnail_();
+
+private:
+    Timeline * w_;
+
+    struct Thumbnail
+    {
+        QImage image;
+        quint64 revision;
+    };
+    QMap<int, Thumbnail> thumbnails_;
+    QRectF canvas_;
+    QTimer * renderTimer_;
+
+    bool hasPreviewFrame_;
+    int previewFrame_;
+
+    // Geometry of thumbnails
+    int thumbnailWidth_() const;
+    int thumbnailHeight_() const;
+    int framesPerThumbnail_() const;
+
+    // Returns the up-to-date thumbnail of the given frame, rendering it now
+    // if necessary. Returns a null image if there is no view to render it
+    QImage thumbnail_(int frame, bool renderIfNeeded);
+
+    // Returns the cached thumbnail of the frame nearest to the given frame,
+    // possibly out of date, or a null image if there is none. Never renders
+    QImage nearestThumbnail_(int frame) const;
+    bool isUpToDate_(int frame) const;
+    void checkCanvas_();
+    void pruneThumbnails_();
+};
+
 class PlaybackSettings
 {
 public:
@@ -205,6 +277,9 @@ private:
     // Delegate timeline painting and mouse events handling
     friend class Timeline_HBar;
     Timeline_HBar * hbar_;
+    friend class Timeline_ThumbnailStrip;
+    Timeline_ThumbnailStrip * thumbnailStrip_;
+    QPushButton * thumbnailsButton_;
 
     // Time control
     QTimer * timer_;
@@ -10,8 +10,12 @@
 #include "Cell.h"
 #include "KeyEdge.h"
 
+#include "VAC.h"
+
 #include <QStack>
 #include <QMap>
+#include <QtGlobal>
+#include <atomic>
 
 namespace VectorAnimationComplex
 {
@@ -19,73 +23,151 @@ namespace VectorAnimationComplex
 namespace Algorithms
 {
 
+CellMarks::CellMarks(VAC * vac) :
+    vac_(vac),
+    generation_(newGeneration()),
+    stack_(&ownStack_),
+    adjacentCells_(&ownAdjacentCells_)
+{
+    if(vac_)
+    {
+        if(vac_->isTraversing_)
+            qFatal("CellMarks: nested traversal of the same VAC");
+        vac_->isTraversing_ = true;
+        stack_ = &vac_->traversalStack_;
+        adjacentCells_ = &vac_->traversalAdjacentCells_;
+        stack_->clear();
+        adjacentCells_->clear();
+    }
+}
+
+CellMarks::~CellMarks()
+{
+    if(vac_)
+        vac_->isTraversing_ = false;
+}
+
+quint64 CellMarks::newGeneration()
+{
+    // Cells are created with traversalMark_ == 0, which is therefore never
+    // used as a generation. 64 bits never overflow in practice.
+    static std::atomic<quint64> lastGeneration(0);
+    return ++lastGeneration;
+}
+
+namespace
+{
+
+VAC * vacOf(const CellSet & cells)
+{
+    return cells.isEmpty() ? 0 : (*cells.begin())->vac();
+}
+
+}
+
 CellSet connected(const CellSet & cells)
 {
+    CellMarks marks(vacOf(cells));
+    std::vector<Cell*> & stack = marks.stack();
+    std::vector<Cell*> & adjacentCells = marks.adjacentCells();
+
     CellSet res = cells;
-    CellSet addedCells = cells;
+    foreach(Cell * c, cells)
+    {
+        if(marks.mark(c))
+            stack.push_back(c);
+    }
 
-    // while some cells have been added
-    while(addedCells.size() != 0)
+    // Depth-first traversal of the neighbourhood
+    while(!stack.empty())
     {
-        CellSet newAddedCells;
-        foreach(Cell * c, addedCells)
+        Cell * c = stack.back();
+        stack.pop_back();
+
+        adjacentCells.clear();
+        c->appendBoundary(adjacentCells);
+        c->appendStar(adjacentCells);
+        for(size_t i=0; i<adjacentCells.size(); ++i)
         {
-            CellSet neighbourhood = c->neighbourhood();
-            foreach(Cell * d, neighbourhood)
+            Cell * d = adjacentCells[i];
+            if(marks.mark(d))
             {
-                if(!res.contains(d))
-                {
-                    res << d;
-                    newAddedCells << d;
-                }
+                res << d;
+                stack.push_back(d);
             }
         }
-        addedCells = newAddedCells;
     }
 
     return res;
 }
 
+namespace
+{
+
+// Adds c and its boundary (or star) to res, if not already marked
+void addClosure(Cell * c, CellMarks & marks, CellSet & res)
+{
+    if(marks.mark(c))
+        res << c;
+
+    std::vector<Cell*> & boundary = marks.adjacentCells();
+    boundary.clear();
+    c->appendBoundary(boundary);
+    for(size_t i=0; i<boundary.size(); ++i)
+    {
+        if(marks.mark(boundary[i]))
+            res << boundary[i];
+    }
+}
+
+void addFullstar(Cell * c, CellMarks & marks, CellSet & res)
+{
+    if(marks.mark(c))
+        res << c;
+
+    std::vector<Cell*> & star = marks.adjacentCells();
+    star.clear();
+    c->appendStar(star);
+    for(size_t i=0; i<star.size(); ++i)
+    {
+        if(marks.mark(star[i]))
+            res << star[i];
+    }
+}
+
+}
 
 CellSet closure(Cell * c)
 {
+    CellMarks marks(c->vac());
     CellSet res;
-    res << c;
-    foreach(Cell * b, c->boundary())
-        res << b;
+    addClosure(c, marks, res);
     return res;
 }
 
 CellSet closure(const CellSet & cells)
 {
+    CellMarks marks(vacOf(cells));
     CellSet res;
     foreach(Cell * c, cells)
-    {
-        res << c;
-        foreach(Cell * b, c->boundary())
-            res << b;
-    }
+        addClosure(c, marks, res);
     return res;
 }
 
 CellSet fullstar(Cell * c)
 {
+    CellMarks marks(c->vac());
     CellSet res;
-    res << c;
-    foreach(Cell * b, c->star())
-        res << b;
+    addFullstar(c, marks, res);
     return res;
 }
 
 CellSet fullstar(const CellSet & cells)
 {
+    CellMarks marks(vacOf(cells));
     CellSet res;
     foreach(Cell * c, cells)
-    {
-        res << c;
-        foreach(Cell * b, c->star())
-            res << b;
-    }
+        addFullstar(c, marks, res);
     return res;
 }
 
@@ -10,6 +10,9 @@
 #define ALGORITHMS_H
 
 #include "CellList.h"
+#include "Cell.h"
+
+#include <vector>
 
 namespace VectorAnimationComplex
 {
@@ -17,6 +20,56 @@ namespace VectorAnimationComplex
 namespace Algorithms
 {
 
+// Marks cells as visited during a traversal of the cells of a VAC, in
+// constant time and without hashing. Creating a CellMarks starts a new
+// generation, which implicitly unmarks all cells. Generations are unique
+// across VACs and threads.
+//
+// Traversals of the same VAC must not be nested, since an inner traversal
+// would unmark the cells marked by the outer one: creating a CellMarks for
+// a VAC which is already being traversed aborts the program. Like all
+// other operations on a VAC, traversals must not be run concurrently on the
+// same VAC, but different VACs can be traversed from different threads.
+//
+// It also provides work buffers, owned by the VAC, which keep their
+// capacity from one traversal to the next, avoiding allocations. A null
+// vac, e.g. for an empty set of cells, uses buffers owned by the CellMarks.
+class CellMarks
+{
+public:
+    CellMarks(VAC * vac);
+    ~CellMarks();
+
+    bool isMarked(const Cell * c) const { return c->traversalMark_ == generation_; }
+
+    // Marks c. Returns whether it was not already marked.
+    bool mark(Cell * c)
+    {
+        if(c->traversalMark_ == generation_)
+            return false;
+        c->traversalMark_ = generation_;
+        return true;
+    }
+
+    // Reusable work buffers, empty when the CellMarks is created
+    std::vector<Cell*> & stack() { return *stack_; }
+    std::vector<Cell*> & adjacentCells() { return *adjacentCells_; }
+
+    // Returns a new generation number, never 0. Thread-safe
+    static quint64 newGeneration();
+
+private:
+    VAC * vac_;
+    quint64 generation_;
+    std::vector<Cell*> * stack_;
+    std::vector<Cell*> * adjacentCells_;
+    std::vector<Cell*> ownStack_;
+    std::vector<Cell*> ownAdjacentCells_;
+
+    CellMarks(const CellMarks &);
+    CellMarks & operator=(const CellMarks &);
+};
+
 // returns all the cells topologically connected to `cells` (super-set of cells)
 CellSet connected(const CellSet & cells);
 
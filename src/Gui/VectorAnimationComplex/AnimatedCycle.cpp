@@ -14,10 +14,14 @@
 #include "InbetweenEdge.h"
 #include "EdgeGeometry.h"
 #include "VAC.h"
+#include "Algorithms.h"
+
+#include "../StringTokenizer.h"
 
 #include <QStack>
 #include <QMap>
 #include <assert.h>
+#include <algorithm>
 #include <QtDebug>
 
 namespace VectorAnimationComplex
@@ -29,7 +33,8 @@ AnimatedCycleNode::AnimatedCycleNode(Cell * cell) :
     next_(0),
     before_(0),
     after_(0),
-    side_(true)
+    side_(true),
+    traversalMark_(0)
 {
 }
 
@@ -97,22 +102,32 @@ AnimatedCycleNode::CycleType AnimatedCycleNode::cycleType(Time time) const
 void AnimatedCycleNode::setCell(Cell * cell)
 {
     cell_ = cell;
+    setModified_();
 }
 void AnimatedCycleNode::setPrevious(AnimatedCycleNode * node)
 {
     previous_ = node;
+    setModified_();
 }
 void AnimatedCycleNode::setNext(AnimatedCycleNode * node)
 {
     next_ = node;
+    setModified_();
 }
 void AnimatedCycleNode::setBefore(AnimatedCycleNode * node)
 {
     before_ = node;
+    setModified_();
 }
 void AnimatedCycleNode::setAfter(AnimatedCycleNode * node)
 {
     after_ = node;
+    setModified_();
+}
+void AnimatedCycleNode::setModified_()
+{
+    if(revision_)
+        ++(*revision_);
 }
 
 // Getters
@@ -213,17 +228,29 @@ void AnimatedCycleNode::setSide(bool side)
 }
 
 AnimatedCycle::AnimatedCycle() :
-    first_(0)
+    first_(0),
+    revision_(new int(0)),
+    nodesRevision_(-1),
+    timeIndexRevision_(-1),
+    isTimeIndexSorted_(false)
 {
 }
 
 AnimatedCycle::AnimatedCycle(AnimatedCycleNode * first) :
-    first_(first)
+    first_(first),
+    revision_(new int(0)),
+    nodesRevision_(-1),
+    timeIndexRevision_(-1),
+    isTimeIndexSorted_(false)
 {
 }
 
 AnimatedCycle::AnimatedCycle(const AnimatedCycle & other) :
-    first_(0)
+    first_(0),
+    revision_(new int(0)),
+    nodesRevision_(-1),
+    timeIndexRevision_(-1),
+    isTimeIndexSorted_(false)
 {
     copyFrom(other);
 }
@@ -247,6 +274,7 @@ void AnimatedCycle::clear()
         delete node;
 
     first_ = 0;
+    setModified_();
 }
 
 void AnimatedCycle::copyFrom(const AnimatedCycle & other)
@@ -270,6 +298,7 @@ void AnimatedCycle::copyFrom(const AnimatedCycle & other)
 
     first_ = oldToNew[other.first_];
     tempNodes_ = other.tempNodes_;
+    setModified_();
 }
 
 AnimatedCycleNode  * AnimatedCycle::first() const
@@ -280,6 +309,128 @@ AnimatedCycleNode  * AnimatedCycle::first() const
 void AnimatedCycle::setFirst(AnimatedCycleNode  * node)
 {
     first_ = node;
+    setModified_();
+}
+
+void AnimatedCycle::setModified_()
+{
+    ++(*revision_);
+}
+
+bool AnimatedCycle::hasValidNodeIndex_() const
+{
+    return nodesRevision_ == *revision_;
+}
+
+void AnimatedCycle::setNodeIndexValid_() const
+{
+    nodesRevision_ = *revision_;
+}
+
+void AnimatedCycle::indexNode_(AnimatedCycleNode * node) const
+{
+    // A node is indexed by one cycle at a time. If it was indexed by
+    // another cycle sharing it, the index of the other cycle is invalidated,
+    // since changes of the node would no longer be reported to it.
+    if(node->revision_ != revision_)
+    {
+        if(node->revision_)
+            ++(*node->revision_);
+        node->revision_ = revision_;
+    }
+    nodes_ << node;
+    cellNodes_[node->cell()] << node;
+    cells_ << node->cell();
+}
+
+void AnimatedCycle::unindexNode_(AnimatedCycleNode * node) const
+{
+    nodes_.remove(node);
+    QHash<Cell*, QSet<AnimatedCycleNode*> >::iterator it = cellNodes_.find(node->cell());
+    if(it != cellNodes_.end())
+    {
+        it->remove(node);
+        if(it->isEmpty())
+        {
+            cellNodes_.erase(it);
+            cells_.remove(node->cell());
+        }
+    }
+}
+
+void AnimatedCycle::updateNodeIndex_() const
+{
+    if(hasValidNodeIndex_())
+        return;
+
+    nodes_.clear();
+    cellNodes_.clear();
+    cells_.clear();
+
+    if(first_)
+    {
+        // Visited nodes are marked with a new generation number rather
+        // than looked up in nodes_
+        quint64 generation = Algorithms::CellMarks::newGeneration();
+
+        QStack<AnimatedCycleNode*> toProcess;
+        toProcess.push(first_);
+        first_->traversalMark_ = generation;
+        indexNode_(first_);
+        while(!toProcess.isEmpty())
+        {
+            AnimatedCycleNode * node = toProcess.pop();
+            AnimatedCycleNode * pointedNodes[4] = { node->previous(),
+                                                    node->next(),
+                                                    node->before(),
+                                                    node->after() };
+            for(int i=0; i<4; ++i)
+            {
+                if(pointedNodes[i] && pointedNodes[i]->traversalMark_ != generation)
+                {
+                    pointedNodes[i]->traversalMark_ = generation;
+                    toProcess.push(pointedNodes[i]);
+                    indexNode_(pointedNodes[i]);
+                }
+            }
+        }
+    }
+
+    setNodeIndexValid_();
+}
+
+void AnimatedCycle::clearCachedTimeIndex()
+{
+    timeIndexRevision_ = -1;
+}
+
+void AnimatedCycle::updateTimeIndex_() const
+{
+    if(timeIndexRevision_ == *revision_)
+        return;
+
+    timeIndexNodes_.clear();
+    timeIndexEnds_.clear();
+    isTimeIndexSorted_ = true;
+
+    // The number of nodes bounds the length of the chain, which would
+    // otherwise be infinite if the cycle is invalid
+    updateNodeIndex_();
+    int maxLength = nodes_.size();
+    for(AnimatedCycleNode * node = first_;
+        node && timeIndexNodes_.size() < maxLength;
+        node = node->after())
+    {
+        KeyCell * keyCell = node->cell()->toKeyCell();
+        InbetweenCell * inbetweenCell = node->cell()->toInbetweenCell();
+        Time end = keyCell ? keyCell->time() : inbetweenCell->afterTime();
+        if(!timeIndexEnds_.isEmpty() && end < timeIndexEnds_.last())
+            isTimeIndexSorted_ = false;
+        timeIndexNodes_ << node;
+        timeIndexEnds_ << end;
+    }
+
+    timeIndexRevision_ = *revision_;
 }
 
 AnimatedCycleNode  * AnimatedCycle::getNode(Time time)
@@ -291,6 +442,24 @@ AnimatedCycleNode  * AnimatedCycle::getNode(Time time)
         return 0;
     }
 
+    // Skip all nodes ending before time. This doesn't change the result
+    // since none of these nodes exist at time.
+    updateTimeIndex_();
+    if(isTimeIndexSorted_)
+    {
+        QList<Time>::const_iterator it = std::lower_bound(
+                    timeIndexEnds_.constBegin(), timeIndexEnds_.constEnd(), time);
+        int i = it - timeIndexEnds_.constBegin();
+        if(i < timeIndexNodes_.size())
+        {
+            res = timeIndexNodes_[i];
+        }
+        else if(timeIndexNodes_.last()->after() == 0)
+        {
+            qWarning("node(t) not found: no after node");
+            return 0;
+        }
+    }
 
     while(!res->cell()->exists(time))
     {
@@ -307,39 +476,14 @@ AnimatedCycleNode  * AnimatedCycle::getNode(Time time)
 
 QSet<AnimatedCycleNode*> AnimatedCycle::nodes() const
 {
-    QSet<AnimatedCycleNode*> res;
-
-    if(!first_)
-        return res;
-
-    QStack<AnimatedCycleNode*> toProcess;
-    toProcess.push(first_);
-    res << first_;
-    while(!toProcess.isEmpty())
-    {
-        AnimatedCycleNode * node = toProcess.pop();
-        AnimatedCycleNode * pointedNodes[4] = { node->previous(),
-                                                node->next(),
-                                                node->before(),
-                                                node->after() };
-        for(int i=0; i<4; ++i)
-        {
-            if(pointedNodes[i] && !res.contains(pointedNodes[i]))
-            {
-                toProcess.push(pointedNodes[i]);
-                res << pointedNodes[i];
-            }
-        }
-    }
-    return res;
+    updateNodeIndex_();
+    return nodes_;
 }
 
 CellSet AnimatedCycle::cells() const
 {
-    CellSet res;
-    foreach(AnimatedCycleNode * node, nodes())
-        res << node->cell();
-    return res;
+    updateNodeIndex_();
+    return cells_;
 }
 KeyCellSet AnimatedCycle::beforeCells() const
 {
@@ -366,22 +510,26 @@ KeyCellSet AnimatedCycle::afterCells() const
 // Replace pointed vertex
 void AnimatedCycle::replaceVertex(KeyVertex * oldVertex, KeyVertex * newVertex)
 {
-    foreach(AnimatedCycleNode * node, nodes())
+    // Only the nodes of oldVertex are visited, and the index is updated
+    // rather than invalidated (the setters invalidate it)
+    foreach(AnimatedCycleNode * node, getNodes(oldVertex))
     {
-        if(node->cell()->toKeyVertex() == oldVertex)
-            node->setCell(newVertex);
+        unindexNode_(node);
+        node->setCell(newVertex);
+        indexNode_(node);
     }
+    setNodeIndexValid_();
 }
 void AnimatedCycle::replaceHalfedge(const KeyHalfedge & oldHalfedge, const KeyHalfedge & newHalfedge)
 {
-    foreach(AnimatedCycleNode * node, nodes())
+    foreach(AnimatedCycleNode * node, getNodes(oldHalfedge.edge))
     {
-        if(node->cell()->toKeyEdge() == oldHalfedge.edge)
-        {
-            node->setCell(newHalfedge.edge);
-            node->setSide((node->side() == oldHalfedge.side) == newHalfedge.side);
-        }
+        unindexNode_(node);
+        node->setCell(newHalfedge.edge);
+        node->setSide((node->side() == oldHalfedge.side) == newHalfedge.side);
+        indexNode_(node);
     }
+    setNodeIndexValid_();
 }
 void AnimatedCycle::replaceEdges(KeyEdge * oldEdge, const KeyEdgeList & newEdges)
 {
@@ -572,13 +720,8 @@ void AnimatedCycle::replaceEdges(KeyEdge * oldEdge, const KeyEdgeList & newEdges
 
 QSet<AnimatedCycleNode*>  AnimatedCycle::getNodes(Cell * cell)
 {
-    QSet<AnimatedCycleNode*> res;
-    foreach(AnimatedCycleNode * node, nodes())
-    {
-        if(node->cell() == cell)
-            res << node;
-    }
-    return res;
+    updateNodeIndex_();
+    return cellNodes_.value(cell);
 }
 
 void AnimatedCycle::replaceInbetweenVertex(InbetweenVertex * sv,
@@ -1099,6 +1242,7 @@ void AnimatedCycle::convertTempIdsToPointers(VAC * vac)
     first_ = nodes[0];
     while(first_->before())
         first_ = first_->before();
+    setModified_();
 
     // Clean
     tempNodes_.clear();
@@ -1119,9 +1263,9 @@ QString str(const QMap<AnimatedCycleNode*,int> & nodeMap, AnimatedCycleNode * no
         return "_";
 }
 
-int toInt(const QMap<int,int> & map, const QString & str)
+int toInt(const QMap<int,int> & map, const QStringRef & str)
 {
-    if(str == "" || str == "_")
+    if(str.isEmpty() || str == QLatin1String("_"))
         return -1;
     else
         return map[str.toInt()];
@@ -1168,6 +1312,11 @@ QString AnimatedCycle::toString() const
 }
 
 void AnimatedCycle::fromString(const QString & str)
+{
+    fromString(QStringRef(&str));
+}
+
+void AnimatedCycle::fromString(const QStringRef & str)
 {
     clear();
     tempNodes_.clear();
@@ -1176,27 +1325,36 @@ void AnimatedCycle::fromString(const QString & str)
     // Example:
     //  "[1:(15+,2,5,_,_) 2:(12,1,2,3,4)]" becomes:
     //  [ "1" ; "15+" ; "2" ; "5" ; "_" ; "_" ; "2" ; "12" ; "1" ; "2" ; "3" ; "4" ]
-    QStringList d = str.split(QRegExp("[\\[\\]\\s\\,\\(\\):]"), QString::SkipEmptyParts); // use , ( ) [ ] : and whitespaces as delimiters
+    StringTokenizer tokenizer(str, "[],():"); // use , ( ) [ ] : and whitespaces as delimiters
 
     // Get the number of nodes
-    int n = d.size()/6;
+    int n = tokenizer.countRemaining()/6;
 
     // Create a map between saved node id and node id in [0..n-1],
     // since we will save this data into an array, and discard the "saved node id"
     QMap<int,int> map;
     for(int i=0; i<n; ++i)
-        map[ d[6*i].toInt() ] = i;
+    {
+        map[ tokenizer.next().toInt() ] = i;
+        for(int j=1; j<6; ++j)
+            tokenizer.next();
+    }
 
     // Store data in tempNodes
+    tokenizer.rewind();
+    tempNodes_.reserve(n);
     for(int i=0; i<n; ++i)
     {
         AnimatedCycle::TempNode tempNode;
 
+        // Saved node id, already processed
+        tokenizer.next();
+
         // Referenced cell and side
-        QString cellside = d[6*i+1];
+        QStringRef cellside = tokenizer.next();
         int l = cellside.length();
         QChar side = cellside.at(l-1);
-        QString cell = cellside.left(l-1);
+        QStringRef cell = cellside.left(l-1);
         if(side == '+' || side == '-')
         {
             tempNode.cell = cell.toInt();
@@ -1209,10 +1367,10 @@ void AnimatedCycle::fromString(const QString & str)
         }
 
         // Previous/Next/Before/After node pointers
-        tempNode.previous = toInt(map, d[6*i+2]);
-        tempNode.next = toInt(map, d[6*i+3]);
-        tempNode.before = toInt(map, d[6*i+4]);
-        tempNode.after = toInt(map, d[6*i+5]);
+        tempNode.previous = toInt(map, tokenizer.next());
+        tempNode.next = toInt(map, tokenizer.next());
+        tempNode.before = toInt(map, tokenizer.next());
+        tempNode.after = toInt(map, tokenizer.next());
 
         // Add to list of nodes
         tempNodes_ << tempNode;
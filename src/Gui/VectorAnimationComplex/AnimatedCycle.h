@@ -14,6 +14,8 @@
 #include "../TimeDef.h"
 #include "Eigen.h"
 #include <QList>
+#include <QHash>
+#include <QSharedPointer>
 
 ////////////// Forward declare global serialization operators /////////////////
 
@@ -83,6 +85,17 @@ private:
     AnimatedCycleNode * before_;
     AnimatedCycleNode * after_;
     bool side_;
+
+    // Revision number of the cycle indexing this node, incremented by the
+    // setters so that the cycle knows its index is outdated (see
+    // AnimatedCycle::nodes()). It is shared, rather than a pointer to the
+    // cycle, so that it is safe to modify a node outliving its cycle.
+    friend class AnimatedCycle;
+    QSharedPointer<int> revision_;
+    void setModified_();
+
+    // Generation at which this node was last visited when indexing
+    quint64 traversalMark_;
 };
 
 class AnimatedCycle
@@ -108,6 +121,15 @@ public:
     // Find all nodes
     QSet<AnimatedCycleNode*> nodes() const; // Note: only return nodes connected to first_ (i.e., may not work if cycle is invalid)
 
+    // Nodes, cells, and the nodes of each cell are indexed on first query,
+    // and the index is kept up to date by the methods of this class. It is
+    // rebuilt on next query if nodes are modified by other means.
+    //
+    // getNode(time) also uses an index of the nodes reachable from first()
+    // by after(), sorted by time. It must be cleared when the time of cells
+    // changes, which is done by InbetweenFace::clearCachedGeometry_().
+    void clearCachedTimeIndex();
+
     // Find all cells
     CellSet cells() const;
     KeyCellSet beforeCells() const; // temporal boundary of n->before == NULL
@@ -132,6 +154,7 @@ public:
     void convertTempIdsToPointers(VAC * vac);
     QString toString() const;
     void fromString(const QString & str);
+    void fromString(const QStringRef & str);
 
     // Methods that can make the animated cycle invalid. Use with caution
 
@@ -142,6 +165,28 @@ private:
 
     AnimatedCycleNode * first_;
 
+    // Index of nodes and cells. The index is valid if nodesRevision_ is
+    // equal to *revision_, which is shared with indexed nodes.
+    QSharedPointer<int> revision_;
+    mutable int nodesRevision_;
+    mutable QSet<AnimatedCycleNode*> nodes_;
+    mutable QHash<Cell*, QSet<AnimatedCycleNode*> > cellNodes_;
+    mutable CellSet cells_;
+    void setModified_();
+    bool hasValidNodeIndex_() const;
+    void updateNodeIndex_() const;
+    void indexNode_(AnimatedCycleNode * node) const;
+    void unindexNode_(AnimatedCycleNode * node) const;
+    void setNodeIndexValid_() const;
+
+    // Index of the "after" chain starting at first_, with the time at
+    // which each node ends.
+    mutable int timeIndexRevision_;
+    mutable bool isTimeIndexSorted_;
+    mutable QList<AnimatedCycleNode*> timeIndexNodes_;
+    mutable QList<Time> timeIndexEnds_;
+    void updateTimeIndex_() const;
+
     // for unserialization
     friend class InbetweenFace;
     struct TempNode { int cell, previous, next, before, after; bool side; };
@@ -12,6 +12,8 @@
 #include "InbetweenVertex.h"
 #include "VAC.h"
 
+#include "../StringTokenizer.h"
+
 #include <assert.h>
 
 namespace VectorAnimationComplex
@@ -153,16 +155,19 @@ QString AnimatedVertex::toString() const
 }
 
 void AnimatedVertex::fromString(const QString & str)
+{
+    fromString(QStringRef(&str));
+}
+
+void AnimatedVertex::fromString(const QStringRef & str)
 {
     // Clear
     tempIds_.clear();
 
     // Split at ',', '[', ']', or any whitespace character
-    QStringList strList = str.split(QRegExp("[\\,\\s\\[\\]]"), QString::SkipEmptyParts);
-
-    int n = strList.size();
-    for(int i=0; i<n; ++i)
-        tempIds_ << strList[i].toInt();
+    StringTokenizer tokenizer(str, ",[]");
+    while(!tokenizer.atEnd())
+        tempIds_ << tokenizer.next().toInt();
 }
 
 
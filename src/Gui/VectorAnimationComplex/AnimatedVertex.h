@@ -54,6 +54,7 @@ public:
     void convertTempIdsToPointers(VAC * vac);
     QString toString() const;
     void fromString(const QString & str);
+    void fromString(const QStringRef & str);
 
     // Replace
     void replaceCells(InbetweenVertex * old, InbetweenVertex * new1, InbetweenVertex * new2);
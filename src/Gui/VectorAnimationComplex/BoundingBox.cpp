@@ -157,6 +157,14 @@ void BoundingBox::intersect(const BoundingBox & other)
         *this = BoundingBox();
 }
 
+BoundingBox BoundingBox::expanded(double d) const
+{
+    if (isEmpty())
+        return BoundingBox();
+    else
+        return BoundingBox(xMin_ - d, xMax_ + d, yMin_ - d, yMax_ + d);
+}
+
 bool BoundingBox::intersects(const BoundingBox & other) const
 {
     return !intersected(other).isEmpty();
@@ -241,6 +241,10 @@ public:
     void unite     (const BoundingBox & other);
     void intersect (const BoundingBox & other);
 
+    // Returns this bounding box grown by d >= 0 in all four directions.
+    // The empty bounding box stays empty.
+    BoundingBox expanded(double d) const;
+
     // Returns whether the two bounding boxes intersect
     bool intersects(const BoundingBox & other) const;
     
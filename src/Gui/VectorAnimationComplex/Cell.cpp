@@ -37,13 +37,15 @@
 #include "../XmlStreamWriter.h"
 
 #include "../CssColor.h"
+#include "../MemoryUsage.h"
 
 namespace VectorAnimationComplex
 {
 
 Cell::Cell(VAC * vac) :
     vac_(vac), id_(-1),
-    isHovered_(0), isSelected_(0)
+    isHovered_(0), isSelected_(0),
+    traversalMark_(0)
 {
     colorHighlighted_[0] = 1;
     colorHighlighted_[1] = 0.7;
@@ -150,7 +152,8 @@ void Cell::updateBoundary_impl(const KeyHalfedge & , const KeyHalfedge & ) {}
 void Cell::updateBoundary_impl(KeyEdge * , const KeyEdgeList & ) {}
 
 
-Cell::Cell(Cell * other)
+Cell::Cell(Cell * other) :
+    traversalMark_(0)
 {
     vac_ = other->vac_;
     id_ = other->id_;
@@ -184,6 +187,7 @@ void Cell::remapPointers(VAC * newVAC)
         auto itEnd = old.end();
         for(; it != itEnd; ++it)
             spatialStar_ << newVAC->getCell((*it)->id());
+        processSpatialStarChanged_();
     }
     {
         CellSet old = temporalStarBefore_;
@@ -221,6 +225,17 @@ void Cell::setColor(const QColor & c)
     color_[1] = c.greenF();
     color_[2] = c.blueF();
     color_[3] = c.alphaF();
+
+    processDrawingChanged_();
+}
+
+void Cell::setSelected(bool b)
+{
+    // Selected cells are drawn with another color. This doesn't change the
+    // frame revisions: views clear their playback cache on selection changes
+    if(isSelected_ != b && vac_)
+        vac_->setDrawingChanged_(this);
+    isSelected_ = b;
 }
 
 bool Cell::isHighlighted() const
@@ -277,9 +292,7 @@ bool Cell::isHighlighted() const
 
 void Cell::glColorTopology_()
 {
-    if(isHighlighted())
-        glColor4dv(colorHighlighted_);
-    else if(isSelected() && global()->toolMode() == Global::SELECT)
+    if(isSelected() && global()->toolMode() == Global::SELECT)
         glColor4dv(colorSelected_);
     else
     {
@@ -330,8 +343,6 @@ void Cell::glColor_(Time time, ViewSettings & viewSettings)
         QColor c = getColor(time, viewSettings);
         glColor4d(c.redF(), c.greenF(), c.blueF(), c.alphaF());
     }
-    else if(isHighlighted())
-        glColor4dv(colorHighlighted_);
     else if(isSelected() && global()->toolMode() == Global::SELECT)
         glColor4dv(colorSelected_);
     else
@@ -341,6 +352,13 @@ void Cell::glColor_(Time time, ViewSettings & viewSettings)
     }
 }
 
+void Cell::glColorHighlight_()
+{
+    // Translucent, so that cells drawn above this one remain visible
+    glColor4d(colorHighlighted_[0], colorHighlighted_[1], colorHighlighted_[2],
+              0.5 * colorHighlighted_[3]);
+}
+
 void Cell::glColor3D_()
 {
     if(global()->displayMode() == Global::ILLUSTRATION_OUTLINE && !toFaceCell())
@@ -375,6 +393,20 @@ void Cell::drawRaw(Time time, ViewSettings & /*viewSettings*/)
     triangles(time).draw();
 }
 
+void Cell::drawHighlight(Time time, ViewSettings & viewSettings)
+{
+    if (!exists(time))
+        return;
+
+    glColorHighlight_();
+    drawRawHighlight(time, viewSettings);
+}
+
+void Cell::drawRawHighlight(Time time, ViewSettings & viewSettings)
+{
+    drawRaw(time, viewSettings);
+}
+
 void Cell::drawPick(Time time, ViewSettings & viewSettings)
 {
     if (!isPickable(time))
@@ -411,6 +443,15 @@ void Cell::drawRawTopology(Time time, ViewSettings & /*viewSettings*/)
     triangles(time).draw();
 }
 
+void Cell::drawTopologyHighlight(Time time, ViewSettings & viewSettings)
+{
+    if (!exists(time))
+        return;
+
+    glColorHighlight_();
+    drawRawTopology(time, viewSettings);
+}
+
 void Cell::drawPickTopology(Time time, ViewSettings & viewSettings)
 {
     if (!isPickable(time))
@@ -524,6 +565,25 @@ CellSet Cell::temporalStarAfter() const
     return temporalStarAfter_;
 }
 
+void Cell::appendBoundary(std::vector<Cell*> & out) const
+{
+    foreach(Cell * c, spatialBoundary())
+        out.push_back(c);
+    foreach(KeyCell * c, beforeCells())
+        out.push_back(c);
+    foreach(KeyCell * c, afterCells())
+        out.push_back(c);
+}
+void Cell::appendStar(std::vector<Cell*> & out) const
+{
+    for(CellSet::const_iterator it = spatialStar_.begin(); it != spatialStar_.end(); ++it)
+        out.push_back(*it);
+    for(CellSet::const_iterator it = temporalStarBefore_.begin(); it != temporalStarBefore_.end(); ++it)
+        out.push_back(*it);
+    for(CellSet::const_iterator it = temporalStarAfter_.begin(); it != temporalStarAfter_.end(); ++it)
+        out.push_back(*it);
+}
+
 // ---------- Neighbourhood ---------
 CellSet Cell::neighbourhood()  const
 {
@@ -599,6 +659,7 @@ void Cell::removeMeFromStarOf_(Cell * c)
 void Cell::addMeToSpatialStarOf_(Cell * c)
 {
     c->spatialStar_ << this;
+    c->processSpatialStarChanged_();
 }
 void Cell::addMeToTemporalStarBeforeOf_(Cell *c)
 {
@@ -612,6 +673,7 @@ void Cell::addMeToTemporalStarAfterOf_(Cell *c)
 void Cell::removeMeFromSpatialStarOf_(Cell * c)
 {
     c->spatialStar_.remove(this);
+    c->processSpatialStarChanged_();
 }
 void Cell::removeMeFromTemporalStarBeforeOf_(Cell *c)
 {
@@ -689,7 +751,8 @@ void Cell::read2ndPass()
 // to insert it in its list of objects.
 Cell::Cell(VAC * vac, QTextStream & in) :
     vac_(vac), id_(-1),
-    isHovered_(0), isSelected_(0)
+    isHovered_(0), isSelected_(0),
+    traversalMark_(0)
 {
     Field field;
     in >> field >> id_;
@@ -736,13 +799,15 @@ QString Cell::xmlType_() const
 
 Cell::Cell(VAC * vac, XmlStreamReader & xml) :
     vac_(vac), id_(-1),
-    isHovered_(0), isSelected_(0)
+    isHovered_(0), isSelected_(0),
+    traversalMark_(0)
 {
-    id_ = xml.attributes().value("id").toInt();
+    QXmlStreamAttributes attributes = xml.attributes();
+    id_ = attributes.value("id").toInt();
 
-    if(xml.attributes().hasAttribute("color"))
+    if(attributes.hasAttribute("color"))
     {
-        CssColor c(xml.attributes().value("color").toString());
+        CssColor c(attributes.value("color"));
         color_[0] = c.rF();
         color_[1] = c.gF();
         color_[2] = c.bF();
@@ -828,23 +893,160 @@ bool Cell::intersects(Time t, const BoundingBox & bb) const
     return triangles(t).intersects(bb);
 }
 
+void Cell::addMemoryUsage(MemoryUsage & usage)
+{
+    const QString subsystem = "Cell caches";
+    const QString type = typeName();
+
+    qint64 trianglesBytes = MemoryUsage::mapNodeBytes(triangles_);
+    for(auto it = triangles_.begin(); it != triangles_.end(); ++it)
+        trianglesBytes += (qint64) it.value().capacity() * sizeof(Triangle);
+    usage.add(subsystem, type + " triangles", trianglesBytes, triangles_.size());
+    usage.add(subsystem, type + " bounding boxes",
+              MemoryUsage::mapNodeBytes(boundingBoxes_), boundingBoxes_.size());
+    usage.add(subsystem, type + " outline bounding boxes",
+              MemoryUsage::mapNodeBytes(outlineBoundingBoxes_), outlineBoundingBoxes_.size());
+}
+
+QString Cell::typeName()
+{
+    if(toKeyVertex())
+        return "KeyVertex";
+    else if(toKeyEdge())
+        return "KeyEdge";
+    else if(toKeyFace())
+        return "KeyFace";
+    else if(toInbetweenVertex())
+        return "InbetweenVertex";
+    else if(toInbetweenEdge())
+        return "InbetweenEdge";
+    else if(toInbetweenFace())
+        return "InbetweenFace";
+    else
+        return "Cell";
+}
+
 void Cell::processGeometryChanged_()
 {
+    // Deferred to the end of the operation, see GeometryChangeTransaction
+    if(vac_->geometryChangeDepth_ > 0)
+    {
+        vac_->deferGeometryChanged_(this, false);
+        return;
+    }
+
     CellSet toClearCells = geometryDependentCells_();
     foreach(Cell * cell, toClearCells)
         cell->clearCachedGeometry_();
 }
 
+void Cell::processDependentGeometryChanged_()
+{
+    if(vac_->geometryChangeDepth_ > 0)
+    {
+        vac_->deferGeometryChanged_(this, true);
+        return;
+    }
+
+    CellSet toClearCells = geometryDependentCells_();
+    toClearCells.remove(this);
+    foreach(Cell * cell, toClearCells)
+        cell->clearCachedGeometry_();
+}
+
 void Cell::clearCachedGeometry_()
 {
+    processDrawingChanged_();
+
     triangles_.clear();
     boundingBoxes_.clear();
     outlineBoundingBoxes_.clear();
 }
 
+void Cell::processSpatialStarChanged_()
+{
+}
+
+void Cell::processDrawingChanged_()
+{
+    if(vac_)
+        vac_->setFramesChanged_(this);
+}
+
+Triangles * Cell::cachedTriangles_(Time t) const
+{
+    int key = std::floor(t.floatTime() * 60 + 0.5);
+    auto it = triangles_.find(key);
+    return (it == triangles_.end()) ? 0 : &it.value();
+}
+
+BoundingBox * Cell::cachedBoundingBox_(Time t) const
+{
+    int key = std::floor(t.floatTime() * 60 + 0.5);
+    auto it = boundingBoxes_.find(key);
+    return (it == boundingBoxes_.end()) ? 0 : &it.value();
+}
+
+void Cell::clearCachedOutlineBoundingBoxes_()
+{
+    outlineBoundingBoxes_.clear();
+}
+
+bool Cell::transformCachedGeometry_(const Eigen::Affine2d & xf)
+{
+    if(!isRigidTransform_(xf))
+        return false;
+
+    transformCachedTriangles_(xf);
+    return true;
+}
+
+void Cell::transformCachedTriangles_(const Eigen::Affine2d & xf)
+{
+    for(auto it = triangles_.begin(); it != triangles_.end(); ++it)
+        it.value().transform(xf);
+
+    // Bounding boxes are not preserved by rotations, and are cheap to
+    // recompute from the triangles
+    boundingBoxes_.clear();
+    outlineBoundingBoxes_.clear();
+}
+
+bool Cell::isRigidTransform_(const Eigen::Affine2d & xf)
+{
+    // Rotation (without reflection) and translation
+    const double eps = 1e-9;
+    Eigen::Matrix2d A = xf.linear();
+    return (A.transpose() * A - Eigen::Matrix2d::Identity()).cwiseAbs().maxCoeff() < eps &&
+           A.determinant() > 0;
+}
+
 // XXX this could be cached, it is called many times during
 // drag and drop and affine transform while not changing
 CellSet Cell::geometryDependentCells_()
+{
+    CellSet res = Algorithms::fullstar(geometryDependentSeeds_());
+    addSizeDependentVertices_(res);
+    return res;
+}
+
+void Cell::addSizeDependentVertices_(CellSet & cells)
+{
+    // Vertices are drawn as disks whose diameter is the width of their
+    // incident edges (see VertexCell::size()), and the all-time bounding box
+    // of inbetween vertices is grown accordingly. Their cached geometry
+    // therefore depends on the width of their incident edges, even though
+    // they are not in the star of these edges
+    CellSet vertices;
+    foreach(Cell * c, cells)
+    {
+        if(c->toEdgeCell())
+            vertices.unite(c->spatialBoundary());
+    }
+    cells.unite(vertices);
+}
+
+CellSet Cell::geometryDependentSeeds_()
 {
     CellSet res;
     res << this;
@@ -859,7 +1061,7 @@ CellSet Cell::geometryDependentCells_()
         res.unite(afterVertices);
     }
 
-    return Algorithms::fullstar(res);
+    return res;
 }
 
 }
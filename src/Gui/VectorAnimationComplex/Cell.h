@@ -99,15 +99,18 @@
 #include <QString>
 #include <QRect>
 #include <QColor>
+#include <vector>
 class QTextStream;
 class XmlStreamWriter;
 class XmlStreamReader;
+class MemoryUsage;
 
 namespace VectorAnimationComplex
 {
 
 class CellObserver;
 class KeyHalfedge;
+namespace Algorithms { class CellMarks; }
 
 // The abstract base class Cell
 class Cell
@@ -225,6 +228,11 @@ public:
     CellSet temporalNeighbourhood() const;
     CellSet temporalNeighbourhoodBefore() const;
     CellSet temporalNeighbourhoodAfter() const;
+    // ------- Without copying sets -------
+    // Same cells as boundary() and star(), appended to out, possibly
+    // several times. Used by traversals (see Algorithms::CellMarks)
+    virtual void appendBoundary(std::vector<Cell*> & out) const;
+    void appendStar(std::vector<Cell*> & out) const;
 
     // Update cell boundary as a result of a split
     void updateBoundary(KeyVertex * oldVertex, KeyVertex * newVertex);
@@ -271,6 +279,10 @@ private:
                                  // only for the boundary, and that the star is only stored to inform all of them
                                  // consistently when a change happened to the boundary
 
+    // Generation at which this cell was last marked by a traversal
+    friend class Algorithms::CellMarks;
+    quint64 traversalMark_;
+
 
 //###################################################################
 //                 HIGHLIGHTING / SELECTING / DRAWING
@@ -302,6 +314,13 @@ public:
     virtual void drawRawTopology(Time time, ViewSettings & viewSettings);
     void drawPickTopology(Time time, ViewSettings & viewSettings);
 
+    // Draws a translucent tint of this cell, with the highlight color, over
+    // an already drawn scene (see VAC::drawOverlay()). Note that draw() and
+    // drawTopology() ignore whether the cell is hovered
+    void drawHighlight(Time time, ViewSettings & viewSettings);
+    virtual void drawRawHighlight(Time time, ViewSettings & viewSettings);
+    void drawTopologyHighlight(Time time, ViewSettings & viewSettings);
+
     virtual void draw3D(View3DSettings & viewSettings);
     virtual void drawRaw3D(View3DSettings & viewSettings);
     virtual void drawPick3D(View3DSettings & viewSettings);
@@ -324,6 +343,7 @@ protected:
     virtual QColor getColor(Time time, ViewSettings & viewSettings) const;
     virtual void glColor_(Time time, ViewSettings & viewSettings);
     virtual void glColorTopology_();
+    void glColorHighlight_();
     virtual void glColor3D_();
     double colorHighlighted_[4];
     double colorSelected_[4];
@@ -334,7 +354,7 @@ private:
     bool isHovered_;
     bool isSelected_;
     void setHovered(bool b) { isHovered_ = b;    }
-    void setSelected(bool b) { isSelected_    = b;    }
+    void setSelected(bool b);
 
     // Non-Virtual Interface idiom
     bool isPickable(Time time) const;
@@ -389,6 +409,13 @@ public:
     //     boundingBox(t).intersects(bb);
     bool intersects(Time t, const BoundingBox & bb) const;
 
+    // Adds the memory held by the cached geometry of this cell, and by its
+    // geometry data if any, to usage. Categories are prefixed by typeName()
+    virtual void addMemoryUsage(MemoryUsage & usage);
+
+    // Name of the concrete type of this cell, e.g. "KeyEdge"
+    QString typeName();
+
 protected:
     // Method to be called by derived classes when their geometry changes
     void processGeometryChanged_();
@@ -396,6 +423,37 @@ protected:
     // Clear cached geometry (derived classes caching more data may specialize it)
     virtual void clearCachedGeometry_();
 
+    // Informs the VAC that the drawing of this cell changed, which is already
+    // done by clearCachedGeometry_(). To be called before updating the cached
+    // geometry in place, so that the region where the cell was drawn is known
+    // (see VAC::changedRegions())
+    void processDrawingChanged_();
+
+    // Called when a cell is added to or removed from the spatial star of this
+    // cell (derived classes caching star-dependent data may specialize it)
+    virtual void processSpatialStarChanged_();
+
+    // Variant of processGeometryChanged_() which leaves the cached geometry of
+    // this cell untouched. Used by derived classes able to update their own
+    // cached geometry in place (e.g., while sculpting)
+    void processDependentGeometryChanged_();
+
+    // Direct access to cached geometry, for in place updates. Return null if
+    // nothing is cached for time t
+    Triangles * cachedTriangles_(Time t) const;
+    BoundingBox * cachedBoundingBox_(Time t) const;
+    void clearCachedOutlineBoundingBoxes_();
+
+    // Applies xf to the cached geometry of this cell instead of clearing it,
+    // knowing that xf was applied to the geometry of this cell and of all
+    // the cells it depends on (see GeometryChangeTransaction). Returns false
+    // if the cached geometry can't be transformed by xf, in which case it
+    // must be cleared. The default implementation transforms the triangles
+    // for rigid transformations only, since stroke widths are not scaled
+    virtual bool transformCachedGeometry_(const Eigen::Affine2d & xf);
+    void transformCachedTriangles_(const Eigen::Affine2d & xf);
+    static bool isRigidTransform_(const Eigen::Affine2d & xf);
+
 private:
     // Cached triangulations and bounding boxes (the integer represent a 1/60th of frame)
     mutable QMap<int,Triangles> triangles_;
@@ -408,8 +466,12 @@ private:
     // Compute outline bounding box for time t (must be implemented by derived classes)
     virtual void computeOutlineBoundingBox_(Time t, BoundingBox & out) const=0;
 
-    // Return the list of cells whose geometry depends on this cell's geometry
+    // Return the list of cells whose geometry depends on this cell's geometry,
+    // which is the fullstar of its geometry dependent seeds, plus the end
+    // vertices of the edges in this fullstar
     CellSet geometryDependentCells_();
+    CellSet geometryDependentSeeds_();
+    static void addSizeDependentVertices_(CellSet & cells);
 };
     
 }
@@ -13,6 +13,7 @@
 #include "VAC.h"
 
 #include "../SaveAndLoad.h"
+#include "../StringTokenizer.h"
 
 #include <QMessageBox>
 
@@ -395,26 +396,9 @@ void Cycle::sample(int numSamples, QList<EdgeSample> & out) const
     }
     else
     {
-        QList<EdgeSample> outAux;
-
-        assert(numSamples >= 2);
-        double l = length();
-        double ds = l/(numSamples-1);
-
         // Computing unoffset cycle
-        double cumulativeLength = 0;
-        int indexHe = 0;
-        KeyHalfedge he = halfedges_[indexHe];
-        for(int i=0; i<numSamples; ++i)
-        {
-            double s = i*ds;
-            while ( (s > cumulativeLength + he.length()) && (indexHe+1 < halfedges_.size()) )
-            {
-                cumulativeLength += he.length();
-                he = halfedges_[++indexHe];
-            }
-            outAux << he.sample(s-cumulativeLength);
-        }
+        std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > outAux(numSamples);
+        KeyHalfedge::sampleUniformly(halfedges_, numSamples, outAux.data());
 
         // Apply offset
         int i0 = std::floor( numSamples * s0_ + 0.5);
@@ -450,25 +434,9 @@ void Cycle::sample(int numSamples, QList<Eigen::Vector2d> & out) const
     }
     else
     {
-        QList<Eigen::Vector2d> outAux;
-
         // Computing unoffset cycle
-        assert(numSamples >= 2);
-        double ds = length()/(numSamples-1);
-
-        double cumulativeLength = 0;
-        int indexHe = 0;
-        KeyHalfedge he = halfedges_[indexHe];
-        for(int i=0; i<numSamples; ++i)
-        {
-            double s = i*ds;
-            while ( (s > cumulativeLength + he.length()) && (indexHe+1 < halfedges_.size()) )
-            {
-                cumulativeLength += he.length();
-                he = halfedges_[++indexHe];
-            }
-            outAux << he.pos(s-cumulativeLength);
-        }
+        std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > outAux(numSamples);
+        KeyHalfedge::sampleUniformly(halfedges_, numSamples, outAux.data());
 
         // Apply offset
         int i0 = std::floor( numSamples * s0_ + 0.5);
@@ -477,9 +445,9 @@ void Cycle::sample(int numSamples, QList<Eigen::Vector2d> & out) const
         if(i0 > numSamples - 1)
             i0 = numSamples - 1;
         for(int i=i0; i<numSamples; ++i)
-            out << outAux[i];
+            out << Eigen::Vector2d(outAux[i].x(), outAux[i].y());
         for(int i=0; i<i0; ++i)
-            out << outAux[i];
+            out << Eigen::Vector2d(outAux[i].x(), outAux[i].y());
     }
 }
 
@@ -607,6 +575,11 @@ QString Cycle::toString() const
 }
 
 void Cycle::fromString(const QString & str)
+{
+    fromString(QStringRef(&str));
+}
+
+void Cycle::fromString(const QStringRef & str)
 {
     // Clear
     tempId_ = -1;
@@ -614,28 +587,28 @@ void Cycle::fromString(const QString & str)
     halfedges_.clear();
 
     // Split at ',', '[', ']', or any whitespace character
-    QStringList strList = str.split(QRegExp("[\\,\\s\\[\\]]"), QString::SkipEmptyParts);
+    StringTokenizer tokenizer(str, ",[]");
+    QStringRef firstStr = tokenizer.next();
+    if(firstStr.isEmpty())
+        return;
 
     // Get some info to determine cycle type
-    QString firstStr = strList[0];
     QChar c =  firstStr.at(firstStr.length()-1);
 
     // Switch depending on type
-    if(strList.size() == 1 && c != '+' && c != '-')
+    if(c != '+' && c != '-' && tokenizer.atEnd())
     {
         // Vertex
-        tempId_ = strList[0].toInt();
+        tempId_ = firstStr.toInt();
     }
     else
     {
         // Halfedges
-        int n = strList.size();
-        for(int i=0; i<n; ++i)
+        for(QStringRef token = firstStr; !token.isEmpty(); token = tokenizer.next())
         {
-            QString str = strList[i];
-            int l = str.length();
-            QChar side = str.at(l-1);
-            QString edge = str.left(l-1);
+            int l = token.length();
+            QChar side = token.at(l-1);
+            QStringRef edge = token.left(l-1);
 
             KeyHalfedge h;
             h.tempId_ = edge.toInt();
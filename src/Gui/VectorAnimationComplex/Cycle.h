@@ -75,6 +75,7 @@ public:
     void convertTempIdsToPointers(VAC * vac);
     QString toString() const;
     void fromString(const QString & str);
+    void fromString(const QStringRef & str);
 
     // Replace boundary cells by other cells
     void replaceVertex(KeyVertex * oldVertex, KeyVertex * newVertex);
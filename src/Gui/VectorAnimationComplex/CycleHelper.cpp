@@ -117,7 +117,7 @@ CycleHelper::CycleHelper(const KeyEdgeSet & edgeSetConst) :
                 edges(),
                 parent(0),
                 isRoot(false),
-                visited(false) {}
+                visited(0) {}
 
             // corresponding cell
             KeyVertex * vertex;
@@ -125,10 +125,12 @@ CycleHelper::CycleHelper(const KeyEdgeSet & edgeSetConst) :
             // incident edges
             QSet<Edge*> edges;
 
-            // tree relationship
+            // tree relationship. visited is the last loop search which
+            // visited this node, so that nodes don't have to be reset
+            // before each search
             Edge * parent;
             bool isRoot;
-            bool visited;
+            int visited;
             Vertex * parentNode() { if(parent->leftNode == this) return parent->rightNode; else return parent->leftNode; }
         };
 
@@ -231,15 +233,12 @@ CycleHelper::CycleHelper(const KeyEdgeSet & edgeSetConst) :
 
 
         // find loops
+        int loopSearch = 0;
         while (!subcomplexEdges.isEmpty())
         {
-            //  initialization
-            foreach(Vertex * node, subcomplexNodes)
-            {
-                node->parent = 0;
-                node->isRoot = false;
-                node->visited = false;
-            }
+            //  initialization: nodes are implicitly marked as not visited,
+            //  and the parent of a node is set before it is visited
+            ++loopSearch;
 
             bool loopFound = false;
 
@@ -249,7 +248,7 @@ CycleHelper::CycleHelper(const KeyEdgeSet & edgeSetConst) :
                 Vertex * notYetVisitedNode = 0;
                 foreach(Vertex * node, subcomplexNodes)
                 {
-                    if(!node->visited)
+                    if(node->visited != loopSearch)
                     {
                         notYetVisitedNode = node;
                         break;
@@ -262,6 +261,7 @@ CycleHelper::CycleHelper(const KeyEdgeSet & edgeSetConst) :
 
                 // otherwise, the the unvisited node as the root
                 notYetVisitedNode->isRoot = true;
+                notYetVisitedNode->parent = 0;
 
                 // traverse the VAC until a loop is found, if any
                 QStack<Vertex*> stack;
@@ -270,7 +270,7 @@ CycleHelper::CycleHelper(const KeyEdgeSet & edgeSetConst) :
                 {
                     Vertex* node = stack.top();
                     stack.pop();
-                    node->visited = true;
+                    node->visited = loopSearch;
 
                     // depth-first recursive call: check all children
                     foreach(Edge * incidentEdge, node->edges)
@@ -283,7 +283,7 @@ CycleHelper::CycleHelper(const KeyEdgeSet & edgeSetConst) :
                                                                  // but it's not an issue for the algorithm
 
                             // check if the child has already been visited or not
-                            if(child->visited) // caution, can be non visited but already on the stack,
+                            if(child->visited == loopSearch) // caution, can be non visited but already on the stack,
                                                // and then already has a parent
                             {
                                 // we've found our loop!
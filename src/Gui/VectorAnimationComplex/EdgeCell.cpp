@@ -19,6 +19,7 @@
 #include "../SaveAndLoad.h"
 #include "../CssColor.h"
 #include "EdgeGeometry.h"
+#include "../MemoryUsage.h"
 
 namespace VectorAnimationComplex
 {
@@ -114,6 +115,27 @@ void EdgeCell::clearCachedGeometry_()
     trianglesTopo_.clear();
 }
 
+bool EdgeCell::transformCachedGeometry_(const Eigen::Affine2d & xf)
+{
+    if(!Cell::transformCachedGeometry_(xf))
+        return false;
+
+    for(auto it = trianglesTopo_.begin(); it != trianglesTopo_.end(); ++it)
+        it.value().transform(xf);
+    return true;
+}
+
+void EdgeCell::addMemoryUsage(MemoryUsage & usage)
+{
+    Cell::addMemoryUsage(usage);
+
+    qint64 trianglesTopoBytes = MemoryUsage::mapNodeBytes(trianglesTopo_);
+    for(auto it = trianglesTopo_.begin(); it != trianglesTopo_.end(); ++it)
+        trianglesTopoBytes += (qint64) it.value().capacity() * sizeof(Triangle);
+    usage.add("Cell caches", typeName() + " topology triangles",
+              trianglesTopoBytes, trianglesTopo_.size());
+}
+
 void EdgeCell::computeOutlineBoundingBox_(Time t, BoundingBox & out) const
 {
     if (exists(t))
@@ -47,11 +47,15 @@ public:
     // Export SVG
     virtual void exportSVG(Time t, QTextStream & out);
 
+    // Memory usage, including topology triangles
+    virtual void addMemoryUsage(MemoryUsage & usage);
+
 protected:
     // Special handling to draw edges of fixed screen-width in topology mode
     // (int=time, double=width)
     mutable QMap< QPair<int,double>, Triangles> trianglesTopo_;
     virtual void clearCachedGeometry_();
+    virtual bool transformCachedGeometry_(const Eigen::Affine2d & xf);
     virtual void triangulate_(double width, Time time, Triangles & out) const=0;
 
 private:
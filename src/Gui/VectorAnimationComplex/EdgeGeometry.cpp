@@ -7,15 +7,20 @@
 // directory of this distribution and at http://opensource.org/licenses/MIT
 
 #include "EdgeGeometry.h"
+#include "TessellationCache.h"
+#include "GeometryPager.h"
 
 #include <QTextStream>
 #include "../XmlStreamWriter.h"
 #include "../XmlStreamReader.h"
+#include "../StringTokenizer.h"
 
 #include "../SaveAndLoad.h"
 #include "../OpenGL.h"
 #include <cmath>
+#include <algorithm>
 #include "../DevSettings.h"
+#include "../MemoryUsage.h"
 #include <QtDebug>
 
 using namespace std;
@@ -130,6 +135,21 @@ void EdgeGeometry::triangulate(double /*width*/, Triangles & /*triangles*/)
     // TODO
 }
 
+bool EdgeGeometry::retriangulate(int /*first*/, int /*last*/, Triangles & /*triangles*/, BoundingBox & /*changedBoundingBox*/)
+{
+    return false;
+}
+
+bool EdgeGeometry::addToTessellationKey(TessellationKey & /*key*/) const
+{
+    return false;
+}
+
+qint64 EdgeGeometry::memoryUsage() const
+{
+    return sizeof(*this) + MemoryUsage::bytes(sampling_);
+}
+
 
 // --------------- Accessing Curve Geometry --------------------
 
@@ -145,6 +165,12 @@ EdgeSample EdgeGeometry::pos(double /*s*/) const
     return EdgeSample();
 }
 
+void EdgeGeometry::sortedPos(const double * s, int n, EdgeSample * out) const
+{
+    for(int k=0; k<n; ++k)
+        out[k] = pos(s[k]);
+}
+
 Eigen::Vector2d EdgeGeometry::der(double /*s*/)
 {
     return Eigen::Vector2d(1,0);
@@ -318,6 +344,11 @@ void EdgeGeometry::endSculptSmooth()
 {
 }
 
+bool EdgeGeometry::sculptModifiedRange(int & /*first*/, int & /*last*/) const
+{
+    return false;
+}
+
 void EdgeGeometry::prepareDragAndDrop()
 {
 }
@@ -326,6 +357,24 @@ void EdgeGeometry::performDragAndDrop(double /*dx*/, double /*dy*/)
 {
 }
 
+void EdgeGeometry::beginEndPointsDrag()
+{
+}
+
+void EdgeGeometry::continueEndPointsDrag(const Eigen::Vector2d & left,
+                                         const Eigen::Vector2d & right)
+{
+    setLeftRightPos(left, right);
+}
+
+void EdgeGeometry::endEndPointsDrag()
+{
+}
+
+void EdgeGeometry::cancelEndPointsDrag()
+{
+}
+
 void EdgeGeometry::prepareAffineTransform()
 {
 
@@ -336,6 +385,11 @@ void EdgeGeometry::performAffineTransform(const Eigen::Affine2d & /*xf*/)
 
 }
 
+void EdgeGeometry::endAffineTransform()
+{
+
+}
+
 EdgeGeometry::ClosestVertexInfo EdgeGeometry::closestPoint(double x, double y)
 {
     ClosestVertexInfo res;
@@ -360,7 +414,7 @@ void EdgeGeometry::write(XmlStreamWriter & /*xml*/) const
 
 LinearSpline::LinearSpline(double ds) :
     EdgeGeometry(ds),
-    curve_(ds)
+    residentCurve_(ds)
 {
 }
 
@@ -368,7 +422,7 @@ LinearSpline::LinearSpline(const std::vector<EdgeSample,Eigen::aligned_allocator
     //EdgeGeometry(ds),
     //curve_(ds)
 {
-    curve_.setVertices(samples);
+    curve_().setVertices(samples);
 }
 
 LinearSpline::LinearSpline(const QList<EdgeSample> & samples)
@@ -378,16 +432,20 @@ LinearSpline::LinearSpline(const QList<EdgeSample> & samples)
     {
         stdvector.push_back(es);
     }
-    curve_.setVertices(stdvector);
+    curve_().setVertices(stdvector);
 }
 
 LinearSpline::LinearSpline(const SculptCurve::Curve<EdgeSample> & other, bool loop) :
-    curve_(other)
+    residentCurve_(other)
 {
+    // The rest shape of a drag in progress belongs to the copied curve only,
+    // e.g. when the undo stack is saved or restored in the middle of a drag
+    residentCurve_.cancelEndPointsDrag();
+
     if(loop)
     {
         isClosed_ = true;
-        curve_.makeLoop();
+        curve_().makeLoop();
     }
 }
 
@@ -405,7 +463,7 @@ LinearSpline::LinearSpline(EdgeGeometry & other) //:
         samples << EdgeSample(vertices[i][0], vertices[i][1]);
 
     // set the curve to be this sampling
-    curve_.setVertices(samples);
+    curve_().setVertices(samples);
 }
 
 
@@ -419,16 +477,31 @@ LinearSpline::LinearSpline(const QList<Eigen::Vector2d> & vertices) //:
         samples << EdgeSample(vertices[i][0], vertices[i][1]);
 
     // set the curve to be this sampling
-    curve_.setVertices(samples);
+    curve_().setVertices(samples);
 }
 
 LinearSpline::~LinearSpline()
 {
+    if(pageId_ >= 0)
+        GeometryPager::instance()->release(pageId_);
 }
 
 LinearSpline * LinearSpline::clone()
 {
-    return new LinearSpline(curve_, isClosed());
+    // Clones of paged out samples are paged out too, e.g. for the undo stack
+    if(pageId_ >= 0)
+    {
+        int pageId = GeometryPager::instance()->copyPage(pageId_);
+        if(pageId >= 0)
+        {
+            LinearSpline * res = new LinearSpline(residentCurve_);
+            res->isClosed_ = isClosed();
+            res->pageId_ = pageId;
+            return res;
+        }
+    }
+
+    return new LinearSpline(curve_(), isClosed());
 }
 
 // ---------------------- Draw ------------------------
@@ -506,16 +579,10 @@ EdgeSampling subdivided(const EdgeSampling & in, double w = 0.0625)
     return out;
 }
 
-void triangulateHelper(const QList<EdgeSample> & samplesInput, Triangles & triangles, bool closed = false)
+// Subdivides numSub times the given samples. The returned samples repeat
+// the first sample at the end if closed.
+QList<EdgeSample> subdividedSamples(const QList<EdgeSample> & samplesInput, bool closed, int numSub)
 {
-    // Initialization and basic case
-    triangles.clear();
-    int n=samplesInput.size();
-    if(n<2)
-        return;
-
-    // Subdivision
-    int numSub = DevSettings::getInt("num sub");
     EdgeSampling sampling1(samplesInput, closed);
     EdgeSampling sampling2(closed);
     for(int i=0; i<numSub; ++i)
@@ -527,177 +594,244 @@ void triangulateHelper(const QList<EdgeSample> & samplesInput, Triangles & trian
     }
     EdgeSampling & sampling = ( (numSub%2) == 0 ) ? sampling1 : sampling2;
 
-    // Samples after subdivision
     QList<EdgeSample> samples;
     for(int i=0; i<sampling.size(); ++i)
         samples << sampling[i];
     if(sampling.isClosed())
         samples << sampling[0];
-    n=samples.size();
+    return samples;
+}
 
-    // Helper function
-    auto getD = [] (double x1, double y1, double x2, double y2)
+// Returns the direction d_i of the segment ending at samples[i], for i in
+// [0..n]. d_0 and d_n are defined from the first and last segments, or
+// wrap around if closed.
+Eigen::Vector2d segmentDirection(const QList<EdgeSample> & samples, int i, bool closed)
+{
+    int n = samples.size();
+    int i1, i2;
+    if(i == 0)
     {
-        Eigen::Vector2d p1(x1, y1);
-        Eigen::Vector2d p2(x2, y2);
-        Eigen::Vector2d d = p2-p1; // Assumption: ||d|| > 0. Will result in NaN otherwise
-        d.normalize();
-        return d;
-    };
-
-    // List to store the following:
-    //  * n+1 vectors d0, d1, .... , dn
-    //  * n   points  A0, A1, .... An-1 and B0, B1, .... Bn-1 (An and Bn are not defined)
-    struct QuadInfo    { EIGEN_MAKE_ALIGNED_OPERATOR_NEW
-        Eigen::Vector2d d;
-        double ax, ay, bx, by; };
-    QList<QuadInfo> quads;
-
-    // Computing the di's
-    QuadInfo qs;
-    if(closed)
-        qs.d = getD(samples[n-2].x(), samples[n-2].y(), samples[n-1].x(), samples[n-1].y());
-    else
-        qs.d = getD(samples[0].x(), samples[0].y(), samples[1].x(), samples[1].y());
-    quads << qs;
-    for(int i=1; i<n; i++)
+        i1 = closed ? n-2 : 0;
+        i2 = i1 + 1;
+    }
+    else if(i == n)
     {
-        qs.d = getD(samples[i-1].x(), samples[i-1].y(), samples[i].x(), samples[i].y());
-        quads << qs;
+        i1 = closed ? 0 : n-2;
+        i2 = i1 + 1;
     }
-    if(closed)
-        qs.d = getD(samples[0].x(), samples[0].y(), samples[1].x(), samples[1].y());
     else
-        qs.d = getD(samples[n-2].x(), samples[n-2].y(), samples[n-1].x(), samples[n-1].y());
-    quads << qs;
+    {
+        i1 = i-1;
+        i2 = i;
+    }
 
-    // Computing the Ai's and Bi's
-    for(int i=0; i<n; i++)
+    Eigen::Vector2d p1(samples[i1].x(), samples[i1].y());
+    Eigen::Vector2d p2(samples[i2].x(), samples[i2].y());
+    Eigen::Vector2d d = p2-p1; // Assumption: ||d|| > 0. Will result in NaN otherwise
+    d.normalize();
+    return d;
+}
+
+// Points A and B on each side of a sample, used as corners of the quads
+struct QuadInfo { double ax, ay, bx, by; };
+
+// Computes the points A and B of samples[i]
+void computeQuadInfo(const QList<EdgeSample> & samples, int i, bool closed, QuadInfo & out)
+{
+    Eigen::Vector2d di = segmentDirection(samples, i, closed);
+    Eigen::Vector2d di1 = segmentDirection(samples, i+1, closed);
+
+    // Compute dotProduct, clamp to [-1.0,1.0] (could be outside due to numerical errors)
+    double dotProduct = - di.dot(di1);
+    if(dotProduct < -1.0)
+        dotProduct = -1.0;
+    else if (dotProduct > 1.0)
+        dotProduct = 1.0;
+
+    // Compute angle. See http://en.cppreference.com/w/cpp/numeric/math/acos for specs of acos
+    double alpha = std::acos(dotProduct); // guaranteed to be in [0,pi] (well, unless dotProduct is NaN, which is assumed not to)
+    double sinAlphaOver2 = std::sin(0.5*alpha); // in [0,1]
+    if(sinAlphaOver2 < 0.3) // Bevel threshold
+        sinAlphaOver2 = 0.3; // Now, sinAlphaOver2 in [0.3,1]
+    double h = 0.5 * samples[i].width() / sinAlphaOver2;
+
+    // TODO: make this an preference option
+    // SIMPLE METHOD -- No bevel
+    h = 0.5 * samples[i].width();
+
+    // Compute bisection basis
+    Eigen::Vector2d u = di + di1;
+    Eigen::Vector2d v;
+    double unorm2 = u.squaredNorm();
+    if(unorm2 > 0)
     {
-        // Compute dotProduct, clamp to [-1.0,1.0] (could be outside due to numerical errors)
-        double dotProduct = - quads[i].d.dot(quads[i+1].d);
-        if(dotProduct < -1.0)
-            dotProduct = -1.0;
-        else if (dotProduct > 1.0)
-            dotProduct = 1.0;
-
-        // Compute angle. See http://en.cppreference.com/w/cpp/numeric/math/acos for specs of acos
-        double alpha = std::acos(dotProduct); // guaranteed to be in [0,pi] (well, unless dotProduct is NaN, which is assumed not to)
-        double sinAlphaOver2 = std::sin(0.5*alpha); // in [0,1]
-        if(sinAlphaOver2 < 0.3) // Bevel threshold
-            sinAlphaOver2 = 0.3; // Now, sinAlphaOver2 in [0.3,1]
-        double h = 0.5 * samples[i].width() / sinAlphaOver2;
-
-        // TODO: make this an preference option
-        // SIMPLE METHOD -- No bevel
-        h = 0.5 * samples[i].width();
-
-        // Compute bisection basis
-        Eigen::Vector2d u = quads[i].d + quads[i+1].d;
-        Eigen::Vector2d v;
-        double unorm2 = u.squaredNorm();
-        if(unorm2 > 0)
-        {
-            u.normalize();
-            v = Eigen::Vector2d(-u[1],u[0]);
-        }
-        else
-        {
-            v = quads[i].d;
-        }
+        u.normalize();
+        v = Eigen::Vector2d(-u[1],u[0]);
+    }
+    else
+    {
+        v = di;
+    }
 
-        quads[i].ax = samples[i].x() + h * v[0];
-        quads[i].ay = samples[i].y() + h * v[1];
+    out.ax = samples[i].x() + h * v[0];
+    out.ay = samples[i].y() + h * v[1];
 
-        quads[i].bx = samples[i].x() - h * v[0];
-        quads[i].by = samples[i].y() - h * v[1];
-    }
+    out.bx = samples[i].x() - h * v[0];
+    out.by = samples[i].y() - h * v[1];
+}
 
-    // tesselate
-    for(int i=1; i<n; i++)
-    {
-        double ax = quads[i-1].ax;
-        double ay = quads[i-1].ay;
-        double bx = quads[i-1].bx;
-        double by = quads[i-1].by;
+// Computes the two triangles of the quad between q1 and q2
+void computeQuadTriangles(const QuadInfo & q1, const QuadInfo & q2, Triangle & t1, Triangle & t2)
+{
+    t1.a << q1.ax, q1.ay;
+    t1.b << q1.bx, q1.by;
+    t1.c << q2.bx, q2.by;
 
-        double cx = quads[i].ax;
-        double cy = quads[i].ay;
-        double dx = quads[i].bx;
-        double dy = quads[i].by;
+    t2.a << q1.ax, q1.ay;
+    t2.b << q2.bx, q2.by;
+    t2.c << q2.ax, q2.ay;
+}
 
+// Number of triangles of each round cap
+const int numCapTriangles = 50;
 
-        triangles.append(ax,ay,bx,by,dx,dy);
-        triangles.append(ax,ay,dx,dy,cx,cy);
-    }
+// Computes the i-th triangle of the round cap centered at sample
+void computeCapTriangle(const EdgeSample & sample, int i, Triangle & out)
+{
+    int m = numCapTriangles;
+    double cx = sample.x();
+    double cy = sample.y();
+    double r = 0.5 * sample.width();
 
-    // Start cap
-    {
-        int m = 50;
-        double cx = samples.front().x();
-        double cy = samples.front().y();
-        double r = 0.5 * samples.front().width();
-        for(int i=0; i<m; ++i)
-        {
-            double theta1 = 2 * (double) i * 3.14159 / (double) m ;
-            double theta2 = 2 * (double) (i+1) * 3.14159 / (double) m ;
+    double theta1 = 2 * (double) i * 3.14159 / (double) m ;
+    double theta2 = 2 * (double) (i+1) * 3.14159 / (double) m ;
 
-            double ax = cx + r*std::cos(theta1);
-            double ay = cy + r*std::sin(theta1);
+    double ax = cx + r*std::cos(theta1);
+    double ay = cy + r*std::sin(theta1);
 
-            double bx = cx + r*std::cos(theta2);
-            double by = cy + r*std::sin(theta2);
+    double bx = cx + r*std::cos(theta2);
+    double by = cy + r*std::sin(theta2);
 
-            triangles.append(ax,ay,bx,by,cx,cy);
-        }
-    }
+    out.a << ax, ay;
+    out.b << bx, by;
+    out.c << cx, cy;
+}
 
-    // End cap
-    {
-        int m = 50;
-        double cx = samples.back().x();
-        double cy = samples.back().y();
-        double r = 0.5 * samples.back().width();
-        for(int i=0; i<m; ++i)
-        {
-            double theta1 = 2 * (double) i * 3.14159 / (double) m ;
-            double theta2 = 2 * (double) (i+1) * 3.14159 / (double) m ;
+void triangulateHelper(const QList<EdgeSample> & samplesInput, Triangles & triangles, bool closed = false)
+{
+    // Initialization and basic case
+    triangles.clear();
+    int n=samplesInput.size();
+    if(n<2)
+        return;
 
-            double ax = cx + r*std::cos(theta1);
-            double ay = cy + r*std::sin(theta1);
+    // Subdivision
+    int numSub = DevSettings::getInt("num sub");
+    QList<EdgeSample> samples = subdividedSamples(samplesInput, closed, numSub);
+    n=samples.size();
 
-            double bx = cx + r*std::cos(theta2);
-            double by = cy + r*std::sin(theta2);
+    // Computing the Ai's and Bi's
+    std::vector<QuadInfo> quads(n);
+    for(int i=0; i<n; i++)
+        computeQuadInfo(samples, i, closed, quads[i]);
 
-            triangles.append(ax,ay,bx,by,cx,cy);
-        }
+    // tesselate
+    Triangle t1, t2;
+    for(int i=1; i<n; i++)
+    {
+        computeQuadTriangles(quads[i-1], quads[i], t1, t2);
+        triangles << t1 << t2;
     }
 
-    /*
-
-    glBegin(GL_POLYGON);
+    // Start cap
+    for(int i=0; i<numCapTriangles; ++i)
     {
-        for(int i=0; i<n; ++i)
-        {
-            double theta = 2 * (double) i * 3.14159 / (double) n ;
-            glVertex2d(p.x() + r*std::cos(theta),p.y()+ r*std::sin(theta));
-        }
+        computeCapTriangle(samples.front(), i, t1);
+        triangles << t1;
     }
-    glEnd();
 
     // End cap
-    p = Eigen::Vector2d( sketchedEdge_->rightPos().x(), sketchedEdge_->rightPos().y() );
-    r = 0.5 * sketchedEdge_->rightPos().width();
-    glBegin(GL_POLYGON);
+    for(int i=0; i<numCapTriangles; ++i)
     {
-        for(int i=0; i<n; ++i)
+        computeCapTriangle(samples.back(), i, t1);
+        triangles << t1;
+    }
+}
+
+// Updates, in place, triangles computed by triangulateHelper(samplesInput,
+// triangles) for an open curve, after the samples in [first, last] have been
+// modified without changing their number. Only the triangles affected by the
+// modification are recomputed, and changedBoundingBox is united with their
+// new bounding box. Returns false, leaving triangles untouched, if this is
+// not possible and triangles must be recomputed from scratch. Only the
+// samples around [first, last] are read, so that the cost doesn't depend on
+// the size of the curve.
+bool retriangulateHelper(const SculptCurve::CurveView<EdgeSample> & samplesInput, int first, int last,
+                         Triangles & triangles, BoundingBox & changedBoundingBox)
+{
+    int n = samplesInput.size();
+    if(n<2 || first<0 || last>=n || first>last)
+        return false;
+
+    // Check that triangles are the output of triangulateHelper for n samples
+    int numSub = DevSettings::getInt("num sub");
+    int numSubSamples = ((n-1) << numSub) + 1;
+    if(triangles.size() != 2*(numSubSamples-1) + 2*numCapTriangles)
+        return false;
+
+    // A modified sample can influence the subdivided samples up to three
+    // input samples away, and the points A and B of their neighbours. We
+    // recompute the samples in [r1, r2], which requires the subdivision of
+    // the samples in [c1, c2] for these to be exact.
+    const int margin = 4;
+    int r1 = std::max(0, first - margin);
+    int r2 = std::min(n-1, last + margin);
+    int c1 = std::max(0, r1 - margin);
+    int c2 = std::min(n-1, r2 + margin);
+    QList<EdgeSample> window;
+    window.reserve(c2-c1+1);
+    for(int i=c1; i<=c2; ++i)
+        window << samplesInput[i];
+    QList<EdgeSample> samples = subdividedSamples(window, false, numSub);
+    int offset = c1 << numSub; // index of samples[0] in the whole subdivided curve
+
+    // Points A and B of subdivided samples in [j1, j2]
+    int j1 = std::max(0, (r1 << numSub) - 1);
+    int j2 = std::min(numSubSamples-1, (r2 << numSub) + 1);
+    std::vector<QuadInfo> quads(j2-j1+1);
+    for(int j=j1; j<=j2; ++j)
+        computeQuadInfo(samples, j-offset, false, quads[j-j1]);
+
+    // Quads between subdivided samples in [j1, j2]
+    for(int j=j1+1; j<=j2; ++j)
+    {
+        Triangle & t1 = triangles[2*(j-1)];
+        Triangle & t2 = triangles[2*(j-1)+1];
+        computeQuadTriangles(quads[j-1-j1], quads[j-j1], t1, t2);
+        changedBoundingBox.unite(t1.boundingBox());
+        changedBoundingBox.unite(t2.boundingBox());
+    }
+
+    // Caps
+    int startCap = 2*(numSubSamples-1);
+    int endCap = startCap + numCapTriangles;
+    for(int i=0; i<numCapTriangles; ++i)
+    {
+        if(r1 == 0)
+        {
+            Triangle & t = triangles[startCap+i];
+            computeCapTriangle(samples.front(), i, t);
+            changedBoundingBox.unite(t.boundingBox());
+        }
+        if(r2 == n-1)
         {
-            double theta = 2 * (double) i * 3.14159 / (double) n ;
-            glVertex2d(p.x() + r*std::cos(theta),p.y()+ r*std::sin(theta));
+            Triangle & t = triangles[endCap+i];
+            computeCapTriangle(samples.back(), i, t);
+            changedBoundingBox.unite(t.boundingBox());
         }
     }
-    glEnd();
-    */
+
+    return true;
 }
 } // End anonymous namespace for helper methods
 
@@ -713,20 +847,51 @@ void LinearSpline::triangulate(Triangles & triangles)
     }
 
     QList<EdgeSample> samples;
-    for(int i=0; i<curve_.size(); ++i)
+    for(int i=0; i<curve_().size(); ++i)
     {
-        samples << curve_[i];
+        samples << curve_()[i];
     }
 
     triangulateHelper(samples, triangles, isClosed());
 }
 
+bool LinearSpline::retriangulate(int first, int last, Triangles & triangles, BoundingBox & changedBoundingBox)
+{
+    // Closed curves wrap around, and too small edges are not drawn: in both
+    // cases, let the caller triangulate from scratch
+    if(isClosed() || length() < 0.1)
+        return false;
+
+    // The view ignores temporary sketching samples, which triangulate()
+    // draws: none are expected while sculpting
+    SculptCurve::CurveView<EdgeSample> samples = curve_().view();
+    if(samples.size() != curve_().size())
+        return false;
+
+    return retriangulateHelper(samples, first, last, triangles, changedBoundingBox);
+}
+
+bool LinearSpline::addToTessellationKey(TessellationKey & key) const
+{
+    // triangulate() depends on the samples, whether the curve is closed
+    // (its length, tested to skip tiny edges, is derived from them), and the
+    // number of subdivisions of triangulateHelper()
+    SculptCurve::Curve<EdgeSample> buffer;
+    const SculptCurve::Curve<EdgeSample> & curve = peekCurve_(buffer);
+    key.add(DevSettings::getInt("num sub"));
+    key.add(isClosed());
+    key.add(curve.size());
+    for(int i=0; i<curve.size(); ++i)
+        key.add(curve[i]);
+    return true;
+}
+
 void LinearSpline::triangulate(double width, Triangles & triangles)
 {
     QList<EdgeSample> samples;
-    for(int i=0; i<curve_.size(); ++i)
+    for(int i=0; i<curve_().size(); ++i)
     {
-        EdgeSample sample = curve_[i];
+        EdgeSample sample = curve_()[i];
         sample.setWidth(width);
         samples << sample;
     }
@@ -773,16 +938,18 @@ LinearSpline::LinearSpline(QTextStream & in) //:
         vertices << EdgeSample(list[0].toDouble(), list[1].toDouble(), list[2].toDouble());
     }
     in >> bracket;
-    curve_.setVertices(vertices);
+    curve_().setVertices(vertices);
     clearSampling();
 }
 
 void LinearSpline::save_(QTextStream & out)
 {
-    out << Save::newField("NumVertices") << curve_.size();
+    SculptCurve::Curve<EdgeSample> buffer;
+    const SculptCurve::Curve<EdgeSample> & curve = peekCurve_(buffer);
+    out << Save::newField("NumVertices") << curve.size();
     out << Save::newField("Vertices") << "[ ";
-    for(int i=0; i<curve_.size(); ++i)
-        out << "(" << curve_[i].x() << "," << curve_[i].y() << "," << curve_[i].width() << ") ";
+    for(int i=0; i<curve.size(); ++i)
+        out << "(" << curve[i].x() << "," << curve[i].y() << "," << curve[i].width() << ") ";
     out << "]";
 }
 
@@ -802,28 +969,31 @@ QString double2qstring(double x)
 LinearSpline::LinearSpline(const QStringRef & str)
 {
     // Clear curve
-    curve_.clear();
+    curve_().clear();
 
     // Get data from string
-    QStringList strList = str.toString() // Expensive, to change by only using QStringRef
-               .split(QRegExp("[\\,\\s]"), QString::SkipEmptyParts); // either ',', or any whitespace character
-    QVector<double> d;
-    for(int i=0; i<strList.size(); ++i)
-        d << strList[i].toDouble();
+    StringTokenizer tokenizer(str, ","); // either ',', or any whitespace character
 
     // Return if not enough data
-    if(d.size() < 1)
+    if(tokenizer.atEnd())
         return;
 
     // Get vertices from data
+    double ds = tokenizer.next().toDouble();
     std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > vertices;
-    int n = (d.size()-1)/3;
+    int n = tokenizer.countRemaining()/3;
+    vertices.reserve(n);
     for(int i=0; i<n; i++)
-        vertices << EdgeSample(d[3*i+1], d[3*i+2], d[3*i+3]);
+    {
+        double x = tokenizer.next().toDouble();
+        double y = tokenizer.next().toDouble();
+        double w = tokenizer.next().toDouble();
+        vertices << EdgeSample(x, y, w);
+    }
 
     // Set curve
-    curve_.setDs(d[0]);
-    curve_.setVertices(vertices);
+    curve_().setDs(ds);
+    curve_().setVertices(vertices);
     clearSampling();
 }
 
@@ -831,7 +1001,7 @@ LinearSpline::LinearSpline(const QStringRef & str)
 LinearSpline::LinearSpline(XmlStreamReader & xml)
 {
     // Clear curve
-    curve_.clear();
+    curve_().clear();
 
     // Get data from string
     QStringList strList =
@@ -852,22 +1022,24 @@ LinearSpline::LinearSpline(XmlStreamReader & xml)
         vertices << EdgeSample(d[3*i+1], d[3*i+2], d[3*i+3]);
 
     // Set curve
-    curve_.setDs(d[0]);
-    curve_.setVertices(vertices);
+    curve_().setDs(d[0]);
+    curve_().setVertices(vertices);
     clearSampling();
 }
 */
 
 void LinearSpline::write(XmlStreamWriter & xml) const
 {
+    SculptCurve::Curve<EdgeSample> buffer;
+    const SculptCurve::Curve<EdgeSample> & curve = peekCurve_(buffer);
     QString d;
-    d += double2qstring(curve_.ds()) + " ";
-    const int n = curve_.size();
+    d += double2qstring(curve.ds()) + " ";
+    const int n = curve.size();
     for(int i=0; i<n; ++i)
     {
-        d += double2qstring(curve_[i].x()) + "," +
-             double2qstring(curve_[i].y()) + "," +
-             double2qstring(curve_[i].width());
+        d += double2qstring(curve[i].x()) + "," +
+             double2qstring(curve[i].y()) + "," +
+             double2qstring(curve[i].width());
 
         if(i<n-1) d += " ";
     }
@@ -878,37 +1050,105 @@ void LinearSpline::write(XmlStreamWriter & xml) const
 
 // --------------- Accessing Curve Geometry --------------------
 
-int LinearSpline::size() const { return curve_.size(); }
-EdgeSample LinearSpline::operator[] (int i) const { return curve_[i]; }
-void LinearSpline::beginSketch(const EdgeSample & sample) { curve_.beginSketch(sample); }
-void LinearSpline::continueSketch(const EdgeSample & sample) { curve_.continueSketch(sample); }
-void LinearSpline::endSketch() { curve_.endSketch(); }
+int LinearSpline::size() const { return curve_().size(); }
+EdgeSample LinearSpline::operator[] (int i) const { return curve_()[i]; }
+void LinearSpline::beginSketch(const EdgeSample & sample) { curve_().beginSketch(sample); }
+void LinearSpline::continueSketch(const EdgeSample & sample) { curve_().continueSketch(sample); }
+void LinearSpline::endSketch() { curve_().endSketch(); }
 
 SculptCurve::Curve<EdgeSample> & LinearSpline::curve()
 {
-    return curve_;
+    return curve_();
+}
+
+bool LinearSpline::pageOut()
+{
+    if(pageId_ >= 0)
+        return true;
+
+    // Only final vertices can be paged out
+    int n = residentCurve_.numFinalVertices();
+    if(n == 0 || n != residentCurve_.size())
+        return false;
+
+    std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > vertices;
+    residentCurve_.takeVertices(vertices);
+    pageId_ = GeometryPager::instance()->pageOut(vertices.data(), n * sizeof(EdgeSample));
+    if(pageId_ < 0)
+    {
+        residentCurve_.restoreVertices(vertices);
+        return false;
+    }
+
+    // Release what is computed from the samples, recomputed when needed
+    sampling_ = QList<Eigen::Vector2d>();
+    curveBeforeTransform_ = SculptCurve::Curve<EdgeSample>();
+    std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> >().swap(vertices_);
+    std::vector<double>().swap(arclengths_);
+    std::vector<SculptTemp>().swap(sculptTemp_);
+    return true;
+}
+
+void LinearSpline::pageIn_() const
+{
+    GeometryPager * pager = GeometryPager::instance();
+    int n = pager->pageSize(pageId_) / sizeof(EdgeSample);
+    std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > vertices(n);
+    pager->pageIn(pageId_, vertices.data());
+    pageId_ = -1;
+    residentCurve_.restoreVertices(vertices);
+}
+
+const SculptCurve::Curve<EdgeSample> & LinearSpline::peekCurve_(SculptCurve::Curve<EdgeSample> & buffer) const
+{
+    if(pageId_ < 0)
+        return residentCurve_;
+
+    GeometryPager * pager = GeometryPager::instance();
+    int n = pager->pageSize(pageId_) / sizeof(EdgeSample);
+    std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > vertices(n);
+    pager->read(pageId_, vertices.data());
+    buffer = residentCurve_;
+    buffer.restoreVertices(vertices);
+    return buffer;
+}
+
+qint64 LinearSpline::memoryUsage() const
+{
+    return sizeof(*this) +
+           MemoryUsage::bytes(sampling_) +
+           residentCurve_.memoryUsage() +
+           curveBeforeTransform_.memoryUsage() +
+           MemoryUsage::bytes(vertices_) +
+           MemoryUsage::bytes(arclengths_) +
+           MemoryUsage::bytes(sculptTemp_);
 }
 
 EdgeSample LinearSpline::pos(double s) const
 {
-    return curve_(s);
+    return curve_()(s);
+}
+
+void LinearSpline::sortedPos(const double * s, int n, EdgeSample * out) const
+{
+    curve_().evaluate(s, n, out);
 }
 
 EdgeSample LinearSpline::leftPos() const
 {
-    return curve_.start();
+    return curve_().start();
 }
 
 EdgeSample LinearSpline::rightPos() const
 {
-    return curve_.end();
+    return curve_().end();
 }
 
 QList<EdgeSample> LinearSpline::edgeSampling() const
 {
     QList<EdgeSample> res;
-    for(int i=0; i<curve_.size(); ++i)
-        res << curve_[i];
+    for(int i=0; i<curve_().size(); ++i)
+        res << curve_()[i];
     return res;
 }
 
@@ -917,7 +1157,7 @@ QList<EdgeSample> LinearSpline::edgeSampling() const
 Eigen::Vector2d LinearSpline::der(double s)
 {
     double ds = 1e-3;
-    EdgeSample dp = curve_(s+ds) - curve_(s-ds);
+    EdgeSample dp = curve_()(s+ds) - curve_()(s-ds);
     Eigen::Vector2d dpe(dp.x(),dp.y());
     double norm = dpe.norm();
 
@@ -929,14 +1169,14 @@ Eigen::Vector2d LinearSpline::der(double s)
 
 double LinearSpline::length() const
 {
-    return curve_.length();
+    return curve_().length();
 }
 
 EdgeGeometry * LinearSpline::trimmed(double from, double to)
 {
     std::vector<double> splitValues;
     splitValues << from << to;
-    return new LinearSpline(curve_.split(splitValues)[0]);
+    return new LinearSpline(curve_().split(splitValues)[0]);
 }
 
 
@@ -944,14 +1184,14 @@ EdgeGeometry * LinearSpline::trimmed(double from, double to)
 
 void LinearSpline::resample_(double ds)
 {
-    curve_.resample(ds);
-    for(int i=0; i<curve_.size(); ++i)
-        sampling_ << Eigen::Vector2d(curve_[i].x(), curve_[i].y());
+    curve_().resample(ds);
+    for(int i=0; i<curve_().size(); ++i)
+        sampling_ << Eigen::Vector2d(curve_()[i].x(), curve_()[i].y());
 }
 
 void LinearSpline::makeLoop_()
 {
-    curve_.makeLoop();
+    curve_().makeLoop();
 }
 
 // --------------------- Manipulating --------------------------
@@ -961,19 +1201,19 @@ void LinearSpline::setLeftRightPos(const Eigen::Vector2d & left,
 {
     if(isClosed())
     {
-        curve_.resample(true);
+        curve_().resample(true);
     }
     else
     {
-        EdgeSample leftSample = curve_.start();
+        EdgeSample leftSample = curve_().start();
         leftSample.setX(left[0]);
         leftSample.setY(left[1]);
 
-        EdgeSample rightSample = curve_.end();
+        EdgeSample rightSample = curve_().end();
         rightSample.setX(right[0]);
         rightSample.setY(right[1]);
 
-        curve_.setEndPoints(leftSample, rightSample);
+        curve_().setEndPoints(leftSample, rightSample);
     }
     clearSampling();
 }
@@ -1001,18 +1241,18 @@ void LinearSpline::setRightDer(const Eigen::Vector2d & rightDer, double radius,
     if(dtheta >= pi)
         dtheta -= 2*pi;
 
-    double rightX = curve_.end().x();
-    double rightY = curve_.end().y();
+    double rightX = curve_().end().x();
+    double rightY = curve_().end().y();
 
     std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > newVertices;
-    for(int i=0; i<curve_.size(); ++i)
+    for(int i=0; i<curve_().size(); ++i)
     {
         // todo: replace by w(distance, radius), where radius is the remaining sculpt radius
-        double weightedDtheta = dtheta * curve_.w_( curve_.length() - curve_.arclength(i), radius);
+        double weightedDtheta = dtheta * curve_().w_( curve_().length() - curve_().arclength(i), radius);
         double c = std::cos(weightedDtheta);
         double s = std::sin(weightedDtheta);
 
-        EdgeSample sample = curve_[i];
+        EdgeSample sample = curve_()[i];
         double oldX = sample.x();
         double oldY = sample.y();
         sample.setX( rightX + (oldX-rightX)*c - (oldY-rightY)*s);
@@ -1020,9 +1260,9 @@ void LinearSpline::setRightDer(const Eigen::Vector2d & rightDer, double radius,
         newVertices << sample;
     }
 
-    curve_.setVertices(newVertices);
+    curve_().setVertices(newVertices);
     if(resample)
-        curve_.resample();
+        curve_().resample();
 
     clearSampling();
 }
@@ -1050,18 +1290,18 @@ void LinearSpline::setLeftDer(const Eigen::Vector2d & leftDer, double radius, bo
     if(dtheta >= pi)
         dtheta -= 2*pi;
 
-    double rightX = curve_.start().x();
-    double rightY = curve_.start().y();
+    double rightX = curve_().start().x();
+    double rightY = curve_().start().y();
 
     std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > newVertices;
-    for(int i=0; i<curve_.size(); ++i)
+    for(int i=0; i<curve_().size(); ++i)
     {
         // todom replace by w(distance, radius), where radius is the remaining sculpt radius
-        double weightedDtheta = dtheta * curve_.w_( curve_.arclength(i), radius);
+        double weightedDtheta = dtheta * curve_().w_( curve_().arclength(i), radius);
         double c = std::cos(weightedDtheta);
         double s = std::sin(weightedDtheta);
 
-        EdgeSample sample = curve_[i];
+        EdgeSample sample = curve_()[i];
         double oldX = sample.x();
         double oldY = sample.y();
         sample.setX( rightX + (oldX-rightX)*c - (oldY-rightY)*s);
@@ -1069,9 +1309,9 @@ void LinearSpline::setLeftDer(const Eigen::Vector2d & leftDer, double radius, bo
         newVertices << sample;
     }
 
-    curve_.setVertices(newVertices);
+    curve_().setVertices(newVertices);
     if(resample)
-        curve_.resample();
+        curve_().resample();
 
     clearSampling();
 }
@@ -1079,46 +1319,49 @@ void LinearSpline::setLeftDer(const Eigen::Vector2d & leftDer, double radius, bo
 void LinearSpline::setWidth(double newWidth)
 {
     std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > newVertices;
-    for(int i=0; i<curve_.size(); ++i)
+    for(int i=0; i<curve_().size(); ++i)
     {
-        EdgeSample sample = curve_[i];
+        EdgeSample sample = curve_()[i];
         sample.setWidth(newWidth);
         newVertices << sample;
     }
 
-    curve_.setVertices(newVertices);
+    curve_().setVertices(newVertices);
 }
 
 
 double LinearSpline::updateSculpt(double x, double y, double radius)
 {
     sculptRadius_ = radius;
-    return curve_.prepareSculpt(x,y, radius);
+    return curve_().prepareSculpt(x,y, radius);
 }
 
 EdgeSample LinearSpline::sculptVertex() const
 {
-    return curve_.sculptVertex();
+    return curve_().sculptVertex();
 }
 double LinearSpline::arclengthOfSculptVertex() const
 {
-    return curve_.arclengthOfSculptVertex();
+    return curve_().arclengthOfSculptVertex();
 }
 
 void LinearSpline::beginSculptDeform(double x, double y)
 {
-    curve_.beginSculptDeform(x, y);
+    curve_().beginSculptDeform(x, y);
 }
 
 void LinearSpline::continueSculptDeform(double x, double y)
 {
-    curve_.continueSculptDeform(x, y);
+    curve_().continueSculptDeform(x, y);
     clearSampling();
+
+    if(!curve_().sculptDeformRange(sculptModifiedFirst_, sculptModifiedLast_))
+        sculptModifiedFirst_ = sculptModifiedLast_ = -1;
 }
 
 void LinearSpline::endSculptDeform()
 {
-    curve_.endSculptDeform();
+    curve_().endSculptDeform();
     clearSampling();
 }
 
@@ -1151,12 +1394,12 @@ void LinearSpline::beginSculptEdgeWidth(double x, double y)
     // save the original geometry
     vertices_.clear();
     arclengths_.clear();
-    for(int i=0; i<curve_.size(); ++i)
+    for(int i=0; i<curve_().size(); ++i)
     {
-        vertices_ << curve_[i];
-        arclengths_ << curve_.arclength(i);
+        vertices_ << curve_()[i];
+        arclengths_ << curve_().arclength(i);
     }
-    sculptIndex_ = curve_.sculptVertexIndex();
+    sculptIndex_ = curve_().sculptVertexIndex();
 
     // Store start x and y
     sculptStartX_ = x;
@@ -1253,8 +1496,19 @@ void LinearSpline::continueSculptEdgeWidth(double x, double /*y*/)
         double widthRatio = newSculptWidth / sculptTemp_[0].width;
         vertices_[v.i].setWidth(v.width  * ( 1 + (widthRatio-1) * v.w) );
     }
-    curve_.setVertices(vertices_);
+    curve_().setVertices(vertices_);
     clearSampling();
+
+    sculptModifiedFirst_ = sculptModifiedLast_ = -1;
+    if(!sculptTemp_.empty())
+    {
+        sculptModifiedFirst_ = sculptModifiedLast_ = sculptTemp_[0].i;
+        for(auto & v: sculptTemp_)
+        {
+            sculptModifiedFirst_ = std::min(sculptModifiedFirst_, v.i);
+            sculptModifiedLast_ = std::max(sculptModifiedLast_, v.i);
+        }
+    }
 }
 
 void LinearSpline::endSculptEdgeWidth()
@@ -1272,14 +1526,27 @@ void LinearSpline::beginSculptSmooth(double /*x*/, double /*y*/)
 
 void LinearSpline::continueSculptSmooth(double /*x*/, double /*y*/)
 {
-    curve_.sculptSmooth(0.05);
+    curve_().sculptSmooth(0.05);
     clearSampling();
+
+    // Smoothing resamples the whole curve
+    sculptModifiedFirst_ = sculptModifiedLast_ = -1;
 }
 
 void LinearSpline::endSculptSmooth()
 {
 }
 
+bool LinearSpline::sculptModifiedRange(int & first, int & last) const
+{
+    if(sculptModifiedFirst_ < 0)
+        return false;
+
+    first = sculptModifiedFirst_;
+    last = sculptModifiedLast_;
+    return true;
+}
+
 void LinearSpline::prepareDragAndDrop()
 {
     dragAndDrop_lastDx_ = 0;
@@ -1292,28 +1559,75 @@ void LinearSpline::performDragAndDrop(double dx, double dy)
     //if(!isClosed_)
     //    return;
 
-    curve_.translate(dx-dragAndDrop_lastDx_,dy-dragAndDrop_lastDy_);
+    curve_().translate(dx-dragAndDrop_lastDx_,dy-dragAndDrop_lastDy_);
     dragAndDrop_lastDx_ = dx;
     dragAndDrop_lastDy_ = dy;
 
     clearSampling();
 }
 
+void LinearSpline::beginEndPointsDrag()
+{
+    if(!isClosed())
+        curve_().beginEndPointsDrag();
+}
+
+void LinearSpline::continueEndPointsDrag(const Eigen::Vector2d & left,
+                                         const Eigen::Vector2d & right)
+{
+    if(isClosed())
+        return;
+
+    // The widths of the end samples are not changed by the drag
+    EdgeSample leftSample = curve_().start();
+    leftSample.setX(left[0]);
+    leftSample.setY(left[1]);
+
+    EdgeSample rightSample = curve_().end();
+    rightSample.setX(right[0]);
+    rightSample.setY(right[1]);
+
+    curve_().setEndPointsFromRest(leftSample, rightSample);
+    clearSampling();
+}
+
+void LinearSpline::endEndPointsDrag()
+{
+    if(isClosed())
+        return;
+
+    curve_().endEndPointsDrag();
+    clearSampling();
+}
+
+void LinearSpline::cancelEndPointsDrag()
+{
+    // Paged out curves have no drag in progress
+    residentCurve_.cancelEndPointsDrag();
+}
+
 void LinearSpline::prepareAffineTransform()
 {
-    curveBeforeTransform_ = curve_;
+    curveBeforeTransform_ = curve_();
 }
 
 void LinearSpline::performAffineTransform(const Eigen::Affine2d & xf)
 {
-    curve_ = curveBeforeTransform_.transformed(xf);
+    // Resampling is deferred to endAffineTransform()
+    curve_() = curveBeforeTransform_;
+    curve_().transform(xf, false);
     clearSampling();
 }
 
+void LinearSpline::endAffineTransform()
+{
+    curveBeforeTransform_ = SculptCurve::Curve<EdgeSample>();
+}
+
 EdgeGeometry::ClosestVertexInfo LinearSpline::closestPoint(double x, double y)
 {
     // Delegate computation
-    SculptCurve::Curve<EdgeSample>::ClosestVertex cv = curve_.findClosestVertex(x,y);
+    SculptCurve::Curve<EdgeSample>::ClosestVertex cv = curve_().findClosestVertex(x,y);
 
     // Handle result
     if(cv.i == -1)
@@ -1324,8 +1638,8 @@ EdgeGeometry::ClosestVertexInfo LinearSpline::closestPoint(double x, double y)
     else
     {
         ClosestVertexInfo res;
-        res.p = curve_[cv.i];
-        res.s = curve_.arclength(cv.i);
+        res.p = curve_()[cv.i];
+        res.s = curve_().arclength(cv.i);
         res.d = cv.d;
         return res;
     }
@@ -1337,7 +1651,9 @@ void LinearSpline::exportSVG(QTextStream & out)
 
     std::vector<double> ax, ay, bx, by;
 
-    if(curve_.size() < 2)
+    SculptCurve::Curve<EdgeSample> buffer;
+    const SculptCurve::Curve<EdgeSample> & curve = peekCurve_(buffer);
+    if(curve.size() < 2)
         return;
 
     // helper function
@@ -1350,34 +1666,34 @@ void LinearSpline::exportSVG(QTextStream & out)
         return Eigen::Vector2d(-v[1],v[0]);
     };
 
-    Eigen::Vector2d u = getNormal(curve_[0].x(), curve_[0].y(),
-                                  curve_[1].x(), curve_[1].y());
-    Eigen::Vector2d p( curve_[0].x(), curve_[0].y() );
-    Eigen::Vector2d A = p + curve_[0].width() * 0.5 * u;
-    Eigen::Vector2d B = p - curve_[0].width() * 0.5 * u;
+    Eigen::Vector2d u = getNormal(curve[0].x(), curve[0].y(),
+                                  curve[1].x(), curve[1].y());
+    Eigen::Vector2d p( curve[0].x(), curve[0].y() );
+    Eigen::Vector2d A = p + curve[0].width() * 0.5 * u;
+    Eigen::Vector2d B = p - curve[0].width() * 0.5 * u;
     ax.push_back(A[0]);
     ay.push_back(A[1]);
     bx.push_back(B[0]);
     by.push_back(B[1]);
-    p = Eigen::Vector2d( curve_[1].x(), curve_[1].y() );
-    A = p + curve_[1].width() * 0.5 * u;
-    B = p - curve_[1].width() * 0.5 * u;
+    p = Eigen::Vector2d( curve[1].x(), curve[1].y() );
+    A = p + curve[1].width() * 0.5 * u;
+    B = p - curve[1].width() * 0.5 * u;
     ax.push_back(A[0]);
     ay.push_back(A[1]);
     bx.push_back(B[0]);
     by.push_back(B[1]);
-    int n = curve_.size();
+    int n = curve.size();
     if(isClosed()) // clean junction drawing for loops
     {
         n -= 1;
     }
     for(int i=2; i<n; i++)
     {
-        Eigen::Vector2d u = getNormal(curve_[i-1].x(), curve_[i-1].y(),
-                                      curve_[i].x(), curve_[i].y());
-        p = Eigen::Vector2d( curve_[i].x(), curve_[i].y() );
-        Eigen::Vector2d A = p + curve_[i].width() * 0.5 * u;
-        Eigen::Vector2d B = p - curve_[i].width() * 0.5 * u;
+        Eigen::Vector2d u = getNormal(curve[i-1].x(), curve[i-1].y(),
+                                      curve[i].x(), curve[i].y());
+        p = Eigen::Vector2d( curve[i].x(), curve[i].y() );
+        Eigen::Vector2d A = p + curve[i].width() * 0.5 * u;
+        Eigen::Vector2d B = p - curve[i].width() * 0.5 * u;
         ax.push_back(A[0]);
         ay.push_back(A[1]);
         bx.push_back(B[0]);
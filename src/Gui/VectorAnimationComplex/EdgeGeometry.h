@@ -24,6 +24,8 @@ class XmlStreamReader;
 namespace VectorAnimationComplex
 {
 
+class TessellationKey;
+
 class EdgeGeometry
 {
 public:
@@ -41,9 +43,23 @@ public:
     virtual void draw(double width);
     virtual void triangulate(double width, Triangles & triangles);
 
+    // update in place triangles computed by triangulate(triangles), knowing
+    // that only the vertices in [first, last] changed, and unite
+    // changedBoundingBox with the bounding box of the updated triangles.
+    // Returns false if not supported, in which case triangles is unchanged
+    virtual bool retriangulate(int first, int last, Triangles & triangles, BoundingBox & changedBoundingBox);
+
+    // adds to key everything that determines the output of triangulate(),
+    // so that it can be looked up in the TessellationCache. Returns false
+    // if not supported, in which case the triangles are not cached
+    virtual bool addToTessellationKey(TessellationKey & key) const;
+
     // override these for your specific curve representation
     Eigen::Vector2d pos2d(double s);
     virtual EdgeSample pos(double s) const;
+    // same as out[k] = pos(s[k]) for k in [0, n), knowing that s is sorted
+    // (in increasing or decreasing order), which may be faster
+    virtual void sortedPos(const double * s, int n, EdgeSample * out) const;
     virtual Eigen::Vector2d der(double s);
     virtual double length() const;
     virtual EdgeGeometry * trimmed(double from, double to);
@@ -61,6 +77,9 @@ public:
     void resample(double ds);
     QList<Eigen::Vector2d> & sampling();
     QList<Eigen::Vector2d> & sampling(double ds);
+
+    // Number of bytes allocated to store this geometry and its samplings
+    virtual qint64 memoryUsage() const;
     virtual QList<EdgeSample> edgeSampling() const;
 
     void clearSampling(); // call this if the geometry changed
@@ -87,12 +106,27 @@ public:
     virtual void beginSculptSmooth(double x, double y);
     virtual void continueSculptSmooth(double x, double y);
     virtual void endSculptSmooth();
+    // range [first, last] of vertices modified by the last continueSculpt*()
+    // call. Returns false if unknown or if the vertices were resampled
+    virtual bool sculptModifiedRange(int & first, int & last) const;
     // loop drag and drop
     virtual void prepareDragAndDrop();
     virtual void performDragAndDrop(double dx, double dy);
+    // end points drag: deform from the shape at beginEndPointsDrag(),
+    // resampling is deferred to endEndPointsDrag(). cancelEndPointsDrag()
+    // releases the rest shape of an abandoned drag, without resampling
+    virtual void beginEndPointsDrag();
+    virtual void continueEndPointsDrag(const Eigen::Vector2d & left,
+                                       const Eigen::Vector2d & right);
+    virtual void endEndPointsDrag();
+    virtual void cancelEndPointsDrag();
     // affine transform
     virtual void prepareAffineTransform();
     virtual void performAffineTransform(const Eigen::Affine2d & xf);
+    // performAffineTransform() may not resample the geometry: it is
+    // resampled by the next setLeftRightPos(). This releases the geometry
+    // saved by prepareAffineTransform()
+    virtual void endAffineTransform();
 
 
     // Save and Load
@@ -154,6 +188,8 @@ public:
     virtual void draw(double width);
     virtual void triangulate(Triangles & triangles);
     virtual void triangulate(double width, Triangles & triangles);
+    virtual bool retriangulate(int first, int last, Triangles & triangles, BoundingBox & changedBoundingBox);
+    virtual bool addToTessellationKey(TessellationKey & key) const;
 
     void exportSVG(QTextStream & out);
 
@@ -162,6 +198,7 @@ public:
     virtual QList<EdgeSample> edgeSampling() const;
 
     EdgeSample pos(double s) const;
+    void sortedPos(const double * s, int n, EdgeSample * out) const;
     Eigen::Vector2d der(double s);
     double length() const;
     EdgeGeometry * trimmed(double from, double to);
@@ -187,12 +224,20 @@ public:
     void beginSculptSmooth(double x, double y);
     void continueSculptSmooth(double x, double y);
     void endSculptSmooth();
+    bool sculptModifiedRange(int & first, int & last) const;
     // loop drag and drop
     void prepareDragAndDrop();
     void performDragAndDrop(double dx, double dy);
+    // end points drag
+    void beginEndPointsDrag();
+    void continueEndPointsDrag(const Eigen::Vector2d & left,
+                               const Eigen::Vector2d & right);
+    void endEndPointsDrag();
+    void cancelEndPointsDrag();
     // affine transform
     void prepareAffineTransform();
     void performAffineTransform(const Eigen::Affine2d & xf);
+    void endAffineTransform();
     // Compute closest point on curve
     ClosestVertexInfo closestPoint(double x, double y);
 
@@ -204,6 +249,15 @@ public:
 
     SculptCurve::Curve<EdgeSample> & curve();
 
+    qint64 memoryUsage() const;
+
+    // Paging. Moves the samples to the scratch file of GeometryPager, until
+    // they are accessed again, and releases the caches derived from them.
+    // Returns false if they couldn't be paged out, e.g. while sketching.
+    // Saving, exporting and tessellation lookups don't page them back in
+    bool pageOut();
+    bool isPagedOut() const { return pageId_ >= 0; }
+
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
     // Sketch
@@ -223,7 +277,28 @@ private:
     //double length_;
     //QList<Eigen::Vector2d> vertices_;
 
-    SculptCurve::Curve<EdgeSample> curve_;
+    // Samples, paged out if pageId_ >= 0. They must only be accessed via
+    // curve_(), which pages them back in if needed
+    mutable SculptCurve::Curve<EdgeSample> residentCurve_;
+    mutable int pageId_ = -1;
+    void pageIn_() const;
+    SculptCurve::Curve<EdgeSample> & curve_()
+    {
+        if(pageId_ >= 0)
+            pageIn_();
+        return residentCurve_;
+    }
+    const SculptCurve::Curve<EdgeSample> & curve_() const
+    {
+        if(pageId_ >= 0)
+            pageIn_();
+        return residentCurve_;
+    }
+
+    // Samples read without paging them back in, e.g. to save them or to
+    // look up their tessellation. If they are paged out, they are copied to
+    // buffer, which is returned
+    const SculptCurve::Curve<EdgeSample> & peekCurve_(SculptCurve::Curve<EdgeSample> & buffer) const;
 
     // Store initial curve for affine tranform
     SculptCurve::Curve<EdgeSample> curveBeforeTransform_;
@@ -246,6 +321,8 @@ private:
         int i; double w; double width;
     };
     std::vector<SculptTemp> sculptTemp_;
+    int sculptModifiedFirst_ = -1; // -1 if unknown
+    int sculptModifiedLast_ = -1;
 
     // drag and drop
     double dragAndDrop_lastDx_;
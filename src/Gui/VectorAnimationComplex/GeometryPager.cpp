@@ -0,0 +1,221 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "GeometryPager.h"
+#include "../MemoryUsage.h"
+
+#include <QTemporaryFile>
+#include <QDir>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstring>
+
+namespace VectorAnimationComplex
+{
+
+namespace
+{
+// Pages are aligned so that the samples can be copied efficiently
+qint64 alignedSize_(qint64 numBytes)
+{
+    return (numBytes + 15) & ~((qint64) 15);
+}
+}
+
+GeometryPager::GeometryPager() :
+    nextId_(0),
+    numBytes_(0),
+    numPagedInBytes_(0),
+    file_(0),
+    data_(0),
+    fileSize_(0)
+{
+}
+
+GeometryPager::~GeometryPager()
+{
+    if(data_)
+        file_->unmap(data_);
+    delete file_;
+}
+
+GeometryPager * GeometryPager::instance()
+{
+    static GeometryPager pager;
+    return &pager;
+}
+
+int GeometryPager::pageOut(const void * data, qint64 numBytes)
+{
+    int id = newPage_(numBytes);
+    if(id >= 0)
+    {
+        std::memcpy(data_ + pages_[id].offset, data, numBytes);
+        ++counters_.numPageOuts;
+    }
+    return id;
+}
+
+int GeometryPager::copyPage(int id)
+{
+    if(!pages_.contains(id))
+        return -1;
+
+    // Note: the file may be remapped by newPage_()
+    int res = newPage_(pages_[id].numBytes);
+    if(res >= 0)
+        std::memcpy(data_ + pages_[res].offset, data_ + pages_[id].offset, pages_[id].numBytes);
+    return res;
+}
+
+int GeometryPager::newPage_(qint64 numBytes)
+{
+    // First free range large enough, growing the file if there is none
+    qint64 size = alignedSize_(numBytes);
+    auto it = freeRanges_.begin();
+    while(it != freeRanges_.end() && it.value() < size)
+        ++it;
+    if(it == freeRanges_.end())
+    {
+        if(!grow_(size))
+            return -1;
+        it = freeRanges_.end();
+        --it; // ends with the new space
+    }
+
+    // Allocate page
+    Page page;
+    page.offset = it.key();
+    page.numBytes = numBytes;
+    qint64 rangeSize = it.value();
+    freeRanges_.erase(it);
+    if(rangeSize > size)
+        freeRanges_.insert(page.offset + size, rangeSize - size);
+
+    int id = nextId_++;
+    pages_.insert(id, page);
+    numBytes_ += numBytes;
+    return id;
+}
+
+qint64 GeometryPager::pageSize(int id) const
+{
+    return pages_.value(id).numBytes;
+}
+
+void GeometryPager::pageIn(int id, void * data)
+{
+    auto it = pages_.find(id);
+    if(it == pages_.end())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    std::memcpy(data, data_ + it->offset, it->numBytes);
+    qint64 time = timer.nsecsElapsed();
+
+    ++counters_.numPageIns;
+    counters_.pageInTime += time;
+    counters_.maxPageInTime = std::max(counters_.maxPageInTime, time);
+    numPagedInBytes_ += it->numBytes;
+
+    release(id);
+}
+
+void GeometryPager::read(int id, void * data) const
+{
+    auto it = pages_.find(id);
+    if(it != pages_.end())
+        std::memcpy(data, data_ + it->offset, it->numBytes);
+}
+
+void GeometryPager::release(int id)
+{
+    auto it = pages_.find(id);
+    if(it == pages_.end())
+        return;
+
+    numBytes_ -= it->numBytes;
+    free_(it->offset, alignedSize_(it->numBytes));
+    pages_.erase(it);
+}
+
+void GeometryPager::free_(qint64 offset, qint64 size)
+{
+    // Merge with the next free range
+    auto next = freeRanges_.find(offset + size);
+    if(next != freeRanges_.end())
+    {
+        size += next.value();
+        freeRanges_.erase(next);
+    }
+
+    // Merge with the previous free range
+    auto previous = freeRanges_.lowerBound(offset);
+    if(previous != freeRanges_.begin())
+    {
+        --previous;
+        if(previous.key() + previous.value() == offset)
+        {
+            offset = previous.key();
+            size += previous.value();
+            freeRanges_.erase(previous);
+        }
+    }
+
+    freeRanges_.insert(offset, size);
+}
+
+bool GeometryPager::grow_(qint64 minSize)
+{
+    const qint64 minFileSize = 16 * 1024 * 1024;
+
+    if(!file_)
+    {
+        file_ = new QTemporaryFile(QDir::tempPath() + "/VPaint-geometry-XXXXXX");
+        if(!file_->open())
+        {
+            delete file_;
+            file_ = 0;
+            return false;
+        }
+    }
+
+    // Double the size of the file. It is unmapped while resized, since some
+    // platforms can't resize mapped files
+    qint64 newSize = std::max(std::max(2 * fileSize_, fileSize_ + minSize), minFileSize);
+    if(data_)
+    {
+        file_->unmap(data_);
+        data_ = 0;
+    }
+    if(file_->resize(newSize))
+        data_ = file_->map(0, newSize);
+    if(!data_)
+    {
+        // Keep the pages which are already in the file
+        if(fileSize_ > 0)
+            data_ = file_->map(0, fileSize_);
+        return false;
+    }
+
+    free_(fileSize_, newSize - fileSize_);
+    fileSize_ = newSize;
+    return true;
+}
+
+void GeometryPager::addMemoryUsage(MemoryUsage & usage) const
+{
+    // Not in memory, unless recently paged out: the operating system writes
+    // the pages of the scratch file to disk as needed
+    if(numPages() > 0)
+        usage.add("Geometry pager", "Paged out samples (scratch file)", numBytes_, numPages());
+}
+
+} // end namespace VectorAnimationComplex
@@ -0,0 +1,110 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef VAC_GEOMETRY_PAGER_H
+#define VAC_GEOMETRY_PAGER_H
+
+#include <QHash>
+#include <QMap>
+
+class QTemporaryFile;
+class MemoryUsage;
+
+namespace VectorAnimationComplex
+{
+
+// Process-wide scratch file where the samples of key edges far from the
+// frames being worked on are moved out of memory (see
+// VAC::updateGeometryPaging()), until they are accessed again through their
+// LinearSpline, which reads them back transparently.
+//
+// The scratch file is a memory-mapped temporary file, removed on exit. It
+// grows as needed and is never shrunk: released pages are reused, first fit.
+// Must only be used from the GUI thread.
+class GeometryPager
+{
+public:
+    static GeometryPager * instance();
+
+    // Copies numBytes bytes from data to a new page and returns its id, or
+    // returns -1 if the scratch file couldn't be created or grown
+    int pageOut(const void * data, qint64 numBytes);
+
+    // Size of the data of the given page, in bytes
+    qint64 pageSize(int id) const;
+
+    // Copies the given page to data, which must be able to hold pageSize(id)
+    // bytes, and releases the page
+    void pageIn(int id, void * data);
+
+    // Same as pageIn(), but keeps the page, e.g. to save the samples of a
+    // paged out edge without bringing them back in memory
+    void read(int id, void * data) const;
+
+    // Copies the given page to a new page and returns its id, or returns -1
+    // if the scratch file couldn't be grown
+    int copyPage(int id);
+
+    // Releases the given page without reading it
+    void release(int id);
+
+    int numPages() const { return pages_.size(); }
+    qint64 numBytes() const { return numBytes_; }
+
+    // Total size of the pages read back by pageIn(), never reset, so that
+    // callers can tell how much was paged in since they last checked
+    qint64 numPagedInBytes() const { return numPagedInBytes_; }
+
+    // Size of the scratch file, and number of its free ranges
+    qint64 fileSize() const { return fileSize_; }
+    int numFreeRanges() const { return freeRanges_.size(); }
+
+    // Page-in latency includes reading the page from disk, if the operating
+    // system evicted it from memory
+    struct Counters
+    {
+        Counters() : numPageOuts(0), numPageIns(0), pageInTime(0), maxPageInTime(0) {}
+        int numPageOuts;
+        int numPageIns;
+        qint64 pageInTime;    // total, in nanoseconds
+        qint64 maxPageInTime; // in nanoseconds
+    };
+    const Counters & counters() const { return counters_; }
+    void resetCounters() { counters_ = Counters(); }
+
+    void addMemoryUsage(MemoryUsage & usage) const;
+
+private:
+    GeometryPager();
+    ~GeometryPager();
+
+    struct Page
+    {
+        qint64 offset;
+        qint64 numBytes;
+    };
+    QHash<int, Page> pages_;
+    int nextId_;
+    qint64 numBytes_;
+    qint64 numPagedInBytes_;
+    Counters counters_;
+    int newPage_(qint64 numBytes);
+
+    // Free ranges of the file, as offset -> size. Adjacent ranges are merged
+    QMap<qint64, qint64> freeRanges_;
+    void free_(qint64 offset, qint64 size);
+
+    QTemporaryFile * file_;
+    uchar * data_;
+    qint64 fileSize_;
+    bool grow_(qint64 minSize);
+};
+
+} // end namespace VectorAnimationComplex
+
+#endif // VAC_GEOMETRY_PAGER_H
@@ -18,12 +18,14 @@ namespace VectorAnimationComplex
 {
 
 InbetweenCell::InbetweenCell(VAC * vac) :
-    Cell(vac)
+    Cell(vac),
+    hasCachedAllTimeBoundingBoxes_(false)
 {
 }
 
 InbetweenCell::InbetweenCell(InbetweenCell * other) :
-    Cell(other)
+    Cell(other),
+    hasCachedAllTimeBoundingBoxes_(false)
 {
 }
 
@@ -36,7 +38,8 @@ InbetweenCell::~InbetweenCell()
 }
 
 InbetweenCell::InbetweenCell(VAC * vac, QTextStream & in) :
-    Cell(vac, in)
+    Cell(vac, in),
+    hasCachedAllTimeBoundingBoxes_(false)
 {
 }
 
@@ -49,7 +52,8 @@ void InbetweenCell::save_(QTextStream & /*out*/)
 }
 
 InbetweenCell::InbetweenCell(VAC * vac, XmlStreamReader & xml) :
-    Cell(vac, xml)
+    Cell(vac, xml),
+    hasCachedAllTimeBoundingBoxes_(false)
 {
 }
 
@@ -106,10 +110,42 @@ bool InbetweenCell::checkAnimated_() const
 }
 
 BoundingBox InbetweenCell::boundingBox() const
+{
+    updateAllTimeBoundingBoxes_();
+    return allTimeBoundingBox_;
+}
+
+BoundingBox InbetweenCell::outlineBoundingBox() const
+{
+    updateAllTimeBoundingBoxes_();
+    return allTimeOutlineBoundingBox_;
+}
+
+void InbetweenCell::updateAllTimeBoundingBoxes_() const
+{
+    if(!hasCachedAllTimeBoundingBoxes_)
+    {
+        computeAllTimeBoundingBoxes_(allTimeBoundingBox_, allTimeOutlineBoundingBox_);
+        hasCachedAllTimeBoundingBoxes_ = true;
+    }
+}
+
+void InbetweenCell::clearCachedGeometry_()
+{
+    Cell::clearCachedGeometry_();
+    clearCachedAllTimeBoundingBoxes_();
+}
+
+void InbetweenCell::clearCachedAllTimeBoundingBoxes_()
+{
+    hasCachedAllTimeBoundingBoxes_ = false;
+}
+
+BoundingBox InbetweenCell::exactBoundingBox() const
 {
     // Get before and after frame
     int beforeFrame = beforeTime().frame();
-    int afterFrame = beforeTime().frame();
+    int afterFrame = afterTime().frame();
 
     // Take the union of all bounding boxes in the middle
     // of each frame.
@@ -128,11 +164,11 @@ BoundingBox InbetweenCell::boundingBox() const
     return res;
 }
 
-BoundingBox InbetweenCell::outlineBoundingBox() const
+BoundingBox InbetweenCell::exactOutlineBoundingBox() const
 {
     // Same as above
     int beforeFrame = beforeTime().frame();
-    int afterFrame = beforeTime().frame();
+    int afterFrame = afterTime().frame();
     BoundingBox res;
     for (double t = beforeFrame + 0.5; t < afterFrame; t += 1.0)
     {
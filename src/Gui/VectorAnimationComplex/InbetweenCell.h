@@ -32,17 +32,44 @@ public:
     virtual KeyCellSet beforeCells() const=0;
     virtual KeyCellSet afterCells() const=0;
 
-    // Bounding box
+    // Bounding box over the whole lifetime of the cell.
+    //
+    // boundingBox() and outlineBoundingBox() are conservative: they contain
+    // boundingBox(t) (resp. outlineBoundingBox(t)) for all t, and are derived
+    // from the key cells and the interpolation scheme without triangulating
+    // the cell. They are cached until the geometry changes.
+    //
+    // exactBoundingBox() and exactOutlineBoundingBox() are the union of the
+    // bounding boxes in the middle of each frame, which requires to
+    // triangulate the cell at each frame of its lifetime.
     using Cell::boundingBox;
     using Cell::outlineBoundingBox;
     BoundingBox boundingBox() const;
     BoundingBox outlineBoundingBox() const;
+    BoundingBox exactBoundingBox() const;
+    BoundingBox exactOutlineBoundingBox() const;
+
+protected:
+    // Computes the conservative bounding boxes returned by boundingBox()
+    // (out) and outlineBoundingBox() (outlineOut)
+    virtual void computeAllTimeBoundingBoxes_(BoundingBox & out, BoundingBox & outlineOut) const=0;
+
+    // Clears the cached all-time bounding boxes. Derived classes which
+    // reimplement clearCachedGeometry_() must call it
+    virtual void clearCachedGeometry_();
+    void clearCachedAllTimeBoundingBoxes_();
 
 private:
     // Trusting operators
     friend class Operator;
     bool checkAnimated_() const;
 
+    // Cached all-time bounding boxes
+    void updateAllTimeBoundingBoxes_() const;
+    mutable bool hasCachedAllTimeBoundingBoxes_;
+    mutable BoundingBox allTimeBoundingBox_;
+    mutable BoundingBox allTimeOutlineBoundingBox_;
+
 
 // --------- Cloning, Assigning, Copying, Serializing ----------
 
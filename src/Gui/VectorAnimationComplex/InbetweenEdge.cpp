@@ -23,11 +23,43 @@
 #include "../SaveAndLoad.h"
 #include "../DevSettings.h"
 #include "../Global.h"
+#include "../MemoryUsage.h"
 
 #include "../XmlStreamWriter.h"
 #include "../XmlStreamReader.h"
 
 #include <assert.h>
+#include <algorithm>
+
+namespace
+{
+
+// Set of all a+b and a-b, for a in bb1 and b in bb2
+VectorAnimationComplex::BoundingBox minkowskiSum_(
+        const VectorAnimationComplex::BoundingBox & bb1,
+        const VectorAnimationComplex::BoundingBox & bb2)
+{
+    if(bb1.isEmpty() || bb2.isEmpty())
+        return VectorAnimationComplex::BoundingBox();
+    else
+        return VectorAnimationComplex::BoundingBox(
+                    bb1.xMin() + bb2.xMin(), bb1.xMax() + bb2.xMax(),
+                    bb1.yMin() + bb2.yMin(), bb1.yMax() + bb2.yMax());
+}
+
+VectorAnimationComplex::BoundingBox minkowskiDifference_(
+        const VectorAnimationComplex::BoundingBox & bb1,
+        const VectorAnimationComplex::BoundingBox & bb2)
+{
+    if(bb1.isEmpty() || bb2.isEmpty())
+        return VectorAnimationComplex::BoundingBox();
+    else
+        return VectorAnimationComplex::BoundingBox(
+                    bb1.xMin() - bb2.xMax(), bb1.xMax() - bb2.xMin(),
+                    bb1.yMin() - bb2.yMax(), bb1.yMax() - bb2.yMin());
+}
+
+}
 
 namespace VectorAnimationComplex
 {
@@ -241,22 +273,23 @@ InbetweenEdge::InbetweenEdge(VAC * vac, XmlStreamReader & xml) :
     InbetweenCell(vac, xml),
     EdgeCell(vac, xml)
 {
-    if(xml.attributes().hasAttribute("beforecycle"))
+    QXmlStreamAttributes attributes = xml.attributes();
+    if(attributes.hasAttribute("beforecycle"))
     {
-        beforeCycle_.fromString(xml.attributes().value("beforecycle").toString());
-        afterCycle_.fromString(xml.attributes().value("aftercycle").toString());
+        beforeCycle_.fromString(attributes.value("beforecycle"));
+        afterCycle_.fromString(attributes.value("aftercycle"));
 
         // Cycle offset
-        if(xml.attributes().hasAttribute("cycleoffset"))
-            afterCycle_.setStartingPoint(xml.attributes().value("cycleoffset").toDouble());
+        if(attributes.hasAttribute("cycleoffset"))
+            afterCycle_.setStartingPoint(attributes.value("cycleoffset").toDouble());
     }
     else
     {
-        beforePath_.fromString(xml.attributes().value("beforepath").toString());
-        afterPath_.fromString(xml.attributes().value("afterpath").toString());
+        beforePath_.fromString(attributes.value("beforepath"));
+        afterPath_.fromString(attributes.value("afterpath"));
 
-        startAnimatedVertex_.fromString(xml.attributes().value("startanimatedvertex").toString());
-        endAnimatedVertex_.fromString(xml.attributes().value("endanimatedvertex").toString());
+        startAnimatedVertex_.fromString(attributes.value("startanimatedvertex"));
+        endAnimatedVertex_.fromString(attributes.value("endanimatedvertex"));
     }
 }
 
@@ -347,106 +380,116 @@ InbetweenEdge::InbetweenEdge(VAC * vac, XmlStreamReader & xml) :
     void InbetweenEdge::clearCachedGeometry_()
     {
         EdgeCell::clearCachedGeometry_();
-        surf_.clear();
-        norm_.clear();
+        clearCachedAllTimeBoundingBoxes_();
+        surface_.clear();
+        samplingCurves_.clear();
     }
 
-    void InbetweenEdge::computeInbetweenSurface(View3DSettings & viewSettings)
+    void InbetweenEdge::addMemoryUsage(MemoryUsage & usage)
     {
-        surf_.clear();
-        norm_.clear();
+        EdgeCell::addMemoryUsage(usage);
+        usage.add("Cell caches", "InbetweenEdge space-time surfaces", surface_.memoryUsage());
 
-        double eps = 1e-5;
-        double tMin = beforeTime().floatTime();
-        double tMax = afterTime().floatTime();
-        int k = viewSettings.k1(); // number of samples per frame
-        double dt = 1 / (double)k;
+        qint64 samplingBytes = 0;
+        foreach(const SculptCurve::Curve<EdgeSample> & curve, samplingCurves_)
+            samplingBytes += curve.memoryUsage();
+        usage.add("Cell caches", "InbetweenEdge samplings", samplingBytes, samplingCurves_.size());
+    }
 
-        // positions
-        for(double t=tMin; t<tMax+eps; t+=dt)
-        {
-            QList<Eigen::Vector3d> geo3D;
+    SpaceTimeSurface::Parameters InbetweenEdge::surfaceParameters_(View3DSettings & viewSettings)
+    {
+        SpaceTimeSurface::Parameters res;
+        res.slicesPerFrame = viewSettings.k1();
+        res.columnStride = viewSettings.k2();
+        res.offset = Eigen::Vector3d(viewSettings.xFromX2D(0),
+                                     viewSettings.yFromY2D(0),
+                                     viewSettings.zFromT(0.0));
+        res.scale = Eigen::Vector3d(viewSettings.xFromX2D(1),
+                                    viewSettings.yFromY2D(1),
+                                    viewSettings.zFromT(1.0)) - res.offset;
+        return res;
+    }
+
+    void InbetweenEdge::computeSurfaceInput_(const SpaceTimeSurface::Parameters & parameters,
+                                             SpaceTimeSurface::Input & input) const
+    {
+        input.parameters = parameters;
+        input.t1 = beforeTime().floatTime();
+        input.t2 = afterTime().floatTime();
+
+        // Key paths are sampled once for all time slices
+        QList<Eigen::Vector2d> beforeSampling;
+        QList<Eigen::Vector2d> afterSampling;
+        sampleKeyPaths_(numGeometrySamples_(), beforeSampling, afterSampling);
+        input.beforeSampling.assign(beforeSampling.begin(), beforeSampling.end());
+        input.afterSampling.assign(afterSampling.begin(), afterSampling.end());
 
-            QList<Eigen::Vector2d> geo2D = getGeometry(Time(t));
-            for(int i=0; i< geo2D.size(); ++i)
+        input.startPositions.clear();
+        input.endPositions.clear();
+        if(!isClosed())
+        {
+            int n = input.numIntervals();
+            input.startPositions.reserve(n+1);
+            input.endPositions.reserve(n+1);
+            for(int i=0; i<=n; ++i)
             {
-                Eigen::Vector3d pos(
-                        viewSettings.xFromX2D(geo2D[i][0]),
-                        viewSettings.yFromY2D(geo2D[i][1]),
-                        viewSettings.zFromT(t));
-                geo3D << pos;
+                Time t(input.gridTime(i));
+                input.startPositions.push_back(startAnimatedVertex_.pos(t));
+                input.endPositions.push_back(endAnimatedVertex_.pos(t));
             }
-
-            surf_ << geo3D;
         }
+    }
 
+    void InbetweenEdge::computeInbetweenSurface(View3DSettings & viewSettings)
+    {
+        SpaceTimeSurface::Input input;
+        computeSurfaceInput_(surfaceParameters_(viewSettings), input);
+        surface_.build(input);
+    }
 
-        if(surf_.size() < 2)
-            return;
+    void InbetweenEdge::computeSurfaces3D(const InbetweenEdgeSet & edges, View3DSettings & viewSettings)
+    {
+        // Gathering the inputs reads the VAC, so it is done sequentially.
+        // Meshing only reads the inputs, so it is done concurrently
+        SpaceTimeSurface::Parameters parameters = surfaceParameters_(viewSettings);
+        std::vector<InbetweenEdge *> outdatedEdges;
+        foreach(InbetweenEdge * e, edges)
+        {
+            if(!e->surface_.isBuilt() || e->surface_.parameters() != parameters)
+                outdatedEdges.push_back(e);
+        }
 
-        // normals
-        for(int i=0; i<surf_.size(); i++)
+        std::vector<SpaceTimeSurface::Input> inputs(outdatedEdges.size());
+        std::vector<const SpaceTimeSurface::Input *> inputPointers;
+        std::vector<SpaceTimeSurface *> surfaces;
+        for(unsigned int i=0; i<outdatedEdges.size(); ++i)
         {
-            QList<Eigen::Vector3d> list;
-            for(int j=0; j<surf_[0].size(); j++)
-            {
-                int i_=i;
-                int j_=j;
-                if(i==surf_.size()-1)
-                    i_--;
-                if(j==surf_[0].size()-1)
-                    j_--;
-                Eigen::Vector3d a = surf_[i_][j_];
-                Eigen::Vector3d b = surf_[i_][j_+1];
-                Eigen::Vector3d c = surf_[i_+1][j_];
-                Eigen::Vector3d u = b-a;
-                Eigen::Vector3d v = c-a;
-                Eigen::Vector3d N = -u.cross(v);
-                list << N;
-                //qDebug() << N[0] << N[1] << N[2];
-            }
-            norm_ << list;
+            outdatedEdges[i]->computeSurfaceInput_(parameters, inputs[i]);
+            inputPointers.push_back(&inputs[i]);
+            surfaces.push_back(&outdatedEdges[i]->surface_);
         }
+        SpaceTimeSurface::buildAll(inputPointers, surfaces);
     }
 
     void InbetweenEdge::drawRaw3D(View3DSettings & viewSettings)
     {
-        if(surf_.isEmpty())
+        if(!surface_.isBuilt() || surface_.parameters() != surfaceParameters_(viewSettings))
             computeInbetweenSurface(viewSettings);
 
-        // drawn in  backward order  to improve the  likeliness the
-        // polygon are  drawn from rear  to near, and  improve the
-        // chance to get the transparency right
-        int n = surf_[0].size();
-        for(int i=surf_.size()-2; i>=0; i--)
-        {
-            glBegin(GL_QUAD_STRIP);
-            for(int j=0; j<n;)
-            {
-                //glColor4d(1.0,0.5,0.5,0.2);
-                glNormal3d(norm_[i][j][0],norm_[i][j][1],norm_[i][j][2]);
-                glVertex3d(surf_[i][j][0],surf_[i][j][1],surf_[i][j][2]);
-                glNormal3d(norm_[i+1][j][0],norm_[i+1][j][1],norm_[i+1][j][2]);
-                glVertex3d(surf_[i+1][j][0],surf_[i+1][j][1],surf_[i+1][j][2]);
+        if(surface_.indices().empty())
+            return;
 
-                if(j == n-1)
-                {
-                    break;
-                }
-                else
-                {
-                    j += viewSettings.k2();
-                    if(j >= n)
-                        j = n-1;
-                }
-            }
-            glEnd();
-        }
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glVertexPointer(3, GL_DOUBLE, 0, surface_.positions().data());
+        glNormalPointer(GL_DOUBLE, 0, surface_.normals().data());
+        glDrawElements(GL_TRIANGLES, surface_.indices().size(), GL_UNSIGNED_INT, surface_.indices().data());
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
     }
 
-    QList<Eigen::Vector2d>  InbetweenEdge::getGeometry(Time time)
+    int InbetweenEdge::numGeometrySamples_() const
     {
-
         // Compute lengths of key paths
         double beforeLength = 0;
         double afterLength = 0;
@@ -461,10 +504,12 @@ InbetweenEdge::InbetweenEdge(VAC * vac, XmlStreamReader & xml) :
             afterLength = afterPath_.length();
         }
         double maxLength = std::max(beforeLength,afterLength);
-        // Compute uniform sampling of key paths
-        int numSamples = (int) (maxLength/5.0) + 2;
-        QList<Eigen::Vector2d> beforeSampling;
-        QList<Eigen::Vector2d> afterSampling;
+        return (int) (maxLength/5.0) + 2;
+    }
+
+    void InbetweenEdge::sampleKeyPaths_(int numSamples, QList<Eigen::Vector2d> & beforeSampling,
+                                        QList<Eigen::Vector2d> & afterSampling) const
+    {
         if(isClosed())
         {
             beforeCycle_.sample(numSamples,beforeSampling);
@@ -477,6 +522,15 @@ InbetweenEdge::InbetweenEdge(VAC * vac, XmlStreamReader & xml) :
         }
         assert(beforeSampling.size() == numSamples);
         assert(afterSampling.size() == numSamples);
+    }
+
+    QList<Eigen::Vector2d>  InbetweenEdge::getGeometry(Time time)
+    {
+        // Compute uniform sampling of key paths
+        int numSamples = numGeometrySamples_();
+        QList<Eigen::Vector2d> beforeSampling;
+        QList<Eigen::Vector2d> afterSampling;
+        sampleKeyPaths_(numSamples, beforeSampling, afterSampling);
         // Interpolate key paths
         double t = time.floatTime(); // in [t1,t2]
         double t1 = beforeTime().floatTime();
@@ -604,6 +658,27 @@ InbetweenEdge::InbetweenEdge(VAC * vac, XmlStreamReader & xml) :
         return sampling;
     }
 
+    const SculptCurve::Curve<EdgeSample> & InbetweenEdge::samplingCurve(Time time) const
+    {
+        // Same key as the other per-time caches, see Cell::cachedTriangles_()
+        int key = std::floor(time.floatTime() * 60 + 0.5);
+        auto it = samplingCurves_.find(key);
+        if(it != samplingCurves_.end())
+            return it.value();
+
+        QList<EdgeSample> sampling = getSampling(time);
+        std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > vertices;
+        vertices.reserve(sampling.size());
+        for(int i=0; i<sampling.size(); ++i)
+            vertices.push_back(sampling[i]);
+
+        // Not made a loop even if this edge is closed: intersecting sketched
+        // edges with it must also find the virtual intersections at its seam
+        SculptCurve::Curve<EdgeSample> & curve = samplingCurves_[key];
+        curve.setVertices(vertices);
+        return curve;
+    }
+
     void InbetweenEdge::triangulate_(Time time, Triangles & out) const
     {
         out.clear();
@@ -630,6 +705,81 @@ InbetweenEdge::InbetweenEdge(VAC * vac, XmlStreamReader & xml) :
         }
     }
 
+    double InbetweenEdge::maxWidth() const
+    {
+        double res = 0;
+        KeyCellSet keyCells = beforeCells();
+        keyCells.unite(afterCells());
+        foreach(KeyCell * c, keyCells)
+        {
+            KeyEdge * e = c->toKeyEdge();
+            if(e && e->geometry())
+            {
+                foreach(const EdgeSample & sample, e->geometry()->edgeSampling())
+                    res = std::max(res, sample.width());
+            }
+        }
+        return res;
+    }
+
+    void InbetweenEdge::computeAllTimeBoundingBoxes_(BoundingBox & out, BoundingBox & outlineOut) const
+    {
+        // Interpolated samples (see getSampling()) are convex combinations of
+        // samples of the before and after key paths, which are themselves
+        // contained in the bounding box of the samples of their key edges
+        BoundingBox keyBox;
+        double width = 0;
+        KeyCellSet keyCells = beforeCells();
+        keyCells.unite(afterCells());
+        foreach(KeyCell * c, keyCells)
+        {
+            KeyEdge * e = c->toKeyEdge();
+            KeyVertex * v = c->toKeyVertex();
+            if(e && e->geometry())
+            {
+                foreach(const EdgeSample & sample, e->geometry()->edgeSampling())
+                {
+                    keyBox.unite(BoundingBox(sample.x(), sample.y()));
+                    width = std::max(width, sample.width());
+                }
+            }
+            else if(v)
+            {
+                Eigen::Vector2d p = v->pos();
+                keyBox.unite(BoundingBox(p[0], p[1]));
+            }
+        }
+        outlineOut = keyBox;
+
+        // Open edges are then warped by a convex combination of the start
+        // and end displacements, i.e., the difference between the position of
+        // the animated vertex and the interpolated end of the key paths
+        if(!isClosed())
+        {
+            QList<Eigen::Vector2d> beforeEnds;
+            QList<Eigen::Vector2d> afterEnds;
+            beforePath_.sample(2, beforeEnds);
+            afterPath_.sample(2, afterEnds);
+
+            BoundingBox startPathBox(beforeEnds[0][0], afterEnds[0][0], beforeEnds[0][1], afterEnds[0][1]);
+            BoundingBox endPathBox(beforeEnds[1][0], afterEnds[1][0], beforeEnds[1][1], afterEnds[1][1]);
+            BoundingBox startVertexBox;
+            BoundingBox endVertexBox;
+            foreach(VertexCell * v, startVertices())
+                startVertexBox.unite(v->outlineBoundingBox());
+            foreach(VertexCell * v, endVertices())
+                endVertexBox.unite(v->outlineBoundingBox());
+
+            BoundingBox displacementBox = minkowskiDifference_(startVertexBox, startPathBox);
+            displacementBox.unite(minkowskiDifference_(endVertexBox, endPathBox));
+            if(!displacementBox.isEmpty())
+                outlineOut = minkowskiSum_(keyBox, displacementBox);
+        }
+
+        // Triangles are at most at half the width from the centerline
+        out = outlineOut.expanded(0.5 * width);
+    }
+
     KeyCellSet InbetweenEdge::beforeCells() const
     {
         if(isClosed())
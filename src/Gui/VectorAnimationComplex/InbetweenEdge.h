@@ -16,8 +16,11 @@
 #include "Cycle.h"
 #include "AnimatedVertex.h"
 #include "EdgeSample.h"
+#include "SculptCurve.h"
+#include "SpaceTimeSurface.h"
 
 #include <QList>
+#include <QMap>
 #include <QPair>
 
 namespace VectorAnimationComplex
@@ -69,9 +72,21 @@ public:
     VertexCell * startVertex(Time time) const;
     VertexCell * endVertex(Time time) const;
 
+    // Upper bound of the width of this edge over its lifetime, i.e. the
+    // maximum width of the key edges it interpolates
+    double maxWidth() const;
+
     // Drawing
     void glColor3D_();
     void drawRaw3D(View3DSettings & viewSettings);
+
+    // Computes the space-time surfaces of all the given edges which are
+    // not up to date, concurrently. Otherwise, drawRaw3D() computes them
+    // one at a time
+    static void computeSurfaces3D(const InbetweenEdgeSet & edges, View3DSettings & viewSettings);
+
+    // Memory usage, including the space-time surface
+    void addMemoryUsage(MemoryUsage & usage);
     //void drawRaw(Time time);
     //void drawRawTopology(Time time, ViewSettings & viewSettings);
     //void resetSampling();
@@ -80,13 +95,27 @@ public:
     QList<EdgeSample> getSampling(Time time) const; // Note: repeat start and end vertices even when closed.
     QList<Eigen::Vector2d> getGeometry(Time time); // Note: repeat start and end vertices even when closed.
 
+    // Same samples as getSampling(time), as an open curve with precomputed
+    // arclengths, even when closed. Cached per time until the geometry of
+    // this edge changes, so that it can be borrowed (see
+    // SculptCurve::Curve::view()) instead of being sampled again
+    const SculptCurve::Curve<EdgeSample> & samplingCurve(Time time) const;
+
 private:
     // Cached geometry
-    QList< QList<Eigen::Vector3d> > surf_;
-    QList< QList<Eigen::Vector3d> > norm_;
+    SpaceTimeSurface surface_;
+    mutable QMap<int, SculptCurve::Curve<EdgeSample> > samplingCurves_;
     virtual void clearCachedGeometry_();
+    static SpaceTimeSurface::Parameters surfaceParameters_(View3DSettings & viewSettings);
+    void computeSurfaceInput_(const SpaceTimeSurface::Parameters & parameters, SpaceTimeSurface::Input & input) const;
     void computeInbetweenSurface(View3DSettings & viewSettings);
 
+    // Uniform samplings of the key paths, used by getGeometry()
+    int numGeometrySamples_() const;
+    void sampleKeyPaths_(int numSamples, QList<Eigen::Vector2d> & beforeSampling,
+                         QList<Eigen::Vector2d> & afterSampling) const;
+    void computeAllTimeBoundingBoxes_(BoundingBox & out, BoundingBox & outlineOut) const;
+
     // Trusting operators
     friend class VAC;
     friend class Operator;
@@ -29,6 +29,7 @@
 
 #include "../XmlStreamReader.h"
 #include "../XmlStreamWriter.h"
+#include "../StringTokenizer.h"
 
 // ------- Unnamed namespace for non-friend non-member helper functions -------
 
@@ -400,6 +401,23 @@ void InbetweenFace::triangulate_(Time time, Triangles & out) const
         computeTrianglesFromCycles(cycles_, out, time);
 }
 
+void InbetweenFace::computeAllTimeBoundingBoxes_(BoundingBox & out, BoundingBox & outlineOut) const
+{
+    // The face is triangulated inside the polygons formed by the centerlines
+    // of its boundary cells
+    out = BoundingBox();
+    foreach(Cell * c, spatialBoundary())
+        out.unite(c->outlineBoundingBox());
+    outlineOut = out;
+}
+
+void InbetweenFace::clearCachedGeometry_()
+{
+    InbetweenCell::clearCachedGeometry_();
+    for(int i=0; i<cycles_.size(); ++i)
+        cycles_[i].clearCachedTimeIndex();
+}
+
 QList<QList<Eigen::Vector2d> > InbetweenFace::getSampling(Time time) const
 {
     QList<QList<Eigen::Vector2d> > res;
@@ -631,36 +649,26 @@ InbetweenFace::InbetweenFace(VAC * vac, XmlStreamReader & xml) :
     FaceCell(vac, xml)
 {
     // Cycles
-    QString str;
-    QStringRef d = xml.attributes().value("cycles");
-    bool opened = false;
-    for(int i=0; i<d.length(); ++i)
+    QXmlStreamAttributes attributes = xml.attributes();
+    StringTokenizer tokenizer(attributes.value("cycles"));
+    for(QStringRef str = tokenizer.nextEnclosed('[', ']'); !str.isNull(); str = tokenizer.nextEnclosed('[', ']'))
     {
-        QChar c = d.at(i);
-        if(c == '[')
-            opened = true;
-        if(opened)
-            str += c;
-        if(c==']')
-        {
-            cycles_ << AnimatedCycle();
-            cycles_.last().fromString(str);
-            opened = false;
-            str.clear();
-        }
+        cycles_ << AnimatedCycle();
+        cycles_.last().fromString(str);
     }
 
-    // Before faces
-    QStringList beforefacesSL = xml.attributes().value("beforefaces").toString().simplified().split(' ');
+    // Before faces. Note: an empty attribute gives an empty list. It used to
+    // give the list [0], which referred to a face that didn't exist
+    StringTokenizer beforefaces(attributes.value("beforefaces"));
     tempBeforeFaces_.clear();
-    for(int i=0; i<beforefacesSL.size(); ++i)
-        tempBeforeFaces_ << beforefacesSL[i].toInt();
+    while(!beforefaces.atEnd())
+        tempBeforeFaces_ << beforefaces.next().toInt();
 
     // After faces
-    QStringList afterfacesSL = xml.attributes().value("afterfaces").toString().simplified().split(' ');
+    StringTokenizer afterfaces(attributes.value("afterfaces"));
     tempAfterFaces_.clear();
-    for(int i=0; i<afterfacesSL.size(); ++i)
-        tempAfterFaces_ << afterfacesSL[i].toInt();
+    while(!afterfaces.atEnd())
+        tempAfterFaces_ << afterfaces.next().toInt();
 }
 
 InbetweenFace::~InbetweenFace()
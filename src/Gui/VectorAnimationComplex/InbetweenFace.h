@@ -75,6 +75,13 @@ private:
     // Implementation of triangulate
     void triangulate_(Time time, Triangles & out) const;
 
+    // All-time bounding boxes
+    void computeAllTimeBoundingBoxes_(BoundingBox & out, BoundingBox & outlineOut) const;
+
+    // Also clears the time index of the cycles, since geometry changes
+    // include changes of the time of key cells
+    virtual void clearCachedGeometry_();
+
 // --------- Cloning, Assigning, Copying, Serializing ----------
 
 protected:
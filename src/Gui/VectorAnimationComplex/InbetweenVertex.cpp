@@ -8,6 +8,7 @@
 
 #include "InbetweenVertex.h"
 #include "KeyVertex.h"
+#include "InbetweenEdge.h"
 
 #include "VAC.h"
 
@@ -18,6 +19,7 @@
 
 #include <QtDebug>
 #include <QTextStream>
+#include <algorithm>
 
 #include "../XmlStreamReader.h"
 #include "../XmlStreamWriter.h"
@@ -297,6 +299,48 @@ Eigen::Vector2d InbetweenVertex::posLinear(Time time) const
         return p2;
 }
 
+void InbetweenVertex::computeAllTimeBoundingBoxes_(BoundingBox & out, BoundingBox & outlineOut) const
+{
+    // The cubic Hermite curve computed by posCubic() is the Bezier curve
+    // with control points p1, p1+m1/3, p2-m2/3, p2, hence is contained in
+    // their convex hull
+    double dt = afterVertex()->time().floatTime() - beforeVertex()->time().floatTime();
+    Eigen::Vector2d p1 = beforeVertex()->pos();
+    Eigen::Vector2d p2 = afterVertex()->pos();
+    Eigen::Vector2d m1 = beforeVertex()->dividedDifferencesTangent(false) * dt;
+    Eigen::Vector2d m2 = afterVertex()->dividedDifferencesTangent(false) * dt;
+    Eigen::Vector2d c1 = p1 + m1 / 3;
+    Eigen::Vector2d c2 = p2 - m2 / 3;
+
+    outlineOut = BoundingBox(p1[0], p1[1]);
+    outlineOut.unite(BoundingBox(c1[0], c1[1]));
+    outlineOut.unite(BoundingBox(c2[0], c2[1]));
+    outlineOut.unite(BoundingBox(p2[0], p2[1]));
+
+    // The vertex is drawn as a disk whose diameter is the width of its
+    // incident edges (see VertexCell::size())
+    double maxSize = 0;
+    foreach(Cell * c, spatialStar())
+    {
+        InbetweenEdge * e = c->toInbetweenEdge();
+        if(e)
+            maxSize = std::max(maxSize, e->maxWidth());
+    }
+    out = outlineOut.expanded(0.5 * maxSize);
+}
+
+void InbetweenVertex::clearCachedGeometry_()
+{
+    VertexCell::clearCachedGeometry_();
+    clearCachedAllTimeBoundingBoxes_();
+}
+
+void InbetweenVertex::processSpatialStarChanged_()
+{
+    VertexCell::processSpatialStarChanged_();
+    clearCachedAllTimeBoundingBoxes_();
+}
+
 bool InbetweenVertex::check_() const
 {
     // todo
@@ -71,6 +71,15 @@ private:
     // Linear interpolation
     Eigen::Vector2d posLinear(Time time) const;
 
+    // All-time bounding boxes
+    void computeAllTimeBoundingBoxes_(BoundingBox & out, BoundingBox & outlineOut) const;
+
+    // Reimplemented from both InbetweenCell and VertexCell
+    void clearCachedGeometry_();
+
+    // The all-time bounding boxes depend on the width of incident edges
+    void processSpatialStarChanged_();
+
 // --------- Cloning, Assigning, Copying, Serializing ----------
 
 protected:
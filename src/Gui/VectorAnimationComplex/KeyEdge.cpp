@@ -13,6 +13,7 @@
 #include "KeyVertex.h"
 #include "VAC.h"
 #include "Intersection.h"
+#include "TessellationCache.h"
 
 #include <limits>
 
@@ -24,6 +25,14 @@
 
 #include "../XmlStreamReader.h"
 #include "../XmlStreamWriter.h"
+#include "../MemoryUsage.h"
+
+namespace
+{
+// Minimum time (in milliseconds) between two invalidations of the cells
+// depending on a sculpted edge
+const qint64 sculptDependentCellsInterval = 100;
+}
 
 namespace VectorAnimationComplex
 {
@@ -236,6 +245,15 @@ VertexCellSet KeyEdge::startVertices() const
     return res;
 }
 
+void KeyEdge::appendBoundary(std::vector<Cell*> & out) const
+{
+    if(startVertex_)
+    {
+        out.push_back(startVertex_);
+        out.push_back(endVertex_);
+    }
+}
+
 VertexCellSet KeyEdge::endVertices() const
 {
     VertexCellSet res;
@@ -279,14 +297,34 @@ void KeyEdge::triangulate_(Time time, Triangles & out) const
 {
     out.clear();
     if (exists(time))
+    {
+        // Re-created copies of this edge (undo, clone, paste) share its key
+        TessellationKey key(TessellationKey::EdgeTriangles);
+        bool isCacheable = geometry()->addToTessellationKey(key);
+        if (isCacheable && TessellationCache::instance()->find(key, out))
+            return;
+
         geometry()->triangulate(out);
+        if (isCacheable)
+            TessellationCache::instance()->insert(key, out);
+    }
 }
 
 void KeyEdge::triangulate_(double width, Time time, Triangles & out) const
 {
     out.clear();
     if (exists(time))
+    {
+        TessellationKey key(TessellationKey::EdgeTopologyTriangles);
+        key.add(width);
+        bool isCacheable = geometry()->addToTessellationKey(key);
+        if (isCacheable && TessellationCache::instance()->find(key, out))
+            return;
+
         geometry()->triangulate(width, out);
+        if (isCacheable)
+            TessellationCache::instance()->insert(key, out);
+    }
 }
 
 QList<EdgeSample> KeyEdge::getSampling(Time /*time*/) const
@@ -294,6 +332,14 @@ QList<EdgeSample> KeyEdge::getSampling(Time /*time*/) const
     return geometry()->edgeSampling();
 }
 
+void KeyEdge::addMemoryUsage(MemoryUsage & usage)
+{
+    EdgeCell::addMemoryUsage(usage);
+
+    if(geometry())
+        usage.add("Edge geometry", "KeyEdge samplings", geometry()->memoryUsage());
+}
+
 void KeyEdge::correctGeometry()
 {
     if(geometry())
@@ -314,6 +360,36 @@ void KeyEdge::correctGeometry()
     }
 }
 
+void KeyEdge::beginCorrectGeometryDrag()
+{
+    if(geometry() && !isClosed())
+        geometry()->beginEndPointsDrag();
+}
+
+void KeyEdge::continueCorrectGeometryDrag()
+{
+    if(geometry() && !isClosed())
+    {
+        geometry()->continueEndPointsDrag(startVertex()->pos(), endVertex()->pos());
+        processGeometryChanged_();
+    }
+}
+
+void KeyEdge::endCorrectGeometryDrag()
+{
+    if(geometry() && !isClosed())
+    {
+        geometry()->endEndPointsDrag();
+        processGeometryChanged_();
+    }
+}
+
+void KeyEdge::cancelCorrectGeometryDrag()
+{
+    if(geometry())
+        geometry()->cancelEndPointsDrag();
+}
+
 void KeyEdge::setWidth(double newWidth)
 {
     geometry()->setWidth(newWidth);
@@ -337,6 +413,7 @@ void KeyEdge::beginSculptDeform(double x, double y)
 {
     // prepare geometry for sculpting
     geometry()->beginSculptDeform(x, y);
+    beginSculptGeometryChanges_();
     prepareSculptPreserveTangents_();
 }
 
@@ -424,7 +501,7 @@ void KeyEdge::prepareSculptPreserveTangents_()
 void KeyEdge::continueSculptDeform(double x, double y)
 {
     geometry()->continueSculptDeform(x, y);
-    processGeometryChanged_();
+    processSculptGeometryChanged_();
     continueSculptPreserveTangents_();
 }
 
@@ -462,12 +539,13 @@ void KeyEdge::endSculptDeform()
 void KeyEdge::beginSculptEdgeWidth(double x, double y)
 {
     geometry()->beginSculptEdgeWidth(x, y);
+    beginSculptGeometryChanges_();
 }
 
 void KeyEdge::continueSculptEdgeWidth(double x, double y)
 {
     geometry()->continueSculptEdgeWidth(x, y);
-    processGeometryChanged_();
+    processSculptGeometryChanged_();
 }
 
 void KeyEdge::endSculptEdgeWidth()
@@ -479,6 +557,7 @@ void KeyEdge::endSculptEdgeWidth()
 void KeyEdge::beginSculptSmooth(double x, double y)
 {
     geometry()->beginSculptSmooth(x, y);
+    beginSculptGeometryChanges_();
     //prepareSculptPreserveTangents_(); // doesn't make sense since sculpt vertex can be different in continueSculptSmooth
 }
 
@@ -486,7 +565,7 @@ void KeyEdge::continueSculptSmooth(double x, double y)
 {
     prepareSculptPreserveTangents_();
     geometry()->continueSculptSmooth(x, y);
-    processGeometryChanged_();
+    processSculptGeometryChanged_();
     //correctGeometry(); // now ensured by geometry()->continueSculptSmooth(x, y)
     continueSculptPreserveTangents_();
 }
@@ -497,6 +576,45 @@ void KeyEdge::endSculptSmooth()
     processGeometryChanged_();
 }
 
+void KeyEdge::beginSculptGeometryChanges_()
+{
+    sculptDependentCellsTimer_.start();
+}
+
+void KeyEdge::processSculptGeometryChanged_()
+{
+    // Patch the cached triangles of this edge over the modified window, if
+    // supported by the geometry. Otherwise, clear them.
+    bool isPatched = false;
+    int first, last;
+    Triangles * triangles = cachedTriangles_(time());
+    if(triangles && geometry()->sculptModifiedRange(first, last))
+    {
+        processDrawingChanged_();
+        BoundingBox changedBoundingBox;
+        if(geometry()->retriangulate(first, last, *triangles, changedBoundingBox))
+        {
+            // Conservative during the sculpt, made exact by endSculpt*()
+            BoundingBox * boundingBox = cachedBoundingBox_(time());
+            if(boundingBox)
+                boundingBox->unite(changedBoundingBox);
+            clearCachedOutlineBoundingBoxes_();
+            trianglesTopo_.clear();
+            isPatched = true;
+        }
+    }
+    if(!isPatched)
+        clearCachedGeometry_();
+
+    // Invalidate dependent cells at a reduced frequency
+    if(!sculptDependentCellsTimer_.isValid() ||
+       sculptDependentCellsTimer_.elapsed() >= sculptDependentCellsInterval)
+    {
+        processDependentGeometryChanged_();
+        sculptDependentCellsTimer_.start();
+    }
+}
+
 void KeyEdge::prepareAffineTransform()
 {
     geometry()->prepareAffineTransform();
@@ -508,6 +626,13 @@ void KeyEdge::performAffineTransform(const Eigen::Affine2d & xf)
     processGeometryChanged_();
 }
 
+void KeyEdge::endAffineTransform()
+{
+    // correctGeometry() resamples the transformed geometry
+    geometry()->endAffineTransform();
+    correctGeometry();
+}
+
 bool KeyEdge::check_() const
 {
     // todo
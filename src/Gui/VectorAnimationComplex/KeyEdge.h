@@ -13,6 +13,7 @@
 #include "KeyCell.h"
 #include "Eigen.h"
 #include "Triangles.h"
+#include <QElapsedTimer>
 
 namespace VectorAnimationComplex
 {
@@ -52,11 +53,23 @@ public:
     // reimplements
     VertexCellSet startVertices() const;
     VertexCellSet endVertices() const;
+    void appendBoundary(std::vector<Cell*> & out) const;
 
 
     // Geometry
     EdgeGeometry * geometry() const { return geometry_; }
+
+    // Memory usage, including geometry
+    void addMemoryUsage(MemoryUsage & usage);
     void correctGeometry();
+    // Same as correctGeometry(), but while the end vertices are dragged: the
+    // edge is deformed from its shape at beginCorrectGeometryDrag(), and is
+    // only resampled by endCorrectGeometryDrag(). cancelCorrectGeometryDrag()
+    // abandons the drag, leaving the edge in its current shape
+    void beginCorrectGeometryDrag();
+    void continueCorrectGeometryDrag();
+    void endCorrectGeometryDrag();
+    void cancelCorrectGeometryDrag();
     void setWidth(double newWidth);
     QList<EdgeSample> getSampling(Time time) const;
 
@@ -83,6 +96,9 @@ public:
     // Affine transform
     void prepareAffineTransform();
     void performAffineTransform(const Eigen::Affine2d & xf);
+    // The geometry is only resampled here, once, when snapping it to the
+    // end vertices
+    void endAffineTransform();
 
 private:
     friend class VAC;
@@ -119,6 +135,14 @@ private:
     double remainingRadiusLeft_;
     double remainingRadiusRight_;
 
+    // Cheaper alternative to processGeometryChanged_() called at each sculpt
+    // step: the edge triangles are patched over the modified window only, and
+    // dependent cells (incident faces, inbetween cells) are invalidated at a
+    // reduced frequency. endSculpt*() performs the full invalidation.
+    void processSculptGeometryChanged_();
+    void beginSculptGeometryChanges_();
+    QElapsedTimer sculptDependentCellsTimer_;
+
     // Implementation of triangulate
     void triangulate_(Time time, Triangles & out) const;
     void triangulate_(double width, Time time, Triangles & out) const;
@@ -10,6 +10,7 @@
 
 #include "../XmlStreamReader.h"
 #include "../XmlStreamWriter.h"
+#include "../StringTokenizer.h"
 #include <QTextStream>
 #include <QtDebug>
 #include <QMessageBox>
@@ -24,6 +25,7 @@
 #include "KeyVertex.h"
 #include "KeyEdge.h"
 #include "KeyFace.h"
+#include "TessellationCache.h"
 #include "../DevSettings.h"
 #include "../Global.h"
 
@@ -238,6 +240,22 @@ void computeTrianglesFromCycles(const QList<Cycle> & cycles, Triangles & triangl
     // Creating polygon data for GLU tesselator
     PolygonData vertices = createPolygonData(cycles);
 
+    // The tesselation only depends on the polygons, which are much cheaper
+    // to hash than to tesselate
+    TessellationKey key(TessellationKey::FaceTriangles);
+    key.add((int) vertices.size());
+    for(auto & vec: vertices)
+    {
+        key.add((int) vec.size());
+        for(auto & v: vec)
+        {
+            key.add(v[0]);
+            key.add(v[1]);
+        }
+    }
+    if(TessellationCache::instance()->find(key, triangles))
+        return;
+
     // Creating the GLU tesselation object
     if(!tobjOffline)
     {
@@ -297,6 +315,7 @@ void computeTrianglesFromCycles(const QList<Cycle> & cycles, Triangles & triangl
 
     // Tranfer to member data
     triangles = offlineTessTriangles;
+    TessellationCache::instance()->insert(key, triangles);
 }
 
 }
@@ -398,6 +417,15 @@ void KeyFace::triangulate_(Time time, Triangles & out) const
         computeTrianglesFromCycles(cycles_, out);
 }
 
+bool KeyFace::transformCachedGeometry_(const Eigen::Affine2d & xf)
+{
+    if(xf.linear().determinant() == 0)
+        return false;
+
+    transformCachedTriangles_(xf);
+    return true;
+}
+
 QList<QList<Eigen::Vector2d> > KeyFace::getSampling(Time /*time*/) const
 {
     QList<QList<Eigen::Vector2d> > res;
@@ -444,23 +472,12 @@ KeyFace::KeyFace(VAC * vac, XmlStreamReader & xml) :
     FaceCell(vac, xml)
 {
     // Cycles
-    QString str;
-    QStringRef d = xml.attributes().value("cycles");
-    bool opened = false;
-    for(int i=0; i<d.length(); ++i)
+    QXmlStreamAttributes attributes = xml.attributes();
+    StringTokenizer tokenizer(attributes.value("cycles"));
+    for(QStringRef str = tokenizer.nextEnclosed('[', ']'); !str.isNull(); str = tokenizer.nextEnclosed('[', ']'))
     {
-        QChar c = d.at(i);
-        if(c == '[')
-            opened = true;
-        if(opened)
-            str += c;
-        if(c==']')
-        {
-            cycles_ << Cycle();
-            cycles_.last().fromString(str);
-            opened = false;
-            str.clear();
-        }
+        cycles_ << Cycle();
+        cycles_.last().fromString(str);
     }
 }
 
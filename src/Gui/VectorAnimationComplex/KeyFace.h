@@ -90,6 +90,10 @@ private:
     // Implementation of triangulate
     void triangulate_(Time time, Triangles & out) const;
 
+    // Faces are filled polygons, whose triangles are preserved by any
+    // invertible affine transformation
+    bool transformCachedGeometry_(const Eigen::Affine2d & xf);
+
 // --------- Cloning, Assigning, Copying, Serializing ----------
 
 protected:
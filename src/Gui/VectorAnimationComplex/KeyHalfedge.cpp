@@ -12,6 +12,9 @@
 #include "KeyVertex.h"
 #include "EdgeGeometry.h"
 
+#include <vector>
+#include <assert.h>
+
 namespace VectorAnimationComplex
 {
 
@@ -197,6 +200,67 @@ EdgeSample KeyHalfedge::sample(double s)
         return edge->geometry()->pos(length()-s);
 }
 
+void KeyHalfedge::sortedSample(double * s, int n, EdgeSample * out)
+{
+    if(!edge)
+    {
+        for(int k=0; k<n; ++k)
+            out[k] = EdgeSample();
+    }
+    else if(side)
+    {
+        edge->geometry()->sortedPos(s, n, out);
+    }
+    else
+    {
+        // Reversed arclengths are sorted in decreasing order, which
+        // sortedPos() supports as well
+        double l = length();
+        for(int k=0; k<n; ++k)
+            s[k] = l - s[k];
+        edge->geometry()->sortedPos(s, n, out);
+    }
+}
+
+void KeyHalfedge::sampleUniformly(const QList<KeyHalfedge> & halfedges,
+                                  int numSamples, EdgeSample * out)
+{
+    assert(numSamples >= 2);
+
+    // Lengths of halfedges
+    int m = halfedges.size();
+    std::vector<double> lengths(m);
+    double totalLength = 0;
+    for(int j=0; j<m; ++j)
+    {
+        lengths[j] = KeyHalfedge(halfedges[j]).length();
+        totalLength += lengths[j];
+    }
+    double ds = totalLength/(numSamples-1);
+
+    // Each sample is assigned to the first halfedge whose end is after it
+    // (or to the last one), then each halfedge samples all its samples at
+    // once
+    std::vector<double> s;
+    s.reserve(numSamples);
+    double cumulativeLength = 0;
+    int i = 0;
+    for(int j=0; j<m && i<numSamples; ++j)
+    {
+        bool isLast = (j+1 == m);
+        int first = i;
+        s.clear();
+        while(i<numSamples && (isLast || i*ds <= cumulativeLength + lengths[j]))
+        {
+            s.push_back(i*ds - cumulativeLength);
+            ++i;
+        }
+        if(!s.empty())
+            KeyHalfedge(halfedges[j]).sortedSample(s.data(), s.size(), out + first);
+        cumulativeLength += lengths[j];
+    }
+}
+
 
 
 Eigen::Vector2d KeyHalfedge::leftPos()
@@ -38,12 +38,22 @@ public:
     double length();
     Eigen::Vector2d pos(double s);
     EdgeSample sample(double s);
+    // Same as out[k] = sample(s[k]) for k in [0, n), with s sorted in
+    // increasing order, but walks the edge geometry only once. If side is
+    // false, s is overwritten by the arclengths along the edge
+    void sortedSample(double * s, int n, EdgeSample * out);
     Eigen::Vector2d leftPos();
     Eigen::Vector2d rightPos();
     Eigen::Vector2d leftDer();
     Eigen::Vector2d rightDer();
     QList<KeyHalfedge> sorted(const QList<KeyHalfedge> & adj);
 
+    // Samples the concatenation of the given halfedges at numSamples >= 2
+    // uniformly spaced arclengths from its start to its end, as used by
+    // Path::sample() and Cycle::sample()
+    static void sampleUniformly(const QList<KeyHalfedge> & halfedges,
+                                int numSamples, EdgeSample * out);
+
     // finding incident halfedges
     QList<KeyHalfedge> endIncidentHalfEdges();
     KeyHalfedge next();
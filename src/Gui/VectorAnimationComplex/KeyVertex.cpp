@@ -20,6 +20,7 @@
 
 #include "../XmlStreamReader.h"
 #include "../XmlStreamWriter.h"
+#include "../StringTokenizer.h"
 
 namespace VectorAnimationComplex
 {
@@ -98,10 +99,10 @@ KeyVertex::KeyVertex(VAC * vac, XmlStreamReader & xml) :
     initColor();
 
     // Position
-    QString stringPos = xml.attributes().value("position").toString();
-    QStringList list = stringPos.split(" ");
-    pos_[0] = list[0].toDouble();
-    pos_[1] = list[1].toDouble();
+    QXmlStreamAttributes attributes = xml.attributes();
+    StringTokenizer tokenizer(attributes.value("position"));
+    pos_[0] = tokenizer.next().toDouble();
+    pos_[1] = tokenizer.next().toDouble();
 
     // Size
     //in >> field >> size_;
@@ -260,6 +261,10 @@ KeyVertexList KeyVertex::afterVertices() const
     return res;
 }
 
+void KeyVertex::appendBoundary(std::vector<Cell*> & /*out*/) const
+{
+}
+
 Eigen::Vector2d KeyVertex::catmullRomTangent(bool slowInOut) const
 {
     Eigen::Vector3d u(0,0,0);
@@ -327,7 +332,6 @@ void KeyVertex::setPos(const Eigen::Vector2d & pos)
 void KeyVertex::prepareDragAndDrop()
 {
     posBack_ = pos_;
-    //todo: store edge geometry
 }
 
 void KeyVertex::performDragAndDrop(double dx, double dy)
@@ -346,6 +350,11 @@ void KeyVertex::performAffineTransform(const Eigen::Affine2d & xf)
     setPos(xf * posBack_);
 }
 
+void KeyVertex::endAffineTransform()
+{
+    processGeometryChanged_();
+}
+
 bool KeyVertex::check_() const
 {
     // todo
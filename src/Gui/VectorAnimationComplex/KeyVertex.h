@@ -41,11 +41,17 @@ public:
     void performDragAndDrop(double dx, double dy);
     void prepareAffineTransform();
     void performAffineTransform(const Eigen::Affine2d & xf);
+    // Re-computes the cached geometry, which may have been transformed
+    // instead during the transform (see GeometryChangeTransaction)
+    void endAffineTransform();
 
     // For cubic spline interpolation
     KeyVertexList beforeVertices() const;
     KeyVertexList afterVertices() const;
 
+    // Reimplements Cell: key vertices have an empty boundary
+    void appendBoundary(std::vector<Cell*> & out) const;
+
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 
@@ -0,0 +1,396 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "KeyframeCorrespondence.h"
+
+#include "KeyVertex.h"
+#include "KeyEdge.h"
+#include "EdgeGeometry.h"
+#include "BoundingBox.h"
+
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+namespace VectorAnimationComplex
+{
+
+namespace
+{
+
+// Number of candidates considered for each cell of the first keyframe
+const int numCandidates = 8;
+
+// Weight of the length difference in the cost of matching two edges
+const double lengthWeight = 0.25;
+
+// Number of samples used to compute the centroid and area of closed edges
+const int numClosedEdgeSamples = 16;
+
+// Uniform grid over a set of points, used to find the points close to a
+// given position. Cells are roughly sized so that they contain one point on
+// average, and are stored contiguously.
+class PointGrid
+{
+public:
+    PointGrid(const QVector<Eigen::Vector2d> & points) :
+        nx_(1), ny_(1), cellSize_(1.0)
+    {
+        BoundingBox bb;
+        for(int i=0; i<points.size(); ++i)
+            bb.unite(BoundingBox(points[i][0], points[i][1]));
+        if(bb.isEmpty())
+        {
+            xMin_ = yMin_ = 0;
+            cellStart_.fill(0, 2);
+            return;
+        }
+
+        // Cell size, capped so that the grid doesn't get too large when
+        // points are very unevenly distributed
+        const int maxCellsPerSide = 1024;
+        xMin_ = bb.xMin();
+        yMin_ = bb.yMin();
+        double area = std::max(bb.width(), 1e-6) * std::max(bb.height(), 1e-6);
+        cellSize_ = std::sqrt(area / points.size());
+        cellSize_ = std::max(cellSize_, std::max(bb.width(), bb.height()) / maxCellsPerSide);
+        cellSize_ = std::max(cellSize_, 1e-6);
+        nx_ = std::min(maxCellsPerSide, (int) std::floor(bb.width() / cellSize_) + 1);
+        ny_ = std::min(maxCellsPerSide, (int) std::floor(bb.height() / cellSize_) + 1);
+
+        // Counting sort of the points by cell
+        QVector<int> cellOfPoint(points.size());
+        cellStart_.fill(0, nx_*ny_+1);
+        for(int k=0; k<points.size(); ++k)
+        {
+            cellOfPoint[k] = cellIndex_(clampedI_(points[k][0]), clampedJ_(points[k][1]));
+            ++cellStart_[cellOfPoint[k]+1];
+        }
+        for(int c=0; c<nx_*ny_; ++c)
+            cellStart_[c+1] += cellStart_[c];
+        items_.resize(points.size());
+        QVector<int> fill = cellStart_;
+        for(int k=0; k<points.size(); ++k)
+            items_[fill[cellOfPoint[k]]++] = k;
+    }
+
+    // Appends to out the indices of the points in the rings of cells around
+    // p, until at least k points are found, plus one more ring so that
+    // points across a cell boundary are not missed.
+    void candidates(const Eigen::Vector2d & p, int k, QVector<int> & out) const
+    {
+        out.clear();
+        int i0 = clampedI_(p[0]);
+        int j0 = clampedJ_(p[1]);
+        int maxRing = std::max(nx_, ny_);
+        int lastRing = maxRing;
+        for(int r=0; r<=lastRing; ++r)
+        {
+            for(int j=j0-r; j<=j0+r; ++j)
+            {
+                if(j<0 || j>=ny_)
+                    continue;
+                bool isBorderRow = (j == j0-r || j == j0+r);
+                int step = isBorderRow ? 1 : 2*r;
+                for(int i=i0-r; i<=i0+r; i+=std::max(step,1))
+                {
+                    if(i<0 || i>=nx_)
+                        continue;
+                    int c = cellIndex_(i,j);
+                    for(int m=cellStart_[c]; m<cellStart_[c+1]; ++m)
+                        out << items_[m];
+                }
+            }
+            if(out.size() >= k && lastRing == maxRing)
+                lastRing = std::min(maxRing, r+1);
+        }
+    }
+
+private:
+    int nx_;
+    int ny_;
+    double xMin_;
+    double yMin_;
+    double cellSize_;
+    QVector<int> cellStart_;
+    QVector<int> items_;
+
+    int cellIndex_(int i, int j) const { return j*nx_ + i; }
+    int clampedI_(double x) const
+    {
+        int i = (int) std::floor((x - xMin_) / cellSize_);
+        return std::max(0, std::min(nx_-1, i));
+    }
+    int clampedJ_(double y) const
+    {
+        int j = (int) std::floor((y - yMin_) / cellSize_);
+        return std::max(0, std::min(ny_-1, j));
+    }
+};
+
+// Shape descriptor of an edge. For closed edges, mid is the centroid.
+struct EdgeDescriptor
+{
+    KeyEdge * edge;
+    Eigen::Vector2d start;
+    Eigen::Vector2d mid;
+    Eigen::Vector2d end;
+    double length;
+    double signedArea;
+};
+
+Eigen::Vector2d samplePos(EdgeGeometry * geometry, double s)
+{
+    EdgeSample sample = geometry->pos(s);
+    return Eigen::Vector2d(sample.x(), sample.y());
+}
+
+EdgeDescriptor computeDescriptor(KeyEdge * edge)
+{
+    EdgeDescriptor res;
+    res.edge = edge;
+    res.signedArea = 0;
+
+    EdgeGeometry * geometry = edge->geometry();
+    double l = geometry->length();
+    res.length = l;
+    if(edge->isClosed())
+    {
+        res.mid = Eigen::Vector2d(0,0);
+        Eigen::Vector2d p = samplePos(geometry, 0);
+        for(int i=0; i<numClosedEdgeSamples; ++i)
+        {
+            Eigen::Vector2d q = samplePos(geometry, l * (i+1) / numClosedEdgeSamples);
+            res.mid += p;
+            res.signedArea += 0.5 * (p[0]*q[1] - q[0]*p[1]);
+            p = q;
+        }
+        res.mid /= numClosedEdgeSamples;
+        res.start = res.end = res.mid;
+    }
+    else
+    {
+        res.start = samplePos(geometry, 0);
+        res.mid = samplePos(geometry, 0.5*l);
+        res.end = samplePos(geometry, l);
+    }
+
+    return res;
+}
+
+// Cost of matching d1 with d2, and whether they have the same orientation
+double matchingCost(const EdgeDescriptor & d1, const EdgeDescriptor & d2, bool & sameOrientation)
+{
+    double cost = lengthWeight * std::abs(d1.length - d2.length);
+    if(d1.edge->isClosed())
+    {
+        sameOrientation = (d1.signedArea >= 0) == (d2.signedArea >= 0);
+        cost += (d1.mid - d2.mid).norm();
+    }
+    else
+    {
+        double midDistance = (d1.mid - d2.mid).norm();
+        double costSame = (d1.start - d2.start).norm() + midDistance + (d1.end - d2.end).norm();
+        double costReversed = (d1.start - d2.end).norm() + midDistance + (d1.end - d2.start).norm();
+        sameOrientation = costSame <= costReversed;
+        cost += std::min(costSame, costReversed) / 3;
+    }
+    return cost;
+}
+
+struct CandidatePair
+{
+    double cost;
+    int i;
+    int j;
+    bool sameOrientation;
+
+    bool operator<(const CandidatePair & other) const
+    {
+        // Ties are broken by index, so that the result doesn't depend on
+        // the implementation of std::sort
+        if(cost != other.cost)
+            return cost < other.cost;
+        if(i != other.i)
+            return i < other.i;
+        return j < other.j;
+    }
+};
+
+// Greedy matching of candidate pairs by increasing cost. Appends to out
+// the accepted pairs.
+void greedyMatching(QVector<CandidatePair> & candidatePairs, int n1, int n2,
+                    QVector<CandidatePair> & out)
+{
+    std::sort(candidatePairs.begin(), candidatePairs.end());
+    QVector<bool> isMatched1(n1, false);
+    QVector<bool> isMatched2(n2, false);
+    for(int k=0; k<candidatePairs.size(); ++k)
+    {
+        const CandidatePair & pair = candidatePairs[k];
+        if(!isMatched1[pair.i] && !isMatched2[pair.j])
+        {
+            isMatched1[pair.i] = true;
+            isMatched2[pair.j] = true;
+            out << pair;
+        }
+    }
+}
+
+// Matches edges of the same kind (open or closed)
+void matchEdges(const KeyEdgeList & edges1, const KeyEdgeList & edges2,
+                QList<KeyframeCorrespondence::EdgePair> & out)
+{
+    if(edges1.isEmpty() || edges2.isEmpty())
+        return;
+
+    QVector<EdgeDescriptor> descriptors1;
+    QVector<EdgeDescriptor> descriptors2;
+    QVector<Eigen::Vector2d> mids2;
+    descriptors1.reserve(edges1.size());
+    descriptors2.reserve(edges2.size());
+    mids2.reserve(edges2.size());
+    foreach(KeyEdge * e, edges1)
+        descriptors1 << computeDescriptor(e);
+    foreach(KeyEdge * e, edges2)
+    {
+        descriptors2 << computeDescriptor(e);
+        mids2 << descriptors2.last().mid;
+    }
+
+    PointGrid grid(mids2);
+    QVector<CandidatePair> candidatePairs;
+    candidatePairs.reserve(descriptors1.size() * numCandidates);
+    QVector<int> candidates;
+    for(int i=0; i<descriptors1.size(); ++i)
+    {
+        grid.candidates(descriptors1[i].mid, numCandidates, candidates);
+        for(int k=0; k<candidates.size(); ++k)
+        {
+            CandidatePair pair;
+            pair.i = i;
+            pair.j = candidates[k];
+            pair.cost = matchingCost(descriptors1[i], descriptors2[pair.j], pair.sameOrientation);
+            candidatePairs << pair;
+        }
+    }
+
+    QVector<CandidatePair> pairs;
+    greedyMatching(candidatePairs, descriptors1.size(), descriptors2.size(), pairs);
+    for(int k=0; k<pairs.size(); ++k)
+    {
+        KeyframeCorrespondence::EdgePair edgePair;
+        edgePair.e1 = descriptors1[pairs[k].i].edge;
+        edgePair.e2 = descriptors2[pairs[k].j].edge;
+        edgePair.sameOrientation = pairs[k].sameOrientation;
+        out << edgePair;
+    }
+}
+
+// Matches vertices by position
+void matchVertices(const KeyVertexList & vertices1, const KeyVertexList & vertices2,
+                   QList<KeyframeCorrespondence::VertexPair> & out)
+{
+    if(vertices1.isEmpty() || vertices2.isEmpty())
+        return;
+
+    QVector<Eigen::Vector2d> positions2;
+    positions2.reserve(vertices2.size());
+    foreach(KeyVertex * v, vertices2)
+        positions2 << v->pos();
+
+    PointGrid grid(positions2);
+    QVector<CandidatePair> candidatePairs;
+    QVector<int> candidates;
+    for(int i=0; i<vertices1.size(); ++i)
+    {
+        Eigen::Vector2d p = vertices1[i]->pos();
+        grid.candidates(p, numCandidates, candidates);
+        for(int k=0; k<candidates.size(); ++k)
+        {
+            CandidatePair pair;
+            pair.i = i;
+            pair.j = candidates[k];
+            pair.cost = (p - positions2[pair.j]).norm();
+            pair.sameOrientation = true;
+            candidatePairs << pair;
+        }
+    }
+
+    QVector<CandidatePair> pairs;
+    greedyMatching(candidatePairs, vertices1.size(), vertices2.size(), pairs);
+    for(int k=0; k<pairs.size(); ++k)
+    {
+        KeyframeCorrespondence::VertexPair vertexPair;
+        vertexPair.v1 = vertices1[pairs[k].i];
+        vertexPair.v2 = vertices2[pairs[k].j];
+        out << vertexPair;
+    }
+}
+
+// Splits edges into open and closed edges. The order of the input is kept,
+// so that the correspondence is deterministic given sorted inputs.
+void splitEdges(const KeyEdgeList & edges, KeyEdgeList & openEdges, KeyEdgeList & closedEdges)
+{
+    foreach(KeyEdge * e, edges)
+    {
+        if(e->isClosed())
+            closedEdges << e;
+        else
+            openEdges << e;
+    }
+}
+
+bool idLessThan(Cell * c1, Cell * c2)
+{
+    return c1->id() < c2->id();
+}
+
+}
+
+KeyframeCorrespondence::KeyframeCorrespondence(const KeyCellSet & cells1, const KeyCellSet & cells2)
+{
+    // Sort by id, since the iteration order of sets is arbitrary
+    KeyEdgeList edges1 = cells1;
+    KeyEdgeList edges2 = cells2;
+    KeyVertexList vertices1 = cells1;
+    KeyVertexList vertices2 = cells2;
+    std::sort(edges1.begin(), edges1.end(), idLessThan);
+    std::sort(edges2.begin(), edges2.end(), idLessThan);
+    std::sort(vertices1.begin(), vertices1.end(), idLessThan);
+    std::sort(vertices2.begin(), vertices2.end(), idLessThan);
+
+    // Edges
+    KeyEdgeList openEdges1, closedEdges1, openEdges2, closedEdges2;
+    splitEdges(edges1, openEdges1, closedEdges1);
+    splitEdges(edges2, openEdges2, closedEdges2);
+    matchEdges(openEdges1, openEdges2, edgePairs_);
+    matchEdges(closedEdges1, closedEdges2, edgePairs_);
+
+    // Vertices which are not already matched as end vertices of edges
+    KeyVertexSet matchedVertices;
+    foreach(const EdgePair & pair, edgePairs_)
+    {
+        if(!pair.e1->isClosed())
+        {
+            matchedVertices << pair.e1->startVertex() << pair.e1->endVertex()
+                            << pair.e2->startVertex() << pair.e2->endVertex();
+        }
+    }
+    KeyVertexList unmatchedVertices1;
+    KeyVertexList unmatchedVertices2;
+    foreach(KeyVertex * v, vertices1)
+        if(!matchedVertices.contains(v))
+            unmatchedVertices1 << v;
+    foreach(KeyVertex * v, vertices2)
+        if(!matchedVertices.contains(v))
+            unmatchedVertices2 << v;
+    matchVertices(unmatchedVertices1, unmatchedVertices2, vertexPairs_);
+}
+
+} // end namespace VectorAnimationComplex
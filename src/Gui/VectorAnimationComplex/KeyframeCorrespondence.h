@@ -0,0 +1,58 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef VAC_KEYFRAME_CORRESPONDENCE_H
+#define VAC_KEYFRAME_CORRESPONDENCE_H
+
+#include <QList>
+#include "CellList.h"
+
+namespace VectorAnimationComplex
+{
+
+// Spatial correspondence between the key cells of two keyframes, used to
+// inbetween them in bulk (see VAC::inbetweenKeyframes()).
+//
+// Edges are matched with edges of the same kind (open or closed), based on a
+// descriptor made of sample positions and length. Candidates are found with
+// a uniform grid over the sample positions, so that the cost is roughly
+// linear in the number of edges. Matching is greedy: candidate pairs are
+// accepted by increasing cost, as long as none of their edges is already
+// matched. Selected vertices which are not the end vertex of a matched edge
+// are matched by nearest position in the same way.
+//
+// Unmatched cells (e.g., when the keyframes don't have the same number of
+// edges) are simply left out.
+class KeyframeCorrespondence
+{
+public:
+    KeyframeCorrespondence(const KeyCellSet & cells1, const KeyCellSet & cells2);
+
+    struct EdgePair
+    {
+        KeyEdge * e1;
+        KeyEdge * e2;
+        bool sameOrientation; // side of e2 for the halfedge matching (e1,true)
+    };
+    const QList<EdgePair> & edgePairs() const { return edgePairs_; }
+
+    struct VertexPair
+    {
+        KeyVertex * v1;
+        KeyVertex * v2;
+    };
+    const QList<VertexPair> & vertexPairs() const { return vertexPairs_; }
+
+private:
+    QList<EdgePair> edgePairs_;
+    QList<VertexPair> vertexPairs_;
+};
+
+} // end namespace VectorAnimationComplex
+
+#endif // VAC_KEYFRAME_CORRESPONDENCE_H
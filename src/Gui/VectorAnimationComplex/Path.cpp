@@ -10,8 +10,10 @@
 #include "KeyVertex.h"
 #include "KeyEdge.h"
 #include "EdgeGeometry.h"
+#include "KeyHalfedge.h"
 #include "VAC.h"
 #include "../SaveAndLoad.h"
+#include "../StringTokenizer.h"
 
 #include <QMessageBox>
 
@@ -390,6 +392,11 @@ QString Path::toString() const
 }
 
 void Path::fromString(const QString & str)
+{
+    fromString(QStringRef(&str));
+}
+
+void Path::fromString(const QStringRef & str)
 {
     // Clear
     tempId_ = -1;
@@ -397,28 +404,28 @@ void Path::fromString(const QString & str)
     halfedges_.clear();
 
     // Split at ',', '[', ']', or any whitespace character
-    QStringList strList = str.split(QRegExp("[\\,\\s\\[\\]]"), QString::SkipEmptyParts);
+    StringTokenizer tokenizer(str, ",[]");
+    QStringRef firstStr = tokenizer.next();
+    if(firstStr.isEmpty())
+        return;
 
     // Get some info to determine cycle type
-    QString firstStr = strList[0];
     QChar c =  firstStr.at(firstStr.length()-1);
 
     // Switch depending on type
-    if(strList.size() == 1 && c != '+' && c != '-')
+    if(c != '+' && c != '-' && tokenizer.atEnd())
     {
         // Vertex
-        tempId_ = strList[0].toInt();
+        tempId_ = firstStr.toInt();
     }
     else
     {
         // Halfedges
-        int n = strList.size();
-        for(int i=0; i<n; ++i)
+        for(QStringRef token = firstStr; !token.isEmpty(); token = tokenizer.next())
         {
-            QString str = strList[i];
-            int l = str.length();
-            QChar side = str.at(l-1);
-            QString edge = str.left(l-1);
+            int l = token.length();
+            QChar side = token.at(l-1);
+            QStringRef edge = token.left(l-1);
 
             KeyHalfedge h;
             h.tempId_ = edge.toInt();
@@ -510,22 +517,11 @@ void Path::sample(int numSamples, QList<EdgeSample> & out) const
     }
     else
     {
-        assert(numSamples >= 2);
-        double ds = length()/(numSamples-1);
-
-        double cumulativeLength = 0;
-        int indexHe = 0;
-        KeyHalfedge he = halfedges_[indexHe];
+        std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > samples(numSamples);
+        KeyHalfedge::sampleUniformly(halfedges_, numSamples, samples.data());
+        out.reserve(numSamples);
         for(int i=0; i<numSamples; ++i)
-        {
-            double s = i*ds;
-            while ( (s > cumulativeLength + he.length()) && (indexHe+1 < halfedges_.size()) )
-            {
-                cumulativeLength += he.length();
-                he = halfedges_[++indexHe];
-            }
-            out << he.sample(s-cumulativeLength);
-        }
+            out << samples[i];
     }
 
 }
@@ -543,22 +539,11 @@ void Path::sample(int numSamples, QList<Eigen::Vector2d> & out) const
     }
     else
     {
-        assert(numSamples >= 2);
-        double ds = length()/(numSamples-1);
-
-        double cumulativeLength = 0;
-        int indexHe = 0;
-        KeyHalfedge he = halfedges_[indexHe];
+        std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > samples(numSamples);
+        KeyHalfedge::sampleUniformly(halfedges_, numSamples, samples.data());
+        out.reserve(numSamples);
         for(int i=0; i<numSamples; ++i)
-        {
-            double s = i*ds;
-            while ( (s > cumulativeLength + he.length()) && (indexHe+1 < halfedges_.size()) )
-            {
-                cumulativeLength += he.length();
-                he = halfedges_[++indexHe];
-            }
-            out << he.pos(s-cumulativeLength);
-        }
+            out << Eigen::Vector2d(samples[i].x(), samples[i].y());
     }
 }
 
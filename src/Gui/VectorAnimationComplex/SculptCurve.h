@@ -17,6 +17,10 @@
  *   - splitting       the curve in different sub-curves)
  *   - intersection    compute self-intersections and intersections with other curves
  *
+ * Intersections with other curves can also be computed against a CurveView,
+ * a read-only view of samples and arclengths stored elsewhere, so that the
+ * geometry of existing edges doesn't need to be copied into a Curve first.
+ *
  * The template parameter T represents a vertex of the curve. It must:
  *  - have the public members `x` and `y`
  *  - have the public members `width()`
@@ -81,6 +85,59 @@ struct Intersection
 };
 
 
+// Read-only view of the samples of a curve and of their arclengths, stored
+// elsewhere (see Curve::view()). The storage is not copied: it must outlive
+// the view, and must not be modified while the view is in use.
+template<class T>
+class CurveView
+{
+public:
+    CurveView() :
+        vertices_(0), arclengths_(0), size_(0), isClosed_(false) {}
+
+    CurveView(const T * vertices, const double * arclengths, int size, bool isClosed) :
+        vertices_(vertices), arclengths_(arclengths), size_(size), isClosed_(isClosed) {}
+
+    int size() const { return size_; }
+    bool isClosed() const { return isClosed_; }
+
+    const T & operator[] (int i) const { return vertices_[i]; }
+    double arclength(int i) const { return arclengths_[i]; }
+    double length() const { return size_ ? arclengths_[size_-1] : 0; }
+
+    T start() const { return size_ ? vertices_[0] : T(); }
+    T end() const { return size_ ? vertices_[size_-1] : T(); }
+
+    // Same as Curve::operator()(s)
+    T operator() (double s) const
+    {
+        assert(size_>0);
+        if(size_ == 1)
+            return vertices_[0];
+
+        // Binary search of the segment [i, i+1] containing s
+        int i = 0;
+        int j = size_-1;
+        while(j-i > 1)
+        {
+            int k = (i+j) / 2;
+            if(arclengths_[k] > s)
+                j = k;
+            else
+                i = k;
+        }
+        double u = (s - arclengths_[i]) / (arclengths_[j] - arclengths_[i]);
+        return vertices_[i].lerp(u,vertices_[j]);
+    }
+
+private:
+    const T * vertices_;
+    const double * arclengths_;
+    int size_;
+    bool isClosed_;
+};
+
+
 template<class T>
 class Curve
 {
@@ -112,6 +169,7 @@ public:
         p_.clear(); // raw input from mouse
         qTemp_.clear(); // temp vertices
         clearFits_();
+        cancelEndPointsDrag();
     }
 
     // must ensure that the first vertex is equal to the last
@@ -252,6 +310,26 @@ public:
     {
         return vertices_.size() + qTemp_.size();
     }
+
+    // Number of vertices which are final while sketching. The other ones
+    // are temporary: they are fitted again on each continueSketch()
+    int numFinalVertices() const
+    {
+        return vertices_.size();
+    }
+
+    // Number of bytes allocated to store the samples, arclengths, and
+    // sketching and sculpting temporaries
+    long long memoryUsage() const
+    {
+        return vertices_.capacity() * sizeof(T) +
+               arclengths_.capacity() * sizeof(double) +
+               restVertices_.capacity() * sizeof(T) +
+               restArclengths_.capacity() * sizeof(double) +
+               qTemp_.capacity() * sizeof(T) +
+               p_.capacity() * sizeof(Input) +
+               sculptTemp_.capacity() * sizeof(SculptTemp);
+    }
     T operator[] (int i) const
     {
         int k = i-vertices_.size();
@@ -266,6 +344,18 @@ public:
         return arclengths_[i];
     }
 
+    // Read-only view of the vertices and arclengths of this curve. Like the
+    // functions of the continuous curve below, ignores whatever is in qTemp.
+    // Invalidated by any modification of the curve
+    CurveView<T> view() const
+    {
+        if(vertices_.empty())
+            return CurveView<T>(0, 0, 0, isClosed_);
+
+        precomputeArclengths_();
+        return CurveView<T>(vertices_.data(), arclengths_.data(), vertices_.size(), isClosed_);
+    }
+
     T start() const
     {
         if(size())
@@ -592,6 +682,24 @@ public:
         setDirtyArclengths_();
     }
 
+    // Moves the vertices out of this curve, e.g. to store them elsewhere
+    // while the curve isn't used (see GeometryPager.h). The curve then has
+    // no vertices until they are given back by restoreVertices(), but keeps
+    // everything else. Arclengths are released too, and recomputed when
+    // needed.
+    void takeVertices(std::vector<T,Eigen::aligned_allocator<T> > & out)
+    {
+        out.clear();
+        out.swap(vertices_);
+        std::vector<double>().swap(arclengths_);
+        setDirtyArclengths_();
+    }
+    void restoreVertices(std::vector<T,Eigen::aligned_allocator<T> > & in)
+    {
+        vertices_.swap(in);
+        setDirtyArclengths_();
+    }
+
     // -------- Continuous curve --------
 
     // Note: these functions ignore whatever is in qTemp
@@ -613,6 +721,44 @@ public:
             return interpolatedVertex_(s);
     }
 
+    // Same as out[k] = (*this)(s[k]) for k in [0, n), but the arclengths
+    // s[k] must be sorted, in increasing or decreasing order. Instead of
+    // searching the whole curve for each of them, this walks the vertices
+    // and the arclengths together: O(n + size()) instead of O(n log size())
+    void evaluate(const double * s, int n, T * out) const
+    {
+        int m = vertices_.size();
+        assert(m>0);
+        if(m == 1)
+        {
+            for(int k=0; k<n; ++k)
+                out[k] = vertices_.front();
+            return;
+        }
+
+        precomputeArclengths_();
+
+        // Invariant: s[k] is evaluated on the segment [i, i+1]. Like in
+        // interpolatedVertex_(), values outside [0, length()] extrapolate
+        // the first or last segment
+        int i = 0;
+        if(n > 0 && s[0] > arclengths_[m-1] / 2)
+            i = m-2;
+        for(int k=0; k<n; ++k)
+        {
+            double sk = s[k];
+            while(i < m-2 && sk >= arclengths_[i+1])
+                ++i;
+            while(i > 0 && sk < arclengths_[i])
+                --i;
+
+            double si = arclengths_[i];
+            double sj = arclengths_[i+1];
+            double u = (sk - si) / (sj - si);
+            out[k] = vertices_[i].lerp(u,vertices_[i+1]);
+        }
+    }
+
     // -------- Apply affine transform --------
 
 
@@ -623,7 +769,9 @@ public:
         return res;
     }
 
-    void transform(const Eigen::Affine2d & xf)
+    // If resampleAfter is false, the vertices are transformed as is, and
+    // calling resample(true) later gives the same result
+    void transform(const Eigen::Affine2d & xf, bool resampleAfter = true)
     {
         for (unsigned int i=0; i<vertices_.size(); ++i)
         {
@@ -633,7 +781,10 @@ public:
             vertices_[i].setY(p[1]);
         }
 
-        resample(true);
+        if(resampleAfter)
+            resample(true);
+        else
+            setDirtyArclengths_();
     }
 
     // -------- Sculpting --------
@@ -868,6 +1019,23 @@ public:
         resample(true);
     }
 
+    // get the range [first, last] of vertices moved by continueSculptDeform().
+    // Returns false if no vertex is moved.
+    bool sculptDeformRange(int & first, int & last) const
+    {
+        if(sculptTemp_.empty())
+            return false;
+
+        first = sculptTemp_[0].i;
+        last = first;
+        for(const auto & v: sculptTemp_)
+        {
+            first = std::min(first, v.i);
+            last = std::max(last, v.i);
+        }
+        return true;
+    }
+
     // apply a smooth filter of radius sculptRadius_ and intensity intensity at sculptVertex_
     void sculptSmooth(double intensity)
     {
@@ -1076,9 +1244,14 @@ public:
     // Includes "virtual intersections": when extending the end of the curve by tolerance would create a new intersection.
     // Return value not sorted.
     std::vector<Intersection> intersections(const SculptCurve::Curve<T> & other, double tolerance = 15.0) const
+    {
+        return intersections(other.view(), tolerance);
+    }
+
+    // Same as above, with the other curve given as a view of its samples
+    std::vector<Intersection> intersections(const CurveView<T> & other, double tolerance = 15.0) const
     {
         precomputeArclengths_();
-        other.precomputeArclengths_();
 
         std::vector<Intersection> res;
 
@@ -1110,7 +1283,7 @@ public:
                 if(doIntersect)
                 {
                     double s = (1-u)*arclengths_[i] + u*arclengths_[i+1];
-                    double t = (1-v)*other.arclengths_[j] + v*other.arclengths_[j+1];
+                    double t = (1-v)*other.arclength(j) + v*other.arclength(j+1);
                     res.push_back(Intersection(s,t));
 
                     // update min/max
@@ -1141,7 +1314,7 @@ public:
                 if(doIntersect)
                 {
                     double s = 0;
-                    double t = (1-v)*other.arclengths_[j] + v*other.arclengths_[j+1];
+                    double t = (1-v)*other.arclength(j) + v*other.arclength(j+1);
                     res.push_back(Intersection(s,t));
 
                     // update min/max
@@ -1170,7 +1343,7 @@ public:
                 if(doIntersect)
                 {
                     double s = l;
-                    double t = (1-v)*other.arclengths_[j] + v*other.arclengths_[j+1];
+                    double t = (1-v)*other.arclength(j) + v*other.arclength(j+1);
                     res.push_back(Intersection(s,t));
 
                     // update min/max
@@ -1185,9 +1358,9 @@ public:
                 }
             }
         }
-        if(minT > tolerance && !other.isClosed_) // start of other
+        if(minT > tolerance && !other.isClosed()) // start of other
         {
-            T va = other.vertices_.front();
+            T va = other.start();
             T ve = other(tolerance);
             T vb = ve.lerp(2.0, va);
             for(int i=0; i<n-1; ++i)
@@ -1214,9 +1387,9 @@ public:
                 }
             }
         }
-        if(maxS < l-tolerance && !other.isClosed_) // end of this
+        if(maxS < l-tolerance && !other.isClosed()) // end of this
         {
-            T va = other.vertices_.back();
+            T va = other.end();
             T ve = other(lOther-tolerance);
             T vb = ve.lerp(2.0, va);
             for(int i=0; i<n-1; ++i)
@@ -1603,10 +1776,73 @@ public:
         resample(true);
     }
 
+    // Same as setEndPoints(), but the displacement is always applied to the
+    // rest shape snapshotted by beginEndPointsDrag(), and the curve is only
+    // resampled by endEndPointsDrag(). This way, repeated calls during a drag
+    // neither reallocate nor accumulate resampling drift.
+    void beginEndPointsDrag()
+    {
+        int n = vertices_.size();
+        if(n == 0 || qTemp_.size() > 0)
+            return;
+
+        precomputeArclengths_();
+        restVertices_.assign(vertices_.begin(), vertices_.end());
+        restArclengths_.resize(n);
+        double l = arclengths_[n-1];
+        double invL = l > 0 ? 1.0 / l : 0.0;
+        for(int i=0; i<n; ++i)
+            restArclengths_[i] = arclengths_[i] * invL;
+    }
+
+    void setEndPointsFromRest(const T & newStart, const T & newEnd)
+    {
+        int n = restVertices_.size();
+        if(n == 0 || n != (int) vertices_.size())
+        {
+            // No drag in progress, or curve changed since the snapshot
+            setEndPoints(newStart, newEnd);
+            return;
+        }
+
+        T dStart = newStart - restVertices_[0];
+        T dEnd = newEnd - restVertices_[n-1];
+        const T * rest = restVertices_.data();
+        const double * u = restArclengths_.data();
+        T * out = vertices_.data();
+        for(int i=0; i<n; ++i)
+            out[i] = rest[i] + dStart.lerp(u[i], dEnd);
+
+        setDirtyArclengths_();
+    }
+
+    void endEndPointsDrag()
+    {
+        if(restVertices_.empty())
+            return;
+
+        cancelEndPointsDrag();
+        resample(true);
+    }
+
+    // Abandons the drag in progress, if any: the rest shape is released and
+    // the samples are left as they are, without resampling
+    void cancelEndPointsDrag()
+    {
+        std::vector<T,Eigen::aligned_allocator<T> >().swap(restVertices_);
+        std::vector<double>().swap(restArclengths_);
+    }
+
+    bool isEndPointsDragging() const { return !restVertices_.empty(); }
+
 private:
     // Sampled curve: the one that is exposed to the user
     std::vector<T,Eigen::aligned_allocator<T> > vertices_;
 
+    // Rest shape of an end points drag, with normalized arclengths
+    std::vector<T,Eigen::aligned_allocator<T> > restVertices_;
+    std::vector<double> restArclengths_;
+
     // Arc-length precomputation
     mutable std::vector<double> arclengths_;
     mutable bool dirtyArclengths_;
@@ -0,0 +1,259 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "SpaceTimeSurface.h"
+
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace VectorAnimationComplex
+{
+
+namespace
+{
+
+// Computes time slices of the surface on demand, restricted to the kept
+// columns, and selects which of them to keep
+class SliceSampler
+{
+public:
+    SliceSampler(const SpaceTimeSurface::Input & input, const std::vector<int> & columns) :
+        input_(input),
+        columns_(columns),
+        slices_(input.numIntervals() + 1)
+    {
+        const int n = input.beforeSampling.size();
+        isWarped_ = input.startPositions.size() == slices_.size() &&
+                    input.endPositions.size() == slices_.size();
+        startBefore_ = input.beforeSampling[0];
+        startAfter_ = input.afterSampling[0];
+        endBefore_ = input.beforeSampling[n-1];
+        endAfter_ = input.afterSampling[n-1];
+        invLastIndex_ = 1.0 / (n-1);
+    }
+
+    const SpaceTimeSurface::Vector2dList & slice(int i)
+    {
+        SpaceTimeSurface::Vector2dList & res = slices_[i];
+        if (!res.empty())
+            return res;
+
+        double dt = input_.t2 - input_.t1;
+        double u = dt > 0 ? (input_.gridTime(i) - input_.t1) / dt : 0;
+
+        Eigen::Vector2d dStart(0, 0);
+        Eigen::Vector2d dEnd(0, 0);
+        if (isWarped_)
+        {
+            dStart = input_.startPositions[i] - (startBefore_ + u * (startAfter_ - startBefore_));
+            dEnd = input_.endPositions[i] - (endBefore_ + u * (endAfter_ - endBefore_));
+        }
+
+        res.reserve(columns_.size());
+        for (int j: columns_)
+        {
+            const Eigen::Vector2d & b = input_.beforeSampling[j];
+            const Eigen::Vector2d & a = input_.afterSampling[j];
+            Eigen::Vector2d p = b + u * (a - b);
+            if (isWarped_)
+            {
+                double w = j * invLastIndex_;
+                p += (1-w) * dStart + w * dEnd;
+            }
+            res.push_back(p);
+        }
+        return res;
+    }
+
+    // Appends to out the grid indices of the slices to keep in [a, b),
+    // knowing that b-a >= 1
+    void refine(int a, int b, std::vector<int> & out)
+    {
+        if (b - a > 1)
+        {
+            int m = (a + b) / 2;
+            const SpaceTimeSurface::Vector2dList & pa = slice(a);
+            const SpaceTimeSurface::Vector2dList & pm = slice(m);
+            const SpaceTimeSurface::Vector2dList & pb = slice(b);
+
+            // Going through the middle slice detects back and forth motions
+            double motion = 0;
+            for (unsigned int j = 0; j < pa.size(); ++j)
+                motion = std::max(motion, (pm[j] - pa[j]).norm() + (pb[j] - pm[j]).norm());
+
+            if (motion > input_.parameters.maxDisplacement)
+            {
+                refine(a, m, out);
+                refine(m, b, out);
+                return;
+            }
+        }
+        out.push_back(a);
+    }
+
+private:
+    const SpaceTimeSurface::Input & input_;
+    const std::vector<int> & columns_;
+    std::vector<SpaceTimeSurface::Vector2dList> slices_;
+    bool isWarped_;
+    Eigen::Vector2d startBefore_, startAfter_, endBefore_, endAfter_;
+    double invLastIndex_;
+};
+
+}
+
+SpaceTimeSurface::Parameters::Parameters() :
+    slicesPerFrame(1),
+    columnStride(1),
+    maxDisplacement(5.0),
+    scale(1, 1, 1),
+    offset(0, 0, 0)
+{
+}
+
+bool SpaceTimeSurface::Parameters::operator==(const Parameters & other) const
+{
+    return slicesPerFrame == other.slicesPerFrame &&
+           columnStride == other.columnStride &&
+           maxDisplacement == other.maxDisplacement &&
+           scale == other.scale &&
+           offset == other.offset;
+}
+
+int SpaceTimeSurface::Input::numIntervals() const
+{
+    int k = std::max(1, parameters.slicesPerFrame);
+    return std::max(1, (int) std::ceil((t2 - t1) * k - 1e-5));
+}
+
+double SpaceTimeSurface::Input::gridTime(int i) const
+{
+    int n = numIntervals();
+    return i == n ? t2 : t1 + (t2 - t1) * i / n;
+}
+
+SpaceTimeSurface::SpaceTimeSurface() :
+    isBuilt_(false),
+    numColumns_(0)
+{
+}
+
+void SpaceTimeSurface::clear()
+{
+    isBuilt_ = false;
+    positions_.clear();
+    normals_.clear();
+    indices_.clear();
+    sliceTimes_.clear();
+    numColumns_ = 0;
+}
+
+void SpaceTimeSurface::build(const Input & input)
+{
+    clear();
+    parameters_ = input.parameters;
+    isBuilt_ = true;
+
+    const int n = input.beforeSampling.size();
+    if (n < 2 || (int) input.afterSampling.size() != n)
+        return;
+
+    // Columns: every columnStride sample, plus the last one
+    std::vector<int> columns;
+    int stride = std::max(1, input.parameters.columnStride);
+    for (int j = 0; j < n-1; j += stride)
+        columns.push_back(j);
+    columns.push_back(n-1);
+    const int C = columns.size();
+    numColumns_ = C;
+
+    // Time slices
+    SliceSampler sampler(input, columns);
+    std::vector<int> sliceIndices;
+    sampler.refine(0, input.numIntervals(), sliceIndices);
+    sliceIndices.push_back(input.numIntervals());
+    const int S = sliceIndices.size();
+
+    // Positions
+    const Eigen::Vector3d & scale = input.parameters.scale;
+    const Eigen::Vector3d & offset = input.parameters.offset;
+    positions_.reserve(S * C);
+    sliceTimes_.reserve(S);
+    for (int i: sliceIndices)
+    {
+        double t = input.gridTime(i);
+        sliceTimes_.push_back(t);
+        for (const Eigen::Vector2d & p: sampler.slice(i))
+            positions_.push_back(scale.cwiseProduct(Eigen::Vector3d(p[0], p[1], t)) + offset);
+    }
+
+    // Triangles, from the last slice to the first. The winding and normals
+    // are the ones of the quad strips previously drawn by InbetweenEdge
+    indices_.reserve(6 * (S-1) * (C-1));
+    normals_.assign(S * C, Eigen::Vector3d(0, 0, 0));
+    for (int i = S-2; i >= 0; --i)
+    {
+        for (int j = 0; j < C-1; ++j)
+        {
+            unsigned int a = i*C + j;
+            unsigned int b = a + 1;
+            unsigned int c = a + C;
+            unsigned int d = c + 1;
+            const unsigned int tris[6] = {a, c, b, b, c, d};
+            for (int k = 0; k < 6; k += 3)
+            {
+                unsigned int p = tris[k], q = tris[k+1], r = tris[k+2];
+                Eigen::Vector3d N = (positions_[q] - positions_[p]).cross(positions_[r] - positions_[p]);
+                normals_[p] += N;
+                normals_[q] += N;
+                normals_[r] += N;
+                indices_.push_back(p);
+                indices_.push_back(q);
+                indices_.push_back(r);
+            }
+        }
+    }
+    for (Eigen::Vector3d & N: normals_)
+    {
+        double l = N.norm();
+        if (l > 0)
+            N /= l;
+    }
+}
+
+void SpaceTimeSurface::buildAll(const std::vector<const Input *> & inputs,
+                                const std::vector<SpaceTimeSurface *> & surfaces)
+{
+    const int n = std::min(inputs.size(), surfaces.size());
+    std::atomic<int> next(0);
+    auto work = [&]()
+    {
+        for (int i = next++; i < n; i = next++)
+            surfaces[i]->build(*inputs[i]);
+    };
+
+    int numThreads = std::min(n, (int) std::thread::hardware_concurrency()) - 1;
+    std::vector<std::thread> threads;
+    for (int k = 0; k < numThreads; ++k)
+        threads.emplace_back(work);
+    work();
+    for (std::thread & thread: threads)
+        thread.join();
+}
+
+long long SpaceTimeSurface::memoryUsage() const
+{
+    return positions_.capacity() * sizeof(Eigen::Vector3d) +
+           normals_.capacity() * sizeof(Eigen::Vector3d) +
+           indices_.capacity() * sizeof(unsigned int) +
+           sliceTimes_.capacity() * sizeof(double);
+}
+
+} // end namespace VectorAnimationComplex
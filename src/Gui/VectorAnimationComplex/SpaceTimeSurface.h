@@ -0,0 +1,116 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef VAC_SPACE_TIME_SURFACE_H
+#define VAC_SPACE_TIME_SURFACE_H
+
+#include "Eigen.h"
+#include <vector>
+
+namespace VectorAnimationComplex
+{
+
+// Indexed triangle mesh of the surface swept by an inbetween edge in
+// space-time, as drawn by the 3D view.
+//
+// The key paths are resampled once, then each time slice is the linear
+// interpolation of the two samplings, warped so that open edges follow their
+// animated end vertices (see InbetweenEdge::getGeometry()). Time slices are
+// a subset of a regular grid: consecutive slices are refined by bisection
+// until no sample moves by more than maxDisplacement in between, so slow or
+// still edges get a few slices only.
+//
+// This class doesn't depend on the VAC nor on OpenGL: all the inputs are
+// gathered beforehand, which allows to build several surfaces concurrently
+// (see buildAll()).
+class SpaceTimeSurface
+{
+public:
+    typedef std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > Vector2dList;
+    typedef std::vector<Eigen::Vector3d> Vector3dList;
+
+    // Parameters which don't depend on the edge, e.g., from View3DSettings
+    struct Parameters
+    {
+        Parameters();
+
+        int slicesPerFrame;     // resolution of the grid of time slices
+        int columnStride;       // only keep one sample every columnStride
+        double maxDisplacement; // max motion of a sample between two slices
+
+        // Mapping from (x, y, t) to 3D: scale.cwiseProduct(x,y,t) + offset
+        Eigen::Vector3d scale;
+        Eigen::Vector3d offset;
+
+        bool operator==(const Parameters & other) const;
+        bool operator!=(const Parameters & other) const { return !(*this == other); }
+    };
+
+    struct Input
+    {
+        Parameters parameters;
+
+        // Time interval
+        double t1;
+        double t2;
+
+        // Uniform samplings of the before and after key paths, of same size
+        Vector2dList beforeSampling;
+        Vector2dList afterSampling;
+
+        // For open edges, positions of the start and end vertices at each
+        // time of the grid, i.e. at gridTime(i) for i in [0, numIntervals()].
+        // Left empty for closed edges, which are not warped
+        Vector2dList startPositions;
+        Vector2dList endPositions;
+
+        // Number of intervals of the grid of time slices
+        int numIntervals() const;
+        double gridTime(int i) const;
+    };
+
+    SpaceTimeSurface();
+
+    // Replaces the mesh by the one computed from input
+    void build(const Input & input);
+
+    // Builds surfaces[i] from inputs[i], using all available cores
+    static void buildAll(const std::vector<const Input *> & inputs,
+                         const std::vector<SpaceTimeSurface *> & surfaces);
+
+    // Empties the mesh. isBuilt() returns false until the next build()
+    void clear();
+
+    bool isBuilt() const { return isBuilt_; }
+    const Parameters & parameters() const { return parameters_; }
+
+    // Mesh, in 3D coordinates. Vertex (i,j) of time slice i and sample j is
+    // at index i*numColumns()+j. Triangles are ordered from the last time
+    // slice to the first, which makes it more likely that transparent
+    // surfaces are drawn from rear to near
+    const Vector3dList & positions() const { return positions_; }
+    const Vector3dList & normals() const { return normals_; }
+    const std::vector<unsigned int> & indices() const { return indices_; }
+    const std::vector<double> & sliceTimes() const { return sliceTimes_; }
+    int numColumns() const { return numColumns_; }
+
+    long long memoryUsage() const;
+
+private:
+    Parameters parameters_;
+    bool isBuilt_;
+    Vector3dList positions_;
+    Vector3dList normals_;
+    std::vector<unsigned int> indices_;
+    std::vector<double> sliceTimes_;
+    int numColumns_;
+};
+
+} // end namespace VectorAnimationComplex
+
+#endif // VAC_SPACE_TIME_SURFACE_H
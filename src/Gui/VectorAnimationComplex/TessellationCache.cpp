@@ -0,0 +1,150 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TessellationCache.h"
+#include "../MemoryUsage.h"
+
+#include <cstring>
+
+namespace VectorAnimationComplex
+{
+
+namespace
+{
+// Finalizer of splitmix64, used to mix each word into the hash
+inline quint64 mix(quint64 x)
+{
+    x ^= x >> 30;
+    x *= Q_UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= Q_UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+    return x;
+}
+
+// Overhead of a cache entry: list node, hash node, and Triangles and
+// TessellationKey objects
+const qint64 entryOverhead = 2 * sizeof(void*) + sizeof(Triangles) + sizeof(TessellationKey) +
+                             sizeof(qint64) + 3 * sizeof(void*) + sizeof(quint64);
+}
+
+TessellationKey::TessellationKey(Kind kind) :
+    hash_(mix((quint64) kind))
+{
+    words_.push_back((quint64) kind);
+}
+
+void TessellationKey::add(quint64 x)
+{
+    // Order-dependent combination, so that permuted samples give
+    // different hashes
+    hash_ = mix(hash_ ^ (x + Q_UINT64_C(0x9e3779b97f4a7c15) + (hash_ << 6) + (hash_ >> 2)));
+    words_.push_back(x);
+}
+
+void TessellationKey::add(double x)
+{
+    // Make 0.0 and -0.0 share their key, since they tessellate the same
+    if (x == 0.0)
+        x = 0.0;
+    quint64 bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    add(bits);
+}
+
+quint64 TessellationKey::value() const
+{
+    return mix(hash_ ^ (quint64) words_.size());
+}
+
+TessellationCache::TessellationCache() :
+    numBytes_(0),
+    maxBytes_(128 * 1024 * 1024)
+{
+}
+
+TessellationCache * TessellationCache::instance()
+{
+    static TessellationCache cache;
+    return &cache;
+}
+
+bool TessellationCache::find(const TessellationKey & key, Triangles & out)
+{
+    auto it = index_.find(key.value());
+    if (it == index_.end() || it.value()->key != key)
+    {
+        if (it != index_.end())
+            ++counters_.numCollisions;
+        ++counters_.numMisses;
+        return false;
+    }
+
+    // Move to front
+    entries_.splice(entries_.begin(), entries_, it.value());
+    out = it.value()->triangles;
+    ++counters_.numHits;
+    return true;
+}
+
+void TessellationCache::insert(const TessellationKey & key, const Triangles & triangles)
+{
+    if (triangles.size() == 0)
+        return;
+
+    quint64 k = key.value();
+    auto it = index_.find(k);
+    if (it != index_.end())
+    {
+        numBytes_ -= it.value()->numBytes;
+        entries_.erase(it.value());
+        index_.erase(it);
+    }
+
+    Entry entry(key);
+    entry.triangles = triangles;
+    entry.numBytes = (qint64) entry.triangles.capacity() * sizeof(Triangle) +
+                     entry.key.numBytes() + entryOverhead;
+    entries_.push_front(entry);
+    index_.insert(k, entries_.begin());
+    numBytes_ += entry.numBytes;
+
+    evict_();
+}
+
+void TessellationCache::clear()
+{
+    entries_.clear();
+    index_.clear();
+    numBytes_ = 0;
+}
+
+void TessellationCache::setMaxBytes(qint64 maxBytes)
+{
+    maxBytes_ = maxBytes;
+    evict_();
+}
+
+void TessellationCache::evict_()
+{
+    while (numBytes_ > maxBytes_ && !entries_.empty())
+    {
+        const Entry & entry = entries_.back();
+        numBytes_ -= entry.numBytes;
+        index_.remove(entry.key.value());
+        entries_.pop_back();
+        ++counters_.numEvictions;
+    }
+}
+
+void TessellationCache::addMemoryUsage(MemoryUsage & usage) const
+{
+    usage.add("Tessellation cache", "Triangles", numBytes_, entries_.size());
+}
+
+} // end namespace VectorAnimationComplex
@@ -0,0 +1,128 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef VAC_TESSELLATION_CACHE_H
+#define VAC_TESSELLATION_CACHE_H
+
+#include "Triangles.h"
+#include "EdgeSample.h"
+#include <QHash>
+#include <list>
+#include <vector>
+
+class MemoryUsage;
+
+namespace VectorAnimationComplex
+{
+
+// Everything that determines the output of a tessellation, e.g. the samples
+// of an edge or the boundary polygons of a face, and its hash. Two cells with
+// equal keys have the same triangles, whatever their identity. The cache is
+// indexed by hash, but keys are compared word by word, so that two different
+// keys with the same hash never share their triangles.
+class TessellationKey
+{
+public:
+    // The kind prevents different tessellations of the same inputs (e.g., an
+    // edge with its own width or with a fixed width) from sharing a key
+    enum Kind
+    {
+        EdgeTriangles = 1,
+        EdgeTopologyTriangles,
+        FaceTriangles
+    };
+    TessellationKey(Kind kind);
+
+    void add(quint64 x);
+    void add(int x) { add((quint64) (qint64) x); }
+    void add(bool x) { add((quint64) (x ? 1 : 0)); }
+    void add(double x);
+    void add(const EdgeSample & s) { add(s.x()); add(s.y()); add(s.width()); }
+
+    // Hash of the key
+    quint64 value() const;
+
+    bool operator==(const TessellationKey & other) const { return words_ == other.words_; }
+    bool operator!=(const TessellationKey & other) const { return words_ != other.words_; }
+
+    // Bytes used to store the key in the cache
+    qint64 numBytes() const { return words_.capacity() * sizeof(quint64); }
+
+private:
+    quint64 hash_;
+    std::vector<quint64> words_; // kind, then all added words
+};
+
+// Process-wide cache of tessellations, shared by all cells of all VACs.
+//
+// The per-cell caches (Cell::triangles_, EdgeCell::trianglesTopo_) are lost
+// whenever cells are re-created: undo/redo (which copies the whole scene),
+// VAC::clone(), paste and import. Key cells look up this cache before
+// tessellating, so that re-created cells whose geometry didn't change get
+// their triangles back for the cost of hashing their inputs.
+//
+// Entries are evicted in least recently used order once the total size of
+// the cached triangles exceeds maxBytes(). Must only be used from the GUI
+// thread.
+class TessellationCache
+{
+public:
+    static TessellationCache * instance();
+
+    // Copies the cached triangles into out and returns true if key is
+    // cached. Otherwise, returns false and leaves out unchanged. A cached key
+    // with the same hash but a different content is a miss (collision)
+    bool find(const TessellationKey & key, Triangles & out);
+
+    // Caches a copy of triangles. Empty tessellations are not cached since
+    // they are already cheap to compute. Replaces the cached key with the
+    // same hash, if any
+    void insert(const TessellationKey & key, const Triangles & triangles);
+
+    void clear();
+
+    qint64 maxBytes() const { return maxBytes_; }
+    void setMaxBytes(qint64 maxBytes);
+
+    struct Counters
+    {
+        Counters() : numHits(0), numMisses(0), numEvictions(0), numCollisions(0) {}
+        int numHits;
+        int numMisses;      // including collisions
+        int numEvictions;
+        int numCollisions;  // misses on a cached key with the same hash
+    };
+    const Counters & counters() const { return counters_; }
+    void resetCounters() { counters_ = Counters(); }
+
+    void addMemoryUsage(MemoryUsage & usage) const;
+
+private:
+    TessellationCache();
+
+    struct Entry
+    {
+        Entry(const TessellationKey & key) : key(key), numBytes(0) {}
+        TessellationKey key;
+        Triangles triangles;
+        qint64 numBytes;
+    };
+    typedef std::list<Entry, Eigen::aligned_allocator<Entry> > EntryList;
+
+    EntryList entries_; // most recently used first
+    QHash<quint64, EntryList::iterator> index_;
+    qint64 numBytes_;
+    qint64 maxBytes_;
+    Counters counters_;
+
+    void evict_();
+};
+
+} // end namespace VectorAnimationComplex
+
+#endif // VAC_TESSELLATION_CACHE_H
@@ -881,6 +881,20 @@ void TransformTool::beginTransform(double x0, double y0, Time time)
         // XXX add the non-loop edges whose end vertices are dragged?
         draggedVertices_ = KeyVertexSet(cellsToTransform);
         draggedEdges_ = KeyEdgeSet(cellsToTransform);
+        transformedCells_ = cellsToTransform;
+        previousXf_ = Eigen::Affine2d::Identity();
+
+        // The end vertices of dragged edges are dragged as well, so only the
+        // other edges incident to dragged vertices need to be corrected
+        correctedEdges_.clear();
+        foreach(KeyVertex * v, draggedVertices_)
+        {
+            foreach(KeyEdge * e, KeyEdgeSet(v->spatialStar()))
+            {
+                if(!draggedEdges_.contains(e))
+                    correctedEdges_ << e;
+            }
+        }
 
         // prepare for affine transform
         foreach(KeyEdge * e, draggedEdges_)
@@ -1041,15 +1055,23 @@ void TransformTool::continueTransform(double x, double y)
         Eigen::Translation2d pivot(xPivot, yPivot);
         xf = pivot * xf * pivot.inverse();
 
-        // Apply affine transformation
+        // Apply affine transformation, propagating geometry changes once.
+        // Dragged edges are only resampled by endTransform(), and meanwhile,
+        // cached triangles are transformed rather than re-computed when
+        // possible (rigid transformations, or faces)
+        VAC * vac = cells_.isEmpty() ? 0 : (*cells_.begin())->vac();
+        GeometryChangeTransaction geometryChange(vac);
         foreach(KeyEdge * e, draggedEdges_)
             e->performAffineTransform(xf);
 
         foreach(KeyVertex * v, draggedVertices_)
             v->performAffineTransform(xf);
 
-        foreach(KeyVertex * v, draggedVertices_)
-            v->correctEdgesGeometry();
+        foreach(KeyEdge * e, correctedEdges_)
+            e->correctGeometry();
+
+        geometryChange.transformCachedGeometry(transformedCells_, xf * previousXf_.inverse());
+        previousXf_ = xf;
 
         // Apply transformation to manual pivot point
         if (manualPivot_)
@@ -1063,6 +1085,23 @@ void TransformTool::continueTransform(double x, double y)
 
 void TransformTool::endTransform()
 {
+    // Resample dragged edges, and re-compute the exact triangles of all
+    // transformed cells, whose cached triangles may have been transformed
+    // during the drag. For instance, vertex triangles would be rotated
+    // instead of aligned with the axes
+    if(!transformedCells_.isEmpty())
+    {
+        GeometryChangeTransaction geometryChange((*transformedCells_.begin())->vac());
+        foreach(KeyEdge * e, draggedEdges_)
+            e->endAffineTransform();
+        foreach(KeyVertex * v, draggedVertices_)
+            v->endAffineTransform();
+    }
+    draggedVertices_.clear();
+    draggedEdges_.clear();
+    correctedEdges_.clear();
+    transformedCells_.clear();
+
     draggingManualPivot_ = false;
     transforming_ = false;
     rotating_ = false;
@@ -143,6 +143,9 @@ private:
     bool isTransformConstrained_() const;
     KeyVertexSet draggedVertices_;
     KeyEdgeSet draggedEdges_;
+    KeyEdgeSet correctedEdges_;   // not transformed, but incident to dragged vertices
+    CellSet transformedCells_;
+    Eigen::Affine2d previousXf_;  // applied to cached geometry so far
     double x0_, y0_, dx_, dy_, x_, y_;
     BoundingBox bb0_, obb0_;
     double dTheta_;
@@ -169,6 +169,16 @@ BoundingBox Triangles::boundingBox() const
     return bb;
 }
 
+void Triangles::transform(const Eigen::Affine2d & xf)
+{
+    for (Triangle & t : triangles_)
+    {
+        t.a = xf * t.a;
+        t.b = xf * t.b;
+        t.c = xf * t.c;
+    }
+}
+
 void Triangles::draw() const
 {
     glBegin(GL_TRIANGLES);
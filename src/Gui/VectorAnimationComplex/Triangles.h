@@ -81,6 +81,7 @@ public:
 
     // Access and modify content
     inline int size() const {return triangles_.size();}
+    inline int capacity() const {return triangles_.capacity();}
     inline Triangle & operator[] (int i) {return triangles_[i];}
 
     // Access raw data
@@ -95,6 +96,9 @@ public:
     // Compute bounding box
     BoundingBox boundingBox() const;
 
+    // Apply an affine transformation to all triangles
+    void transform(const Eigen::Affine2d & xf);
+
     // Draw
     void draw() const;
     void draw3D(Time t, View3DSettings & viewSettings) const;
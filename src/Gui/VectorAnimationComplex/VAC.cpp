@@ -29,7 +29,9 @@
 
 #include "EdgeSample.h"
 #include "EdgeGeometry.h"
+#include "GeometryPager.h"
 #include "Intersection.h"
+#include "KeyframeCorrespondence.h"
 
 #include "../GLUtils.h"
 #include "../Timeline.h"
@@ -43,6 +45,7 @@
 
 #include "../XmlStreamWriter.h"
 #include "../XmlStreamReader.h"
+#include "../MemoryUsage.h"
 
 #include <QPair>
 #include <QtDebug>
@@ -52,6 +55,9 @@
 #include <QColorDialog>
 #include <QInputDialog>
 
+#include <algorithm>
+#include <cmath>
+
 #define MYDEBUG 0
 
 namespace VectorAnimationComplex
@@ -257,10 +263,21 @@ void VAC::initNonCopyable()
 {
     drawRectangleOfSelection_ = false;
     sketchedEdge_ = 0;
+    sketchedEdgeNumFinalVertices_ = 0;
+    sketchedEdgeTailBoundingBox_ = BoundingBox();
+    sketchedEdgeBoundingBox_ = BoundingBox();
+    pagingFirstTime_ = 0;
+    pagingLastTime_ = 0;
+    pagingFirstFrame_ = 0;
+    pagingLastFrame_ = 0;
+    pagingMaxBytes_ = 0;
+    pagingNumCells_ = -1;
+    pagingPagedInBytes_ = 0;
     hoveredFaceOnMousePress_ = 0;
     hoveredFaceOnMouseRelease_ = 0;
     sculptedEdge_ = 0;
     toBePaintedFace_ = 0;
+    deformedEdges_.clear();
     hoveredCell_ = 0;
     transformTool_.setNoHoveredObject();
     transformTool_.setCells(CellSet());
@@ -274,11 +291,17 @@ void VAC::initCopyable()
     ds_ = 5.0;
     cells_.clear();
     zOrdering_.clear();
+    setAllFramesChanged_();
 }
 
 
 VAC::VAC() :
-    SceneObject()
+    SceneObject(),
+    geometryChangeDepth_(0),
+    isTraversing_(false),
+    revision_(0),
+    allFramesRevision_(0),
+    drawingChangesRevision_(0)
 {
     initNonCopyable();
     initCopyable();
@@ -295,6 +318,12 @@ QString VAC::stringType()
 }
 
 
+void VAC::addMemoryUsage(MemoryUsage & usage)
+{
+    foreach(Cell * cell, cells_)
+        cell->addMemoryUsage(usage);
+}
+
 VAC * VAC::clone()
 {
     // Create new Graph
@@ -578,6 +607,7 @@ void VAC::drawInbetweenCells3D(View3DSettings & viewSettings)
     if(viewSettings.drawAsMesh())
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     InbetweenEdgeSet inbetweenEdges = cells();
+    InbetweenEdge::computeSurfaces3D(inbetweenEdges, viewSettings);
     foreach(InbetweenEdge * e, inbetweenEdges)
         e->draw3D(viewSettings);
     if(viewSettings.drawAsMesh())
@@ -592,11 +622,38 @@ void VAC::draw(Time time, ViewSettings & viewSettings)
 {
     ViewSettings::DisplayMode displayMode = viewSettings.displayMode();
 
+    // Keep the samples of key edges far from the drawn frames out of memory
+    if(viewSettings.isMainDrawing())
+        updateGeometryPaging();
+
+    // Cells to draw. When only a region of the view is redrawn, the cells
+    // which don't intersect it are skipped. The bounding boxes of the cells
+    // drawn by views are cached, since they are the regions to redraw when
+    // these cells change (see changedRegions())
+    QRectF region = viewSettings.drawingRegion();
+    BoundingBox regionBoundingBox;
+    if(!region.isNull())
+        regionBoundingBox = BoundingBox(region.left(), region.right(), region.top(), region.bottom());
+    bool needsBoundingBoxes = viewSettings.isMainDrawing() || !region.isNull();
+    std::vector<Cell*> cellsToDraw;
+    for(auto c: zOrdering_)
+    {
+        if(!c->exists(time))
+            continue;
+        if(needsBoundingBoxes)
+        {
+            const BoundingBox & boundingBox = c->boundingBox(time);
+            if(!region.isNull() && !boundingBox.intersects(regionBoundingBox))
+                continue;
+        }
+        cellsToDraw.push_back(c);
+    }
+
     // Illustration mode
     if( (displayMode == ViewSettings::ILLUSTRATION))
     {
         // Draw all cells
-        for(auto c: zOrdering_)
+        for(auto c: cellsToDraw)
             c->draw(time, viewSettings);
 
         // Draw sketched edge
@@ -608,7 +665,7 @@ void VAC::draw(Time time, ViewSettings & viewSettings)
     else if( (displayMode == ViewSettings::OUTLINE) )
     {
         // Draw all cells
-        for(auto c: zOrdering_)
+        for(auto c: cellsToDraw)
             c->drawTopology(time, viewSettings);
 
         // Draw sketched edge
@@ -620,18 +677,62 @@ void VAC::draw(Time time, ViewSettings & viewSettings)
     else if( (displayMode == ViewSettings::ILLUSTRATION_OUTLINE) )
     {
         // First pass
-        for(auto c: zOrdering_)
+        for(auto c: cellsToDraw)
             c->draw(time, viewSettings);
         if(sketchedEdge_)
             drawSketchedEdge(time, viewSettings);
 
         // Second pass
-        for(auto c: zOrdering_)
+        for(auto c: cellsToDraw)
             c->drawTopology(time, viewSettings);
         if(sketchedEdge_)
             drawTopologySketchedEdge(time, viewSettings);
     }
 
+    // Draw edge orientation
+    if(DevSettings::getBool("draw edge orientation"))
+    {
+        KeyEdgeSet edges = cells();
+        foreach(KeyEdge * e, edges)
+        {
+            if(e->exists(time))
+            {
+                double l = e->geometry()->length();
+                Eigen::Vector2d p = e->geometry()->pos2d(0.5*l);
+                Eigen::Vector2d u = e->geometry()->der(0.5*l);
+                GLUtils::drawArrow(p,u);
+            }
+        }
+        InbetweenEdgeSet sedges = cells();
+        foreach(InbetweenEdge * se, sedges)
+        {
+            if(se->exists(time))
+            {
+                QList<EdgeSample> samples = se->getSampling(time);
+                LinearSpline ls(samples);
+                double l = ls.length();
+                Eigen::Vector2d p = ls.pos2d(0.5*l);
+                Eigen::Vector2d u = ls.der(0.5*l);
+                GLUtils::drawArrow(p,u);
+            }
+        }
+    }
+}
+
+void VAC::drawOverlay(Time time, ViewSettings & viewSettings)
+{
+    ViewSettings::DisplayMode displayMode = viewSettings.displayMode();
+
+    // Tint the hovered cell, which draw() draws as any other cell, so that
+    // hovering a cell doesn't require to redraw the whole scene
+    if(hoveredCell_ && hoveredCell_->isHighlighted())
+    {
+        if(displayMode == ViewSettings::OUTLINE)
+            hoveredCell_->drawTopologyHighlight(time, viewSettings);
+        else
+            hoveredCell_->drawHighlight(time, viewSettings);
+    }
+
     // Draw to be painted face
     if( (global()->toolMode() == Global::PAINT) &&
             toBePaintedFace_)
@@ -789,35 +890,6 @@ void VAC::draw(Time time, ViewSettings & viewSettings)
     {
         transformTool_.draw(selectedCells_, time, viewSettings);
     }
-
-    // Draw edge orientation
-    if(DevSettings::getBool("draw edge orientation"))
-    {
-        KeyEdgeSet edges = cells();
-        foreach(KeyEdge * e, edges)
-        {
-            if(e->exists(time))
-            {
-                double l = e->geometry()->length();
-                Eigen::Vector2d p = e->geometry()->pos2d(0.5*l);
-                Eigen::Vector2d u = e->geometry()->der(0.5*l);
-                GLUtils::drawArrow(p,u);
-            }
-        }
-        InbetweenEdgeSet sedges = cells();
-        foreach(InbetweenEdge * se, sedges)
-        {
-            if(se->exists(time))
-            {
-                QList<EdgeSample> samples = se->getSampling(time);
-                LinearSpline ls(samples);
-                double l = ls.length();
-                Eigen::Vector2d p = ls.pos2d(0.5*l);
-                Eigen::Vector2d u = ls.der(0.5*l);
-                GLUtils::drawArrow(p,u);
-            }
-        }
-    }
 }
 
 void VAC::drawPick(Time time, ViewSettings & viewSettings)
@@ -976,6 +1048,11 @@ int VAC::numSelectedCells() const
     return selectedCells_.size();
 }
 
+const SelectionSummary & VAC::selectionSummary() const
+{
+    return selectionSummary_;
+}
+
 int VAC::hoveredTransformWidgetId() const
 {
     return transformTool_.hovered();
@@ -1092,7 +1169,12 @@ void VAC::exportSVG_(Time t, QTextStream & out)
 }
 
 VAC::VAC(QTextStream & in) :
-    SceneObject()
+    SceneObject(),
+    geometryChangeDepth_(0),
+    isTraversing_(false),
+    revision_(0),
+    allFramesRevision_(0),
+    drawingChangesRevision_(0)
 {
     clear();
 
@@ -1291,6 +1373,7 @@ void VAC::insertCell_(Cell * cell)
     cell->vac_ = this;
     cells_.insert(id, cell);
     zOrdering_.insertCell(cell);
+    setFramesChanged_(cell);
 }
 
 void VAC::insertCellLast_(Cell * cell)
@@ -1300,6 +1383,7 @@ void VAC::insertCellLast_(Cell * cell)
     cell->vac_ = this;
     cells_.insert(id, cell);
     zOrdering_.insertLast(cell);
+    setFramesChanged_(cell);
 }
 
 void VAC::removeCell_(Cell * cell)
@@ -1320,6 +1404,7 @@ void VAC::removeCell_(Cell * cell)
         }
         if(cell == sculptedEdge_)
             sculptedEdge_ = 0;
+        deformedEdges_.remove(cell->toKeyEdge());
 
         if(cell == hoveredFaceOnMousePress_)
             hoveredFaceOnMousePress_ = 0;
@@ -1327,7 +1412,356 @@ void VAC::removeCell_(Cell * cell)
             hoveredFaceOnMouseRelease_= 0;
         hoveredFacesOnMouseMove_.remove(cell->toKeyFace());
         facesToConsiderForCutting_.remove(cell->toKeyFace());
+        geometryChangedCells_.remove(cell);
+        dependentGeometryChangedCells_.remove(cell);
+        transformedGeometryCells_.remove(cell);
+    }
+}
+
+void VAC::beginGeometryChange_()
+{
+    ++geometryChangeDepth_;
+}
+
+void VAC::endGeometryChange_()
+{
+    --geometryChangeDepth_;
+    if(geometryChangeDepth_ == 0)
+        commitGeometryChanges_();
+}
+
+void VAC::deferGeometryChanged_(Cell * cell, bool dependentOnly)
+{
+    if(dependentOnly)
+        dependentGeometryChangedCells_ << cell;
+    else
+        geometryChangedCells_ << cell;
+    ++geometryChangeCounters_.numDeferredChanges;
+}
+
+void VAC::transformCachedGeometry_(const CellSet & cells, const Eigen::Affine2d & xf)
+{
+    assert(geometryChangeDepth_ > 0);
+    foreach(Cell * c, cells)
+    {
+        setFramesChanged_(c); // before its bounding boxes are transformed
+        if(c->toKeyCell() && c->transformCachedGeometry_(xf))
+            transformedGeometryCells_ << c;
+    }
+}
+
+quint64 VAC::newRevision_()
+{
+    // Only accessed from the GUI thread
+    static quint64 lastRevision = 0;
+    return ++lastRevision;
+}
+
+void VAC::setFramesChanged_(Cell * cell)
+{
+    // Frames where the cell exists
+    int firstFrame, lastFrame;
+    if(KeyCell * keyCell = cell->toKeyCell())
+    {
+        firstFrame = std::floor(keyCell->time().floatTime());
+        lastFrame = std::ceil(keyCell->time().floatTime());
+    }
+    else if(InbetweenCell * inbetweenCell = cell->toInbetweenCell())
+    {
+        firstFrame = std::floor(inbetweenCell->beforeTime().floatTime());
+        lastFrame = std::ceil(inbetweenCell->afterTime().floatTime());
+    }
+    else
+    {
+        setAllFramesChanged_();
+        return;
     }
+
+    setDrawingChanged_(cell);
+    for(int frame = firstFrame; frame <= lastFrame; ++frame)
+        frameRevisions_[frame] = revision_;
+}
+
+void VAC::setAllFramesChanged_()
+{
+    revision_ = newRevision_();
+    allFramesRevision_ = revision_;
+    frameRevisions_.clear();
+    clearDrawingChanges_();
+}
+
+quint64 VAC::frameRevision(int frame) const
+{
+    return std::max(allFramesRevision_, frameRevisions_.value(frame, 0));
+}
+
+void VAC::setDrawingChanged_(Cell * cell)
+{
+    // The cached bounding boxes are the ones of the times where the cell
+    // was drawn, see draw(). Copying them is cheap since QMap is implicitly
+    // shared, and they are detached when the cache of the cell is cleared
+    DrawingChange_ change;
+    change.revision = newRevision_();
+    change.cellId = cell->id();
+    change.boundingBoxes = cell->boundingBoxes_;
+    addDrawingChange_(change);
+}
+
+void VAC::setDrawingChanged_(const BoundingBox & boundingBox)
+{
+    if(boundingBox.isEmpty())
+        return;
+
+    DrawingChange_ change;
+    change.revision = newRevision_();
+    change.cellId = -1;
+    change.boundingBox = boundingBox;
+    addDrawingChange_(change);
+}
+
+void VAC::addDrawingChange_(const DrawingChange_ & change)
+{
+    // Beyond this number of changes, redrawing their regions is unlikely to
+    // be faster than redrawing everything
+    const int maxNumDrawingChanges = 1000;
+
+    revision_ = change.revision;
+    if(drawingChanges_.size() < maxNumDrawingChanges)
+        drawingChanges_ << change;
+    else
+        clearDrawingChanges_();
+}
+
+void VAC::clearDrawingChanges_()
+{
+    drawingChanges_.clear();
+    drawingChangesRevision_ = revision_;
+}
+
+bool VAC::changedRegions(quint64 revision, Time time, QList<BoundingBox> & out) const
+{
+    if(revision < drawingChangesRevision_)
+        return false;
+
+    // Same key as Cell::boundingBox(Time)
+    int key = std::floor(time.floatTime() * 60 + 0.5);
+    QSet<int> changedCells;
+    for(int i = drawingChanges_.size() - 1; i >= 0 && drawingChanges_[i].revision > revision; --i)
+    {
+        // Before the change
+        const DrawingChange_ & change = drawingChanges_[i];
+        auto it = change.boundingBoxes.find(key);
+        if(it != change.boundingBoxes.end())
+            out << it.value();
+        if(!change.boundingBox.isEmpty())
+            out << change.boundingBox;
+
+        // After the change
+        if(change.cellId >= 0 && !changedCells.contains(change.cellId))
+        {
+            changedCells << change.cellId;
+            Cell * cell = cells_.value(change.cellId, 0);
+            if(cell && cell->exists(time))
+                out << cell->boundingBox(time);
+        }
+    }
+
+    return true;
+}
+
+void VAC::updateGeometryPaging()
+{
+    // Zero disables paging
+    qint64 maxBytes = (qint64) DevSettings::getInt("geometry budget (MB)") * 1024 * 1024;
+    if(maxBytes == 0)
+        return;
+
+    // Frames being worked on: around the active time, and the playing
+    // window of the timeline while playing, which views prerender (see
+    // View::prerenderPlaybackFrame_())
+    double margin = DevSettings::getInt("geometry paging margin (frames)");
+    double activeTime = global()->activeTime().floatTime();
+    double firstTime = activeTime - margin;
+    double lastTime = activeTime + margin;
+    int firstFrame = 0;
+    int lastFrame = -1;
+    Timeline * timeline = global()->timeline();
+    if(timeline && timeline->isPlaying())
+    {
+        firstFrame = timeline->firstFrame();
+        lastFrame = timeline->lastFrame();
+    }
+
+    // Samples paged back in since the last call, e.g. by drawing far away
+    // frames or by editing far away cells, are paged out again once they
+    // are a significant part of the budget
+    qint64 pagedInBytes = GeometryPager::instance()->numPagedInBytes();
+    if(firstTime == pagingFirstTime_ && lastTime == pagingLastTime_ &&
+       firstFrame == pagingFirstFrame_ && lastFrame == pagingLastFrame_ &&
+       maxBytes == pagingMaxBytes_ && cells_.size() == pagingNumCells_ &&
+       pagedInBytes - pagingPagedInBytes_ <= maxBytes / 8)
+    {
+        return;
+    }
+    pagingFirstTime_ = firstTime;
+    pagingLastTime_ = lastTime;
+    pagingFirstFrame_ = firstFrame;
+    pagingLastFrame_ = lastFrame;
+    pagingMaxBytes_ = maxBytes;
+    pagingNumCells_ = cells_.size();
+    pagingPagedInBytes_ = pagedInBytes;
+
+    // Memory held by the geometry of key edges, including what paged out
+    // ones keep, and the samples which can be paged out, with their
+    // distance to the frames being worked on. The samples of a key edge are
+    // used at its time, and by the inbetween edges interpolating it
+    struct Candidate
+    {
+        double distance;
+        LinearSpline * geometry;
+        qint64 numBytes;
+        bool operator<(const Candidate & other) const { return distance > other.distance; }
+    };
+    std::vector<Candidate> candidates;
+    qint64 numBytes = 0;
+    foreach(Cell * cell, cells_)
+    {
+        KeyEdge * edge = cell->toKeyEdge();
+        LinearSpline * geometry = edge ? dynamic_cast<LinearSpline *>(edge->geometry()) : 0;
+        if(!geometry)
+            continue;
+        qint64 geometryBytes = geometry->memoryUsage();
+        numBytes += geometryBytes;
+        if(geometry->isPagedOut() || edge->isSelected() || edge == sculptedEdge_)
+            continue;
+
+        double t0 = edge->time().floatTime();
+        double t1 = t0;
+        foreach(Cell * c, edge->temporalStar())
+        {
+            if(InbetweenCell * inbetweenCell = c->toInbetweenCell())
+            {
+                t0 = std::min(t0, inbetweenCell->beforeTime().floatTime());
+                t1 = std::max(t1, inbetweenCell->afterTime().floatTime());
+            }
+        }
+        double distance = std::max(0.0, std::max(firstTime - t1, t0 - lastTime));
+        if(firstFrame <= lastFrame)
+            distance = std::min(distance, std::max(0.0, std::max(firstFrame - t1, t0 - lastFrame)));
+        if(distance > 0)
+        {
+            Candidate candidate;
+            candidate.distance = distance;
+            candidate.geometry = geometry;
+            candidate.numBytes = geometryBytes;
+            candidates.push_back(candidate);
+        }
+    }
+
+    // Page out, farthest first
+    if(numBytes <= maxBytes)
+        return;
+    std::sort(candidates.begin(), candidates.end());
+    for(size_t i = 0; i < candidates.size() && numBytes > maxBytes; ++i)
+    {
+        const Candidate & candidate = candidates[i];
+        if(candidate.geometry->pageOut())
+            numBytes -= candidate.numBytes - candidate.geometry->memoryUsage();
+    }
+}
+
+namespace
+{
+BoundingBox sampleBoundingBox_(const LinearSpline & spline, int first, int last)
+{
+    BoundingBox res;
+    for(int i=first; i<last; ++i)
+    {
+        EdgeSample s = spline[i];
+        double r = 0.5 * s.width();
+        res.unite(BoundingBox(s.x() - r, s.x() + r, s.y() - r, s.y() + r));
+    }
+    return res;
+}
+}
+
+void VAC::setSketchedEdgeChanged_()
+{
+    // While sketching, the samples of the sketched edge become final one
+    // after the other, and only the ones after the last final sample are
+    // fitted again on each new input (see SculptCurve::Curve::continueSketch())
+    BoundingBox changed = sketchedEdgeTailBoundingBox_;
+    sketchedEdgeTailBoundingBox_ = BoundingBox();
+    if(sketchedEdge_)
+    {
+        int n = sketchedEdge_->size();
+        int numFinal = sketchedEdge_->curve().numFinalVertices();
+        changed.unite(sampleBoundingBox_(*sketchedEdge_, std::max(0, sketchedEdgeNumFinalVertices_ - 1), n));
+        sketchedEdgeTailBoundingBox_ = sampleBoundingBox_(*sketchedEdge_, std::max(0, numFinal - 1), n);
+        sketchedEdgeNumFinalVertices_ = numFinal;
+    }
+    sketchedEdgeBoundingBox_.unite(changed);
+    setDrawingChanged_(changed);
+}
+
+void VAC::setSketchedEdgeRemoved_()
+{
+    setDrawingChanged_(sketchedEdgeBoundingBox_);
+    sketchedEdgeNumFinalVertices_ = 0;
+    sketchedEdgeTailBoundingBox_ = BoundingBox();
+    sketchedEdgeBoundingBox_ = BoundingBox();
+}
+
+namespace
+{
+bool isBoundaryFirst(Cell * c1, Cell * c2)
+{
+    return c1->dimension() < c2->dimension();
+}
+}
+
+void VAC::commitGeometryChanges_()
+{
+    if(geometryChangedCells_.isEmpty() && dependentGeometryChangedCells_.isEmpty())
+    {
+        transformedGeometryCells_.clear();
+        return;
+    }
+
+    // All cells depending on a changed cell, computed with a single
+    // traversal of their fullstar
+    CellSet seeds;
+    foreach(Cell * c, geometryChangedCells_)
+        seeds.unite(c->geometryDependentSeeds_());
+    CellSet toClearCells = Algorithms::fullstar(seeds);
+    Cell::addSizeDependentVertices_(toClearCells);
+
+    // Cells which have patched their own cached geometry (e.g., during a
+    // sculpt) are excluded, unless they also depend on another changed cell
+    foreach(Cell * c, dependentGeometryChangedCells_)
+    {
+        if(toClearCells.contains(c))
+            continue;
+        CellSet dependentCells = c->geometryDependentCells_();
+        dependentCells.remove(c);
+        toClearCells.unite(dependentCells);
+    }
+
+    // Cells whose cached geometry was transformed along with their geometry
+    toClearCells.subtract(transformedGeometryCells_);
+
+    // Clear caches exactly once, boundary cells first
+    cellsToClear_.assign(toClearCells.begin(), toClearCells.end());
+    std::stable_sort(cellsToClear_.begin(), cellsToClear_.end(), isBoundaryFirst);
+    for(Cell * c: cellsToClear_)
+        c->clearCachedGeometry_();
+
+    geometryChangeCounters_.numCommits += 1;
+    geometryChangeCounters_.numClearedCaches += cellsToClear_.size();
+    geometryChangedCells_.clear();
+    dependentGeometryChangedCells_.clear();
+    transformedGeometryCells_.clear();
+    cellsToClear_.clear();
 }
 
 
@@ -1449,6 +1883,18 @@ void VAC::deleteCells(const CellSet & cells)
 
 void VAC::deleteCell(Cell * cell)
 {
+    // If a geometry change of this cell is deferred, its dependent cells
+    // must still be found once it is deleted
+    if(geometryChangedCells_.contains(cell) || dependentGeometryChangedCells_.contains(cell))
+    {
+        CellSet seeds = cell->geometryDependentSeeds_();
+        seeds.remove(cell);
+        geometryChangedCells_.unite(seeds);
+    }
+
+    // The frames where the cell exists must be rendered again
+    setFramesChanged_(cell);
+
     // Recusrively delete star cells first (complex remains valid upon return)
     cell->destroyStar();
 
@@ -1743,6 +2189,7 @@ void VAC::beginSketchEdge(double x, double y, double w, Time time)
     timeInteractivity_ = time;
     sketchedEdge_ = new LinearSpline(ds_);
     sketchedEdge_->beginSketch(EdgeSample(x,y,w));
+    setSketchedEdgeChanged_();
     hoveredFaceOnMousePress_ = 0;
     hoveredFaceOnMouseRelease_ = 0;
     hoveredFacesOnMouseMove_.clear();
@@ -1760,6 +2207,7 @@ void VAC::continueSketchEdge(double x, double y, double w)
     if(sketchedEdge_)
     {
         sketchedEdge_->continueSketch(EdgeSample(x,y,w));
+        setSketchedEdgeChanged_();
         if(hoveredCell_)
         {
             InbetweenFace * sface = hoveredCell_->toInbetweenFace();
@@ -1800,6 +2248,7 @@ void VAC::endSketchEdge()
 
         delete sketchedEdge_;
         sketchedEdge_ = 0;
+        setSketchedEdgeRemoved_();
 
 
         //emit changed();
@@ -1820,6 +2269,7 @@ void VAC::beginCutFace(double x, double y, double w, KeyVertex * startVertex)
 
         sketchedEdge_ = new LinearSpline(ds_);
         sketchedEdge_->beginSketch(EdgeSample(x,y,w));
+        setSketchedEdgeChanged_();
 
         //emit changed();
     }
@@ -1835,6 +2285,7 @@ void VAC::continueCutFace(double x, double y, double w)
             w = 3.0;
 
         sketchedEdge_->continueSketch(EdgeSample(x,y,w));
+        setSketchedEdgeChanged_();
         //emit changed();
     }
 }
@@ -1882,6 +2333,7 @@ void VAC::endCutFace(KeyVertex * endVertex)
 
         delete sketchedEdge_;
         sketchedEdge_ = 0;
+        setSketchedEdgeRemoved_();
 
         if(hasBeenCut)
         {
@@ -2078,6 +2530,8 @@ bool VAC::cutFace_(KeyFace * face, KeyEdge * edge, CutFaceFeedback * feedback)
             //Set depth-ordering of new faces to be just below the old face
             zOrdering_.moveBelow(f1,face);
             zOrdering_.moveBelow(f2,face);
+            setFramesChanged_(f1);
+            setFramesChanged_(f2);
 
             // Update star
             InbetweenFaceSet sfacesbefore = face->temporalStarBefore();
@@ -2782,6 +3236,8 @@ void VAC::unglue_(KeyEdge * e)
 
 bool VAC::uncut_(KeyVertex * v)
 {
+    GeometryChangeTransaction geometryChange(this);
+
     // compute edge n usage, check it's not more than 2
     bool isSplittedLoop = false;
     KeyEdge * e1 = 0;
@@ -3056,6 +3512,8 @@ bool VAC::uncut_(KeyVertex * v)
 
 bool VAC::uncut_(KeyEdge * e)
 {
+    GeometryChangeTransaction geometryChange(this);
+
     // Compute number of uses
     int nUses = nUses_(e);
     if(nUses < 2)
@@ -3417,6 +3875,7 @@ bool VAC::uncut_(KeyEdge * e)
         // update z-ordering
         zOrdering_.removeCell(f);
         zOrdering_.insertCell(f);
+        setFramesChanged_(f);
 
         // Recompute geometry
         f->processGeometryChanged_();
@@ -3458,8 +3917,13 @@ void VAC::insertSketchedEdgeInVAC(double tolerance, bool useFaceToConsiderForCut
     double lSelf = sketchedEdge_->length(); // compute it now
     std::vector<double> lOthers;            // will be computed inside the loop
 
-    // Store geometry of existing edges as a "SketchedEdge"
-    std::vector< SculptCurve::Curve<EdgeSample>,Eigen::aligned_allocator<SculptCurve::Curve<EdgeSample> >  > sketchedEdges; // sketchedEdges.size() == nEdges.
+    // Geometry of existing edges, borrowed from their own storage rather
+    // than copied: only edges which are actually split are copied, later,
+    // by cutEdgeAtVertices_(). Edges whose geometry is not a LinearSpline
+    // are the exception: they are sampled into otherCurvesStorage, whose
+    // elements have stable addresses
+    std::vector< SculptCurve::CurveView<EdgeSample> > otherCurves; // otherCurves.size() == nEdges.
+    std::list< SculptCurve::Curve<EdgeSample>,Eigen::aligned_allocator<SculptCurve::Curve<EdgeSample> > > otherCurvesStorage;
 
     // Compute intersections with self
     if(intersectWithSelf)
@@ -3477,20 +3941,9 @@ void VAC::insertSketchedEdgeInVAC(double tolerance, bool useFaceToConsiderForCut
         }
         foreach(InbetweenEdge * sedge, inbetweenEdges)
         {
-            // Get sampling as a QList of EdgeSamples
-            QList<EdgeSample> sampling = sedge->getSampling(timeInteractivity_);
-
-            // Convert sampling to a std::vector of EdgeSamples
-            std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > stdSampling;
-            for(int i=0; i<sampling.size(); ++i)
-                stdSampling << sampling[i];
-
-            // Convert sampling to a SculptCurve::Curve<EdgeSample>
-            SculptCurve::Curve<EdgeSample> sketchedEdge;
-            sketchedEdge.setVertices(stdSampling);
-
-            // Compute intersections
-            std::vector<SculptCurve::Intersection> intersections = sketchedEdge_->curve().intersections(sketchedEdge, tolerance);
+            // Compute intersections with the cached sampling of the edge
+            const SculptCurve::Curve<EdgeSample> & sampling = sedge->samplingCurve(timeInteractivity_);
+            std::vector<SculptCurve::Intersection> intersections = sketchedEdge_->curve().intersections(sampling.view(), tolerance);
 
             // Keyframe edge if there are some intersections
             if(intersections.size() > 0)
@@ -3510,12 +3963,12 @@ void VAC::insertSketchedEdgeInVAC(double tolerance, bool useFaceToConsiderForCut
         // For each of them, compute intersections with sketched edge
         foreach (KeyEdge * iedge, iedgesBefore)
         {
-            // Convert geometry of instant edge to a SketchedEdge
+            // Get a view of the geometry of instant edge
             EdgeGeometry * geometry = iedge->geometry();
             LinearSpline * linearSpline = dynamic_cast<LinearSpline *>(geometry);
             if(linearSpline)
             {
-                sketchedEdges << linearSpline->curve() ;
+                otherCurves << linearSpline->curve().view();
             }
             else
             {
@@ -3523,15 +3976,16 @@ void VAC::insertSketchedEdgeInVAC(double tolerance, bool useFaceToConsiderForCut
                 std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > vertices;
                 for(int i=0; i<eigenSampling.size(); ++i)
                     vertices << EdgeSample(eigenSampling[i][0], eigenSampling[i][1], 10); // todo: get actual width
-                sketchedEdges << SculptCurve::Curve<EdgeSample>();
-                sketchedEdges.back().setVertices(vertices);
+                otherCurvesStorage.push_back(SculptCurve::Curve<EdgeSample>());
+                otherCurvesStorage.back().setVertices(vertices);
+                otherCurves << otherCurvesStorage.back().view();
             }
 
             // Compute intersections
-            othersIntersections << sketchedEdge_->curve().intersections(sketchedEdges.back(), tolerance);
+            othersIntersections << sketchedEdge_->curve().intersections(otherCurves.back(), tolerance);
 
             // Store length
-            lOthers << sketchedEdges.back().length();
+            lOthers << otherCurves.back().length();
         }
     }
 
@@ -3720,7 +4174,7 @@ void VAC::insertSketchedEdgeInVAC(double tolerance, bool useFaceToConsiderForCut
         std::cout << "    [ ";
         for(double s : splitValues)
             std::cout << s << " ";
-        std::cout << "] -- length = " << sketchedEdges[i1].length() << std::endl;
+        std::cout << "] -- length = " << otherCurves[i1].length() << std::endl;
         i1++;
     }
     std::cout << std::endl;
@@ -3768,10 +4222,10 @@ void VAC::insertSketchedEdgeInVAC(double tolerance, bool useFaceToConsiderForCut
             if(othersSplitValues[i].size() > 0 && !iedge->isClosed())
             {
                 // todo: be careful!! Potentially add several times the same node here!!!
-                splitNodes.existing << sketchedEdges[i].start();
+                splitNodes.existing << otherCurves[i].start();
                 splitNodes.existingNodes << iedge->startVertex();
 
-                splitNodes.existing << sketchedEdges[i].end();
+                splitNodes.existing << otherCurves[i].end();
                 splitNodes.existingNodes << iedge->endVertex();
             }
             i++;
@@ -4209,6 +4663,7 @@ void VAC::continueSculptDeform(double x, double y)
 {
     if(sculptedEdge_)
     {
+        GeometryChangeTransaction geometryChange(this);
         sculptedEdge_->continueSculptDeform(x, y);
         //emit changed();
     }
@@ -4236,6 +4691,7 @@ void VAC::continueSculptEdgeWidth(double x, double y)
 {
     if(sculptedEdge_)
     {
+        GeometryChangeTransaction geometryChange(this);
         sculptedEdge_->continueSculptEdgeWidth(x, y);
         //emit changed();
     }
@@ -4268,6 +4724,7 @@ void VAC::continueSculptSmooth(double x, double y)
     {
         // WARNING: sculptedEdge_ may have changed, and then sculptedEdge_->continueSculptSmooth(x, y);
         //          called without sculptedEdge_->beginSculptSmooth(x, y); called beforehand
+        GeometryChangeTransaction geometryChange(this);
         sculptedEdge_->continueSculptSmooth(x, y);
         //emit changed();
     }
@@ -4700,6 +5157,133 @@ void VAC::inbetweenSelection()
     emit checkpoint();
 }
 
+namespace
+{
+
+// Returns an inbetween vertex from v1 to v2, either previously created by
+// the same bulk operation, already existing, or new
+InbetweenVertex * findOrCreateInbetweenVertex(
+        VAC * vac, KeyVertex * v1, KeyVertex * v2,
+        QMap<QPair<KeyVertex*,KeyVertex*>, InbetweenVertex*> & inbetweenVertices)
+{
+    QPair<KeyVertex*,KeyVertex*> key(v1, v2);
+    InbetweenVertex * res = inbetweenVertices.value(key, 0);
+    if(!res)
+    {
+        InbetweenVertexSet after = v1->temporalStarAfter();
+        foreach(InbetweenVertex * sv, after)
+            if(sv->afterVertex() == v2)
+                res = sv;
+        if(!res)
+        {
+            res = vac->newInbetweenVertex(v1, v2);
+            res->setColor(v1->color());
+        }
+        inbetweenVertices[key] = res;
+    }
+    return res;
+}
+
+bool hasInbetweenEdge(KeyEdge * e1, KeyEdge * e2)
+{
+    InbetweenEdgeSet after = e1->temporalStarAfter();
+    foreach(InbetweenEdge * se, after)
+        if(se->afterCells().contains(e2))
+            return true;
+    return false;
+}
+
+}
+
+int VAC::inbetweenKeyCells_(const KeyCellSet & cells1, const KeyCellSet & cells2)
+{
+    // Compute the correspondence. cells1 must be before cells2.
+    KeyframeCorrespondence correspondence(cells1, cells2);
+
+    // Create inbetween edges, sharing inbetween vertices
+    int numCreatedCells = 0;
+    QMap<QPair<KeyVertex*,KeyVertex*>, InbetweenVertex*> inbetweenVertices;
+    foreach(const KeyframeCorrespondence::EdgePair & pair, correspondence.edgePairs())
+    {
+        if(hasInbetweenEdge(pair.e1, pair.e2))
+            continue;
+
+        KeyHalfedge h1(pair.e1, true);
+        KeyHalfedge h2(pair.e2, pair.sameOrientation);
+        InbetweenEdge * ste = 0;
+        if(pair.e1->isClosed())
+        {
+            Cycle cycle1(QList<KeyHalfedge>() << h1);
+            Cycle cycle2(QList<KeyHalfedge>() << h2);
+            ste = newInbetweenEdge(cycle1, cycle2);
+        }
+        else
+        {
+            int numInbetweenVertices = inbetweenVertices.size();
+            InbetweenVertex * svstart = findOrCreateInbetweenVertex(
+                        this, h1.startVertex(), h2.startVertex(), inbetweenVertices);
+            InbetweenVertex * svend = findOrCreateInbetweenVertex(
+                        this, h1.endVertex(), h2.endVertex(), inbetweenVertices);
+            numCreatedCells += inbetweenVertices.size() - numInbetweenVertices;
+
+            Path path1(QList<KeyHalfedge>() << h1);
+            Path path2(QList<KeyHalfedge>() << h2);
+            AnimatedVertex avstart(InbetweenVertexList() << svstart);
+            AnimatedVertex avend(InbetweenVertexList() << svend);
+            ste = newInbetweenEdge(path1, path2, avstart, avend);
+        }
+        ste->setColor(pair.e1->color());
+        ++numCreatedCells;
+    }
+
+    // Create inbetween vertices for the remaining isolated vertices
+    foreach(const KeyframeCorrespondence::VertexPair & pair, correspondence.vertexPairs())
+    {
+        int numInbetweenVertices = inbetweenVertices.size();
+        findOrCreateInbetweenVertex(this, pair.v1, pair.v2, inbetweenVertices);
+        numCreatedCells += inbetweenVertices.size() - numInbetweenVertices;
+    }
+
+    return numCreatedCells;
+}
+
+void VAC::inbetweenKeyframes()
+{
+    // Get the two times spanned by the selection
+    KeyCellSet selection = selectedCells();
+    QList<Time> sortedTimes;
+    foreach(KeyCell * c, selection)
+        if(!sortedTimes.contains(c->time()))
+            sortedTimes << c->time();
+    if(sortedTimes.size() != 2)
+    {
+        qDebug("Inbetweening keyframes: Selected objects must span exactly two frames. Abort.");
+        return;
+    }
+    std::sort(sortedTimes.begin(), sortedTimes.end());
+
+    // Split the selection by time
+    KeyCellSet cells1;
+    KeyCellSet cells2;
+    foreach(KeyCell * c, selection)
+    {
+        if(c->time() == sortedTimes[0])
+            cells1 << c;
+        else
+            cells2 << c;
+    }
+
+    // Inbetween all cells at once, with a single checkpoint
+    int numCreatedCells = inbetweenKeyCells_(cells1, cells2);
+    if(numCreatedCells == 0)
+        return;
+
+    deselectAll();
+    emit needUpdatePicking();
+    emit changed();
+    emit checkpoint();
+}
+
 void VAC::keyframeSelection()
 {
     keyframe_(selectedCells(), global()->activeTime());
@@ -4965,6 +5549,9 @@ KeyEdge * VAC::keyframe_(InbetweenEdge * sedge, Time time)
     zOrdering_.moveBelowBoundary(keyEdge);
     zOrdering_.moveBelowBoundary(inbetweenEdgeBefore);
     zOrdering_.moveBelowBoundary(inbetweenEdgeAfter);
+    setFramesChanged_(keyEdge);
+    setFramesChanged_(inbetweenEdgeBefore);
+    setFramesChanged_(inbetweenEdgeAfter);
 
     // Delete old cell
     deleteCell(sedge);
@@ -5127,6 +5714,9 @@ KeyFace * VAC::keyframe_(InbetweenFace * sface, Time time)
     zOrdering_.moveBelowBoundary(keyFace);
     zOrdering_.moveBelowBoundary(inbetweenFaceBefore);
     zOrdering_.moveBelowBoundary(inbetweenFaceAfter);
+    setFramesChanged_(keyFace);
+    setFramesChanged_(inbetweenFaceBefore);
+    setFramesChanged_(inbetweenFaceAfter);
 
     // Delete old cell
     deleteCell(sface);
@@ -5153,7 +5743,8 @@ QList<Cycle> VAC::createFace_computeCycles()
         SmartConnectedKeyEdgeSet & potentialCycle = smartKeyEdgeSet[i];
         if(potentialCycle.type() == SmartConnectedKeyEdgeSet::GENERAL )
         {
-            global()->mainWindow()->statusBar()->showMessage(tr("Some selected edges were ambiguous and have been ignored"));
+            if(global()->mainWindow())
+                global()->mainWindow()->statusBar()->showMessage(tr("Some selected edges were ambiguous and have been ignored"));
         }
         else if(potentialCycle.type() == SmartConnectedKeyEdgeSet::CLOSED_EDGE )
         {
@@ -5401,6 +5992,7 @@ void VAC::raise()
     if(numSelectedCells() > 0)
     {
         zOrdering_.raise(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5413,6 +6005,7 @@ void VAC::lower()
     if(numSelectedCells() > 0)
     {
         zOrdering_.lower(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5425,6 +6018,7 @@ void VAC::raiseToTop()
     if(numSelectedCells() > 0)
     {
         zOrdering_.raiseToTop(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5437,6 +6031,7 @@ void VAC::lowerToBottom()
     if(numSelectedCells() > 0)
     {
         zOrdering_.lowerToBottom(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5450,6 +6045,7 @@ void VAC::altRaise()
     if(numSelectedCells() > 0)
     {
         zOrdering_.altRaise(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5462,6 +6058,7 @@ void VAC::altLower()
     if(numSelectedCells() > 0)
     {
         zOrdering_.altLower(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5474,6 +6071,7 @@ void VAC::altRaiseToTop()
     if(numSelectedCells() > 0)
     {
         zOrdering_.altRaiseToTop(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5486,6 +6084,7 @@ void VAC::altLowerToBottom()
     if(numSelectedCells() > 0)
     {
         zOrdering_.altLowerToBottom(selectedCells());
+        setAllFramesChanged_();
 
         emit needUpdatePicking();
         emit changed();
@@ -5871,6 +6470,10 @@ void VAC::setNoHoveredCell()
 
 void VAC::informTimelineOfSelection()
 {
+    Timeline * timeline = global()->timeline();
+    if(!timeline)
+        return;
+
     int selectionType = 0;
     double t = 0;
     double t1 = 0;
@@ -5921,7 +6524,6 @@ void VAC::informTimelineOfSelection()
             t2 = t;
     }
 
-    Timeline * timeline = global()->timeline();
     timeline->setSelectionType(selectionType);
     timeline->setT(t);
     timeline->setT1(t1);
@@ -5933,6 +6535,7 @@ void VAC::addToSelection(Cell * cell, bool emitSignal)
     if(cell && !cell->isSelected())
     {
         selectedCells_ << cell;
+        selectionSummary_.add(cell);
         cell->setSelected(true);
         emitSelectionChanged_();
         if(emitSignal)
@@ -5947,6 +6550,7 @@ void VAC::removeFromSelection(Cell * cell, bool emitSignal)
     if(cell && cell->isSelected())
     {
         selectedCells_.remove(cell);
+        selectionSummary_.remove(cell);
         cell->setSelected(false);
         emitSelectionChanged_();
         if(emitSignal)
@@ -6032,6 +6636,7 @@ void VAC::setSelectedCells(const CellSet & cells, bool emitSignal)
         else
         {
             changing = true;
+            selectionSummary_.add(cell);
         }
     }
 
@@ -6045,6 +6650,7 @@ void VAC::setSelectedCells(const CellSet & cells, bool emitSignal)
         {
             changing = true;
             cell->setSelected(false);
+            selectionSummary_.remove(cell);
         }
     }
 
@@ -6140,8 +6746,14 @@ void VAC::deselectFaces(bool emitSignal)
 
 void VAC::prepareDragAndDrop(double x0, double y0, Time time)
 {
+    // A previous drag may not have been completed, e.g. if the mouse release
+    // was lost. Release the rest shapes of its edges
+    foreach(KeyEdge * iedge, deformedEdges_)
+        iedge->cancelCorrectGeometryDrag();
+
     draggedVertices_.clear();
     draggedEdges_.clear();
+    deformedEdges_.clear();
 
     // do nothing if the highlighted object is not a node object
     if(!hoveredCell_)
@@ -6197,9 +6809,24 @@ void VAC::prepareDragAndDrop(double x0, double y0, Time time)
     draggedVertices_ = KeyVertexSet(cellsToDrag);
     draggedEdges_ = KeyEdgeSet(cellsToDrag);
 
+    // Open edges incident to dragged vertices are deformed from their rest
+    // shape, which also covers the translation of dragged open edges
+    foreach(KeyVertex * v, draggedVertices_)
+    {
+        foreach(Cell * c, v->spatialStar())
+        {
+            KeyEdge * iedge = c->toKeyEdge();
+            if(iedge && !iedge->isClosed())
+                deformedEdges_ << iedge;
+        }
+    }
+
     // prepare drag and drop
     foreach(KeyEdge * iedge, draggedEdges_)
-        iedge->geometry()->prepareDragAndDrop();
+        if(iedge->isClosed())
+            iedge->geometry()->prepareDragAndDrop();
+    foreach(KeyEdge * iedge, deformedEdges_)
+        iedge->beginCorrectGeometryDrag();
     foreach(KeyVertex * v, draggedVertices_)
         v->prepareDragAndDrop();
 
@@ -6228,18 +6855,23 @@ void VAC::performDragAndDrop(double x, double y)
         else if (std::abs(theta + 3*PI/4) <   PI/8) { dx = -d; dy = -d; }
     }
 
+    // Dragged cells and their incident edges share most dependent cells
+    GeometryChangeTransaction geometryChange(this);
+
     foreach(KeyEdge * iedge, draggedEdges_)
     {
-        iedge->geometry()->performDragAndDrop(dx, dy);
-        iedge->processGeometryChanged_();
+        if(iedge->isClosed())
+        {
+            iedge->geometry()->performDragAndDrop(dx, dy);
+            iedge->processGeometryChanged_();
+        }
     }
 
     foreach(KeyVertex * v, draggedVertices_)
         v->performDragAndDrop(dx, dy);
 
-
-    foreach(KeyVertex * v, draggedVertices_)
-        v->correctEdgesGeometry();
+    foreach(KeyEdge * iedge, deformedEdges_)
+        iedge->continueCorrectGeometryDrag();
 
     transformTool_.performDragAndDrop(dx, dy);
 
@@ -6248,6 +6880,11 @@ void VAC::performDragAndDrop(double x, double y)
 
 void VAC::completeDragAndDrop()
 {
+    // Resample deformed edges once, now that their final shape is known
+    foreach(KeyEdge * iedge, deformedEdges_)
+        iedge->endCorrectGeometryDrag();
+    deformedEdges_.clear();
+
     transformTool_.endDragAndDrop();
     global()->setDragAndDropping(false);
 
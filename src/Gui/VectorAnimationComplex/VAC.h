@@ -11,7 +11,9 @@
 
 #include <QSet>
 #include <QMap>
+#include <QHash>
 #include <QColor>
+#include <vector>
 
 #include "../SceneObject.h"
 
@@ -23,6 +25,7 @@
 #include "TransformTool.h"
 
 #include "../View3DSettings.h"
+#include "../SelectionSummary.h"
 
 class Scene;
 class XmlStreamWriter;
@@ -43,6 +46,7 @@ class AnimatedVertex;
 class KeyHalfedge;
 class PreviewKeyFace;
 class BoundingBox;
+namespace Algorithms { class CellMarks; }
 
 class VAC: public SceneObject
 {
@@ -69,8 +73,54 @@ public:
     QMap<int, int> import(VAC * other, bool selectImportedCells = false); // insert a copy of other inside this
     VAC * subcomplex(const CellSet & subcomplexCells); // Create a new VAC whose cells are cells
 
+    // Memory held by the cached and stored geometry of all cells
+    void addMemoryUsage(MemoryUsage & usage);
+
+    // Geometry change transactions (see GeometryChangeTransaction below)
+    struct GeometryChangeCounters
+    {
+        GeometryChangeCounters() : numDeferredChanges(0), numCommits(0), numClearedCaches(0) {}
+        int numDeferredChanges; // processGeometryChanged_() calls deferred by a transaction
+        int numCommits;         // outermost transactions which had deferred changes
+        int numClearedCaches;   // clearCachedGeometry_() calls made by commits
+    };
+    const GeometryChangeCounters & geometryChangeCounters() const { return geometryChangeCounters_; }
+    void resetGeometryChangeCounters() { geometryChangeCounters_ = GeometryChangeCounters(); }
+
+    // Revisions of the drawing of each frame, for caches of rendered frames
+    // (see PlaybackCache). Changing the geometry or color of a cell, or
+    // inserting or removing it, gives a new revision to the frames where
+    // the cell exists. Other changes (e.g., z-ordering) give a new revision
+    // to all frames. An image of a frame rendered at revision() is up to
+    // date as long as frameRevision() isn't greater. Revisions are unique
+    // across all VACs, so a new VAC (e.g., after undo) invalidates them all
+    quint64 revision() const { return revision_; }
+    quint64 frameRevision(int frame) const;
+
+    // Regions of the drawing at the given time which changed since the given
+    // revision, for views redrawing only these regions over an image of the
+    // scene rendered at this revision (see View and DirtyRegion). Changed
+    // cells are recorded with the bounding boxes they had when they were
+    // drawn before the change (see Cell::boundingBox(Time)), and the ones
+    // they have after the change are computed here. Returns false if the
+    // changes aren't known, e.g., when all frames changed since the revision
+    // or when there were too many changes, in which case everything must be
+    // redrawn.
+    bool changedRegions(quint64 revision, Time time, QList<BoundingBox> & out) const;
+
+    // Pages out the samples of the key edges which are far from the frames
+    // being worked on, i.e., around the active time and, while playing, in
+    // the playing window of the timeline, farthest first, until the samples
+    // in memory fit in the "geometry budget (MB)" dev setting. They are paged
+    // back in when accessed (see LinearSpline::pageOut() and GeometryPager).
+    // Called by draw(), and does nothing unless these frames or the number
+    // of cells changed, or many samples were paged back in, since the last
+    // call.
+    void updateGeometryPaging();
+
     // Drawing
     void draw(Time time, ViewSettings & viewSettings);
+    void drawOverlay(Time time, ViewSettings & viewSettings);
     void drawPick(Time time, ViewSettings & viewSettings);
     void drawInbetweenCells3D(View3DSettings & viewSettings);
     void drawOneFrame3D(Time time, View3DSettings & viewSettings, ViewSettings & view2DSettings, bool drawAsTopo = false);
@@ -92,6 +142,7 @@ public:
     Cell * hoveredCell() const;
     const CellSet & selectedCells() const;
     int numSelectedCells() const;
+    const SelectionSummary & selectionSummary() const;
 
     // Get hovered transform widget id
     int hoveredTransformWidgetId() const;
@@ -246,6 +297,7 @@ public slots:
     void updateCellsToConsiderForCutting();
     // -- animation --
     void inbetweenSelection();
+    void inbetweenKeyframes();
     void keyframeSelection();
     void motionPaste(VAC* & clipboard);
 
@@ -311,6 +363,69 @@ private:
     // Trusting operators
     friend class Operator;
 
+    // Geometry change transactions
+    friend class Cell;
+    friend class GeometryChangeTransaction;
+    void beginGeometryChange_();
+    void endGeometryChange_();
+    void deferGeometryChanged_(Cell * cell, bool dependentOnly);
+    void transformCachedGeometry_(const CellSet & cells, const Eigen::Affine2d & xf);
+    void commitGeometryChanges_();
+    int geometryChangeDepth_;
+    CellSet geometryChangedCells_;          // processGeometryChanged_()
+    CellSet dependentGeometryChangedCells_; // processDependentGeometryChanged_()
+    CellSet transformedGeometryCells_;      // transformCachedGeometry_()
+    GeometryChangeCounters geometryChangeCounters_;
+    std::vector<Cell*> cellsToClear_;
+
+    // Traversals of the cells of this VAC (see Algorithms::CellMarks). The
+    // work buffers keep their capacity from one traversal to the next
+    friend class Algorithms::CellMarks;
+    bool isTraversing_;
+    std::vector<Cell*> traversalStack_;
+    std::vector<Cell*> traversalAdjacentCells_;
+
+    // Frame revisions
+    static quint64 newRevision_();
+    void setFramesChanged_(Cell * cell);
+    void setAllFramesChanged_();
+    quint64 revision_;
+    quint64 allFramesRevision_;
+    QHash<int, quint64> frameRevisions_;
+
+    // Geometry paging: frames, budget, number of cells and paged in bytes
+    // (see GeometryPager::numPagedInBytes()) of the last updateGeometryPaging()
+    double pagingFirstTime_;
+    double pagingLastTime_;
+    int pagingFirstFrame_;
+    int pagingLastFrame_;
+    qint64 pagingMaxBytes_;
+    int pagingNumCells_;
+    qint64 pagingPagedInBytes_;
+
+    // Changed regions, sorted by revision. All the changes made after
+    // drawingChangesRevision_ are recorded
+    struct DrawingChange_
+    {
+        quint64 revision;
+        int cellId;                          // -1 if not a cell
+        QMap<int, BoundingBox> boundingBoxes; // same keys as Cell::boundingBoxes_
+        BoundingBox boundingBox;             // at all times
+    };
+    void setDrawingChanged_(Cell * cell);
+    void setDrawingChanged_(const BoundingBox & boundingBox);
+    void addDrawingChange_(const DrawingChange_ & change);
+    void clearDrawingChanges_();
+    QList<DrawingChange_> drawingChanges_;
+    quint64 drawingChangesRevision_;
+
+    // Only the last samples of the sketched edge change while sketching
+    void setSketchedEdgeChanged_();
+    void setSketchedEdgeRemoved_();
+    int sketchedEdgeNumFinalVertices_;
+    BoundingBox sketchedEdgeTailBoundingBox_;
+    BoundingBox sketchedEdgeBoundingBox_;
+
     // All cells in vac, accessible by ID
     QMap<int, Cell*> cells_;
     void removeCell_(Cell * cell);
@@ -392,6 +507,7 @@ private:
     // Inbetweening
     InbetweenVertex * inbetweenVertices_(KeyVertex * v1, KeyVertex * v2);
     InbetweenEdge * inbetweenEdges_(KeyEdge * e1, KeyEdge * e2);
+    int inbetweenKeyCells_(const KeyCellSet & cells1, const KeyCellSet & cells2);
 
     // Keyframing
     KeyCellSet keyframe_(const CellSet & cells, Time time);
@@ -405,6 +521,7 @@ private:
     // Drag and drop
     KeyVertexSet draggedVertices_;
     KeyEdgeSet draggedEdges_;
+    KeyEdgeSet deformedEdges_; // open edges incident to dragged vertices
     double x0_, y0_;
 
     // Temporal drag and drop
@@ -424,6 +541,7 @@ private:
     int hoveredTransformWidgetId_;
     Cell * hoveredCell_;
     CellSet selectedCells_;
+    SelectionSummary selectionSummary_;
 
     // Z-layering
     ZOrderedCells zOrdering_;
@@ -440,6 +558,36 @@ private:
     friend class TransformTool;
 };
 
+// Defers the propagation of geometry changes in vac until the outermost
+// transaction is destroyed. Meanwhile, Cell::processGeometryChanged_() only
+// records the changed cell, and the caches of all dependent cells are then
+// cleared exactly once, boundary cells first. This avoids walking the
+// dependent cells once per changed cell in operations which change many
+// cells at once (drag and drop, transform, uncut, sculpt).
+//
+// Cached geometry of dependent cells may be stale until then, so the
+// operation must not rely on it.
+class GeometryChangeTransaction
+{
+public:
+    // Does nothing if vac is null
+    GeometryChangeTransaction(VAC * vac) : vac_(vac) { if(vac_) vac_->beginGeometryChange_(); }
+    ~GeometryChangeTransaction() { if(vac_) vac_->endGeometryChange_(); }
+
+    // Declares that xf was applied to the geometry of the given key cells,
+    // and of all the cells they depend on (e.g., cells is a closure). Their
+    // cached triangles are transformed now, and they are not cleared at the
+    // end of the transaction, when supported (see
+    // Cell::transformCachedGeometry_()). Inbetween cells are ignored
+    void transformCachedGeometry(const CellSet & cells, const Eigen::Affine2d & xf)
+        { if(vac_) vac_->transformCachedGeometry_(cells, xf); }
+
+private:
+    VAC * vac_;
+    GeometryChangeTransaction(const GeometryChangeTransaction &);
+    GeometryChangeTransaction & operator=(const GeometryChangeTransaction &);
+};
+
 }
 
 #endif
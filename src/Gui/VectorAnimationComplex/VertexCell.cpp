@@ -17,6 +17,7 @@
 #include <QStringList>
 #include "../SaveAndLoad.h"
 #include "../Global.h"
+#include "../MemoryUsage.h"
 #include "CellList.h"
 
 #include <limits>
@@ -93,12 +94,17 @@ void VertexCell::drawPickCustom(Time time, ViewSettings & /*viewSettings*/)
 
 void VertexCell::drawRaw(Time time, ViewSettings & viewSettings)
 {
-    if(isHighlighted() || isSelected())
+    if(isSelected())
     {
         Cell::drawRaw(time, viewSettings);
     }
 }
 
+void VertexCell::drawRawHighlight(Time time, ViewSettings & viewSettings)
+{
+    Cell::drawRaw(time, viewSettings);
+}
+
 void VertexCell::drawRawTopology(Time time, ViewSettings & viewSettings)
 {
     bool screenRelative = viewSettings.screenRelative();
@@ -143,15 +149,15 @@ double VertexCell::size(Time time) const
     double defaultSize = 0;
 
     // get outgoing halfedges
-    QList<Halfedge> incidentEdgesT = incidentEdges(time);
+    const std::vector<Halfedge> & incidentEdgesT = incidentEdges(time);
 
     // valence == 0
-    if(incidentEdgesT.isEmpty())
+    if(incidentEdgesT.empty())
         return defaultSize;
 
     // valence > 0
     double res = 0; //std::numeric_limits<double>::max();
-    foreach(Halfedge h, incidentEdgesT)
+    for(Halfedge h: incidentEdgesT)
     {
         EdgeSample sample = h.startSample(time);
         if(sample.width() > res)
@@ -170,6 +176,7 @@ void VertexCell::save_(QTextStream & /*out*/)
 
 void VertexCell::remapPointers(VAC * /*newVAC*/)
 {
+    incidentEdges_.clear();
 }
 
 void VertexCell::write_(XmlStreamWriter & /*xml*/) const
@@ -196,8 +203,14 @@ CellSet VertexCell::spatialBoundary(Time /*t*/) const
     return CellSet();
 }
 
-QList<Halfedge> VertexCell::incidentEdges(Time t) const
+const std::vector<Halfedge> & VertexCell::incidentEdges(Time t) const
 {
+    // Return cached halfedges if any
+    int key = std::floor(t.floatTime() * 60 + 0.5);
+    auto it = incidentEdges_.find(key);
+    if(it != incidentEdges_.end())
+        return it.value();
+
     // Get key edges and inbetween edges in spatial star
     CellSet spatialStarT = spatialStar(t);
     KeyEdgeSet keyEdges = spatialStarT;
@@ -205,25 +218,50 @@ QList<Halfedge> VertexCell::incidentEdges(Time t) const
 
     // Orient them so that "start(h) = this"
     // Note: Possibly add them twice if start = end = this
-    QList<Halfedge> res;
+    std::vector<Halfedge> & res = incidentEdges_[key];
+    res.reserve(keyEdges.size() + inbetweenEdges.size());
     foreach(KeyEdge * keyEdge, keyEdges)
     {
         if(keyEdge->startVertex()->toVertexCell() == this)
-            res << Halfedge(keyEdge, true);
+            res.push_back(Halfedge(keyEdge, true));
         if(keyEdge->endVertex()->toVertexCell() == this)
-            res << Halfedge(keyEdge, false);
+            res.push_back(Halfedge(keyEdge, false));
     }
+    // Note: the start or end vertex is null at the time of the key
+    // vertices bounding the inbetween edge
     foreach(InbetweenEdge * inbetweenEdge, inbetweenEdges)
     {
-        if(inbetweenEdge->startVertex(t)->toVertexCell()  == this)
-            res << Halfedge(inbetweenEdge, true);
-        if(inbetweenEdge->endVertex(t)->toVertexCell() == this)
-            res << Halfedge(inbetweenEdge, false);
+        if(inbetweenEdge->startVertex(t) == this)
+            res.push_back(Halfedge(inbetweenEdge, true));
+        if(inbetweenEdge->endVertex(t) == this)
+            res.push_back(Halfedge(inbetweenEdge, false));
     }
 
     return res;
 }
 
+void VertexCell::clearCachedGeometry_()
+{
+    Cell::clearCachedGeometry_();
+    incidentEdges_.clear();
+}
+
+void VertexCell::processSpatialStarChanged_()
+{
+    incidentEdges_.clear();
+}
+
+void VertexCell::addMemoryUsage(MemoryUsage & usage)
+{
+    Cell::addMemoryUsage(usage);
+
+    qint64 incidentEdgesBytes = MemoryUsage::mapNodeBytes(incidentEdges_);
+    for(auto it = incidentEdges_.begin(); it != incidentEdges_.end(); ++it)
+        incidentEdgesBytes += MemoryUsage::bytes(it.value());
+    usage.add("Cell caches", typeName() + " incident halfedges",
+              incidentEdgesBytes, incidentEdges_.size());
+}
+
 bool VertexCell::checkVertex_() const
 {
     // todo
@@ -13,6 +13,8 @@
 #include "Cell.h"
 #include "Halfedge.h"
 #include <QPair>
+#include <QMap>
+#include <vector>
 
 namespace VectorAnimationComplex
 {
@@ -32,18 +34,34 @@ public:
     // Drawing
     //void draw(Time time, ViewSettings & viewSettings);
     void drawRaw(Time time, ViewSettings & viewSettings);
+    void drawRawHighlight(Time time, ViewSettings & viewSettings);
     void drawRawTopology(Time time, ViewSettings & viewSettings);
 
     // Topology
     CellSet spatialBoundary() const;
     CellSet spatialBoundary(Time t) const;
-    QList<Halfedge> incidentEdges(Time t) const;
 
+    // Halfedges h such that start(h) == this at time t, possibly twice the
+    // same edge if both its end vertices are this. They are cached per
+    // frame, and the returned reference is valid until the spatial star or
+    // the geometry of this vertex changes: don't keep it across edits of the
+    // VAC. The cache is filled by this const method: only call it from the
+    // GUI thread
+    const std::vector<Halfedge> & incidentEdges(Time t) const;
+
+    // Memory usage, including cached incident halfedges
+    void addMemoryUsage(MemoryUsage & usage);
 
 protected:
     virtual ~VertexCell()=0;
 
+    // Reimplemented to clear the cached incident halfedges
+    virtual void clearCachedGeometry_();
+    virtual void processSpatialStarChanged_();
+
 private:
+    // Cached incident halfedges (the integer represent a 1/60th of frame)
+    mutable QMap<int, std::vector<Halfedge> > incidentEdges_;
 
     // Trusting operators
     friend class Operator;
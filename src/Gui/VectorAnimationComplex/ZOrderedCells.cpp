@@ -12,6 +12,9 @@
 #include "Algorithms.h"
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
 #include <QDebug>
 
 namespace VectorAnimationComplex
@@ -136,16 +139,135 @@ void ZOrderedCells::altLower(Cell * cell) { altLower(CellSet() << cell); }
 void ZOrderedCells::altRaiseToTop(Cell * cell) { altRaiseToTop(CellSet() << cell); }
 void ZOrderedCells::altLowerToBottom(Cell * cell) { altLowerToBottom(CellSet() << cell); }
 
-namespace // local free function
+namespace // local free functions and classes
 {
 
-bool intersect(Cell * c, const CellSet & cells)
+// Tolerance larger than the one of BoundingBox::intersects(), so that
+// IntersectionQuery never skips a box it would consider as intersecting
+const double intersectionMargin = 1e-9;
+
+// Answers whether the all-time bounding box of a given cell intersects the
+// one of at least one of the given cells, like testing each of them.
+//
+// The given cells are indexed once, on first query, since raise() and
+// lower() often return before testing for intersection. Their boxes are
+// sorted by xMin and organized as an implicit balanced binary tree (the
+// root of [lo,hi) is at (lo+hi)/2), where each node also stores the bounds
+// of its subtree: maximum xMax and y-range. A query skips all subtrees
+// which are entirely on the left, on the right, above or below the query
+// box.
+//
+// Note: the all-time bounding box of inbetween cells used to be always
+// empty, since InbetweenCell::boundingBox() sampled no frame. Inbetween cells
+// therefore never intersected anything here: raising an inbetween cell moved
+// it to the top, and raising a cell never stopped above an inbetween cell it
+// is drawn over. They now use the conservative box of InbetweenCell, which
+// is the intended behaviour. Being conservative, it can only make raise()
+// and lower() stop earlier, which is still a valid order.
+class IntersectionQuery
 {
-    foreach(Cell * c2, cells)
-        if(c->boundingBox().intersects(c2->boundingBox()))
+public:
+    IntersectionQuery(const CellSet & cells) :
+        cells_(cells),
+        isBuilt_(false)
+    {
+    }
+
+    bool intersects(Cell * c)
+    {
+        if(!isBuilt_)
+            build_();
+
+        if(nodes_.empty())
+            return false;
+
+        return intersects_(0, (int) nodes_.size(), c->boundingBox());
+    }
+
+private:
+    const CellSet & cells_;
+    bool isBuilt_;
+
+    struct Bounds
+    {
+        double xMax, yMin, yMax;
+    };
+    std::vector<BoundingBox> nodes_;
+    std::vector<Bounds> bounds_;
+
+    static bool xMinLessThan_(const BoundingBox & bb1, const BoundingBox & bb2)
+    {
+        return bb1.xMin() < bb2.xMin();
+    }
+
+    void build_()
+    {
+        // Empty boxes never intersect anything, we can ignore them
+        foreach(Cell * c, cells_)
+        {
+            BoundingBox bb = c->boundingBox();
+            if(!bb.isEmpty())
+                nodes_.push_back(bb);
+        }
+        std::sort(nodes_.begin(), nodes_.end(), xMinLessThan_);
+
+        bounds_.resize(nodes_.size());
+        computeBounds_(0, (int) nodes_.size());
+        isBuilt_ = true;
+    }
+
+    Bounds computeBounds_(int lo, int hi)
+    {
+        Bounds res;
+        if(lo >= hi)
+        {
+            const double inf = std::numeric_limits<double>::infinity();
+            res.xMax = -inf;
+            res.yMin = inf;
+            res.yMax = -inf;
+            return res;
+        }
+
+        int mid = (lo + hi) / 2;
+        Bounds left = computeBounds_(lo, mid);
+        Bounds right = computeBounds_(mid+1, hi);
+        const BoundingBox & node = nodes_[mid];
+        res.xMax = std::max(node.xMax(), std::max(left.xMax, right.xMax));
+        res.yMin = std::min(node.yMin(), std::min(left.yMin, right.yMin));
+        res.yMax = std::max(node.yMax(), std::max(left.yMax, right.yMax));
+        bounds_[mid] = res;
+        return res;
+    }
+
+    bool intersects_(int lo, int hi, const BoundingBox & bb) const
+    {
+        if(lo >= hi)
+            return false;
+
+        // All boxes in the subtree are on the left, above, or below bb
+        int mid = (lo + hi) / 2;
+        const Bounds & bounds = bounds_[mid];
+        if(bounds.xMax + intersectionMargin < bb.xMin() ||
+           bounds.yMax + intersectionMargin < bb.yMin() ||
+           bounds.yMin - intersectionMargin > bb.yMax())
+        {
+            return false;
+        }
+
+        const BoundingBox & node = nodes_[mid];
+        if(bb.intersects(node))
             return true;
-    return false;
-}
+
+        if(intersects_(lo, mid, bb))
+            return true;
+
+        // Boxes in the right subtree are on the right of nodes_[mid]
+        if(node.xMin() > bb.xMax() + intersectionMargin)
+            return false;
+
+        return intersects_(mid+1, hi, bb);
+    }
+};
 
 }
 
@@ -167,6 +289,9 @@ void ZOrderedCells::raise(CellSet cellsToRaise)
     // Get cells closure
     CellSet closure = Algorithms::closure(cellsToRaise);
 
+    // Spatial index of cells to raise
+    IntersectionQuery intersectionQuery(cellsToRaise);
+
     // First loop: advance it until we find c1 such that:
     //   - c1 is after every of the cells to raise (i.e., nFound == n)
     //   - c1 is not in the closure of the cells to raise
@@ -183,7 +308,7 @@ void ZOrderedCells::raise(CellSet cellsToRaise)
         {
             it = list_.extractTo(it,raisedCells);
         }
-        else if( (nFound == n) && (intersect(*it,cellsToRaise)) )
+        else if( (nFound == n) && (intersectionQuery.intersects(*it)) )
         {
             c1 = *it;
             break;
@@ -242,6 +367,9 @@ void ZOrderedCells::lower(CellSet cellsToLower)
     // Get cells "fullstar" (i.e., star union itself)
     CellSet fullstar = Algorithms::fullstar(cellsToLower);
 
+    // Spatial index of cells to lower
+    IntersectionQuery intersectionQuery(cellsToLower);
+
     // First loop: advance it until we find c1 such that:
     //   - c1 is before every of the cells to lower (i.e., nFound == n)
     //   - c1 is not in the fullstar of the cells to lower
@@ -258,7 +386,7 @@ void ZOrderedCells::lower(CellSet cellsToLower)
         {
             it = list_.extractTo(it,loweredCells);
         }
-        else if( (nFound == n) && (intersect(*it,cellsToLower)) )
+        else if( (nFound == n) && (intersectionQuery.intersects(*it)) )
         {
             c1 = *it;
             break;
@@ -366,6 +494,9 @@ void ZOrderedCells::altRaise(CellSet cellsToRaise)
     it = list_.extractTo(it,raisedCells);
     nFound++;
 
+    // Spatial index of cells to raise
+    IntersectionQuery intersectionQuery(cellsToRaise);
+
     // First loop: advance it until we find c1 such that:
     //   - c1 is after every of the cells to raise (i.e., nFound == n)
     //   - c1 intersects at least one cell to raise
@@ -377,7 +508,7 @@ void ZOrderedCells::altRaise(CellSet cellsToRaise)
             it = list_.extractTo(it,raisedCells);
             nFound++;
         }
-        else if( (nFound == n) && (intersect(*it,cellsToRaise)) )
+        else if( (nFound == n) && (intersectionQuery.intersects(*it)) )
         {
             c1 = *it;
             break;
@@ -411,6 +542,9 @@ void ZOrderedCells::altLower(CellSet cellsToLower)
     it = list_.extractTo(it,loweredCells);
     nFound++;
 
+    // Spatial index of cells to lower
+    IntersectionQuery intersectionQuery(cellsToLower);
+
     // First loop: advance it until we find c1 such that:
     //   - c1 is before every of the cells to lower (i.e., nFound == n)
     //   - c1 intersects at least one cell to lower
@@ -422,7 +556,7 @@ void ZOrderedCells::altLower(CellSet cellsToLower)
             it = list_.extractTo(it,loweredCells);
             nFound++;
         }
-        else if( (nFound == n) && (intersect(*it,cellsToLower)) )
+        else if( (nFound == n) && (intersectionQuery.intersects(*it)) )
         {
             c1 = *it;
             break;
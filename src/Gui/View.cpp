@@ -7,6 +7,7 @@
 // directory of this distribution and at http://opensource.org/licenses/MIT
 
 #include "View.h"
+#include "ViewActions.h"
 
 #include "Scene.h"
 #include "Timeline.h"
@@ -17,43 +18,33 @@
 #include "Background/BackgroundRenderer.h"
 #include "VectorAnimationComplex/VAC.h"
 #include "VectorAnimationComplex/Cell.h"
+#include "InputTrace.h"
+#include "MemoryUsage.h"
+#include "CameraReprojection.h"
+#include "DirtyRegion.h"
 
 #include <QtDebug>
 #include <QApplication>
 #include <QPushButton>
+#include <QTimer>
 #include <cmath>
 
-// define mouse actions
-
-#define  SELECT_ACTION                                      100
-#define  ADDSELECT_ACTION                                   101
-#define  DESELECT_ACTION                                    102
-#define  TOGGLESELECT_ACTION                                103
-#define  DESELECTALL_ACTION                                 104
-#define  RECTANGLE_OF_SELECTION_ACTION                      105
-#define  DRAG_AND_DROP_ACTION                               106
-#define  SPLIT_ACTION                                       107
-#define  TRANSFORM_SELECTION_ACTION                         108
-
-#define  SKETCH_ACTION                                      200
-#define  SKETCH_CHANGE_PEN_WIDTH_ACTION                     203
-#define  SKETCH_CHANGE_SNAP_THRESHOLD_ACTION                204
-#define  SKETCH_CHANGE_PEN_WIDTH_AND_SNAP_THRESHOLD_ACTION  205
-
-#define  SCULPT_CHANGE_RADIUS_ACTION                        300
-#define  SCULPT_DEFORM_ACTION                               301
-#define  SCULPT_SMOOTH_ACTION                               302
-#define  SCULPT_CHANGE_WIDTH_ACTION                         303
-
-#define  PAINT_ACTION                                       400
-
 View::View(Scene * scene, QWidget * parent) :
     GLWidget(parent, true),
     scene_(scene),
     pickingImg_(0),
     pickingIsEnabled_(true),
     currentAction_(0),
-    vac_(0)
+    vac_(0),
+    isOverlayUpdate_(false),
+    isNavigating_(false),
+    hasSceneImage_(false),
+    sceneImageTextureId_(0),
+    sceneImageFboId_(0),
+    sceneImageWidth_(0),
+    sceneImageHeight_(0),
+    sceneImageRevision_(0),
+    settingsGeneration_(0)
 {
     // Make renderers
     Background * bg = scene_->background();
@@ -65,6 +56,10 @@ View::View(Scene * scene, QWidget * parent) :
     connect(viewSettingsWidget_, SIGNAL(changed()), this, SIGNAL(settingsChanged()));
     cameraTravellingIsEnabled_ = true;
 
+    // Note: beginNavigation_() and endNavigation_() must be called before update()
+    connect(this, SIGNAL(viewIsGoingToChange(int, int)), this, SLOT(beginNavigation_()));
+    connect(this, SIGNAL(viewChanged(int, int)), this, SLOT(endNavigation_()));
+
     connect(this, SIGNAL(viewIsGoingToChange(int, int)), this, SLOT(updatePicking()));
     //connect(this, SIGNAL(viewIsGoingToChange(int, int)), this, SLOT(updateHighlightedObject(int, int)));
     connect(this, SIGNAL(viewIsGoingToChange(int, int)), this, SLOT(update()));
@@ -80,11 +75,29 @@ View::View(Scene * scene, QWidget * parent) :
     connect(this, SIGNAL(viewChanged(int, int)), this, SLOT(update()));
 
     connect(global(), SIGNAL(keyboardModifiersChanged()), this, SLOT(handleNewKeyboardModifiers()));
+
+    // Changes of cells are tracked by the VAC (see drawSceneImage_()), but
+    // not the other changes affecting the image of the scene
+    connect(scene_->background(), SIGNAL(changed()), this, SLOT(invalidateSceneImage_()));
+    connect(viewSettingsWidget_, SIGNAL(changed()), this, SLOT(onSettingsChanged_()));
+    connect(DevSettings::instance(), SIGNAL(changed()), this, SLOT(onSettingsChanged_()));
+
+    // Playback cache
+    prerenderTimer_ = new QTimer(this);
+    prerenderTimer_->setSingleShot(true);
+    prerenderTimer_->setInterval(0);
+    connect(prerenderTimer_, SIGNAL(timeout()), this, SLOT(prerenderPlaybackFrame_()));
+    connect(scene_, SIGNAL(changed()), this, SLOT(restartPrerendering_()));
+    connect(scene_->background(), SIGNAL(changed()), this, SLOT(clearPlaybackCache_()));
+    connect(scene_, SIGNAL(selectionChanged()), this, SLOT(clearPlaybackCache_()));
 }
 
 View::~View()
 {
     deletePicking();
+    deleteSceneImage_();
+    makeCurrent();
+    playbackCache_.clear();
 }
 
 void View::initCamera()
@@ -113,6 +126,7 @@ void View::resizeEvent(QResizeEvent * event)
 void View::resizeGL(int width, int height)
 {
     GLWidget::resizeGL(width, height);
+    hasSceneImage_ = false;
     updatePicking();
 }
 
@@ -163,6 +177,15 @@ void View::update()
     updateGL();
 }
 
+void View::updateOverlay()
+{
+    // Falls back to a full redraw in drawScene() if the image of the scene
+    // is missing or out of date
+    isOverlayUpdate_ = true;
+    updateGL();
+    isOverlayUpdate_ = false;
+}
+
 void View::updateZoomFromView()
 {
     viewSettings_.setZoom(zoom());
@@ -393,6 +416,8 @@ void View::setActive(bool isActive)
 
 void View::ClicEvent(int action, double x, double y)
 {
+    recordInputEvent_(InputTrace::ClicEvent, action, x, y);
+
     // It is View's responsibility to call update() or updatePicking()
 
     if(action==SPLIT_ACTION)
@@ -493,11 +518,12 @@ void View::ClicEvent(int action, double x, double y)
 
 void View::MoveEvent(double x, double y)
 {
-    // Boolean deciding if the scene must be redrawn even though only the mouse
+    // Boolean deciding if the overlays must be redrawn even though only the mouse
     // has moved with no action performed. This is possible because depending on
     // where the mouse is, the action to-be-performed can be different, and
     // feedback to user on what is action would be must be given to user before
-    // the action is undertaken
+    // the action is undertaken. This feedback is all drawn by drawOverlay(), so
+    // the scene itself doesn't have to be redrawn.
     bool mustRedraw = false;
     global()->setSceneCursorPos(Eigen::Vector2d(x,y));
 
@@ -506,6 +532,9 @@ void View::MoveEvent(double x, double y)
     if(hoveredObjectChanged)
         mustRedraw = true;
 
+    // Record after picking, so that the hovered cell is up to date
+    recordInputEvent_(InputTrace::HoverEvent, 0, x, y);
+
     // Update to-be-drawn straight line
     Qt::KeyboardModifiers keys = global()->keyboardModifiers();
     if( (global()->toolMode() == Global::SKETCH) )
@@ -543,10 +572,10 @@ void View::MoveEvent(double x, double y)
     if(mustRedraw)
     {
         // so that the highlighted object is also highlighted in other views
-        // this is a matter of preference, we could call only "update()" if
-        // we don't like this behaviour. But I like it, personally. Maybe
+        // this is a matter of preference, we could call only "updateOverlay()"
+        // if we don't like this behaviour. But I like it, personally. Maybe
         // I could add it as a user preference
-        emit allViewsNeedToUpdate();
+        emit allViewsNeedToUpdateOverlay();
     }
 }
 
@@ -555,9 +584,31 @@ Time View::interactiveTime() const
     return viewSettings_.time();
 }
 
+double View::penWidth_() const
+{
+    double w = global()->settings().edgeWidth();
+    if(mouse_isTablet_ &&  global()->useTabletPressure())
+        w *= 2 * mouse_tabletPressure_; // 2 so that a half-pressure would get the default width
+    return w;
+}
+
+void View::recordInputEvent_(int type, int action, double x, double y)
+{
+    InputTrace * trace = InputTrace::recorder();
+    if(trace)
+    {
+        VectorAnimationComplex::VAC * vac = scene_->vectorAnimationComplex();
+        VectorAnimationComplex::Cell * hoveredCell = vac ? vac->hoveredCell() : 0;
+        trace->record((InputTrace::EventType) type, action, x, y, interactiveTime(),
+                      penWidth_(), hoveredCell ? hoveredCell->id() : -1);
+    }
+}
+
 
 void View::PMRPressEvent(int action, double x, double y)
 {
+    recordInputEvent_(InputTrace::PressEvent, action, x, y);
+
     currentAction_ = action;
 
     // It is View's responsibility to call update() or updatePicking
@@ -596,14 +647,7 @@ void View::PMRPressEvent(int action, double x, double y)
         double xScene = pos.rx();
         double yScene = pos.ry();
 
-        double w = global()->settings().edgeWidth();
-        bool debug = false;
-        if(!debug)
-        {
-            if(mouse_isTablet_ &&  global()->useTabletPressure())
-                w *= 2 * mouse_tabletPressure_; // 2 so that a half-pressure would get the default width
-        }
-        vac_->beginSketchEdge(xScene,yScene, w, interactiveTime());
+        vac_->beginSketchEdge(xScene,yScene, penWidth_(), interactiveTime());
 
         //emit allViewsNeedToUpdatePicking();
         //updateHighlightedObject(mouse_Event_X_, mouse_Event_Y_);
@@ -709,6 +753,8 @@ void View::PMRPressEvent(int action, double x, double y)
 
 void View::PMRMoveEvent(int action, double x, double y)
 {
+    recordInputEvent_(InputTrace::MoveEvent, action, x, y);
+
     global()->setSceneCursorPos(Eigen::Vector2d(x,y));
 
     if(action==SKETCH_ACTION)
@@ -719,14 +765,7 @@ void View::PMRMoveEvent(int action, double x, double y)
         {
             lastMousePos_ = mousePos;
 
-            double w = global()->settings().edgeWidth();
-            bool debug = false;
-            if(!debug)
-            {
-                if(mouse_isTablet_ &&  global()->useTabletPressure())
-                    w *= 2 * mouse_tabletPressure_; // 2 so that a half-pressure would get the default width
-            }
-            vac_->continueSketchEdge(x,y, w); // Note: this call "changed", hence all views are updated
+            vac_->continueSketchEdge(x,y, penWidth_()); // Note: this call "changed", hence all views are updated
         }
 
         //emit allViewsNeedToUpdatePicking();
@@ -876,6 +915,8 @@ void View::PMRMoveEvent(int action, double x, double y)
 }
 void View::PMRReleaseEvent(int action, double x, double y)
 {
+    recordInputEvent_(InputTrace::ReleaseEvent, action, x, y);
+
     currentAction_ = 0;
 
     global()->setSceneCursorPos(Eigen::Vector2d(x,y));
@@ -994,6 +1035,29 @@ void View::drawScene()
         }
     }
 
+    // When only the overlays or a few cells changed, reuse the last full
+    // redraw if possible
+    if(drawSceneImage_())
+    {
+        drawOverlay_();
+        return;
+    }
+
+    // During camera navigation, reuse the last full redraw if possible
+    if(isNavigating_ && drawReprojectedSceneImage_())
+    {
+        drawOverlay_();
+        return;
+    }
+
+    // During playback, reuse the image of this frame if possible
+    if(isPlayed_() && drawPlaybackCacheImage_())
+    {
+        drawOverlay_();
+        prerenderTimer_->start();
+        return;
+    }
+
     // Clear to white
     glClearColor(1.0,1.0,1.0,1.0);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -1010,6 +1074,397 @@ void View::drawScene()
 
     // Draw scene
     drawSceneDelegate_(activeTime());
+
+    // Keep the image for overlay updates and navigation gestures
+    captureSceneImage_();
+
+    // Keep the image for playback, and render next frames when idle
+    if(isPlayed_() && activeTime().type() == Time::ExactFrame)
+    {
+        capturePlaybackCacheImage_(activeTime().frame());
+        prerenderTimer_->start();
+    }
+
+    // Draw overlays
+    drawOverlay_();
+}
+
+void View::drawOverlay_()
+{
+    viewSettings_.setMainDrawing(true);
+    scene_->drawOverlay(activeTime(), viewSettings_);
+}
+
+void View::invalidateSceneImage_()
+{
+    hasSceneImage_ = false;
+}
+
+void View::onSettingsChanged_()
+{
+    // Cached images of the playback cache are invalidated by the new
+    // generation (see updatePlaybackCacheViewport_())
+    ++settingsGeneration_;
+    invalidateSceneImage_();
+}
+
+bool View::isPlayed_() const
+{
+    Timeline * timeline = global()->timeline();
+    return timeline && timeline->isPlaying() &&
+           timeline->playedViews().contains(const_cast<View*>(this));
+}
+
+bool View::updatePlaybackCacheViewport_()
+{
+    playbackCache_.setMaxBytes((qint64) DevSettings::getInt("playback cache (MB)") * 1024 * 1024);
+
+    // Onion skins draw other frames, whose changes don't change the
+    // revision of this frame (see VAC::frameRevision())
+    if(viewSettings_.onionSkinningIsEnabled())
+    {
+        playbackCache_.clear();
+        return false;
+    }
+
+    PlaybackCache::Settings settings;
+    settings.toolMode = global()->toolMode();
+    settings.displayMode = viewSettings_.displayMode();
+    settings.settingsGeneration = settingsGeneration_;
+    playbackCache_.setViewport(camera2D(), viewportWidth_, viewportHeight_, settings);
+
+    // Changes of the canvas require to render all frames again
+    QRectF canvas = canvasRect_();
+    if(canvas != playbackCacheCanvas_)
+    {
+        playbackCache_.clear();
+        playbackCacheCanvas_ = canvas;
+    }
+
+    return playbackCache_.maxNumFrames() > 0 && scene_->vectorAnimationComplex();
+}
+
+bool View::drawPlaybackCacheImage_()
+{
+    Time t = activeTime();
+    if(t.type() != Time::ExactFrame || !updatePlaybackCacheViewport_())
+        return false;
+
+    VectorAnimationComplex::VAC * vac = scene_->vectorAnimationComplex();
+    GLuint textureId = playbackCache_.texture(t.frame(), vac->frameRevision(t.frame()));
+    if(!textureId)
+        return false;
+
+    // The image already contains the canvas and background
+    glClearColor(1.0,1.0,1.0,1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawSceneImageQuad_(QRectF(0, 0, viewportWidth_, viewportHeight_), textureId);
+
+    return true;
+}
+
+void View::capturePlaybackCacheImage_(int frame)
+{
+    if(updatePlaybackCacheViewport_())
+        playbackCache_.capture(frame, scene_->vectorAnimationComplex()->revision());
+}
+
+void View::prerenderPlaybackFrame_()
+{
+    Timeline * timeline = global()->timeline();
+    if(!isPlayed_() || !isVisible() || !updatePlaybackCacheViewport_())
+        return;
+
+    // Next frame of the playing window which is not cached yet, not going
+    // further than what the cache can hold
+    VectorAnimationComplex::VAC * vac = scene_->vectorAnimationComplex();
+    int firstFrame = timeline->firstFrame();
+    int numFrames = timeline->lastFrame() - firstFrame + 1;
+    int currentFrame = std::floor(activeTime().floatTime());
+    int maxLookAhead = std::min(numFrames, playbackCache_.maxNumFrames()) - 1;
+    int frame = 0;
+    bool found = false;
+    for(int i=1; i<=maxLookAhead && !found; ++i)
+    {
+        frame = firstFrame + ((currentFrame + i - firstFrame) % numFrames + numFrames) % numFrames;
+        found = !playbackCache_.contains(frame, vac->frameRevision(frame));
+    }
+    if(!found)
+        return;
+
+    // Draw the frame in the back buffer, as in paintGL(), and copy it. This
+    // is never swapped: the next paintGL() clears it
+    makeCurrent();
+    glDepthMask(GL_TRUE);
+    glClearColor(1.0,1.0,1.0,1.0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    setCameraPositionAndOrientation();
+    scene_->drawCanvas(viewSettings_);
+    drawSceneDelegate_(Time(frame));
+    playbackCache_.capture(frame, vac->revision());
+
+    // Render the next one later, so that playback and user input are
+    // processed in between
+    prerenderTimer_->start();
+}
+
+void View::restartPrerendering_()
+{
+    // Changes of cells give a new revision to the frames where they exist,
+    // so their cached images are simply not used anymore (see
+    // VAC::frameRevision()), and are rendered again
+    if(isPlayed_())
+        prerenderTimer_->start();
+}
+
+void View::clearPlaybackCache_()
+{
+    makeCurrent();
+    playbackCache_.clear();
+}
+
+void View::beginNavigation_()
+{
+    isNavigating_ = DevSettings::getBool("fast navigation");
+    hasSceneImage_ = false;
+}
+
+void View::endNavigation_()
+{
+    isNavigating_ = false;
+    hasSceneImage_ = false;
+}
+
+bool View::drawReprojectedSceneImage_()
+{
+    // Maximum magnification or minification of the reprojected image
+    const double maxScale = 2.0;
+
+    // Maximum fraction of the viewport not covered by the reprojected image
+    const double maxExposedFraction = 0.25;
+
+    int w = viewportWidth_;
+    int h = viewportHeight_;
+    VectorAnimationComplex::VAC * vac = scene_->vectorAnimationComplex();
+    if(!hasSceneImage_ || !sceneImageKey_.isReprojectableTo(currentSceneImageKey_()) ||
+       (vac && vac->revision() != sceneImageRevision_))
+    {
+        return false;
+    }
+
+    CameraReprojection reprojection(sceneImageKey_.camera, camera2D(), w, h);
+    if(!reprojection.isAcceptable(maxScale))
+        return false;
+    if(reprojection.exposedFraction() > maxExposedFraction)
+        return false;
+
+    // Low-detail pass: only draw canvas and background, which are visible
+    // in the exposed regions
+    glClearColor(1.0,1.0,1.0,1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    scene_->drawCanvas(viewSettings_);
+    drawBackground_(scene_->background(), activeTime().frame());
+
+    // Draw reprojected image
+    drawSceneImageQuad_(reprojection.mappedViewport(), sceneImageTextureId_);
+
+    return true;
+}
+
+QRectF View::canvasRect_() const
+{
+    QRectF canvas;
+    if(global()->showCanvas())
+        canvas = QRectF(scene_->left(), scene_->top(), scene_->width(), scene_->height());
+    return canvas;
+}
+
+SceneImageKey View::currentSceneImageKey_() const
+{
+    SceneImageKey key;
+    key.width = viewportWidth_;
+    key.height = viewportHeight_;
+    key.camera = camera2D();
+    key.time = activeTime();
+    key.vac = scene_->vectorAnimationComplex();
+    key.toolMode = global()->toolMode();
+    key.canvas = canvasRect_();
+    return key;
+}
+
+bool View::drawSceneImage_()
+{
+    int w = viewportWidth_;
+    int h = viewportHeight_;
+    GLWidget_Camera2D camera = camera2D();
+    if(!hasSceneImage_ || sceneImageKey_ != currentSceneImageKey_())
+        return false;
+
+    // Regions where cells changed since the image was drawn. Changes of
+    // cells are the only changes tracked: other redraws are full redraws,
+    // unless only the overlays changed
+    VectorAnimationComplex::VAC * vac = scene_->vectorAnimationComplex();
+    DirtyRegion region(w, h);
+    double margin = 0;
+    if(vac && vac->revision() != sceneImageRevision_)
+    {
+        // Onion skins show the cells at other times, whose changes are not
+        // reported by changedRegions()
+        int maxPercent = DevSettings::getInt("dirty region redraw (max %)");
+        QList<VectorAnimationComplex::BoundingBox> boundingBoxes;
+        if(maxPercent == 0 || viewSettings_.onionSkinningIsEnabled() ||
+           !vac->changedRegions(sceneImageRevision_, activeTime(), boundingBoxes))
+        {
+            return false;
+        }
+
+        // Topology is drawn around the triangles of cells, and edges are
+        // antialiased
+        double topologyWidth = std::max(viewSettings_.vertexTopologySize(),
+                                        viewSettings_.edgeTopologyWidth());
+        margin = 2.0 + 0.5 * topologyWidth * (viewSettings_.screenRelative() ? 1.0 : camera.zoom());
+        foreach(const VectorAnimationComplex::BoundingBox & box, boundingBoxes)
+        {
+            if(box.isInfinite())
+                region.addAll();
+            else if(!box.isEmpty())
+                region.addSceneRect(QRectF(box.xMin(), box.yMin(), box.width(), box.height()), camera, margin);
+        }
+        if(100 * region.coveredFraction() > maxPercent)
+            return false;
+    }
+    else if(!isOverlayUpdate_)
+    {
+        return false;
+    }
+
+    // The image already contains the canvas and background
+    glClearColor(1.0,1.0,1.0,1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawSceneImageQuad_(QRectF(0, 0, w, h), sceneImageTextureId_);
+
+    // Redraw changed regions, and keep the result as the new image
+    if(vac && vac->revision() != sceneImageRevision_)
+    {
+        drawDirtyRegion_(region, margin);
+        captureSceneImage_();
+    }
+
+    return true;
+}
+
+void View::drawDirtyRegion_(const DirtyRegion & region, double margin)
+{
+    // Each rectangle is redrawn from scratch, clipped to the rectangle. Cells
+    // which can't be drawn within the rectangle are skipped (see VAC::draw()),
+    // using a scene rectangle grown by the margin, since cells are culled by
+    // their triangles while their topology is drawn beyond
+    GLWidget_Camera2D camera = camera2D();
+    glEnable(GL_SCISSOR_TEST);
+    foreach(const QRect & rect, region.rects())
+    {
+        QRect glRect = region.glRect(rect);
+        glScissor(glRect.x(), glRect.y(), glRect.width(), glRect.height());
+        glClearColor(1.0,1.0,1.0,1.0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        scene_->drawCanvas(viewSettings_);
+
+        double d = margin / camera.zoom();
+        viewSettings_.setDrawingRegion(DirtyRegion::sceneRect(rect, camera).adjusted(-d, -d, d, d));
+        drawSceneDelegate_(activeTime());
+        viewSettings_.setDrawingRegion(QRectF());
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void View::drawSceneImageQuad_(const QRectF & r, GLuint textureId)
+{
+    // Draw in window coordinates. Note that the first row of the texture is
+    // the bottom of the viewport.
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glColor4d(1.0, 1.0, 1.0, 1.0);
+    glBegin(GL_QUADS);
+    {
+        glTexCoord2d(0, 1); glVertex2d(r.left(),  r.top());
+        glTexCoord2d(1, 1); glVertex2d(r.right(), r.top());
+        glTexCoord2d(1, 0); glVertex2d(r.right(), r.bottom());
+        glTexCoord2d(0, 0); glVertex2d(r.left(),  r.bottom());
+    }
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+    glPopMatrix();
+}
+
+void View::captureSceneImage_()
+{
+    int w = viewportWidth_;
+    int h = viewportHeight_;
+    if(w <= 0 || h <= 0)
+        return;
+
+    // The window framebuffer is multisampled, so it can't be copied to a
+    // texture directly. Instead, it is resolved by blitting it to a
+    // framebuffer object with the texture as color attachment.
+    if(!(GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object))
+        return;
+
+    if(sceneImageWidth_ != w || sceneImageHeight_ != h)
+    {
+        deleteSceneImage_();
+
+        glGenTextures(1, &sceneImageTextureId_);
+        glBindTexture(GL_TEXTURE_2D, sceneImageTextureId_);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &sceneImageFboId_);
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneImageFboId_);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, sceneImageTextureId_, 0);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if(status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            deleteSceneImage_();
+            return;
+        }
+
+        sceneImageWidth_ = w;
+        sceneImageHeight_ = h;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sceneImageFboId_);
+    glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    hasSceneImage_ = true;
+    sceneImageKey_ = currentSceneImageKey_();
+    sceneImageRevision_ = sceneImageKey_.vac ? sceneImageKey_.vac->revision() : 0;
+}
+
+void View::deleteSceneImage_()
+{
+    if(sceneImageTextureId_)
+    {
+        glDeleteFramebuffers(1, &sceneImageFboId_);
+        glDeleteTextures(1, &sceneImageTextureId_);
+        sceneImageFboId_ = 0;
+        sceneImageTextureId_ = 0;
+        sceneImageWidth_ = 0;
+        sceneImageHeight_ = 0;
+    }
+    hasSceneImage_ = false;
 }
 
 void View::drawSceneDelegate_(Time t)
@@ -1066,6 +1521,7 @@ void View::toggleOutline()
 {
     viewSettings_.toggleOutline();
     viewSettingsWidget_->updateWidgetFromSettings();
+    onSettingsChanged_();
     update();
 }
 
@@ -1073,6 +1529,7 @@ void View::toggleOutlineOnly()
 {
     viewSettings_.toggleOutlineOnly();
     viewSettingsWidget_->updateWidgetFromSettings();
+    onSettingsChanged_();
     update();
 }
 
@@ -1080,6 +1537,7 @@ void View::setDisplayMode(ViewSettings::DisplayMode displayMode)
 {
     viewSettings_.setDisplayMode(displayMode);
     viewSettingsWidget_->updateWidgetFromSettings();
+    onSettingsChanged_();
     update();
 }
 
@@ -1087,6 +1545,7 @@ void View::setOnionSkinningEnabled(bool enabled)
 {
     viewSettings_.setOnionSkinningIsEnabled(enabled);
     viewSettingsWidget_->updateWidgetFromSettings();
+    onSettingsChanged_();
     update();
 }
 
@@ -1330,6 +1789,32 @@ void View::deletePicking()
     }
 }
 
+void View::addMemoryUsage(MemoryUsage & usage) const
+{
+    if (pickingImg_)
+    {
+        qint64 numPixels = (qint64) WINDOW_SIZE_X_ * WINDOW_SIZE_Y_;
+        usage.add("Views", "Picking images", 4 * numPixels);
+
+        // GPU memory: RGBA8 texture plus one third for mipmaps, and a
+        // 32-bit depth renderbuffer
+        usage.add("Views", "Picking framebuffers", numPixels * 4 * 4 / 3 + numPixels * 4);
+    }
+
+    if (sceneImageTextureId_)
+    {
+        qint64 numPixels = (qint64) sceneImageWidth_ * sceneImageHeight_;
+        usage.add("Views", "Scene images", 4 * numPixels);
+    }
+
+    playbackCache_.addMemoryUsage(usage);
+
+    foreach (BackgroundRenderer * backgroundRenderer, backgroundRenderers_)
+    {
+        backgroundRenderer->addMemoryUsage(usage);
+    }
+}
+
 void View::newPicking()
 {
     //  code adapted from http://www.songho.ca/opengl/gl_fbo.html
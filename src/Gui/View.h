@@ -18,6 +18,7 @@
 #include "GeometryUtils.h"
 #include <QList>
 #include <QPointF>
+#include <QRectF>
 #include <QPoint>
 #include "TimeDef.h"
 
@@ -25,6 +26,8 @@
 #include <QMap>
 
 #include "ViewSettings.h"
+#include "PlaybackCache.h"
+#include "SceneImageKey.h"
 
 
 class Scene;
@@ -37,6 +40,9 @@ class KeyEdge;
 class Time;
 class Background;
 class BackgroundRenderer;
+class MemoryUsage;
+class DirtyRegion;
+class QTimer;
 
 // mouse event in scene coordinates
 struct MouseEvent 
@@ -116,8 +122,12 @@ public:
     QImage drawToImage(double x, double y, double w, double h, int imgW, int imgH, bool useViewSettings);
     QImage drawToImage(Time t, double x, double y, double w, double h, int imgW, int imgH, bool useViewSettings);
 
+    // Memory held by the picking buffers and background textures of this view
+    void addMemoryUsage(MemoryUsage & usage) const;
+
 public slots:
     void update();        // update only this view (i.e., redraw the scene, leave other views unchanged)
+    void updateOverlay(); // update only the hover feedback and cursors of this view (see SceneObject::drawOverlay())
     void updatePicking(); // update picking for this view only (i.e., redraw the picking image of this view)
     bool updateHoveredObject(int x, int y);
     void handleNewKeyboardModifiers();
@@ -135,9 +145,27 @@ public slots:
 protected:
     virtual void resizeEvent(QResizeEvent * event);
 
+private slots:
+    // Camera navigation gestures (dolly, travelling, zoom)
+    void beginNavigation_();
+    void endNavigation_();
+
+    // Called when something drawn in the image of the scene changes, other
+    // than cells, whose changes are tracked by the VAC
+    void invalidateSceneImage_();
+
+    // Called when view settings or dev settings change
+    void onSettingsChanged_();
+
+    // Playback cache
+    void restartPrerendering_();
+    void clearPlaybackCache_();
+    void prerenderPlaybackFrame_();
+
 signals:
     void allViewsNeedToUpdate();        // update all views (including other 2D or 3D views)
     void allViewsNeedToUpdatePicking(); // update picking of all views (including other 2D or 3D views)
+    void allViewsNeedToUpdateOverlay(); // update hover feedback and cursors of all views
 
     void settingsChanged();
 
@@ -155,6 +183,13 @@ private:
     MouseEvent mouseEvent() const;
     QPoint lastMousePos_;
 
+    // Width of sketched edges, taking tablet pressure into account
+    double penWidth_() const;
+
+    // Appends the given event to the input trace, if one is being recorded.
+    // type is an InputTrace::EventType
+    void recordInputEvent_(int type, int action, double x, double y);
+
     // picking
     void newPicking();
     void drawPick();
@@ -191,6 +226,55 @@ private:
     // than one Background (i.e., one per layer)
     void drawBackground_(Background * background, int frame);
     QMap<Background *, BackgroundRenderer *> backgroundRenderers_;
+
+    // Image of the last full redraw of the scene, without overlays.
+    //
+    // When only the overlays change (e.g., the mouse moves in sketch mode, or
+    // another cell is hovered), the image is drawn back as is and the
+    // overlays are drawn over it, instead of redrawing all cells.
+    //
+    // Fast camera navigation. During a navigation gesture, the image is
+    // reprojected with the new camera (see CameraReprojection.h), over a
+    // redraw of the canvas and background only. The scene is fully redrawn
+    // when the gesture ends, or when the reprojected image becomes too
+    // blurry or doesn't cover enough of the viewport.
+    //
+    // Dirty regions. When cells changed since the image was drawn, only
+    // the regions of the image where they were and are now drawn are
+    // redrawn (see VAC::changedRegions() and DirtyRegion.h), unless these
+    // regions cover too much of the viewport.
+    bool isOverlayUpdate_;
+    bool isNavigating_;
+    bool hasSceneImage_;
+    GLuint sceneImageTextureId_;
+    GLuint sceneImageFboId_;
+    int sceneImageWidth_;
+    int sceneImageHeight_;
+    SceneImageKey sceneImageKey_;
+    quint64 sceneImageRevision_;
+    int settingsGeneration_; // incremented by onSettingsChanged_()
+    SceneImageKey currentSceneImageKey_() const;
+    QRectF canvasRect_() const;
+    bool drawSceneImage_();
+    void drawDirtyRegion_(const DirtyRegion & region, double margin);
+    bool drawPlaybackCacheImage_();
+    bool drawReprojectedSceneImage_();
+    void drawSceneImageQuad_(const QRectF & rect, GLuint textureId);
+    void drawOverlay_();
+
+    // Playback cache. While this view is played, the images of the frames
+    // drawn are kept, and the frames of the playing window which are not
+    // cached yet are rendered one at a time when the event loop is idle.
+    // Cached frames are then drawn as is, unless one of their cells changed
+    // (see VAC::frameRevision()). Subframes are always drawn live.
+    PlaybackCache playbackCache_;
+    QRectF playbackCacheCanvas_;
+    QTimer * prerenderTimer_;
+    bool isPlayed_() const;
+    bool updatePlaybackCacheViewport_();
+    void capturePlaybackCacheImage_(int frame);
+    void captureSceneImage_();
+    void deleteSceneImage_();
 };
 
 #endif
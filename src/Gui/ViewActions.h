@@ -0,0 +1,38 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef VIEWACTIONS_H
+#define VIEWACTIONS_H
+
+// Mouse actions of View. They are shared with InputReplayer, which replays
+// recorded actions, hence the separate header. Don't include it in View3D.cpp
+// which defines its own actions.
+
+#define  SELECT_ACTION                                      100
+#define  ADDSELECT_ACTION                                   101
+#define  DESELECT_ACTION                                    102
+#define  TOGGLESELECT_ACTION                                103
+#define  DESELECTALL_ACTION                                 104
+#define  RECTANGLE_OF_SELECTION_ACTION                      105
+#define  DRAG_AND_DROP_ACTION                               106
+#define  SPLIT_ACTION                                       107
+#define  TRANSFORM_SELECTION_ACTION                         108
+
+#define  SKETCH_ACTION                                      200
+#define  SKETCH_CHANGE_PEN_WIDTH_ACTION                     203
+#define  SKETCH_CHANGE_SNAP_THRESHOLD_ACTION                204
+#define  SKETCH_CHANGE_PEN_WIDTH_AND_SNAP_THRESHOLD_ACTION  205
+
+#define  SCULPT_CHANGE_RADIUS_ACTION                        300
+#define  SCULPT_DEFORM_ACTION                               301
+#define  SCULPT_SMOOTH_ACTION                               302
+#define  SCULPT_CHANGE_WIDTH_ACTION                         303
+
+#define  PAINT_ACTION                                       400
+
+#endif // VIEWACTIONS_H
@@ -121,6 +121,15 @@ void ViewSettings::setMainDrawing(bool newValue)
     }
 }
 
+QRectF ViewSettings::drawingRegion() const
+{
+    return drawingRegion_;
+}
+void ViewSettings::setDrawingRegion(const QRectF & region)
+{
+    drawingRegion_ = region;
+}
+
 int ViewSettings::vertexTopologySize() const
 {
     return vertexTopologySize_;
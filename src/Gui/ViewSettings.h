@@ -12,6 +12,7 @@
 #include "TimeDef.h"
 #include <QWidget>
 #include <QPushButton>
+#include <QRectF>
 
 class ViewSettings
 {
@@ -44,6 +45,13 @@ public:
     bool isMainDrawing() const;
     void setMainDrawing(bool newValue);
 
+    // Region of the scene being redrawn, in scene coordinates, when only
+    // some regions of a view are redrawn (see View::drawSceneImage_()).
+    // Cells which don't intersect it can be skipped. Null if the whole
+    // view is redrawn
+    QRectF drawingRegion() const;
+    void setDrawingRegion(const QRectF & region);
+
 
     int vertexTopologySize() const;
     void setVertexTopologySize(int newValue);
@@ -96,6 +104,7 @@ private:
     bool drawBackground_;
     bool drawCursor_;
     bool isMainDrawing_;
+    QRectF drawingRegion_;
     int vertexTopologySize_;
     int edgeTopologyWidth_;
     bool drawTopologyFaces_;
@@ -10,10 +10,16 @@
 #include "MainWindow.h"
 #include "Global.h"
 #include "UpdateCheck.h"
+#include "InputReplayer.h"
 
 int main(int argc, char *argv[])
 {
     Application app(argc, argv);
+
+    // Headless replay of an input trace, for benchmarking
+    if(app.arguments().contains("--replay"))
+        return InputReplayer::runFromCommandLine(app.arguments());
+
     MainWindow mainWindow;
     UpdateCheck update(&mainWindow);
 
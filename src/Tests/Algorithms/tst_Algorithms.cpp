@@ -0,0 +1,278 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/Algorithms.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/KeyFace.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+#include "VectorAnimationComplex/InbetweenEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/Path.h"
+#include "VectorAnimationComplex/Cycle.h"
+#include "VectorAnimationComplex/AnimatedVertex.h"
+
+#include <QThread>
+#include <random>
+#include <algorithm>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+// Implementations of connected(), closure() and fullstar() before
+// CellMarks, based on copied sets
+namespace Reference
+{
+
+CellSet connected(const CellSet & cells)
+{
+    CellSet res = cells;
+    CellSet addedCells = cells;
+    while(addedCells.size() != 0)
+    {
+        CellSet newAddedCells;
+        foreach(Cell * c, addedCells)
+        {
+            foreach(Cell * d, c->neighbourhood())
+            {
+                if(!res.contains(d))
+                {
+                    res << d;
+                    newAddedCells << d;
+                }
+            }
+        }
+        addedCells = newAddedCells;
+    }
+    return res;
+}
+
+CellSet closure(const CellSet & cells)
+{
+    CellSet res;
+    foreach(Cell * c, cells)
+    {
+        res << c;
+        foreach(Cell * b, c->boundary())
+            res << b;
+    }
+    return res;
+}
+
+CellSet fullstar(const CellSet & cells)
+{
+    CellSet res;
+    foreach(Cell * c, cells)
+    {
+        res << c;
+        foreach(Cell * b, c->star())
+            res << b;
+    }
+    return res;
+}
+
+}
+
+// Two keyframes of random key vertices, open edges sharing these vertices,
+// and closed edges filled by faces, then inbetween vertices and edges
+// between some of the edges of the two keyframes
+QList<Cell*> createScene(VAC & vac, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> pos(0, 100);
+    QList<Cell*> res;
+    QList<KeyEdge*> openEdges[2];
+    QList<KeyEdge*> closedEdges[2];
+    for(int t=0; t<2; ++t)
+    {
+        QList<KeyVertex*> vertices;
+        for(int i=0; i<15; ++i)
+        {
+            vertices << vac.newKeyVertex(Time(t), Eigen::Vector2d(pos(rng), pos(rng)));
+            res << vertices.last();
+        }
+        for(int i=0; i<12; ++i)
+        {
+            KeyVertex * v1 = vertices[rng() % vertices.size()];
+            KeyVertex * v2 = vertices[rng() % vertices.size()];
+            if(v1 == v2)
+                continue;
+            openEdges[t] << vac.newKeyEdge(Time(t), v1, v2);
+            res << openEdges[t].last();
+        }
+        for(int i=0; i<3; ++i)
+        {
+            double x = pos(rng);
+            double y = pos(rng);
+            QList<Eigen::Vector2d> points;
+            points << Eigen::Vector2d(x, y) << Eigen::Vector2d(x+10, y) << Eigen::Vector2d(x+10, y+10);
+            closedEdges[t] << vac.newKeyEdge(Time(t), new LinearSpline(points));
+            res << closedEdges[t].last();
+            res << vac.newKeyFace(Cycle(QList<KeyHalfedge>() << KeyHalfedge(closedEdges[t].last(), true)));
+        }
+    }
+
+    QMap<QPair<KeyVertex*, KeyVertex*>, InbetweenVertex*> inbetweenVertices;
+    for(int i=0; i<std::min(openEdges[0].size(), openEdges[1].size()) / 2; ++i)
+    {
+        KeyEdge * e0 = openEdges[0][i];
+        KeyEdge * e1 = openEdges[1][i];
+        InbetweenVertex * svs[2];
+        KeyVertex * ends0[2] = { e0->startVertex(), e0->endVertex() };
+        KeyVertex * ends1[2] = { e1->startVertex(), e1->endVertex() };
+        for(int j=0; j<2; ++j)
+        {
+            QPair<KeyVertex*, KeyVertex*> key(ends0[j], ends1[j]);
+            if(!inbetweenVertices.contains(key))
+            {
+                inbetweenVertices[key] = vac.newInbetweenVertex(ends0[j], ends1[j]);
+                res << inbetweenVertices[key];
+            }
+            svs[j] = inbetweenVertices[key];
+        }
+        res << vac.newInbetweenEdge(
+                   Path(QList<KeyHalfedge>() << KeyHalfedge(e0, true)),
+                   Path(QList<KeyHalfedge>() << KeyHalfedge(e1, true)),
+                   AnimatedVertex(InbetweenVertexList() << svs[0]),
+                   AnimatedVertex(InbetweenVertexList() << svs[1]));
+    }
+    res << vac.newInbetweenEdge(
+               Cycle(QList<KeyHalfedge>() << KeyHalfedge(closedEdges[0][0], true)),
+               Cycle(QList<KeyHalfedge>() << KeyHalfedge(closedEdges[1][0], true)));
+
+    return res;
+}
+
+CellSet randomSubset(const QList<Cell*> & cells, std::mt19937 & rng, int size)
+{
+    CellSet res;
+    for(int i=0; i<size; ++i)
+        res << cells[rng() % cells.size()];
+    return res;
+}
+
+// Compares the traversals of a VAC with the reference, which can be run in
+// another thread
+class Comparison: public QThread
+{
+public:
+    Comparison(unsigned int seed) : seed(seed), numMismatches(0), numTraversals(0)
+    {
+        cells = createScene(vac, seed);
+    }
+
+    VAC vac;
+    QList<Cell*> cells;
+    unsigned int seed;
+    int numMismatches;
+    int numTraversals;
+
+    void run()
+    {
+        std::mt19937 rng(seed);
+        for(int i=0; i<300; ++i)
+        {
+            CellSet subset = randomSubset(cells, rng, 1 + i % 5);
+            if(Algorithms::closure(subset) != Reference::closure(subset))
+                ++numMismatches;
+            if(Algorithms::fullstar(subset) != Reference::fullstar(subset))
+                ++numMismatches;
+            if(Algorithms::connected(subset) != Reference::connected(subset))
+                ++numMismatches;
+            Cell * c = *subset.begin();
+            if(Algorithms::closure(c) != Reference::closure(CellSet() << c))
+                ++numMismatches;
+            if(Algorithms::fullstar(c) != Reference::fullstar(CellSet() << c))
+                ++numMismatches;
+            numTraversals += 5;
+        }
+    }
+};
+
+}
+
+class TestAlgorithms: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sameAsReference()
+    {
+        for(unsigned int seed=1; seed<=10; ++seed)
+        {
+            Comparison comparison(seed);
+            comparison.run();
+            QCOMPARE(comparison.numTraversals, 1500);
+            QCOMPARE(comparison.numMismatches, 0);
+        }
+    }
+
+    void emptySets()
+    {
+        QVERIFY(Algorithms::closure(CellSet()).isEmpty());
+        QVERIFY(Algorithms::fullstar(CellSet()).isEmpty());
+        QVERIFY(Algorithms::connected(CellSet()).isEmpty());
+    }
+
+    // Marks are per VAC: a traversal of a VAC can run while another VAC is
+    // being traversed, and a new traversal unmarks all cells
+    void marksArePerVAC()
+    {
+        Comparison comparison1(1);
+        Comparison comparison2(2);
+
+        Algorithms::CellMarks marks(&comparison1.vac);
+        Cell * c = comparison1.cells[0];
+        QVERIFY(marks.mark(c));
+        QVERIFY(!marks.mark(c));
+        QVERIFY(marks.isMarked(c));
+
+        CellSet subset;
+        subset << comparison2.cells[0] << comparison2.cells[20];
+        QCOMPARE(Algorithms::closure(subset), Reference::closure(subset));
+        QCOMPARE(Algorithms::connected(subset), Reference::connected(subset));
+        QVERIFY(marks.isMarked(c));
+
+        Algorithms::CellMarks marks2(&comparison2.vac);
+        QVERIFY(!marks2.isMarked(c));
+    }
+
+    // Different VACs can be traversed concurrently
+    void concurrentVACs()
+    {
+        QList<Comparison*> comparisons;
+        for(unsigned int seed=1; seed<=4; ++seed)
+            comparisons << new Comparison(seed);
+        foreach(Comparison * comparison, comparisons)
+            comparison->start();
+        foreach(Comparison * comparison, comparisons)
+            comparison->wait();
+        foreach(Comparison * comparison, comparisons)
+        {
+            QCOMPARE(comparison->numTraversals, 1500);
+            QCOMPARE(comparison->numMismatches, 0);
+        }
+        qDeleteAll(comparisons);
+    }
+
+    void generationsAreUnique()
+    {
+        quint64 g1 = Algorithms::CellMarks::newGeneration();
+        quint64 g2 = Algorithms::CellMarks::newGeneration();
+        QVERIFY(g1 != 0);
+        QVERIFY(g2 > g1);
+    }
+};
+
+VPAINT_TEST_MAIN(TestAlgorithms)
+#include "tst_Algorithms.moc"
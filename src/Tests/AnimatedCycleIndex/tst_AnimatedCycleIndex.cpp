@@ -0,0 +1,486 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/AnimatedCycle.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/KeyHalfedge.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+
+#include <QStack>
+#include <random>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+// Nodes reachable from first(), found without the index
+QSet<AnimatedCycleNode *> bruteNodes(const AnimatedCycle & cycle)
+{
+    QSet<AnimatedCycleNode *> res;
+    QStack<AnimatedCycleNode *> toProcess;
+    if(cycle.first())
+    {
+        res << cycle.first();
+        toProcess.push(cycle.first());
+    }
+    while(!toProcess.isEmpty())
+    {
+        AnimatedCycleNode * node = toProcess.pop();
+        AnimatedCycleNode * pointedNodes[4] = { node->previous(), node->next(),
+                                                node->before(), node->after() };
+        for(int i=0; i<4; ++i)
+        {
+            if(pointedNodes[i] && !res.contains(pointedNodes[i]))
+            {
+                res << pointedNodes[i];
+                toProcess.push(pointedNodes[i]);
+            }
+        }
+    }
+    return res;
+}
+
+CellSet bruteCells(const AnimatedCycle & cycle)
+{
+    CellSet res;
+    foreach(AnimatedCycleNode * node, bruteNodes(cycle))
+        res << node->cell();
+    return res;
+}
+
+QSet<AnimatedCycleNode *> bruteNodes(const AnimatedCycle & cycle, Cell * cell)
+{
+    QSet<AnimatedCycleNode *> res;
+    foreach(AnimatedCycleNode * node, bruteNodes(cycle))
+        if(node->cell() == cell)
+            res << node;
+    return res;
+}
+
+// getNode(time) before the time index: walks from first() along after()
+AnimatedCycleNode * bruteNode(const AnimatedCycle & cycle, Time time)
+{
+    AnimatedCycleNode * res = cycle.first();
+    while(res && !res->cell()->exists(time))
+        res = res->after();
+    return res;
+}
+
+// Key vertices and open key edges at times 0, 2, 4 and 6, and inbetween
+// vertices between them
+struct Scene
+{
+    VAC vac;
+    QList<KeyVertex *> keyVertices;
+    QList<KeyEdge *> keyEdges;
+    QList<Cell *> cells;
+    QList<Time> times;
+
+    Scene()
+    {
+        const int numVertices = 3;
+        for(int t=0; t<=6; t+=2)
+        {
+            for(int k=0; k<numVertices; ++k)
+                keyVertices << vac.newKeyVertex(Time(t), Eigen::Vector2d(10 * k, t));
+            int first = keyVertices.size() - numVertices;
+            for(int k=0; k<numVertices; ++k)
+                keyEdges << vac.newKeyEdge(Time(t), keyVertices[first + k],
+                                           keyVertices[first + (k+1) % numVertices]);
+        }
+        foreach(KeyVertex * v, keyVertices)
+            cells << v;
+        foreach(KeyEdge * e, keyEdges)
+            cells << e;
+        for(int i=0; i+numVertices<keyVertices.size(); ++i)
+            cells << vac.newInbetweenVertex(keyVertices[i], keyVertices[i+numVertices]);
+
+        for(int f=-1; f<=7; ++f)
+            times << Time(f) << Time(f, true) << Time(f + 0.5);
+    }
+
+    // Time at which the given cell ends
+    static Time end(Cell * cell)
+    {
+        KeyCell * keyCell = cell->toKeyCell();
+        return keyCell ? keyCell->time() : cell->toInbetweenCell()->afterTime();
+    }
+};
+
+// Compares all queries of the index with the brute-force traversal
+bool hasValidIndex(AnimatedCycle & cycle, const Scene & scene)
+{
+    if(cycle.nodes() != bruteNodes(cycle))
+        return false;
+    if(cycle.cells() != bruteCells(cycle))
+        return false;
+    foreach(Cell * cell, scene.cells)
+        if(cycle.getNodes(cell) != bruteNodes(cycle, cell))
+            return false;
+    foreach(Time time, scene.times)
+        if(cycle.getNode(time) != bruteNode(cycle, time))
+            return false;
+    return true;
+}
+
+// A random cycle of nodes. Nodes are ordered: next() makes a loop through
+// all of them, so that they are all reachable, and before() and after()
+// only point to previous and following nodes, so that after() never loops.
+// If sorted, the nodes are ordered by end time, which makes the time index
+// sorted.
+struct RandomCycle
+{
+    AnimatedCycle cycle;
+    QList<AnimatedCycleNode *> nodes;
+
+    RandomCycle(const Scene & scene, std::mt19937 & rng, bool sorted)
+    {
+        int numNodes = std::uniform_int_distribution<int>(1, 30)(rng);
+        QList<Cell *> cells;
+        for(int i=0; i<numNodes; ++i)
+            cells << randomCell(scene, rng);
+        if(sorted)
+            std::stable_sort(cells.begin(), cells.end(), [](Cell * c1, Cell * c2) {
+                return Scene::end(c1) < Scene::end(c2); });
+
+        foreach(Cell * cell, cells)
+            nodes << new AnimatedCycleNode(cell);
+        for(int i=0; i<numNodes; ++i)
+        {
+            nodes[i]->setNext(nodes[(i+1) % numNodes]);
+            nodes[i]->setPrevious(nodes[randomIndex(0, numNodes-1, rng)]);
+            nodes[i]->setBefore(randomNode(0, i-1, rng));
+            nodes[i]->setAfter(randomNode(i+1, numNodes-1, rng));
+            nodes[i]->setSide(rng() % 2);
+        }
+        cycle.setFirst(nodes[0]);
+    }
+
+    static Cell * randomCell(const Scene & scene, std::mt19937 & rng)
+    {
+        return scene.cells[randomIndex(0, scene.cells.size()-1, rng)];
+    }
+
+    static int randomIndex(int min, int max, std::mt19937 & rng)
+    {
+        return std::uniform_int_distribution<int>(min, max)(rng);
+    }
+
+    // A random node in [min, max], or null one time out of four
+    AnimatedCycleNode * randomNode(int min, int max, std::mt19937 & rng) const
+    {
+        if(min > max || rng() % 4 == 0)
+            return 0;
+        else
+            return nodes[randomIndex(min, max, rng)];
+    }
+
+    // Modifies a random node through its setters
+    void modify(const Scene & scene, std::mt19937 & rng)
+    {
+        int i = randomIndex(0, nodes.size()-1, rng);
+        switch(rng() % 4)
+        {
+        case 0:
+            nodes[i]->setCell(randomCell(scene, rng));
+            break;
+        case 1:
+            nodes[i]->setPrevious(nodes[randomIndex(0, nodes.size()-1, rng)]);
+            break;
+        case 2:
+            nodes[i]->setBefore(randomNode(0, i-1, rng));
+            break;
+        default:
+            nodes[i]->setAfter(randomNode(i+1, nodes.size()-1, rng));
+            break;
+        }
+    }
+};
+
+QtMessageHandler defaultMessageHandler = 0;
+
+// getNode(time) warns when no node exists at time, which is expected
+void messageHandler(QtMsgType type, const QMessageLogContext & context, const QString & msg)
+{
+    if(!msg.startsWith("node(t) not found"))
+        defaultMessageHandler(type, context, msg);
+}
+
+} // end namespace
+
+class TestAnimatedCycleIndex: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        defaultMessageHandler = qInstallMessageHandler(messageHandler);
+    }
+
+    void cleanupTestCase()
+    {
+        qInstallMessageHandler(defaultMessageHandler);
+    }
+
+    void emptyCycle()
+    {
+        Scene scene;
+        AnimatedCycle cycle;
+        QVERIFY(hasValidIndex(cycle, scene));
+        QVERIFY(cycle.nodes().isEmpty());
+        QVERIFY(cycle.getNode(Time(0)) == 0);
+    }
+
+    // Queries of random cycles, sorted by time or not, including after
+    // modifying their nodes through the setters of the nodes
+    void randomCycles()
+    {
+        Scene scene;
+        std::mt19937 rng(83);
+        for(int i=0; i<200; ++i)
+        {
+            RandomCycle random(scene, rng, i % 2);
+            QVERIFY(hasValidIndex(random.cycle, scene));
+            for(int j=0; j<5; ++j)
+            {
+                random.modify(scene, rng);
+                QVERIFY(hasValidIndex(random.cycle, scene));
+            }
+
+            // A cell whose time changes requires clearing the time index
+            random.cycle.clearCachedTimeIndex();
+            QVERIFY(hasValidIndex(random.cycle, scene));
+        }
+    }
+
+    void replaceVertex()
+    {
+        Scene scene;
+        std::mt19937 rng(8301);
+        for(int i=0; i<200; ++i)
+        {
+            RandomCycle random(scene, rng, i % 2);
+            for(int j=0; j<5; ++j)
+            {
+                // Index first or not, and replace by a vertex at the same
+                // time or not
+                if(rng() % 2)
+                    random.cycle.nodes();
+                KeyVertex * oldVertex = scene.keyVertices[
+                        RandomCycle::randomIndex(0, scene.keyVertices.size()-1, rng)];
+                KeyVertex * newVertex = scene.keyVertices[
+                        RandomCycle::randomIndex(0, scene.keyVertices.size()-1, rng)];
+                QSet<AnimatedCycleNode *> replaced = bruteNodes(random.cycle, oldVertex);
+                random.cycle.replaceVertex(oldVertex, newVertex);
+                QVERIFY(hasValidIndex(random.cycle, scene));
+                foreach(AnimatedCycleNode * node, replaced)
+                    QVERIFY(node->cell() == newVertex);
+            }
+        }
+    }
+
+    void replaceHalfedge()
+    {
+        Scene scene;
+        std::mt19937 rng(8302);
+        for(int i=0; i<200; ++i)
+        {
+            RandomCycle random(scene, rng, i % 2);
+            for(int j=0; j<5; ++j)
+            {
+                if(rng() % 2)
+                    random.cycle.nodes();
+                KeyHalfedge oldHalfedge(scene.keyEdges[
+                        RandomCycle::randomIndex(0, scene.keyEdges.size()-1, rng)], rng() % 2);
+                KeyHalfedge newHalfedge(scene.keyEdges[
+                        RandomCycle::randomIndex(0, scene.keyEdges.size()-1, rng)], rng() % 2);
+                QMap<AnimatedCycleNode *, bool> sides;
+                foreach(AnimatedCycleNode * node, bruteNodes(random.cycle, oldHalfedge.edge))
+                    sides[node] = node->side();
+                random.cycle.replaceHalfedge(oldHalfedge, newHalfedge);
+                QVERIFY(hasValidIndex(random.cycle, scene));
+                foreach(AnimatedCycleNode * node, sides.keys())
+                {
+                    QVERIFY(node->cell() == newHalfedge.edge);
+                    QCOMPARE(node->side(), (sides[node] == oldHalfedge.side) == newHalfedge.side);
+                }
+            }
+        }
+    }
+
+    // Replaces an open key edge, traversed in both directions, by several
+    // edges, in a cycle made of two triangles at times 0 and 2 connected by
+    // an inbetween vertex
+    void replaceOpenEdges()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        AnimatedCycleNode * n[3];
+        AnimatedCycleNode * m[3];
+        for(int k=0; k<3; ++k)
+        {
+            n[k] = new AnimatedCycleNode(scene.keyEdges[k]);
+            m[k] = new AnimatedCycleNode(scene.keyEdges[3 + k]);
+        }
+        n[1]->setSide(false);
+        for(int k=0; k<3; ++k)
+        {
+            n[k]->setNext(n[(k+1) % 3]);
+            n[k]->setPrevious(n[(k+2) % 3]);
+            m[k]->setNext(m[(k+1) % 3]);
+            m[k]->setPrevious(m[(k+2) % 3]);
+        }
+        AnimatedCycleNode * iv = new AnimatedCycleNode(scene.cells[2 * scene.keyVertices.size()]);
+        iv->setNext(iv);
+        iv->setPrevious(iv);
+        n[0]->setAfter(iv);
+        iv->setBefore(n[0]);
+        iv->setAfter(m[0]);
+        m[0]->setBefore(iv);
+        m[1]->setBefore(n[1]);
+        n[1]->setAfter(m[1]);
+        AnimatedCycle cycle(n[0]);
+        QVERIFY(hasValidIndex(cycle, scene));
+
+        KeyEdge * e0 = scene.keyEdges[0];
+        KeyVertex * x = vac.newKeyVertex(Time(0), Eigen::Vector2d(5, 5));
+        KeyEdgeList split;
+        split << vac.newKeyEdge(Time(0), e0->startVertex(), x)
+              << vac.newKeyEdge(Time(0), x, e0->endVertex());
+        scene.cells << x << split[0] << split[1];
+        cycle.replaceEdges(e0, split);
+        QVERIFY(hasValidIndex(cycle, scene));
+        QVERIFY(cycle.getNodes(e0).isEmpty());
+        QCOMPARE(cycle.getNodes(x).size(), 1);
+        QVERIFY(cycle.first()->cell() == split[0]);
+
+        KeyEdge * e1 = scene.keyEdges[1];
+        KeyVertex * y = vac.newKeyVertex(Time(0), Eigen::Vector2d(15, 5));
+        KeyVertex * z = vac.newKeyVertex(Time(0), Eigen::Vector2d(15, 10));
+        KeyEdgeList reversed;
+        reversed << vac.newKeyEdge(Time(0), e1->startVertex(), y)
+                 << vac.newKeyEdge(Time(0), y, z)
+                 << vac.newKeyEdge(Time(0), z, e1->endVertex());
+        scene.cells << y << z << reversed[0] << reversed[1] << reversed[2];
+        cycle.nodes();
+        cycle.replaceEdges(e1, reversed);
+        QVERIFY(hasValidIndex(cycle, scene));
+        QCOMPARE(cycle.getNodes(reversed[2]).size(), 1);
+        QVERIFY(m[1]->before()->cell() == reversed[0]);
+        QCOMPARE(cycle.nodes().size(), 12);
+    }
+
+    // Replaces a closed key edge at time 0, between closed key edges at times
+    // -2 and 2, by an open edge
+    void replaceClosedEdge()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        KeyEdge * closed[3];
+        AnimatedCycleNode * nodes[3];
+        for(int i=0; i<3; ++i)
+        {
+            closed[i] = vac.newKeyEdge(Time(2 * i - 2));
+            scene.cells << closed[i];
+            nodes[i] = new AnimatedCycleNode(closed[i]);
+            nodes[i]->setNext(nodes[i]);
+            nodes[i]->setPrevious(nodes[i]);
+        }
+        for(int i=0; i<2; ++i)
+        {
+            nodes[i]->setAfter(nodes[i+1]);
+            nodes[i+1]->setBefore(nodes[i]);
+        }
+        AnimatedCycle cycle(nodes[0]);
+        QVERIFY(hasValidIndex(cycle, scene));
+
+        KeyVertex * x = vac.newKeyVertex(Time(0));
+        KeyEdgeList cut;
+        cut << vac.newKeyEdge(Time(0), x, x);
+        scene.cells << x << cut[0];
+        cycle.replaceEdges(closed[1], cut);
+        QVERIFY(hasValidIndex(cycle, scene));
+        QVERIFY(cycle.getNodes(closed[1]).isEmpty());
+        QVERIFY(cycle.getNode(Time(0))->cell() == cut[0]);
+        QCOMPARE(cycle.nodes().size(), 4);
+    }
+
+    // Copies have their own nodes and index: modifying one doesn't
+    // invalidate the index of the other
+    void copies()
+    {
+        Scene scene;
+        std::mt19937 rng(8303);
+        for(int i=0; i<100; ++i)
+        {
+            RandomCycle random(scene, rng, i % 2);
+            QVERIFY(hasValidIndex(random.cycle, scene));
+
+            AnimatedCycle copy(random.cycle);
+            AnimatedCycle assigned;
+            assigned.nodes();
+            assigned = random.cycle;
+            QVERIFY(hasValidIndex(copy, scene));
+            QVERIFY(hasValidIndex(assigned, scene));
+            QCOMPARE(copy.cells(), random.cycle.cells());
+            QCOMPARE(assigned.nodes().size(), random.cycle.nodes().size());
+
+            random.modify(scene, rng);
+            QVERIFY(hasValidIndex(random.cycle, scene));
+            QVERIFY(hasValidIndex(copy, scene));
+
+            foreach(AnimatedCycleNode * node, copy.nodes())
+                node->setCell(scene.keyVertices[0]);
+            QVERIFY(hasValidIndex(copy, scene));
+            QVERIFY(hasValidIndex(random.cycle, scene));
+            QVERIFY(hasValidIndex(assigned, scene));
+
+            // Assigning again replaces the indexed nodes
+            copy.replaceVertex(scene.keyVertices[0], scene.keyVertices[1]);
+            assigned = copy;
+            QVERIFY(hasValidIndex(assigned, scene));
+            QCOMPARE(assigned.cells(), copy.cells());
+        }
+    }
+
+    // Cycles sharing nodes, which is allowed by AnimatedCycle(first), are
+    // notified of the changes of their nodes whichever indexed them last
+    void sharedNodes()
+    {
+        Scene scene;
+        std::mt19937 rng(8304);
+        for(int i=0; i<100; ++i)
+        {
+            RandomCycle random(scene, rng, i % 2);
+            AnimatedCycle shared(random.cycle.first());
+            for(int j=0; j<5; ++j)
+            {
+                QVERIFY(hasValidIndex(random.cycle, scene));
+                QVERIFY(hasValidIndex(shared, scene));
+                random.modify(scene, rng);
+                QVERIFY(hasValidIndex(random.cycle, scene));
+                QVERIFY(hasValidIndex(shared, scene));
+                random.modify(scene, rng);
+                QVERIFY(hasValidIndex(shared, scene));
+                QVERIFY(hasValidIndex(random.cycle, scene));
+            }
+
+            // The nodes are owned by random.cycle
+            shared.setFirst(0);
+        }
+    }
+};
+
+VPAINT_TEST_MAIN(TestAnimatedCycleIndex)
+#include "tst_AnimatedCycleIndex.moc"
@@ -0,0 +1,180 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "CameraReprojection.h"
+
+#include <QtTest>
+#include <QVector>
+#include <cmath>
+
+namespace
+{
+
+GLWidget_Camera2D camera(double x, double y, double zoom)
+{
+    GLWidget_Camera2D res;
+    res.setX(x);
+    res.setY(y);
+    res.setZoom(zoom);
+    return res;
+}
+
+QVector<double> params(double x, double y, double zoom)
+{
+    return QVector<double>() << x << y << zoom;
+}
+
+GLWidget_Camera2D camera(const QVector<double> & params)
+{
+    return camera(params[0], params[1], params[2]);
+}
+
+// Window coordinates of the scene point q
+QPointF project(const GLWidget_Camera2D & c, const QPointF & q)
+{
+    Eigen::Vector3d p = c.viewMatrix() * Eigen::Vector3d(q.x(), q.y(), 0);
+    return QPointF(p[0], p[1]);
+}
+
+bool fuzzyEqual(const QPointF & p1, const QPointF & p2)
+{
+    return std::abs(p1.x() - p2.x()) < 1e-9 && std::abs(p1.y() - p2.y()) < 1e-9;
+}
+
+double area(const QRectF & r)
+{
+    return r.isEmpty() ? 0 : r.width() * r.height();
+}
+
+}
+
+class TestCameraReprojection: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // A scene point projected with "from" then mapped is where "to"
+    // projects it
+    void map_data()
+    {
+        QTest::addColumn<QVector<double> >("fromParams"); // x, y, zoom
+        QTest::addColumn<QVector<double> >("toParams");
+
+        QTest::newRow("identity") << params(12, -3, 1.5) << params(12, -3, 1.5);
+        QTest::newRow("pan") << params(0, 0, 1) << params(25, -40, 1);
+        QTest::newRow("zoom in") << params(10, 20, 1) << params(-50, -30, 1.8);
+        QTest::newRow("zoom out") << params(10, 20, 2) << params(300, 200, 0.3);
+    }
+
+    void map()
+    {
+        QFETCH(QVector<double>, fromParams);
+        QFETCH(QVector<double>, toParams);
+        GLWidget_Camera2D from = camera(fromParams);
+        GLWidget_Camera2D to = camera(toParams);
+
+        CameraReprojection reprojection(from, to, 800, 600);
+        QCOMPARE(reprojection.scale(), to.zoom() / from.zoom());
+
+        QList<QPointF> scenePoints;
+        scenePoints << QPointF(0, 0) << QPointF(1, 0) << QPointF(0, 1)
+                    << QPointF(-123.5, 77.25) << QPointF(1e4, -2e3);
+        foreach(const QPointF & q, scenePoints)
+            QVERIFY(fuzzyEqual(reprojection.map(project(from, q)), project(to, q)));
+
+        QRectF mapped = reprojection.mappedViewport();
+        QVERIFY(fuzzyEqual(mapped.topLeft(), reprojection.map(QPointF(0, 0))));
+        QVERIFY(fuzzyEqual(mapped.bottomRight(), reprojection.map(QPointF(800, 600))));
+    }
+
+    // Images magnified or minified by up to maxScale are acceptable
+    void isAcceptable_data()
+    {
+        QTest::addColumn<double>("zoom");
+        QTest::addColumn<bool>("acceptable");
+
+        QTest::newRow("1") << 1.0 << true;
+        QTest::newRow("1.5") << 1.5 << true;
+        QTest::newRow("2") << 2.0 << true;
+        QTest::newRow("2.001") << 2.001 << false;
+        QTest::newRow("0.5") << 0.5 << true;
+        QTest::newRow("0.499") << 0.499 << false;
+        QTest::newRow("10") << 10.0 << false;
+        QTest::newRow("0.1") << 0.1 << false;
+    }
+
+    void isAcceptable()
+    {
+        QFETCH(double, zoom);
+        QFETCH(bool, acceptable);
+
+        CameraReprojection reprojection(camera(5, 5, 1), camera(-20, 8, zoom), 800, 600);
+        QCOMPARE(reprojection.isAcceptable(2.0), acceptable);
+
+        // Same relative zoom from another zoom level
+        CameraReprojection reprojection2(camera(0, 0, 4), camera(0, 0, 4 * zoom), 800, 600);
+        QCOMPARE(reprojection2.isAcceptable(2.0), acceptable);
+    }
+
+    // The exposed regions and the covered part of the viewport are disjoint
+    // and together cover the whole viewport
+    void exposedRegions_data()
+    {
+        QTest::addColumn<QVector<double> >("toParams"); // x, y, zoom
+        QTest::addColumn<int>("numRegions");
+        QTest::addColumn<double>("exposedFraction");
+
+        // From camera(0,0,1), viewport 800x600
+        QTest::newRow("identity") << params(0, 0, 1) << 0 << 0.0;
+        QTest::newRow("pan right") << params(200, 0, 1) << 1 << 0.25;
+        QTest::newRow("pan left") << params(-80, 0, 1) << 1 << 0.1;
+        QTest::newRow("pan down") << params(0, 60, 1) << 1 << 0.1;
+        QTest::newRow("pan diagonal") << params(80, -60, 1) << 2 << 1.0 - 0.9 * 0.9;
+        QTest::newRow("zoom in") << params(-400, -300, 2) << 0 << 0.0;
+        QTest::newRow("zoom out") << params(200, 150, 0.5) << 4 << 0.75;
+        QTest::newRow("out of view") << params(1000, 0, 1) << 1 << 1.0;
+    }
+
+    void exposedRegions()
+    {
+        QFETCH(QVector<double>, toParams);
+        QFETCH(int, numRegions);
+        QFETCH(double, exposedFraction);
+
+        const double w = 800;
+        const double h = 600;
+        QRectF viewport(0, 0, w, h);
+        CameraReprojection reprojection(camera(0, 0, 1), camera(toParams), w, h);
+        QList<QRectF> regions = reprojection.exposedRegions();
+        QRectF covered = reprojection.mappedViewport().intersected(viewport);
+
+        QCOMPARE(regions.size(), numRegions);
+        double totalArea = area(covered);
+        for(int i=0; i<regions.size(); ++i)
+        {
+            QVERIFY(!regions[i].isEmpty());
+            QVERIFY(viewport.contains(regions[i]));
+            QCOMPARE(area(regions[i].intersected(covered)), 0.0);
+            for(int j=i+1; j<regions.size(); ++j)
+                QCOMPARE(area(regions[i].intersected(regions[j])), 0.0);
+            totalArea += area(regions[i]);
+        }
+        QVERIFY(qFuzzyCompare(totalArea, w * h));
+        QVERIFY(qFuzzyCompare(1.0 + reprojection.exposedFraction(), 1.0 + exposedFraction));
+    }
+
+    void emptyViewport()
+    {
+        CameraReprojection reprojection(camera(0, 0, 1), camera(10, 10, 1), 0, 0);
+        QVERIFY(reprojection.exposedRegions().isEmpty());
+        QCOMPARE(reprojection.exposedFraction(), 0.0);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestCameraReprojection)
+#include "tst_CameraReprojection.moc"
@@ -0,0 +1,15 @@
+# Copyright (C) 2012-2016 The VPaint Developers.
+# See the COPYRIGHT file at the top-level directory of this distribution
+# and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+#
+# This file is part of VPaint, a vector graphics editor. It is subject to the
+# license terms and conditions in the LICENSE.MIT file found in the top-level
+# directory of this distribution and at http://opensource.org/licenses/MIT
+
+include(../Tests.pri)
+include($$GUI_DIR/Gui.pri)
+TARGET = tst_CellMemoryUsage
+QT += widgets
+
+HEADERS += ../TestApplication.h
+SOURCES += tst_CellMemoryUsage.cpp
@@ -0,0 +1,201 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "MemoryUsage.h"
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/EdgeSample.h"
+#include "VectorAnimationComplex/Halfedge.h"
+#include "VectorAnimationComplex/Triangles.h"
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+const int numSamples = 21;
+const QString caches = "Cell caches";
+
+// Bytes of a QMap node, as counted by MemoryUsage::mapNodeBytes()
+template <class K, class V>
+qint64 nodeBytes()
+{
+    return 3 * sizeof(void*) + sizeof(K) + sizeof(V);
+}
+
+qint64 trianglesBytes(const Triangles & triangles)
+{
+    return (qint64) triangles.capacity() * sizeof(Triangle);
+}
+
+// Restores the number of subdivisions at the end of a test
+class NumSubGuard
+{
+public:
+    NumSubGuard() : numSub_(DevSettings::getInt("num sub")) { DevSettings::setInt("num sub", 0); }
+    ~NumSubGuard() { DevSettings::setInt("num sub", numSub_); }
+
+private:
+    int numSub_;
+};
+
+// Key vertices v[0] and v[1], and the key edge e of width 4 between them,
+// made of numSamples samples, at time 0, and the key vertex w at time 1.
+// All of them are drawn, which fills their caches
+struct Scene
+{
+    VAC vac;
+    KeyVertex * v[2];
+    KeyEdge * e;
+    KeyVertex * w;
+
+    Scene()
+    {
+        v[0] = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        v[1] = vac.newKeyVertex(Time(0), Eigen::Vector2d(100, 0));
+        QList<EdgeSample> samples;
+        for(int i=0; i<numSamples; ++i)
+            samples << EdgeSample(5 * i, 0, 4);
+        e = vac.newKeyEdge(Time(0), v[0], v[1], new LinearSpline(samples));
+        w = vac.newKeyVertex(Time(1), Eigen::Vector2d(500, 500));
+
+        for(int i=0; i<2; ++i)
+        {
+            v[i]->triangles(Time(0));
+            v[i]->boundingBox(Time(0));
+        }
+        v[0]->outlineBoundingBox(Time(0));
+        v[0]->triangles(Time(1)); // empty, since v[0] doesn't exist at time 1
+        e->triangles(Time(0));
+        e->boundingBox(Time(0));
+        e->outlineBoundingBox(Time(0));
+        e->triangles(2.0, Time(0));
+        w->triangles(Time(1));
+        w->boundingBox(Time(1));
+    }
+};
+
+} // end namespace
+
+class TestCellMemoryUsage: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void knownScene()
+    {
+        NumSubGuard guard;
+        Scene scene;
+        const Triangles & v0Triangles = scene.v[0]->triangles(Time(0));
+        const Triangles & v1Triangles = scene.v[1]->triangles(Time(0));
+        const Triangles & wTriangles = scene.w->triangles(Time(1));
+        const Triangles & eTriangles = scene.e->triangles(Time(0));
+        const Triangles & eTopoTriangles = scene.e->triangles(2.0, Time(0));
+
+        // Triangle counts: 50 per vertex, and 2 per segment plus two caps
+        // of 50 per edge
+        QCOMPARE(v0Triangles.size(), 50);
+        QCOMPARE(wTriangles.size(), 50);
+        QCOMPARE(scene.v[0]->triangles(Time(1)).size(), 0);
+        QCOMPARE(eTriangles.size(), 2 * (numSamples-1) + 100);
+        QCOMPARE(eTopoTriangles.size(), 2 * (numSamples-1) + 100);
+
+        MemoryUsage usage;
+        scene.vac.addMemoryUsage(usage);
+
+        // Key vertices: triangles at time 0 and 1 for v[0], and at their
+        // time for the others
+        MemoryUsage::Entry vertexTriangles = usage.entry(caches, "KeyVertex triangles");
+        QCOMPARE(vertexTriangles.numItems, (qint64) 4);
+        QCOMPARE(vertexTriangles.numBytes,
+                 4 * nodeBytes<int,Triangles>() +
+                 trianglesBytes(v0Triangles) + trianglesBytes(v1Triangles) + trianglesBytes(wTriangles));
+        QVERIFY(vertexTriangles.numBytes >= 4 * nodeBytes<int,Triangles>() + (qint64) 150 * sizeof(Triangle));
+
+        MemoryUsage::Entry vertexBoundingBoxes = usage.entry(caches, "KeyVertex bounding boxes");
+        QCOMPARE(vertexBoundingBoxes.numItems, (qint64) 3);
+        QCOMPARE(vertexBoundingBoxes.numBytes, 3 * nodeBytes<int,BoundingBox>());
+
+        MemoryUsage::Entry vertexOutlines = usage.entry(caches, "KeyVertex outline bounding boxes");
+        QCOMPARE(vertexOutlines.numItems, (qint64) 1);
+        QCOMPARE(vertexOutlines.numBytes, nodeBytes<int,BoundingBox>());
+
+        // Incident halfedges, computed to get the size of the vertices: one
+        // for each end vertex of e, none for w
+        MemoryUsage::Entry halfedges = usage.entry(caches, "KeyVertex incident halfedges");
+        QCOMPARE(halfedges.numItems, (qint64) 3);
+        QCOMPARE(halfedges.numBytes,
+                 3 * nodeBytes<int, std::vector<Halfedge> >() + (qint64) 2 * sizeof(Halfedge));
+
+        // Key edge
+        MemoryUsage::Entry edgeTriangles = usage.entry(caches, "KeyEdge triangles");
+        QCOMPARE(edgeTriangles.numItems, (qint64) 1);
+        QCOMPARE(edgeTriangles.numBytes, nodeBytes<int,Triangles>() + trianglesBytes(eTriangles));
+
+        MemoryUsage::Entry edgeBoundingBoxes = usage.entry(caches, "KeyEdge bounding boxes");
+        QCOMPARE(edgeBoundingBoxes.numItems, (qint64) 1);
+        QCOMPARE(edgeBoundingBoxes.numBytes, nodeBytes<int,BoundingBox>());
+
+        MemoryUsage::Entry edgeOutlines = usage.entry(caches, "KeyEdge outline bounding boxes");
+        QCOMPARE(edgeOutlines.numItems, (qint64) 1);
+        QCOMPARE(edgeOutlines.numBytes, nodeBytes<int,BoundingBox>());
+
+        typedef QPair<int,double> TopologyKey;
+        MemoryUsage::Entry topology = usage.entry(caches, "KeyEdge topology triangles");
+        QCOMPARE(topology.numItems, (qint64) 1);
+        QCOMPARE(topology.numBytes, nodeBytes<TopologyKey,Triangles>() + trianglesBytes(eTopoTriangles));
+
+        // The samples and their arclengths, without sampling
+        MemoryUsage::Entry samplings = usage.entry("Edge geometry", "KeyEdge samplings");
+        QCOMPARE(samplings.numItems, (qint64) 1);
+        QCOMPARE(samplings.numBytes,
+                 (qint64) (sizeof(LinearSpline) + numSamples * (sizeof(EdgeSample) + sizeof(double))));
+
+        // Nothing else
+        QCOMPARE(usage.subsystems(), QList<QString>() << caches << "Edge geometry");
+        QCOMPARE(usage.totalBytes(),
+                 vertexTriangles.numBytes + vertexBoundingBoxes.numBytes + vertexOutlines.numBytes +
+                 halfedges.numBytes + edgeTriangles.numBytes + edgeBoundingBoxes.numBytes +
+                 edgeOutlines.numBytes + topology.numBytes + samplings.numBytes);
+    }
+
+    // Caches cleared by a change are no longer counted
+    void clearedCaches()
+    {
+        NumSubGuard guard;
+        Scene scene;
+        MemoryUsage before;
+        scene.vac.addMemoryUsage(before);
+
+        scene.vac.deleteCell(scene.w);
+        MemoryUsage after;
+        scene.vac.addMemoryUsage(after);
+        QCOMPARE(after.entry(caches, "KeyVertex triangles").numItems, (qint64) 3);
+        QCOMPARE(after.entry(caches, "KeyVertex bounding boxes").numItems, (qint64) 2);
+        QCOMPARE(after.entry(caches, "KeyVertex incident halfedges").numItems, (qint64) 2);
+        QVERIFY(after.totalBytes() < before.totalBytes());
+
+        // Moving v[1] clears the caches of v[1] and e, and of v[0], whose
+        // size depends on e
+        scene.v[1]->setPos(Eigen::Vector2d(100, 50));
+        scene.v[1]->correctEdgesGeometry();
+        MemoryUsage moved;
+        scene.vac.addMemoryUsage(moved);
+        QCOMPARE(moved.entry(caches, "KeyEdge triangles").numItems, (qint64) 0);
+        QCOMPARE(moved.entry(caches, "KeyEdge topology triangles").numItems, (qint64) 0);
+        QCOMPARE(moved.entry(caches, "KeyEdge bounding boxes").numItems, (qint64) 0);
+        QCOMPARE(moved.entry("Edge geometry", "KeyEdge samplings").numItems, (qint64) 1);
+    }
+};
+
+VPAINT_TEST_MAIN(TestCellMemoryUsage)
+#include "tst_CellMemoryUsage.moc"
@@ -0,0 +1,175 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+bool fuzzyEqual(const BoundingBox & bb1, const BoundingBox & bb2)
+{
+    const double eps = 1e-9;
+    return std::abs(bb1.xMin() - bb2.xMin()) < eps && std::abs(bb1.xMax() - bb2.xMax()) < eps &&
+           std::abs(bb1.yMin() - bb2.yMin()) < eps && std::abs(bb1.yMax() - bb2.yMax()) < eps;
+}
+
+bool contains(const QList<BoundingBox> & boxes, const BoundingBox & bb)
+{
+    foreach(const BoundingBox & b, boxes)
+        if(fuzzyEqual(b, bb))
+            return true;
+    return false;
+}
+
+// Key vertices v[0] and v[1], and the key edge e of width 10 between them,
+// at time 0, and the key vertex w at time 1
+struct Scene
+{
+    VAC vac;
+    KeyVertex * v[2];
+    KeyEdge * e;
+    KeyVertex * w;
+
+    Scene()
+    {
+        v[0] = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        v[1] = vac.newKeyVertex(Time(0), Eigen::Vector2d(100, 0));
+        e = vac.newKeyEdge(Time(0), v[0], v[1], 0, 10);
+        w = vac.newKeyVertex(Time(1), Eigen::Vector2d(500, 500));
+
+        // Draw them, which caches their bounding boxes
+        foreach(Cell * c, vac.cells())
+            c->boundingBox(c->exists(Time(0)) ? Time(0) : Time(1));
+    }
+};
+
+} // end namespace
+
+class TestChangedRegions: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void noChange()
+    {
+        Scene scene;
+        QList<BoundingBox> regions;
+        QVERIFY(scene.vac.changedRegions(scene.vac.revision(), Time(0), regions));
+        QVERIFY(regions.isEmpty());
+    }
+
+    // A moved cell is redrawn where it was before the change and where it
+    // is after
+    void beforeAndAfter()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        BoundingBox edgeBefore = scene.e->boundingBox(Time(0));
+        BoundingBox vertexBefore = scene.v[1]->boundingBox(Time(0));
+        quint64 revision = vac.revision();
+
+        scene.v[1]->setPos(Eigen::Vector2d(100, 50));
+        scene.v[1]->correctEdgesGeometry();
+        QVERIFY(vac.revision() > revision);
+
+        QList<BoundingBox> regions;
+        QVERIFY(vac.changedRegions(revision, Time(0), regions));
+        QVERIFY(contains(regions, edgeBefore));
+        QVERIFY(contains(regions, vertexBefore));
+        BoundingBox edgeAfter = scene.e->boundingBox(Time(0));
+        BoundingBox vertexAfter = scene.v[1]->boundingBox(Time(0));
+        QVERIFY(edgeAfter.yMax() > 50);
+        QVERIFY(contains(regions, edgeAfter));
+        QVERIFY(contains(regions, vertexAfter));
+
+        // Nothing at time 0 about the vertex at time 1
+        QVERIFY(!contains(regions, scene.w->boundingBox(Time(1))));
+
+        // Nothing changed since
+        regions.clear();
+        QVERIFY(vac.changedRegions(vac.revision(), Time(0), regions));
+        QVERIFY(regions.isEmpty());
+    }
+
+    // A removed cell is only redrawn where it was
+    void removal()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        BoundingBox before = scene.w->boundingBox(Time(1));
+        quint64 revision = vac.revision();
+
+        vac.deleteCell(scene.w);
+
+        QList<BoundingBox> regions;
+        QVERIFY(vac.changedRegions(revision, Time(1), regions));
+        QVERIFY(!regions.isEmpty());
+        foreach(const BoundingBox & bb, regions)
+            QVERIFY(fuzzyEqual(bb, before));
+
+        regions.clear();
+        QVERIFY(vac.changedRegions(revision, Time(0), regions));
+        QVERIFY(regions.isEmpty());
+    }
+
+    // Changing the z-ordering of the selection changes all frames
+    void zOrdering()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        quint64 revision = vac.revision();
+        vac.addToSelection(scene.e, false);
+        vac.lower();
+
+        QList<BoundingBox> regions;
+        QVERIFY(!vac.changedRegions(revision, Time(0), regions));
+        QVERIFY(vac.frameRevision(0) > revision);
+        QVERIFY(vac.frameRevision(1) > revision);
+        QVERIFY(vac.changedRegions(vac.revision(), Time(0), regions));
+        QVERIFY(regions.isEmpty());
+    }
+
+    // Too many changes to be redrawn faster than everything are forgotten,
+    // but later ones are recorded again
+    void logOverflow()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        quint64 revision = vac.revision();
+        QList<BoundingBox> regions;
+        int numMoves = 0;
+        while(vac.changedRegions(revision, Time(0), regions) && numMoves < 10000)
+        {
+            regions.clear();
+            scene.v[1]->setPos(Eigen::Vector2d(100, numMoves % 10));
+            scene.v[1]->correctEdgesGeometry();
+            ++numMoves;
+        }
+        QVERIFY(numMoves > 100);
+        QVERIFY(numMoves < 10000);
+
+        quint64 afterOverflow = vac.revision();
+        scene.v[0]->setPos(Eigen::Vector2d(0, 20));
+        scene.v[0]->correctEdgesGeometry();
+        regions.clear();
+        QVERIFY(!vac.changedRegions(revision, Time(0), regions));
+        QVERIFY(vac.changedRegions(afterOverflow, Time(0), regions));
+        QVERIFY(contains(regions, scene.v[0]->boundingBox(Time(0))));
+    }
+};
+
+VPAINT_TEST_MAIN(TestChangedRegions)
+#include "tst_ChangedRegions.moc"
@@ -0,0 +1,394 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "IO/CompressedDocument.h"
+#include "XmlStreamWriter.h"
+#include "XmlStreamReader.h"
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <random>
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+// Number lists, as in the xywdense attribute of edges
+QByteArray documentLikeData(int size)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> number(-500, 500);
+    QByteArray res;
+    res.reserve(size + 32);
+    while(res.size() < size)
+        res += QByteArray::number(number(rng), 'g', 15) + ' ';
+    res.resize(size);
+    return res;
+}
+
+bool compress(const QByteArray & data, int writeSize, QByteArray & out)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    CompressedDevice device(&buffer);
+    if(!device.open(QIODevice::WriteOnly))
+        return false;
+    for(int i=0; i<data.size(); i+=writeSize)
+    {
+        int n = qMin(writeSize, data.size() - i);
+        if(device.write(data.constData() + i, n) != n)
+            return false;
+    }
+    device.close();
+    out = buffer.data();
+    return !device.hasError();
+}
+
+// Returns whether the whole document was successfully read. The data read
+// before an error is still given in out
+bool decompress(const QByteArray & compressed, int readSize, QByteArray & out)
+{
+    out.clear();
+    QBuffer buffer;
+    buffer.setData(compressed);
+    buffer.open(QIODevice::ReadOnly);
+    CompressedDevice device(&buffer);
+    if(!device.open(QIODevice::ReadOnly))
+        return false;
+    while(true)
+    {
+        QByteArray data = device.read(readSize);
+        if(data.isEmpty())
+            break;
+        out += data;
+    }
+    return device.atEnd() && !device.hasError();
+}
+
+// Sizes of the chunks of a compressed document, or -1 if the layout is
+// invalid: magic, chunks, terminator, and nothing after it
+QList<int> chunkSizes(const QByteArray & compressed)
+{
+    QList<int> res;
+    int pos = CompressedDevice::magic().size();
+    while(pos + 4 <= compressed.size())
+    {
+        quint32 n = qFromBigEndian<quint32>((const uchar *) compressed.constData() + pos);
+        pos += 4;
+        if(n == 0)
+        {
+            if(pos != compressed.size())
+                res << -1;
+            return res;
+        }
+        res << qUncompress(compressed.mid(pos, n)).size();
+        pos += n;
+    }
+    res << -1;
+    return res;
+}
+
+// Key edges made of noisy sine waves, with their own end vertices
+void createScene(VAC & vac, int numEdges, int numSamples)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(0, 2000);
+    std::uniform_real_distribution<double> noise(-1, 1);
+    for(int i=0; i<numEdges; ++i)
+    {
+        double x0 = coord(rng);
+        double y0 = coord(rng);
+        std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > samples;
+        for(int j=0; j<numSamples; ++j)
+        {
+            double x = x0 + 3 * j;
+            double y = y0 + 30 * std::sin(j / 10.0) + noise(rng);
+            samples.push_back(EdgeSample(x, y, 5 + noise(rng)));
+        }
+        KeyVertex * v0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(samples.front().x(), samples.front().y()));
+        KeyVertex * v1 = vac.newKeyVertex(Time(0), Eigen::Vector2d(samples.back().x(), samples.back().y()));
+        vac.newKeyEdge(Time(0), v0, v1, new LinearSpline(samples));
+    }
+}
+
+// Same layout as the "objects" element of a layer
+void writeDocument(QIODevice * device, VAC & vac)
+{
+    XmlStreamWriter xml(device);
+    xml.writeStartDocument();
+    xml.writeStartElement("objects");
+    vac.write(xml);
+    xml.writeEndElement();
+    xml.writeEndDocument();
+}
+
+bool readDocument(QIODevice * device, VAC & vac)
+{
+    XmlStreamReader xml(device);
+    if(!xml.readNextStartElement() || xml.name() != "objects")
+        return false;
+    vac.read(xml);
+    return !xml.hasError();
+}
+
+QByteArray toXml(VAC & vac)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    writeDocument(&buffer, vac);
+    return buffer.data();
+}
+
+} // end namespace
+
+class TestCompressedDocument: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Documents are split into chunks of chunkSize() bytes, whatever the
+    // size of the writes and reads
+    void roundTrip_data()
+    {
+        const int chunk = CompressedDevice::chunkSize();
+
+        QTest::addColumn<int>("size");
+        QTest::addColumn<int>("writeSize");
+        QTest::addColumn<int>("readSize");
+
+        QTest::newRow("empty") << 0 << 1 << 1000;
+        QTest::newRow("one byte") << 1 << 1 << 1;
+        QTest::newRow("chunk - 1") << chunk - 1 << 4093 << 1000;
+        QTest::newRow("chunk") << chunk << chunk << 1000;
+        QTest::newRow("chunk + 1") << chunk + 1 << 4093 << chunk + 1;
+        QTest::newRow("two chunks, one write") << 2 * chunk << 2 * chunk << 4093;
+        QTest::newRow("several chunks") << 3 * chunk + 17 << chunk + 1 << 3 * chunk + 17;
+    }
+
+    void roundTrip()
+    {
+        QFETCH(int, size);
+        QFETCH(int, writeSize);
+        QFETCH(int, readSize);
+
+        const int chunk = CompressedDevice::chunkSize();
+        QByteArray data = documentLikeData(size);
+
+        QByteArray compressed;
+        QVERIFY(compress(data, writeSize, compressed));
+        QVERIFY(compressed.startsWith(CompressedDevice::magic()));
+
+        QList<int> expectedChunkSizes;
+        for(int i=0; i<size; i+=chunk)
+            expectedChunkSizes << qMin(chunk, size - i);
+        QCOMPARE(chunkSizes(compressed), expectedChunkSizes);
+
+        QByteArray res;
+        QVERIFY(decompress(compressed, readSize, res));
+        QCOMPARE(res.size(), data.size());
+        QVERIFY(res == data);
+    }
+
+    // Every truncation is reported as an error, after the data of the
+    // complete chunks
+    void truncatedInput_data()
+    {
+        QTest::addColumn<int>("numRemovedBytes");
+        QTest::addColumn<int>("numReadableBytes");
+
+        const int chunk = CompressedDevice::chunkSize();
+        QTest::newRow("terminator") << 4 << 2 * chunk + 100;
+        QTest::newRow("end of terminator") << 1 << 2 * chunk + 100;
+        QTest::newRow("end of last chunk") << 5 << 2 * chunk;
+        QTest::newRow("middle of document") << -1 << chunk;
+    }
+
+    void truncatedInput()
+    {
+        QFETCH(int, numRemovedBytes);
+        QFETCH(int, numReadableBytes);
+
+        const int chunk = CompressedDevice::chunkSize();
+        QByteArray data = documentLikeData(2 * chunk + 100);
+        QByteArray compressed;
+        QVERIFY(compress(data, chunk, compressed));
+
+        // Middle of the document: just after the header of the second chunk
+        if(numRemovedBytes < 0)
+        {
+            int pos = CompressedDevice::magic().size();
+            pos += 4 + qFromBigEndian<quint32>((const uchar *) compressed.constData() + pos);
+            numRemovedBytes = compressed.size() - (pos + 4);
+        }
+        compressed.chop(numRemovedBytes);
+
+        QByteArray res;
+        QVERIFY(!decompress(compressed, 1000, res));
+        QCOMPARE(res.size(), numReadableBytes);
+        QVERIFY(res == data.left(numReadableBytes));
+    }
+
+    void truncatedMagic()
+    {
+        QByteArray compressed;
+        QVERIFY(compress(documentLikeData(100), 100, compressed));
+
+        QByteArray res;
+        QVERIFY(!decompress(compressed.left(CompressedDevice::magic().size() - 1), 1000, res));
+        QVERIFY(res.isEmpty());
+
+        // Magic only
+        QVERIFY(!decompress(CompressedDevice::magic(), 1000, res));
+        QVERIFY(res.isEmpty());
+    }
+
+    void badMagic()
+    {
+        QByteArray compressed;
+        QVERIFY(compress(documentLikeData(100), 100, compressed));
+
+        // Plain XML documents are not compressed, and not decompressed
+        QByteArray xml = "<?xml version=\"1.0\"?>\n<vec version=\"1.6\"></vec>\n";
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::ReadOnly);
+        QVERIFY(!CompressedDevice::isCompressed(&buffer));
+        QCOMPARE(buffer.pos(), (qint64) 0);
+        QByteArray res;
+        QVERIFY(!decompress(xml, 1000, res));
+
+        // Any modified byte of the magic
+        for(int i=0; i<CompressedDevice::magic().size(); ++i)
+        {
+            QByteArray corrupted = compressed;
+            corrupted[i] = (char) (corrupted[i] ^ 0x20);
+            QBuffer corruptedBuffer(&corrupted);
+            corruptedBuffer.open(QIODevice::ReadOnly);
+            QVERIFY(!CompressedDevice::isCompressed(&corruptedBuffer));
+            QVERIFY(!decompress(corrupted, 1000, res));
+            QVERIFY(res.isEmpty());
+        }
+    }
+
+    void corruptedChunk()
+    {
+        QByteArray data = documentLikeData(10000);
+        QByteArray compressed;
+        QVERIFY(compress(data, 10000, compressed));
+        int headerPos = CompressedDevice::magic().size();
+
+        // Chunk size larger than any compressed chunk
+        QByteArray tooLarge = compressed;
+        qToBigEndian<quint32>(3 * CompressedDevice::chunkSize(), (uchar *) tooLarge.data() + headerPos);
+        QByteArray res;
+        QVERIFY(!decompress(tooLarge, 1000, res));
+        QVERIFY(res.isEmpty());
+
+        // Deflate stream, after the uncompressed size written by qCompress()
+        QByteArray badData = compressed;
+        for(int i=headerPos + 8; i<headerPos + 16; ++i)
+            badData[i] = (char) (badData[i] ^ 0xFF);
+        QVERIFY(!decompress(badData, 1000, res));
+        QVERIFY(res.isEmpty());
+    }
+
+    // DocumentInputFile detects compressed documents by content, whatever
+    // their extension
+    void documentFiles()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QByteArray data = documentLikeData(CompressedDevice::chunkSize() + 5);
+
+        QStringList filenames;
+        filenames << "plain.vec" << "compressed.vecz" << "compressed.vec";
+        QList<bool> compressed;
+        compressed << false << true << true;
+        for(int i=0; i<filenames.size(); ++i)
+        {
+            QString filePath = dir.path() + "/" + filenames[i];
+            DocumentOutputFile out(filePath, compressed[i]);
+            QVERIFY(out.isOpen());
+            QCOMPARE(out.device()->write(data), (qint64) data.size());
+            QVERIFY(out.close());
+
+            DocumentInputFile in(filePath);
+            QVERIFY(in.isOpen());
+            QCOMPARE(in.isCompressed(), compressed[i]);
+            QVERIFY(in.device()->readAll() == data);
+        }
+
+        DocumentInputFile missing(dir.path() + "/missing.vec");
+        QVERIFY(!missing.isOpen());
+    }
+
+    // Saving and loading a document, including XML writing and parsing,
+    // which dominate the cost of the container
+    void endToEnd_data()
+    {
+        QTest::addColumn<bool>("compressed");
+        QTest::newRow("vec") << false;
+        QTest::newRow("vecz") << true;
+    }
+
+    void endToEnd()
+    {
+        QFETCH(bool, compressed);
+
+        VAC vac;
+        createScene(vac, 2000, 100);
+        QByteArray xml = toXml(vac);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString filePath = dir.path() + (compressed ? "/document.vecz" : "/document.vec");
+
+        QElapsedTimer timer;
+        timer.start();
+        QBENCHMARK_ONCE
+        {
+            DocumentOutputFile out(filePath, compressed);
+            QVERIFY(out.isOpen());
+            writeDocument(out.device(), vac);
+            QVERIFY(out.close());
+        }
+        qint64 saveTime = timer.elapsed();
+
+        timer.start();
+        VAC loaded;
+        {
+            DocumentInputFile in(filePath);
+            QVERIFY(in.isOpen());
+            QCOMPARE(in.isCompressed(), compressed);
+            QVERIFY(readDocument(in.device(), loaded));
+        }
+        qint64 loadTime = timer.elapsed();
+
+        qint64 fileSize = QFileInfo(filePath).size();
+        qDebug("%s: %.1f MB of XML, %.1f MB on disk (%.2fx). Save %lld ms, load %lld ms",
+               compressed ? "vecz" : "vec",
+               xml.size() / 1048576.0, fileSize / 1048576.0,
+               (double) fileSize / xml.size(), saveTime, loadTime);
+
+        QCOMPARE(loaded.cells().size(), vac.cells().size());
+        QVERIFY(toXml(loaded) == toXml(vac));
+    }
+};
+
+VPAINT_TEST_MAIN(TestCompressedDocument)
+#include "tst_CompressedDocument.moc"
@@ -0,0 +1,180 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "DirtyRegion.h"
+
+#include <QtTest>
+
+namespace
+{
+
+// Whether no two rectangles of the region overlap
+bool isDisjoint(const DirtyRegion & region)
+{
+    const QList<QRect> & rects = region.rects();
+    for(int i=0; i<rects.size(); ++i)
+        for(int j=i+1; j<rects.size(); ++j)
+            if(rects[i].intersects(rects[j]))
+                return false;
+    return true;
+}
+
+// Whether the given rectangle is covered by a rectangle of the region
+bool isCovered(const DirtyRegion & region, const QRect & rect)
+{
+    foreach(const QRect & r, region.rects())
+        if(r.contains(rect))
+            return true;
+    return false;
+}
+
+} // end namespace
+
+class TestDirtyRegion: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty()
+    {
+        DirtyRegion region(100, 50);
+        QVERIFY(region.isEmpty());
+        QCOMPARE(region.coveredFraction(), 0.0);
+
+        // Degenerate rectangles add nothing
+        region.addRect(QRectF(10, 10, 0, 20));
+        region.addRect(QRectF(10, 10, 20, 0));
+        QVERIFY(region.isEmpty());
+    }
+
+    // Overlapping rectangles are merged into their union, transitively
+    void merging()
+    {
+        DirtyRegion region(200, 200);
+        region.addRect(QRectF(10, 10, 20, 20));
+        region.addRect(QRectF(20, 20, 20, 20));
+        QCOMPARE(region.rects().size(), 1);
+        QCOMPARE(region.rects()[0], QRect(10, 10, 30, 30));
+
+        region.addRect(QRectF(100, 100, 10, 10));
+        QCOMPARE(region.rects().size(), 2);
+
+        // Touching rectangles are kept apart
+        region.addRect(QRectF(110, 100, 10, 10));
+        QCOMPARE(region.rects().size(), 3);
+        QVERIFY(isDisjoint(region));
+
+        // Overlaps all of them
+        region.addRect(QRectF(25, 25, 90, 80));
+        QCOMPARE(region.rects().size(), 1);
+        QCOMPARE(region.rects()[0], QRect(10, 10, 110, 100));
+    }
+
+    // Beyond maxNumRects(), the rectangles are merged into fewer ones which
+    // still cover them all, without overlapping
+    void capping()
+    {
+        DirtyRegion region(1000, 1000);
+        QList<QRect> added;
+        for(int i=0; i<30; ++i)
+        {
+            QRect rect(30 * i, 7 * i * i % 900, 5, 5);
+            region.addRect(rect);
+            added << rect;
+            QVERIFY(region.rects().size() <= DirtyRegion::maxNumRects());
+            QVERIFY(isDisjoint(region));
+        }
+        foreach(const QRect & rect, added)
+            QVERIFY(isCovered(region, rect));
+
+        // Nearby rectangles are merged first
+        DirtyRegion pairs(1000, 1000);
+        for(int i=0; i<DirtyRegion::maxNumRects(); ++i)
+            pairs.addRect(QRectF(100 * i, 100 * i, 10, 10));
+        pairs.addRect(QRectF(100 * 3 + 12, 100 * 3, 10, 10));
+        QCOMPARE(pairs.rects().size(), DirtyRegion::maxNumRects());
+        QVERIFY(isCovered(pairs, QRect(300, 300, 22, 10)));
+        QVERIFY(pairs.coveredFraction() * 1000 * 1000 < 8 * 100 + 22 * 10);
+    }
+
+    // Rectangles are clipped to the viewport and rounded outward
+    void clipping()
+    {
+        DirtyRegion region(100, 50);
+        region.addRect(QRectF(-10, -10, 30, 30));
+        QCOMPARE(region.rects().size(), 1);
+        QCOMPARE(region.rects()[0], QRect(0, 0, 20, 20));
+
+        // Outside of the viewport
+        DirtyRegion outside(100, 50);
+        outside.addRect(QRectF(200, 0, 10, 10));
+        outside.addRect(QRectF(0, -30, 10, 10));
+        QVERIFY(outside.isEmpty());
+
+        // Margin, and partially covered pixels
+        DirtyRegion margin(100, 50);
+        margin.addRect(QRectF(40.5, 20.5, 1, 1), 2);
+        QCOMPARE(margin.rects().size(), 1);
+        QCOMPARE(margin.rects()[0], QRect(38, 18, 6, 6));
+
+        // The margin is clipped too
+        DirtyRegion corner(100, 50);
+        corner.addRect(QRectF(98, 48, 1, 1), 5);
+        QCOMPARE(corner.rects()[0], QRect(93, 43, 7, 7));
+
+        // Larger than the viewport
+        DirtyRegion all(100, 50);
+        all.addRect(QRectF(-1000, -1000, 3000, 3000));
+        QCOMPARE(all.rects().size(), 1);
+        QCOMPARE(all.rects()[0], QRect(0, 0, 100, 50));
+    }
+
+    void coveredFraction()
+    {
+        DirtyRegion region(100, 100);
+        region.addRect(QRectF(0, 0, 10, 10));
+        region.addRect(QRectF(50, 50, 20, 20));
+        QCOMPARE(region.coveredFraction(), 0.05);
+
+        // Merged rectangles are counted once
+        region.addRect(QRectF(55, 55, 10, 10));
+        QCOMPARE(region.coveredFraction(), 0.05);
+
+        region.addAll();
+        QCOMPARE(region.rects().size(), 1);
+        QCOMPARE(region.coveredFraction(), 1.0);
+
+        // Empty viewport
+        DirtyRegion none(0, 0);
+        none.addAll();
+        QVERIFY(none.isEmpty());
+        QCOMPARE(none.coveredFraction(), 0.0);
+    }
+
+    // Window coordinates are p = zoom * q + (x,y)
+    void sceneRects()
+    {
+        GLWidget_Camera2D camera;
+        camera.setX(10);
+        camera.setY(5);
+        camera.setZoom(2);
+
+        DirtyRegion region(200, 100);
+        region.addSceneRect(QRectF(0, 0, 10, 10), camera, 1);
+        QCOMPARE(region.rects().size(), 1);
+        QCOMPARE(region.rects()[0], QRect(9, 4, 22, 22));
+        QCOMPARE(DirtyRegion::sceneRect(QRect(10, 5, 20, 20), camera), QRectF(0, 0, 10, 10));
+
+        // OpenGL window coordinates have the y axis up
+        QCOMPARE(region.glRect(QRect(0, 0, 10, 10)), QRect(0, 90, 10, 10));
+        QCOMPARE(region.glRect(QRect(5, 90, 10, 10)), QRect(5, 0, 10, 10));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestDirtyRegion)
+#include "tst_DirtyRegion.moc"
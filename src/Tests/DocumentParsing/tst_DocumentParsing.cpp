@@ -0,0 +1,417 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "XmlStreamReader.h"
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/KeyFace.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+#include "VectorAnimationComplex/InbetweenFace.h"
+#include "VectorAnimationComplex/Path.h"
+#include "VectorAnimationComplex/Cycle.h"
+#include "VectorAnimationComplex/AnimatedVertex.h"
+#include "VectorAnimationComplex/AnimatedCycle.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+
+#include <QBuffer>
+#include <QRegExp>
+#include <QStringList>
+#include <algorithm>
+
+using namespace VectorAnimationComplex;
+
+// The parsers of the cell attributes were moved from QString::split() to
+// StringTokenizer. These tests compare them with verbatim copies of the
+// former parsing code, on the strings written by VPaint and on variants
+// with other whitespaces and delimiters.
+
+namespace
+{
+
+QString num(int i)
+{
+    return QString().setNum(i);
+}
+
+// Former Path::fromString() and Cycle::fromString(), which were identical,
+// returning the result as written by toString(). Crashes on empty lists
+QString formerPathOrCycle(const QString & str)
+{
+    QStringList strList = str.split(QRegExp("[\\,\\s\\[\\]]"), QString::SkipEmptyParts);
+    QString firstStr = strList[0];
+    QChar c =  firstStr.at(firstStr.length()-1);
+    if(strList.size() == 1 && c != '+' && c != '-')
+        return "[" + num(strList[0].toInt()) + "]";
+
+    QStringList halfedges;
+    for(int i=0; i<strList.size(); ++i)
+    {
+        QString str = strList[i];
+        int l = str.length();
+        QChar side = str.at(l-1);
+        QString edge = str.left(l-1);
+        halfedges << num(edge.toInt()) + ((side == '+') ? "+" : "-");
+    }
+    return "[" + halfedges.join(" ") + "]";
+}
+
+// Former AnimatedVertex::fromString(), returning the result as written by
+// toString()
+QString formerAnimatedVertex(const QString & str)
+{
+    QStringList strList = str.split(QRegExp("[\\,\\s\\[\\]]"), QString::SkipEmptyParts);
+    QStringList ids;
+    for(int i=0; i<strList.size(); ++i)
+        ids << num(strList[i].toInt());
+    return "[" + ids.join(" ") + "]";
+}
+
+// Former AnimatedCycle::fromString() data: the referenced cell and side,
+// and previous, next, before and after nodes (-1 if none) of each node
+QList<QList<int> > formerAnimatedCycle(const QString & str)
+{
+    QStringList d = str.split(QRegExp("[\\[\\]\\s\\,\\(\\):]"), QString::SkipEmptyParts);
+    int n = d.size()/6;
+    QMap<int,int> map;
+    for(int i=0; i<n; ++i)
+        map[ d[6*i].toInt() ] = i;
+
+    auto toInt = [&map](const QString & s) { return (s == "" || s == "_") ? -1 : map[s.toInt()]; };
+    QList<QList<int> > res;
+    for(int i=0; i<n; ++i)
+    {
+        QList<int> node;
+        QString cellside = d[6*i+1];
+        int l = cellside.length();
+        QChar side = cellside.at(l-1);
+        QString cell = cellside.left(l-1);
+        if(side == '+' || side == '-')
+            node << cell.toInt() << (side == '+');
+        else
+            node << cellside.toInt() << true;
+        node << toInt(d[6*i+2]) << toInt(d[6*i+3]) << toInt(d[6*i+4]) << toInt(d[6*i+5]);
+        res << node;
+    }
+    return res;
+}
+
+// Former LinearSpline(const QStringRef &): ds followed by x, y, width
+// triplets. Incomplete triplets are ignored
+QVector<double> formerLinearSpline(const QString & str)
+{
+    QStringList strList = str.split(QRegExp("[\\,\\s]"), QString::SkipEmptyParts);
+    QVector<double> d;
+    for(int i=0; i<strList.size(); ++i)
+        d << strList[i].toDouble();
+    if(d.size() > 0)
+        d.resize(1 + 3 * ((d.size()-1)/3));
+    return d;
+}
+
+// Former KeyVertex position: split at single spaces. Crashes on less than
+// two parts
+Eigen::Vector2d formerPosition(const QString & str)
+{
+    QStringList list = str.split(" ");
+    return Eigen::Vector2d(list[0].toDouble(), list[1].toDouble());
+}
+
+// Former InbetweenFace "beforefaces" and "afterfaces". An empty or blank
+// list gives the face id 0
+QList<int> formerFaceIds(const QString & str)
+{
+    QStringList sl = str.simplified().split(' ');
+    QList<int> res;
+    for(int i=0; i<sl.size(); ++i)
+        res << sl[i].toInt();
+    return res;
+}
+
+// Variants of a string written by VPaint, parsed the same by the former
+// parsers: other whitespaces, extra delimiters around and between tokens
+QStringList variants(const QString & str, const QString & delimiters)
+{
+    QStringList res;
+    res << str;
+    res << "  " + str + " \t\n";
+    res << QString(str).replace(" ", " \t \n ");
+    foreach(QChar d, delimiters)
+    {
+        QString s = str;
+        s.replace(d, QString(" ") + d + d + "\t");
+        res << s;
+    }
+    return res;
+}
+
+// Two key vertex paths at frame 0 forming a triangle, key vertices at frame
+// 2, and inbetween vertices between both
+struct Scene
+{
+    VAC vac;
+    KeyVertex * v[3];
+    KeyEdge * e[3];
+    KeyVertex * u[2];
+    InbetweenVertex * iv[2];
+
+    Scene()
+    {
+        v[0] = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        v[1] = vac.newKeyVertex(Time(0), Eigen::Vector2d(100, 0));
+        v[2] = vac.newKeyVertex(Time(0), Eigen::Vector2d(50, 80));
+        for(int i=0; i<3; ++i)
+            e[i] = vac.newKeyEdge(Time(0), v[i], v[(i+1)%3]);
+        for(int i=0; i<2; ++i)
+        {
+            u[i] = vac.newKeyVertex(Time(2), v[i]->pos());
+            iv[i] = vac.newInbetweenVertex(v[i], u[i]);
+        }
+    }
+
+    QString halfedges(int n) const
+    {
+        QStringList res;
+        for(int i=0; i<n; ++i)
+            res << num(e[i]->id()) + "+";
+        return "[" + res.join(" ") + "]";
+    }
+};
+
+template <class T>
+QString parsed(VAC & vac, const QString & str)
+{
+    T t;
+    t.fromString(str);
+    t.convertTempIdsToPointers(&vac);
+    return t.toString();
+}
+
+// Reads the given cells, in the format of the "objects" element of a layer
+void readObjects(VAC & vac, const QString & objects)
+{
+    QByteArray data = ("<objects>" + objects + "</objects>").toUtf8();
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    XmlStreamReader xml(&buffer);
+    QVERIFY(xml.readNextStartElement());
+    vac.read(xml);
+    QVERIFY(!xml.hasError());
+}
+
+QString xmlEscaped(const QString & str)
+{
+    QString res = str.toHtmlEscaped();
+    res.replace("\t", "&#9;");
+    res.replace("\n", "&#10;");
+    return res;
+}
+
+QList<int> sortedIds(const QSet<KeyFace*> & faces)
+{
+    QList<int> res;
+    foreach(KeyFace * f, faces)
+        res << f->id();
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+} // end namespace
+
+class TestDocumentParsing: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pathsAndCycles()
+    {
+        Scene scene;
+        QStringList written;
+        written << scene.halfedges(1) << scene.halfedges(2) << scene.halfedges(3)
+                << "[" + num(scene.v[1]->id()) + "]";
+        foreach(const QString & str, written)
+        {
+            foreach(const QString & variant, variants(str, ",[]"))
+            {
+                QString former = formerPathOrCycle(variant);
+                QCOMPARE(former, str);
+                QCOMPARE(parsed<Path>(scene.vac, variant), former);
+                QCOMPARE(parsed<Cycle>(scene.vac, variant), former);
+            }
+        }
+
+        // Malformed: missing brackets, unbalanced brackets, mixed delimiters
+        QStringList malformed;
+        int e0 = scene.e[0]->id();
+        int e1 = scene.e[1]->id();
+        malformed << num(e0) + "+ " + num(e1) + "-"
+                  << "[" + num(e0) + "-," + num(e1) + "+"
+                  << "]]" + num(e1) + "-[" + num(e0) + "+"
+                  << num(scene.v[2]->id())
+                  << "[[" + num(scene.v[2]->id()) + ",";
+        foreach(const QString & str, malformed)
+        {
+            QString former = formerPathOrCycle(str);
+            QCOMPARE(parsed<Path>(scene.vac, str), former);
+            QCOMPARE(parsed<Cycle>(scene.vac, str), former);
+        }
+
+        // Empty lists: the former parsers read past the end of the token list
+        QStringList empty;
+        empty << "" << "[]" << " [ ] " << ",";
+        foreach(const QString & str, empty)
+        {
+            QCOMPARE(parsed<Path>(scene.vac, str), QString("[]"));
+            QCOMPARE(parsed<Cycle>(scene.vac, str), QString("[]"));
+        }
+    }
+
+    void animatedVertices()
+    {
+        Scene scene;
+        QStringList written;
+        written << "[" + num(scene.iv[0]->id()) + "]"
+                << "[" + num(scene.iv[0]->id()) + " " + num(scene.iv[1]->id()) + "]"
+                << "[]";
+        foreach(const QString & str, written)
+        {
+            foreach(const QString & variant, variants(str, ",[]"))
+            {
+                QString former = formerAnimatedVertex(variant);
+                QCOMPARE(former, str);
+                QCOMPARE(parsed<AnimatedVertex>(scene.vac, variant), former);
+            }
+        }
+
+        QStringList malformed;
+        malformed << "" << ",,," << num(scene.iv[1]->id()) + "," + num(scene.iv[0]->id())
+                  << "]" + num(scene.iv[1]->id()) + "[";
+        foreach(const QString & str, malformed)
+            QCOMPARE(parsed<AnimatedVertex>(scene.vac, str), formerAnimatedVertex(str));
+    }
+
+    void animatedCycles()
+    {
+        Scene scene;
+        int e0 = scene.e[0]->id();
+        int e1 = scene.e[1]->id();
+        int e2 = scene.e[2]->id();
+        QString str = QString("[1:(%1+,3,2,_,_) 2:(%2+,1,3,_,_) 3:(%3+,2,1,_,_)]").arg(e0).arg(e1).arg(e2);
+        QString written = parsed<AnimatedCycle>(scene.vac, str);
+        QCOMPARE(formerAnimatedCycle(written).size(), 3);
+        QCOMPARE(parsed<AnimatedCycle>(scene.vac, written), written);
+
+        // Extra tokens, not making a whole node, are ignored
+        QStringList inputs = variants(written, ",():[]");
+        inputs << written + " 7" << written.left(written.length() - 1) + " 4:(" + num(e0) + "+]";
+        foreach(const QString & variant, inputs)
+        {
+            QCOMPARE(formerAnimatedCycle(variant), formerAnimatedCycle(written));
+            QCOMPARE(parsed<AnimatedCycle>(scene.vac, variant), written);
+        }
+    }
+
+    void linearSplines()
+    {
+        QStringList inputs;
+        inputs << "5 0,0,1 10,0,2 20,5.5,3"
+               << "  5\t0,0,1\n10,0,2   20,5.5,3 "
+               << "5,0,0,1,,10,0,2,,,20,5.5,3,"
+               << "5 0,0,1 10,0"     // incomplete sample
+               << "1e-1 -1.5e3,2E2,0.125"
+               << "5"                // no samples
+               << ""                 // empty
+               << " , ";             // blank
+        foreach(const QString & str, inputs)
+        {
+            QVector<double> former = formerLinearSpline(str);
+            LinearSpline spline(QStringRef(&str));
+            int n = former.isEmpty() ? 0 : (former.size()-1)/3;
+            QCOMPARE(spline.size(), n);
+            if(!former.isEmpty())
+                QCOMPARE(spline.curve().ds(), former[0]);
+            for(int i=0; i<n; ++i)
+            {
+                QCOMPARE(spline[i].x(), former[1+3*i]);
+                QCOMPARE(spline[i].y(), former[2+3*i]);
+                QCOMPARE(spline[i].width(), former[3+3*i]);
+            }
+        }
+    }
+
+    void keyVertexPositions()
+    {
+        // As written by KeyVertex::write_()
+        QStringList written;
+        written << "1.5 -2" << "0 0" << "1000 0.25" << "1e+20 -3.25e-05";
+        foreach(const QString & str, written)
+        {
+            VAC vac;
+            readObjects(vac, "<vertex id=\"1\" frame=\"0\" position=\"" + xmlEscaped(str) + "\"/>");
+            KeyVertex * v = vac.getCell(1)->toKeyVertex();
+            QVERIFY(v);
+            QCOMPARE(v->pos(), formerPosition(str));
+        }
+
+        // The former parser only accepted single spaces, giving (0,0) for
+        // other whitespaces, and read past the end of the list for less
+        // than two numbers
+        QStringList others;
+        others << "  1.5\t-2 " << "1.5\n\n-2" << "1.5" << "" << "abc def";
+        const double expected[][2] = {{1.5, -2}, {1.5, -2}, {1.5, 0}, {0, 0}, {0, 0}};
+        for(int i=0; i<others.size(); ++i)
+        {
+            VAC vac;
+            readObjects(vac, "<vertex id=\"1\" frame=\"0\" position=\"" + xmlEscaped(others[i]) + "\"/>");
+            QCOMPARE(vac.getCell(1)->toKeyVertex()->pos(), Eigen::Vector2d(expected[i][0], expected[i][1]));
+        }
+    }
+
+    void inbetweenFaceLists()
+    {
+        // As written by InbetweenFace::write_(), and with other whitespaces
+        QStringList inputs;
+        inputs << "1 2" << "2" << " 1   2 " << "1\t2\n" << "\n2 1";
+        foreach(const QString & str, inputs)
+        {
+            VAC vac;
+            readObjects(vac,
+                        "<face id=\"1\" frame=\"0\" cycles=\"\"/>"
+                        "<face id=\"2\" frame=\"0\" cycles=\"\"/>"
+                        "<face id=\"3\" frame=\"4\" cycles=\"\"/>"
+                        "<inbetweenface id=\"4\" cycles=\"\" beforefaces=\"" + xmlEscaped(str) + "\" afterfaces=\"3\"/>");
+            InbetweenFace * f = vac.getCell(4)->toInbetweenFace();
+            QVERIFY(f);
+            QList<int> former = formerFaceIds(str);
+            std::sort(former.begin(), former.end());
+            QCOMPARE(sortedIds(f->beforeFaces()), former);
+            QCOMPARE(sortedIds(f->afterFaces()), QList<int>() << 3);
+        }
+
+        // Empty or blank lists: the former parser read the face id 0, which
+        // doesn't exist in documents without cell 0
+        QStringList blank;
+        blank << "" << "   " << "\t";
+        foreach(const QString & str, blank)
+        {
+            QCOMPARE(formerFaceIds(str), QList<int>() << 0);
+            VAC vac;
+            readObjects(vac,
+                        "<face id=\"1\" frame=\"4\" cycles=\"\"/>"
+                        "<inbetweenface id=\"2\" cycles=\"\" beforefaces=\"" + xmlEscaped(str) + "\" afterfaces=\"1\"/>");
+            InbetweenFace * f = vac.getCell(2)->toInbetweenFace();
+            QVERIFY(f->beforeFaces().isEmpty());
+            QCOMPARE(sortedIds(f->afterFaces()), QList<int>() << 1);
+        }
+    }
+};
+
+VPAINT_TEST_MAIN(TestDocumentParsing)
+#include "tst_DocumentParsing.moc"
@@ -0,0 +1,294 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/SculptCurve.h"
+#include "VectorAnimationComplex/EdgeSample.h"
+
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+typedef SculptCurve::Curve<EdgeSample> Curve;
+typedef std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > Samples;
+
+// An open wavy curve from (0,0) to (200,y), with varying widths
+Samples wavySamples()
+{
+    Samples res;
+    for(int i=0; i<=40; ++i)
+    {
+        double x = 5.0 * i;
+        res.push_back(EdgeSample(x, 20 * std::sin(x / 25), 2 + std::cos(x / 15)));
+    }
+    return res;
+}
+
+Curve wavyCurve()
+{
+    Curve res(5.0);
+    res.setVertices(wavySamples());
+    res.resample(true);
+    return res;
+}
+
+// Moves the position of a sample, keeping its width
+EdgeSample moved(const EdgeSample & s, double dx, double dy)
+{
+    return EdgeSample(s.x() + dx, s.y() + dy, s.width());
+}
+
+bool fuzzyEqual(const EdgeSample & a, const EdgeSample & b, double eps = 1e-6)
+{
+    return std::abs(a.x() - b.x()) < eps &&
+           std::abs(a.y() - b.y()) < eps &&
+           std::abs(a.width() - b.width()) < eps;
+}
+
+bool fuzzyEqual(const Curve & a, const Curve & b, double eps = 1e-6)
+{
+    if(a.size() != b.size())
+        return false;
+    for(int i=0; i<a.size(); ++i)
+        if(!fuzzyEqual(a[i], b[i], eps))
+            return false;
+    return true;
+}
+
+LinearSpline * spline(KeyEdge * e)
+{
+    return dynamic_cast<LinearSpline *>(e->geometry());
+}
+
+// An open wavy edge between v0 and v1, and a straight edge between v1 and v2
+struct Scene
+{
+    VAC vac;
+    KeyVertex * v0;
+    KeyVertex * v1;
+    KeyVertex * v2;
+    KeyEdge * e01;
+    KeyEdge * e12;
+
+    Scene()
+    {
+        Samples samples = wavySamples();
+        const EdgeSample & last = samples.back();
+        v0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        v1 = vac.newKeyVertex(Time(0), Eigen::Vector2d(last.x(), last.y()));
+        v2 = vac.newKeyVertex(Time(0), Eigen::Vector2d(last.x() + 100, last.y()));
+        e01 = vac.newKeyEdge(Time(0), v0, v1, new LinearSpline(samples));
+        e12 = vac.newKeyEdge(Time(0), v1, v2);
+    }
+};
+
+} // end namespace
+
+class TestEndPointsDrag: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // A drag to a single position gives the same curve as setEndPoints(),
+    // which was called by correctGeometry() on each move before
+    void singleMoveMatchesSetEndPoints_data()
+    {
+        QTest::addColumn<double>("dxStart");
+        QTest::addColumn<double>("dyStart");
+        QTest::addColumn<double>("dxEnd");
+        QTest::addColumn<double>("dyEnd");
+
+        QTest::newRow("end only") << 0.0 << 0.0 << 30.0 << -12.0;
+        QTest::newRow("start only") << -7.0 << 3.0 << 0.0 << 0.0;
+        QTest::newRow("both") << -7.0 << 3.0 << 30.0 << -12.0;
+        QTest::newRow("translation") << 15.0 << 15.0 << 15.0 << 15.0;
+        QTest::newRow("shrink") << 40.0 << 0.0 << -40.0 << 0.0;
+    }
+
+    void singleMoveMatchesSetEndPoints()
+    {
+        QFETCH(double, dxStart);
+        QFETCH(double, dyStart);
+        QFETCH(double, dxEnd);
+        QFETCH(double, dyEnd);
+
+        Curve rest = wavyCurve();
+        EdgeSample newStart = moved(rest.start(), dxStart, dyStart);
+        EdgeSample newEnd = moved(rest.end(), dxEnd, dyEnd);
+
+        Curve incremental = rest;
+        incremental.setEndPoints(newStart, newEnd);
+
+        Curve dragged = rest;
+        dragged.beginEndPointsDrag();
+        QVERIFY(dragged.isEndPointsDragging());
+        dragged.setEndPointsFromRest(newStart, newEnd);
+
+        // Not resampled until the end of the drag
+        QCOMPARE(dragged.size(), rest.size());
+        QVERIFY(fuzzyEqual(dragged.start(), newStart));
+        QVERIFY(fuzzyEqual(dragged.end(), newEnd));
+
+        dragged.endEndPointsDrag();
+        QVERIFY(!dragged.isEndPointsDragging());
+        QVERIFY(fuzzyEqual(dragged, incremental));
+    }
+
+    // Intermediate moves don't change the result: each one restarts from the
+    // rest shape
+    void intermediateMovesDontDrift()
+    {
+        Curve rest = wavyCurve();
+        EdgeSample newEnd = moved(rest.end(), 35, 20);
+
+        Curve incremental = rest;
+        incremental.setEndPoints(rest.start(), newEnd);
+
+        Curve dragged = rest;
+        dragged.beginEndPointsDrag();
+        for(int i=1; i<=25; ++i)
+        {
+            double u = i / 25.0;
+            dragged.setEndPointsFromRest(rest.start(), moved(rest.end(), -60 * std::sin(7 * u), 45 * u));
+        }
+        dragged.setEndPointsFromRest(rest.start(), newEnd);
+        dragged.endEndPointsDrag();
+
+        QVERIFY(fuzzyEqual(dragged, incremental));
+    }
+
+    // A cancelled drag releases the rest shape and keeps the current samples
+    void cancel()
+    {
+        Curve rest = wavyCurve();
+        EdgeSample newEnd = moved(rest.end(), 10, -5);
+
+        // Arclengths are computed by beginEndPointsDrag(), and kept
+        Curve dragged = rest;
+        dragged.length();
+        long long restBytes = dragged.memoryUsage();
+        dragged.beginEndPointsDrag();
+        QVERIFY(dragged.memoryUsage() > restBytes);
+        dragged.setEndPointsFromRest(rest.start(), newEnd);
+        dragged.cancelEndPointsDrag();
+
+        QVERIFY(!dragged.isEndPointsDragging());
+        QCOMPARE(dragged.memoryUsage(), restBytes);
+        QCOMPARE(dragged.size(), rest.size());
+        QVERIFY(fuzzyEqual(dragged.end(), newEnd));
+
+        // Without drag, setEndPointsFromRest() is setEndPoints()
+        EdgeSample newEnd2 = moved(rest.end(), -20, 8);
+        Curve incremental = dragged;
+        incremental.setEndPoints(rest.start(), newEnd2);
+        dragged.setEndPointsFromRest(rest.start(), newEnd2);
+        QVERIFY(fuzzyEqual(dragged, incremental));
+    }
+
+    // Replacing the samples abandons the drag
+    void setVerticesCancels()
+    {
+        Curve curve = wavyCurve();
+        curve.beginEndPointsDrag();
+        curve.setVertices(wavySamples());
+        QVERIFY(!curve.isEndPointsDragging());
+    }
+
+    // Dragging a vertex through VAC deforms its incident edges like
+    // setEndPoints() does, and releases their rest shapes on release
+    void dragVertex()
+    {
+        Scene scene;
+        Curve rest = spline(scene.e01)->curve();
+        Eigen::Vector2d p1 = scene.v1->pos();
+
+        scene.vac.setHoveredCell(scene.v1);
+        scene.vac.prepareDragAndDrop(p1[0], p1[1], Time(0));
+        QVERIFY(spline(scene.e01)->curve().isEndPointsDragging());
+        QVERIFY(spline(scene.e12)->curve().isEndPointsDragging());
+        for(int i=1; i<=10; ++i)
+            scene.vac.performDragAndDrop(p1[0] + 3 * i, p1[1] - 2 * i);
+        scene.vac.completeDragAndDrop();
+
+        QVERIFY(!spline(scene.e01)->curve().isEndPointsDragging());
+        QVERIFY(!spline(scene.e12)->curve().isEndPointsDragging());
+
+        Curve incremental = rest;
+        incremental.setEndPoints(rest.start(), moved(rest.end(), 30, -20));
+        QVERIFY(fuzzyEqual(spline(scene.e01)->curve(), incremental));
+    }
+
+    // Clones, e.g. saved to or restored from the undo stack in the middle
+    // of a drag, don't carry the rest shape
+    void cloneDuringDrag()
+    {
+        Scene scene;
+        Eigen::Vector2d p1 = scene.v1->pos();
+        scene.vac.setHoveredCell(scene.v1);
+        scene.vac.prepareDragAndDrop(p1[0], p1[1], Time(0));
+        scene.vac.performDragAndDrop(p1[0] + 10, p1[1]);
+
+        VAC * clone = scene.vac.clone();
+        KeyEdge * e01 = clone->getCell(scene.e01->id())->toKeyEdge();
+        QVERIFY(e01);
+        QVERIFY(!spline(e01)->curve().isEndPointsDragging());
+        QVERIFY(fuzzyEqual(spline(e01)->curve().end(), spline(scene.e01)->curve().end()));
+        delete clone;
+
+        scene.vac.completeDragAndDrop();
+    }
+
+    // A drag which is never completed is cancelled by the next one
+    void abandonedDrag()
+    {
+        Scene scene;
+        Eigen::Vector2d p1 = scene.v1->pos();
+        scene.vac.setHoveredCell(scene.v1);
+        scene.vac.prepareDragAndDrop(p1[0], p1[1], Time(0));
+        scene.vac.performDragAndDrop(p1[0] + 10, p1[1]);
+
+        scene.vac.setHoveredCell(scene.v0);
+        scene.vac.prepareDragAndDrop(0, 0, Time(0));
+        QVERIFY(spline(scene.e01)->curve().isEndPointsDragging());
+        QVERIFY(!spline(scene.e12)->curve().isEndPointsDragging());
+        scene.vac.completeDragAndDrop();
+        QVERIFY(!spline(scene.e01)->curve().isEndPointsDragging());
+
+        scene.vac.setHoveredCell(scene.v1);
+        scene.vac.prepareDragAndDrop(p1[0], p1[1], Time(0));
+        scene.vac.setNoHoveredCell();
+        scene.vac.prepareDragAndDrop(p1[0], p1[1], Time(0));
+        QVERIFY(!spline(scene.e01)->curve().isEndPointsDragging());
+        QVERIFY(!spline(scene.e12)->curve().isEndPointsDragging());
+    }
+
+    // Edges deleted during a drag are not accessed when it completes
+    void deleteDuringDrag()
+    {
+        Scene scene;
+        Eigen::Vector2d p1 = scene.v1->pos();
+        scene.vac.setHoveredCell(scene.v1);
+        scene.vac.prepareDragAndDrop(p1[0], p1[1], Time(0));
+        scene.vac.performDragAndDrop(p1[0] + 10, p1[1]);
+        scene.vac.deleteCell(scene.e12);
+        scene.vac.performDragAndDrop(p1[0] + 20, p1[1]);
+        scene.vac.completeDragAndDrop();
+        QVERIFY(!spline(scene.e01)->curve().isEndPointsDragging());
+    }
+};
+
+VPAINT_TEST_MAIN(TestEndPointsDrag)
+#include "tst_EndPointsDrag.moc"
@@ -0,0 +1,180 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+
+#include <QColor>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+const int firstFrame = -2;
+const int lastFrame = 8;
+
+// Frames in [firstFrame, lastFrame] whose image rendered at the given
+// revision is out of date
+QList<int> changedFrames(const VAC & vac, quint64 revision)
+{
+    QList<int> res;
+    for(int frame = firstFrame; frame <= lastFrame; ++frame)
+        if(vac.frameRevision(frame) > revision)
+            res << frame;
+    return res;
+}
+
+QList<int> range(int first, int last)
+{
+    QList<int> res;
+    for(int frame = first; frame <= last; ++frame)
+        res << frame;
+    return res;
+}
+
+// Images rendered at the current revision are up to date
+bool isUpToDate(const VAC & vac)
+{
+    return changedFrames(vac, vac.revision()).isEmpty();
+}
+
+// Key vertices v at time 0 and u at time 4, the inbetween vertex sv between
+// them, and the key edge e at time 6
+struct Scene
+{
+    VAC vac;
+    KeyVertex * v;
+    KeyVertex * u;
+    InbetweenVertex * sv;
+    KeyEdge * e;
+
+    Scene()
+    {
+        v = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        u = vac.newKeyVertex(Time(4), Eigen::Vector2d(100, 0));
+        sv = vac.newInbetweenVertex(v, u);
+        KeyVertex * a = vac.newKeyVertex(Time(6), Eigen::Vector2d(500, 500));
+        KeyVertex * b = vac.newKeyVertex(Time(6), Eigen::Vector2d(600, 500));
+        e = vac.newKeyEdge(Time(6), a, b, 0, 10);
+    }
+};
+
+} // end namespace
+
+class TestFrameRevisions: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void noChange()
+    {
+        Scene scene;
+        QVERIFY(isUpToDate(scene.vac));
+        QVERIFY(scene.vac.frameRevision(1000) <= scene.vac.revision());
+    }
+
+    // Only the frames where the new cell exists change
+    void insertion()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        quint64 revision = vac.revision();
+        vac.newKeyVertex(Time(2), Eigen::Vector2d(0, 0));
+        QVERIFY(vac.revision() > revision);
+        QCOMPARE(changedFrames(vac, revision), QList<int>() << 2);
+        QVERIFY(isUpToDate(vac));
+
+        // A key cell between two frames appears in both
+        revision = vac.revision();
+        vac.newKeyVertex(Time(2.5), Eigen::Vector2d(0, 0));
+        QCOMPARE(changedFrames(vac, revision), QList<int>() << 2 << 3);
+
+        revision = vac.revision();
+        vac.newInbetweenVertex(scene.u, vac.newKeyVertex(Time(7), Eigen::Vector2d(0, 0)));
+        QCOMPARE(changedFrames(vac, revision), range(4, 7));
+    }
+
+    // Moving a key vertex changes the frames of the inbetween vertex whose
+    // geometry depends on it
+    void geometryChange()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        quint64 revision = vac.revision();
+        scene.u->setPos(Eigen::Vector2d(100, 50));
+        QCOMPARE(changedFrames(vac, revision), range(0, 4));
+        QVERIFY(isUpToDate(vac));
+
+        revision = vac.revision();
+        scene.e->startVertex()->setPos(Eigen::Vector2d(500, 450));
+        scene.e->startVertex()->correctEdgesGeometry();
+        QCOMPARE(changedFrames(vac, revision), QList<int>() << 6);
+    }
+
+    void colorChange()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        quint64 revision = vac.revision();
+        scene.e->setColor(Qt::red);
+        QCOMPARE(changedFrames(vac, revision), QList<int>() << 6);
+
+        revision = vac.revision();
+        scene.sv->setColor(Qt::red);
+        QCOMPARE(changedFrames(vac, revision), range(0, 4));
+        QVERIFY(isUpToDate(vac));
+    }
+
+    // Deleting u deletes sv too
+    void deletion()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        quint64 revision = vac.revision();
+        vac.deleteCell(scene.e);
+        QCOMPARE(changedFrames(vac, revision), QList<int>() << 6);
+
+        revision = vac.revision();
+        vac.deleteCell(scene.u);
+        QCOMPARE(changedFrames(vac, revision), range(0, 4));
+        QVERIFY(isUpToDate(vac));
+    }
+
+    // Changing the z-ordering changes all frames, even without cells
+    void zOrdering()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        quint64 revision = vac.revision();
+        vac.addToSelection(scene.e, false);
+        QVERIFY(changedFrames(vac, revision).isEmpty());
+        vac.raise();
+        QCOMPARE(changedFrames(vac, revision), range(firstFrame, lastFrame));
+        QVERIFY(vac.frameRevision(1000) > revision);
+        QVERIFY(isUpToDate(vac));
+    }
+
+    // Revisions are unique across VACs: images rendered with another VAC
+    // are out of date
+    void newVac()
+    {
+        Scene scene;
+        quint64 revision = scene.vac.revision();
+        Scene other;
+        QCOMPARE(changedFrames(other.vac, revision), range(firstFrame, lastFrame));
+        QVERIFY(other.vac.revision() > revision);
+    }
+};
+
+VPAINT_TEST_MAIN(TestFrameRevisions)
+#include "tst_FrameRevisions.moc"
@@ -0,0 +1,173 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+bool fuzzyEqual(const BoundingBox & bb1, const BoundingBox & bb2)
+{
+    const double eps = 1e-9;
+    return std::abs(bb1.xMin() - bb2.xMin()) < eps && std::abs(bb1.xMax() - bb2.xMax()) < eps &&
+           std::abs(bb1.yMin() - bb2.yMin()) < eps && std::abs(bb1.yMax() - bb2.yMax()) < eps;
+}
+
+// Horizontal chain of key vertices v[0..3] and key edges e[0..2] of width
+// 10, where e[i] is between v[i] and v[i+1]
+struct Chain
+{
+    VAC vac;
+    KeyVertex * v[4];
+    KeyEdge * e[3];
+
+    Chain()
+    {
+        for(int i=0; i<4; ++i)
+            v[i] = vac.newKeyVertex(Time(0), Eigen::Vector2d(100 * i, 0));
+        for(int i=0; i<3; ++i)
+            e[i] = vac.newKeyEdge(Time(0), v[i], v[i+1], 0, 10);
+    }
+
+    // Fills the cached geometry of all cells, so that stale caches would be
+    // noticed
+    void computeCaches()
+    {
+        foreach(Cell * c, vac.cells())
+            c->boundingBox();
+    }
+
+    // Moves v[0] and v[1] up, in this order
+    void moveVertices()
+    {
+        v[0]->setPos(Eigen::Vector2d(0, 50));
+        v[0]->correctEdgesGeometry();
+        v[1]->setPos(Eigen::Vector2d(100, 50));
+        v[1]->correctEdgesGeometry();
+    }
+};
+
+} // end namespace
+
+class TestGeometryChangeTransaction: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Changes are only committed by the outermost transaction, once
+    void nestedTransactionsCoalesce()
+    {
+        Chain chain;
+        chain.computeCaches();
+        VAC & vac = chain.vac;
+        vac.resetGeometryChangeCounters();
+
+        {
+            GeometryChangeTransaction outer(&vac);
+            chain.v[0]->setPos(Eigen::Vector2d(0, 50));
+            {
+                GeometryChangeTransaction inner(&vac);
+                chain.v[1]->setPos(Eigen::Vector2d(100, 50));
+                {
+                    GeometryChangeTransaction innermost(&vac);
+                    chain.v[0]->setPos(Eigen::Vector2d(0, 60));
+                }
+                QCOMPARE(vac.geometryChangeCounters().numCommits, 0);
+            }
+            QCOMPARE(vac.geometryChangeCounters().numCommits, 0);
+            QCOMPARE(vac.geometryChangeCounters().numDeferredChanges, 3);
+            QCOMPARE(vac.geometryChangeCounters().numClearedCaches, 0);
+        }
+
+        // Cleared once: v[0], v[1] and their incident edges e[0] and e[1],
+        // and v[2], whose size depends on the width of e[1]
+        QCOMPARE(vac.geometryChangeCounters().numCommits, 1);
+        QCOMPARE(vac.geometryChangeCounters().numDeferredChanges, 3);
+        QCOMPARE(vac.geometryChangeCounters().numClearedCaches, 5);
+    }
+
+    // Each transaction without change commits nothing
+    void emptyTransactions()
+    {
+        Chain chain;
+        VAC & vac = chain.vac;
+        vac.resetGeometryChangeCounters();
+        {
+            GeometryChangeTransaction outer(&vac);
+            GeometryChangeTransaction inner(&vac);
+        }
+        QCOMPARE(vac.geometryChangeCounters().numCommits, 0);
+        QCOMPARE(vac.geometryChangeCounters().numDeferredChanges, 0);
+        QCOMPARE(vac.geometryChangeCounters().numClearedCaches, 0);
+
+        // A null VAC is ignored
+        GeometryChangeTransaction transaction(0);
+    }
+
+    // Sequential transactions commit separately, and changes outside of
+    // transactions are not counted
+    void sequentialTransactions()
+    {
+        Chain chain;
+        VAC & vac = chain.vac;
+        vac.resetGeometryChangeCounters();
+
+        chain.v[3]->setPos(Eigen::Vector2d(300, 10));
+        QCOMPARE(vac.geometryChangeCounters().numDeferredChanges, 0);
+        QCOMPARE(vac.geometryChangeCounters().numCommits, 0);
+
+        {
+            GeometryChangeTransaction transaction(&vac);
+            chain.v[3]->setPos(Eigen::Vector2d(300, 20));
+        }
+        {
+            GeometryChangeTransaction transaction(&vac);
+            chain.v[3]->setPos(Eigen::Vector2d(300, 30));
+        }
+
+        // v[3], e[2], and v[2] whose size depends on e[2], each time
+        QCOMPARE(vac.geometryChangeCounters().numDeferredChanges, 2);
+        QCOMPARE(vac.geometryChangeCounters().numCommits, 2);
+        QCOMPARE(vac.geometryChangeCounters().numClearedCaches, 6);
+    }
+
+    // Cells get the same cached geometry as without transaction
+    void sameGeometryAsWithoutTransaction()
+    {
+        Chain immediate;
+        immediate.computeCaches();
+        immediate.moveVertices();
+
+        Chain deferred;
+        deferred.computeCaches();
+        {
+            GeometryChangeTransaction transaction(&deferred.vac);
+            deferred.moveVertices();
+        }
+
+        foreach(Cell * c, immediate.vac.cells())
+        {
+            Cell * other = deferred.vac.getCell(c->id());
+            QVERIFY(other);
+            QVERIFY(fuzzyEqual(c->boundingBox(), other->boundingBox()));
+        }
+        QVERIFY(deferred.e[0]->boundingBox().yMin() > 40);
+        QVERIFY(deferred.v[2]->boundingBox().yMax() < 10);
+    }
+};
+
+VPAINT_TEST_MAIN(TestGeometryChangeTransaction)
+#include "tst_GeometryChangeTransaction.moc"
@@ -0,0 +1,190 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "VectorAnimationComplex/GeometryPager.h"
+
+#include <QtTest>
+#include <QByteArray>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+QByteArray someData(int numBytes, int seed)
+{
+    QByteArray res(numBytes, 0);
+    for(int i=0; i<numBytes; ++i)
+        res[i] = (char) ((i * 31 + seed * 7) % 251);
+    return res;
+}
+
+int pageOut(const QByteArray & data)
+{
+    return GeometryPager::instance()->pageOut(data.constData(), data.size());
+}
+
+QByteArray read(int id)
+{
+    GeometryPager * pager = GeometryPager::instance();
+    QByteArray res(pager->pageSize(id), 0);
+    pager->read(id, res.data());
+    return res;
+}
+
+} // end namespace
+
+class TestGeometryPager: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Each test releases its pages, so that the whole file is free
+    void init()
+    {
+        GeometryPager * pager = GeometryPager::instance();
+        QCOMPARE(pager->numPages(), 0);
+        QCOMPARE(pager->numBytes(), (qint64) 0);
+        QVERIFY(pager->numFreeRanges() <= 1);
+        pager->resetCounters();
+    }
+
+    void roundTrip()
+    {
+        GeometryPager * pager = GeometryPager::instance();
+        qint64 pagedInBytes = pager->numPagedInBytes();
+        QByteArray data = someData(1000, 1);
+        int id = pageOut(data);
+        QVERIFY(id >= 0);
+        QCOMPARE(pager->numPages(), 1);
+        QCOMPARE(pager->numBytes(), (qint64) 1000);
+        QCOMPARE(pager->pageSize(id), (qint64) 1000);
+        QCOMPARE(pager->counters().numPageOuts, 1);
+
+        // Reading keeps the page
+        QCOMPARE(read(id), data);
+        QCOMPARE(read(id), data);
+        QCOMPARE(pager->numPages(), 1);
+        QCOMPARE(pager->counters().numPageIns, 0);
+        QCOMPARE(pager->numPagedInBytes(), pagedInBytes);
+
+        // Paging in releases it
+        QByteArray out(1000, 0);
+        pager->pageIn(id, out.data());
+        QCOMPARE(out, data);
+        QCOMPARE(pager->numPages(), 0);
+        QCOMPARE(pager->numBytes(), (qint64) 0);
+        QCOMPARE(pager->counters().numPageIns, 1);
+        QCOMPARE(pager->numPagedInBytes(), pagedInBytes + 1000);
+
+        // Released pages are ignored
+        QByteArray untouched = someData(1000, 2);
+        out = untouched;
+        pager->pageIn(id, out.data());
+        pager->read(id, out.data());
+        QCOMPARE(out, untouched);
+        pager->release(id);
+        QCOMPARE(pager->pageSize(id), (qint64) 0);
+        QCOMPARE(pager->counters().numPageIns, 1);
+    }
+
+    // Released pages are merged with adjacent free ranges, and reused first
+    // fit. Pages are aligned to 16 bytes
+    void freeRangeMerging()
+    {
+        GeometryPager * pager = GeometryPager::instance();
+        int a = pageOut(someData(100, 1));
+        int b = pageOut(someData(100, 2));
+        int c = pageOut(someData(100, 3));
+        QVERIFY(a >= 0 && b >= 0 && c >= 0);
+        qint64 fileSize = pager->fileSize();
+        QCOMPARE(pager->numFreeRanges(), 1);
+
+        pager->release(b);
+        QCOMPARE(pager->numFreeRanges(), 2);
+        pager->release(a);
+        QCOMPARE(pager->numFreeRanges(), 2);
+
+        // Fits exactly where a and b were
+        QByteArray data = someData(224, 4);
+        int d = pageOut(data);
+        QVERIFY(d >= 0);
+        QCOMPARE(pager->numFreeRanges(), 1);
+        QCOMPARE(read(c), someData(100, 3));
+
+        pager->release(c);
+        QCOMPARE(pager->numFreeRanges(), 1);
+        QCOMPARE(read(d), data);
+        pager->release(d);
+        QCOMPARE(pager->numFreeRanges(), 1);
+        QCOMPARE(pager->fileSize(), fileSize);
+    }
+
+    void copyPage()
+    {
+        GeometryPager * pager = GeometryPager::instance();
+        QCOMPARE(pager->copyPage(-1), -1);
+
+        QByteArray data = someData(5000, 5);
+        int id = pageOut(data);
+        int copy = pager->copyPage(id);
+        QVERIFY(copy >= 0);
+        QVERIFY(copy != id);
+        QCOMPARE(pager->numPages(), 2);
+        QCOMPARE(pager->numBytes(), (qint64) 10000);
+
+        pager->release(id);
+        QCOMPARE(read(copy), data);
+        pager->release(copy);
+        QCOMPARE(pager->numPages(), 0);
+        QCOMPARE(pager->numFreeRanges(), 1);
+    }
+
+    // Pages are kept when the file grows, which remaps it, including while
+    // a page is copied
+    void growth()
+    {
+        GeometryPager * pager = GeometryPager::instance();
+        const int pageSize = 1024 * 1024;
+        QList<int> ids;
+        QList<QByteArray> pages;
+        ids << pageOut(someData(pageSize, 0));
+        pages << someData(pageSize, 0);
+        QVERIFY(ids[0] >= 0);
+
+        // Page out until the file grows
+        qint64 fileSize = pager->fileSize();
+        while(pager->fileSize() == fileSize && ids.size() < 1000)
+        {
+            pages << someData(pageSize, ids.size());
+            ids << pageOut(pages.last());
+            QVERIFY(ids.last() >= 0);
+        }
+        QVERIFY(pager->fileSize() > fileSize);
+
+        // Copy until the file grows again
+        fileSize = pager->fileSize();
+        while(pager->fileSize() == fileSize && ids.size() < 1000)
+        {
+            pages << pages[0];
+            ids << pager->copyPage(ids[0]);
+            QVERIFY(ids.last() >= 0);
+        }
+        QVERIFY(pager->fileSize() > fileSize);
+
+        for(int i=0; i<ids.size(); ++i)
+            QVERIFY(read(ids[i]) == pages[i]);
+        foreach(int id, ids)
+            pager->release(id);
+        QCOMPARE(pager->numBytes(), (qint64) 0);
+        QCOMPARE(pager->numFreeRanges(), 1);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestGeometryPager)
+#include "tst_GeometryPager.moc"
@@ -0,0 +1,200 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/EdgeSample.h"
+#include "VectorAnimationComplex/GeometryPager.h"
+#include "VectorAnimationComplex/TessellationCache.h"
+
+#include <QTextStream>
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+const int numEdges = 60;
+const int numSamples = 3000;
+const qint64 maxBytes = 1024 * 1024;
+
+QList<EdgeSample> samples(int i)
+{
+    QList<EdgeSample> res;
+    for(int j=0; j<numSamples; ++j)
+        res << EdgeSample(0.1 * j, 10 * i + std::sin(0.01 * j), 2);
+    return res;
+}
+
+LinearSpline * spline(KeyEdge * e)
+{
+    return dynamic_cast<LinearSpline *>(e->geometry());
+}
+
+QString saved(EdgeGeometry * geometry)
+{
+    QString res;
+    QTextStream out(&res);
+    geometry->save(out);
+    out.flush();
+    return res;
+}
+
+// Sets a budget of 1 MB and a margin of 5 frames, and restores the settings
+// at the end of a test
+class SettingsGuard
+{
+public:
+    SettingsGuard() :
+        budget_(DevSettings::getInt("geometry budget (MB)")),
+        margin_(DevSettings::getInt("geometry paging margin (frames)"))
+    {
+        DevSettings::setInt("geometry budget (MB)", maxBytes / (1024 * 1024));
+        DevSettings::setInt("geometry paging margin (frames)", 5);
+    }
+    ~SettingsGuard()
+    {
+        DevSettings::setInt("geometry budget (MB)", budget_);
+        DevSettings::setInt("geometry paging margin (frames)", margin_);
+    }
+
+private:
+    int budget_;
+    int margin_;
+};
+
+// The key edge e[i] is at time i, and its samples take about 70 kB
+struct Scene
+{
+    VAC vac;
+    KeyEdge * e[numEdges];
+
+    Scene()
+    {
+        for(int i=0; i<numEdges; ++i)
+        {
+            QList<EdgeSample> s = samples(i);
+            KeyVertex * v0 = vac.newKeyVertex(Time(i), Eigen::Vector2d(s.first().x(), s.first().y()));
+            KeyVertex * v1 = vac.newKeyVertex(Time(i), Eigen::Vector2d(s.last().x(), s.last().y()));
+            e[i] = vac.newKeyEdge(Time(i), v0, v1, new LinearSpline(s));
+        }
+    }
+
+    // Memory held by the geometry of all edges, paged out or not
+    qint64 residentBytes() const
+    {
+        qint64 res = 0;
+        for(int i=0; i<numEdges; ++i)
+            res += spline(e[i])->memoryUsage();
+        return res;
+    }
+};
+
+} // end namespace
+
+class TestGeometryPaging: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // The edges farthest from the active time, which is 0 without views,
+    // are paged out until the geometry fits in the budget
+    void withinBudget()
+    {
+        SettingsGuard guard;
+        Scene scene;
+        QVERIFY(scene.residentBytes() > maxBytes);
+
+        scene.vac.updateGeometryPaging();
+        QVERIFY(scene.residentBytes() <= maxBytes);
+        for(int i=0; i<=5; ++i)
+            QVERIFY(!spline(scene.e[i])->isPagedOut());
+        QVERIFY(spline(scene.e[numEdges-1])->isPagedOut());
+        for(int i=1; i<numEdges; ++i)
+            QVERIFY(spline(scene.e[i])->isPagedOut() || !spline(scene.e[i-1])->isPagedOut());
+
+        // Paged out samples are read back when accessed
+        LinearSpline * last = spline(scene.e[numEdges-1]);
+        QList<EdgeSample> expected = samples(numEdges-1);
+        QCOMPARE(last->size(), numSamples);
+        QVERIFY(!last->isPagedOut());
+        for(int j=0; j<numSamples; ++j)
+            QVERIFY((*last)[j].x() == expected[j].x() && (*last)[j].y() == expected[j].y());
+    }
+
+    // Saving, cloning and tessellation lookups keep the samples paged out
+    void peek()
+    {
+        SettingsGuard guard;
+        Scene scene;
+        scene.vac.updateGeometryPaging();
+        LinearSpline * last = spline(scene.e[numEdges-1]);
+        QVERIFY(last->isPagedOut());
+        qint64 pagedInBytes = GeometryPager::instance()->numPagedInBytes();
+
+        LinearSpline resident(samples(numEdges-1));
+        QCOMPARE(saved(last), saved(&resident));
+        QVERIFY(last->isPagedOut());
+
+        TessellationKey key(TessellationKey::EdgeTriangles);
+        TessellationKey residentKey(TessellationKey::EdgeTriangles);
+        QVERIFY(last->addToTessellationKey(key));
+        QVERIFY(resident.addToTessellationKey(residentKey));
+        QVERIFY(key == residentKey);
+        QVERIFY(last->isPagedOut());
+
+        LinearSpline * clone = last->clone();
+        QVERIFY(clone->isPagedOut());
+        QCOMPARE(saved(clone), saved(&resident));
+        QVERIFY(clone->isPagedOut());
+        delete clone;
+
+        QCOMPARE(GeometryPager::instance()->numPagedInBytes(), pagedInBytes);
+    }
+
+    // Samples paged back in, e.g. by drawing far away frames, are paged out
+    // again by the next pass
+    void pagedInAgain()
+    {
+        SettingsGuard guard;
+        Scene scene;
+        scene.vac.updateGeometryPaging();
+        for(int i=0; i<numEdges; ++i)
+            spline(scene.e[i])->size();
+        QVERIFY(scene.residentBytes() > maxBytes);
+
+        scene.vac.updateGeometryPaging();
+        QVERIFY(scene.residentBytes() <= maxBytes);
+        QVERIFY(spline(scene.e[numEdges-1])->isPagedOut());
+    }
+
+    // Selected edges stay in memory, and a zero budget disables paging
+    void exceptions()
+    {
+        SettingsGuard guard;
+        Scene scene;
+        scene.vac.addToSelection(scene.e[numEdges-1], false);
+        scene.vac.updateGeometryPaging();
+        QVERIFY(!spline(scene.e[numEdges-1])->isPagedOut());
+        QVERIFY(spline(scene.e[numEdges-2])->isPagedOut());
+
+        DevSettings::setInt("geometry budget (MB)", 0);
+        Scene unpaged;
+        unpaged.vac.updateGeometryPaging();
+        for(int i=0; i<numEdges; ++i)
+            QVERIFY(!spline(unpaged.e[i])->isPagedOut());
+    }
+};
+
+VPAINT_TEST_MAIN(TestGeometryPaging)
+#include "tst_GeometryPaging.moc"
@@ -0,0 +1,105 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "IdListCopier.h"
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+
+#include <QClipboard>
+#include <QSignalSpy>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+QList<int> ids(const CellSet & cells)
+{
+    QList<int> res;
+    foreach(Cell * cell, cells)
+        res << cell->id();
+    return res;
+}
+
+QList<int> clipboardIds()
+{
+    QList<int> res;
+    QStringList list = QApplication::clipboard()->text().split(", ");
+    foreach(const QString & str, list)
+        res << str.toInt();
+    return res;
+}
+
+} // end namespace
+
+class TestIdListCopier: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void appendIds()
+    {
+        QVector<int> ids;
+        ids << 3 << 14 << 15 << 92;
+        QString text;
+        IdListCopier::appendIds(ids, 0, 1, text);
+        IdListCopier::appendIds(ids, 1, 1, text);
+        IdListCopier::appendIds(ids, 1, 4, text);
+        QCOMPARE(text, QString("3, 14, 15, 92"));
+    }
+
+    // More ids than copied per event loop iteration
+    void manyIds()
+    {
+        VAC vac;
+        for(int i=0; i<25000; ++i)
+            vac.addToSelection(vac.newKeyVertex(Time(0), Eigen::Vector2d(i, 0)), false);
+        CellSet selected = vac.selectedCells();
+        QList<int> expected = ids(selected);
+
+        IdListCopier copier;
+        QSignalSpy spy(&copier, SIGNAL(finished(int)));
+        copier.copy(selected);
+        QVERIFY(copier.isCopying());
+
+        // Cells may be deleted while copying
+        vac.deleteCell(*selected.begin());
+
+        QVERIFY(spy.wait());
+        QVERIFY(!copier.isCopying());
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.at(0).at(0).toInt(), 25000);
+        QCOMPARE(clipboardIds(), expected);
+    }
+
+    // A new copy cancels the one in progress
+    void restart()
+    {
+        VAC vac;
+        CellSet first;
+        CellSet second;
+        for(int i=0; i<20000; ++i)
+            first << vac.newKeyVertex(Time(0), Eigen::Vector2d(i, 0));
+        for(int i=0; i<3; ++i)
+            second << vac.newKeyVertex(Time(0), Eigen::Vector2d(i, 1));
+
+        IdListCopier copier;
+        QSignalSpy spy(&copier, SIGNAL(finished(int)));
+        copier.copy(first);
+        copier.copy(second);
+        QVERIFY(spy.wait());
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.at(0).at(0).toInt(), 3);
+        QCOMPARE(clipboardIds(), ids(second));
+    }
+};
+
+VPAINT_TEST_MAIN(TestIdListCopier)
+#include "tst_IdListCopier.moc"
@@ -0,0 +1,163 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+#include "VectorAnimationComplex/InbetweenEdge.h"
+#include "VectorAnimationComplex/Path.h"
+#include "VectorAnimationComplex/AnimatedVertex.h"
+
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+bool contains(const BoundingBox & outer, const BoundingBox & inner)
+{
+    const double eps = 1e-9;
+    return inner.isEmpty() ||
+           ( outer.xMin() <= inner.xMin() + eps && inner.xMax() <= outer.xMax() + eps &&
+             outer.yMin() <= inner.yMin() + eps && inner.yMax() <= outer.yMax() + eps );
+}
+
+// Vertices are triangulated as approximate disks
+bool fuzzyEqual(const BoundingBox & bb1, const BoundingBox & bb2)
+{
+    const double eps = 1e-3;
+    return std::abs(bb1.xMin() - bb2.xMin()) < eps && std::abs(bb1.xMax() - bb2.xMax()) < eps &&
+           std::abs(bb1.yMin() - bb2.yMin()) < eps && std::abs(bb1.yMax() - bb2.yMax()) < eps;
+}
+
+// A horizontal key edge of width 10 at time 0, moved 50 units down at time
+// 2, and the inbetween edge between them
+struct Scene
+{
+    VAC vac;
+    KeyVertex * v0;
+    KeyVertex * w0;
+    KeyVertex * v2;
+    KeyVertex * w2;
+    KeyEdge * e0;
+    KeyEdge * e2;
+    InbetweenVertex * sv;
+    InbetweenVertex * sw;
+    InbetweenEdge * se;
+
+    Scene()
+    {
+        v0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        w0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(100, 0));
+        v2 = vac.newKeyVertex(Time(2), Eigen::Vector2d(0, 50));
+        w2 = vac.newKeyVertex(Time(2), Eigen::Vector2d(100, 50));
+        e0 = vac.newKeyEdge(Time(0), v0, w0, 0, 10);
+        e2 = vac.newKeyEdge(Time(2), v2, w2, 0, 10);
+        sv = vac.newInbetweenVertex(v0, v2);
+        sw = vac.newInbetweenVertex(w0, w2);
+        se = vac.newInbetweenEdge(
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(e0, true)),
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(e2, true)),
+                    AnimatedVertex(InbetweenVertexList() << sv),
+                    AnimatedVertex(InbetweenVertexList() << sw));
+    }
+};
+
+}
+
+class TestInbetweenBoundingBox: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // The conservative boxes contain the boxes at each frame
+    void containsExactBoundingBox()
+    {
+        Scene scene;
+        QList<InbetweenCell*> cells;
+        cells << scene.sv << scene.sw << scene.se;
+        foreach(InbetweenCell * c, cells)
+        {
+            QVERIFY(!c->exactBoundingBox().isEmpty());
+            QVERIFY(contains(c->boundingBox(), c->exactBoundingBox()));
+            QVERIFY(contains(c->outlineBoundingBox(), c->exactOutlineBoundingBox()));
+        }
+    }
+
+    // The motion of sv is a straight line from (0,0) to (0,50), and it is
+    // drawn as a disk of diameter the width of se
+    void inbetweenVertex()
+    {
+        Scene scene;
+        QVERIFY(fuzzyEqual(scene.sv->outlineBoundingBox(), BoundingBox(0, 0, 0, 50)));
+        QVERIFY(fuzzyEqual(scene.sv->boundingBox(), BoundingBox(-5, 5, -5, 55)));
+    }
+
+    // The cached boxes of inbetween vertices depend on the width of the key
+    // edges interpolated by their incident inbetween edges
+    void invalidatedByKeyEdgeWidth()
+    {
+        Scene scene;
+        QVERIFY(fuzzyEqual(scene.sv->boundingBox(), BoundingBox(-5, 5, -5, 55)));
+        QVERIFY(fuzzyEqual(scene.v0->boundingBox(), BoundingBox(-5, 5, -5, 5)));
+
+        scene.e0->setWidth(40);
+        QVERIFY(fuzzyEqual(scene.sv->boundingBox(), BoundingBox(-20, 20, -20, 70)));
+        QVERIFY(contains(scene.sv->boundingBox(), scene.sv->exactBoundingBox()));
+
+        // Key vertices are also drawn with the width of their incident edges
+        QVERIFY(fuzzyEqual(scene.v0->boundingBox(), BoundingBox(-20, 20, -20, 20)));
+
+        // Same when the changes are deferred to the end of a transaction
+        {
+            GeometryChangeTransaction transaction(&scene.vac);
+            scene.e2->setWidth(60);
+        }
+        QVERIFY(fuzzyEqual(scene.sv->boundingBox(), BoundingBox(-30, 30, -30, 80)));
+        QVERIFY(fuzzyEqual(scene.v2->boundingBox(), BoundingBox(-30, 30, 20, 80)));
+    }
+
+    void invalidatedByKeyVertexPosition()
+    {
+        Scene scene;
+        QVERIFY(fuzzyEqual(scene.sw->outlineBoundingBox(), BoundingBox(100, 100, 0, 50)));
+        scene.w2->setPos(Eigen::Vector2d(200, 50));
+        QVERIFY(fuzzyEqual(scene.sw->outlineBoundingBox(), BoundingBox(100, 200, 0, 50)));
+        QVERIFY(contains(scene.se->boundingBox(), scene.se->exactBoundingBox()));
+    }
+
+    // Boxes of inbetween vertices without incident edges are not grown, and
+    // grow when an edge is added to their star
+    void invalidatedBySpatialStar()
+    {
+        VAC vac;
+        KeyVertex * v0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        KeyVertex * w0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(100, 0));
+        KeyVertex * v2 = vac.newKeyVertex(Time(2), Eigen::Vector2d(0, 50));
+        KeyVertex * w2 = vac.newKeyVertex(Time(2), Eigen::Vector2d(100, 50));
+        KeyEdge * e0 = vac.newKeyEdge(Time(0), v0, w0, 0, 10);
+        KeyEdge * e2 = vac.newKeyEdge(Time(2), v2, w2, 0, 10);
+        InbetweenVertex * sv = vac.newInbetweenVertex(v0, v2);
+        InbetweenVertex * sw = vac.newInbetweenVertex(w0, w2);
+        QVERIFY(fuzzyEqual(sv->boundingBox(), BoundingBox(0, 0, 0, 50)));
+
+        vac.newInbetweenEdge(
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(e0, true)),
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(e2, true)),
+                    AnimatedVertex(InbetweenVertexList() << sv),
+                    AnimatedVertex(InbetweenVertexList() << sw));
+        QVERIFY(fuzzyEqual(sv->boundingBox(), BoundingBox(-5, 5, -5, 55)));
+    }
+};
+
+VPAINT_TEST_MAIN(TestInbetweenBoundingBox)
+#include "tst_InbetweenBoundingBox.moc"
@@ -0,0 +1,266 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "MemoryUsage.h"
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+#include "VectorAnimationComplex/InbetweenEdge.h"
+#include "VectorAnimationComplex/Halfedge.h"
+#include "VectorAnimationComplex/Path.h"
+#include "VectorAnimationComplex/AnimatedVertex.h"
+
+#include <algorithm>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+bool lessThan(const Halfedge & h1, const Halfedge & h2)
+{
+    return h1.edge < h2.edge || (h1.edge == h2.edge && h1.side < h2.side);
+}
+
+std::vector<Halfedge> sorted(std::vector<Halfedge> halfedges)
+{
+    std::sort(halfedges.begin(), halfedges.end(), lessThan);
+    return halfedges;
+}
+
+// Incident halfedges computed from the spatial star, without cache
+std::vector<Halfedge> expected(VertexCell * v, Time t)
+{
+    std::vector<Halfedge> res;
+    foreach(Cell * c, v->spatialStar(t))
+    {
+        KeyEdge * keyEdge = c->toKeyEdge();
+        InbetweenEdge * inbetweenEdge = c->toInbetweenEdge();
+        if(keyEdge)
+        {
+            if(keyEdge->startVertex()->toVertexCell() == v)
+                res.push_back(Halfedge(keyEdge, true));
+            if(keyEdge->endVertex()->toVertexCell() == v)
+                res.push_back(Halfedge(keyEdge, false));
+        }
+        else if(inbetweenEdge)
+        {
+            if(inbetweenEdge->startVertex(t) == v)
+                res.push_back(Halfedge(inbetweenEdge, true));
+            if(inbetweenEdge->endVertex(t) == v)
+                res.push_back(Halfedge(inbetweenEdge, false));
+        }
+    }
+    return sorted(res);
+}
+
+bool isEqual(const std::vector<Halfedge> & halfedges1, const std::vector<Halfedge> & halfedges2)
+{
+    if(halfedges1.size() != halfedges2.size())
+        return false;
+    for(size_t i=0; i<halfedges1.size(); ++i)
+        if(halfedges1[i].edge != halfedges2[i].edge || halfedges1[i].side != halfedges2[i].side)
+            return false;
+    return true;
+}
+
+bool isUpToDateAt(VertexCell * v, Time t)
+{
+    return isEqual(sorted(v->incidentEdges(t)), expected(v, t));
+}
+
+// Number of frames whose incident halfedges are cached by v
+qint64 numCachedFrames(VertexCell * v)
+{
+    MemoryUsage usage;
+    v->addMemoryUsage(usage);
+    return usage.entry("Cell caches", v->typeName() + " incident halfedges").numItems;
+}
+
+// Key edges e from a to b at time -4, and f from c to d at time 4, and the
+// inbetween edge se between them. The start of se goes through the key
+// vertex ka at time 0, and its end through kb.
+struct Scene
+{
+    VAC vac;
+    KeyVertex * a;
+    KeyVertex * b;
+    KeyVertex * c;
+    KeyVertex * d;
+    KeyVertex * ka;
+    KeyVertex * kb;
+    KeyEdge * e;
+    KeyEdge * f;
+    InbetweenVertex * sa[2];
+    InbetweenVertex * sb[2];
+    InbetweenEdge * se;
+
+    Scene()
+    {
+        a = vac.newKeyVertex(Time(-4), Eigen::Vector2d(0, 0));
+        b = vac.newKeyVertex(Time(-4), Eigen::Vector2d(100, 0));
+        c = vac.newKeyVertex(Time(4), Eigen::Vector2d(0, 50));
+        d = vac.newKeyVertex(Time(4), Eigen::Vector2d(100, 50));
+        ka = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 25));
+        kb = vac.newKeyVertex(Time(0), Eigen::Vector2d(100, 25));
+        e = vac.newKeyEdge(Time(-4), a, b, 0, 10);
+        f = vac.newKeyEdge(Time(4), c, d, 0, 10);
+        sa[0] = vac.newInbetweenVertex(a, ka);
+        sa[1] = vac.newInbetweenVertex(ka, c);
+        sb[0] = vac.newInbetweenVertex(b, kb);
+        sb[1] = vac.newInbetweenVertex(kb, d);
+        se = vac.newInbetweenEdge(
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(e, true)),
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(f, true)),
+                    AnimatedVertex(InbetweenVertexList() << sa[0] << sa[1]),
+                    AnimatedVertex(InbetweenVertexList() << sb[0] << sb[1]));
+    }
+
+    QList<VertexCell *> vertices()
+    {
+        QList<VertexCell *> res;
+        foreach(Cell * cell, vac.cells())
+            if(cell->toVertexCell())
+                res << cell->toVertexCell();
+        return res;
+    }
+
+    static QList<Time> times()
+    {
+        QList<Time> res;
+        for(int f=-4; f<=4; ++f)
+            res << Time(f) << Time(f + 0.5);
+        return res;
+    }
+
+    // Caches the incident halfedges of all vertices at all times
+    void fillCaches()
+    {
+        foreach(VertexCell * v, vertices())
+            foreach(Time t, times())
+                v->incidentEdges(t);
+    }
+
+    bool isUpToDate()
+    {
+        foreach(VertexCell * v, vertices())
+            foreach(Time t, times())
+                if(!isUpToDateAt(v, t))
+                    return false;
+        return true;
+    }
+};
+
+} // end namespace
+
+class TestIncidentEdges: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // The same vector is returned until the cache is cleared
+    void cached()
+    {
+        Scene scene;
+        QCOMPARE(numCachedFrames(scene.a), (qint64) 0);
+        const std::vector<Halfedge> & halfedges = scene.a->incidentEdges(Time(-4));
+        QCOMPARE(numCachedFrames(scene.a), (qint64) 1);
+        QVERIFY(&scene.a->incidentEdges(Time(-4)) == &halfedges);
+        QCOMPARE(halfedges.size(), (size_t) 1);
+        QVERIFY(halfedges[0].edge == scene.e && halfedges[0].side);
+
+        scene.fillCaches();
+        QVERIFY(numCachedFrames(scene.sa[0]) > 0);
+        QVERIFY(scene.isUpToDate());
+
+        // At time 1, the start of se is sa[1]
+        QCOMPARE(scene.sa[0]->incidentEdges(Time(1)).size(), (size_t) 0);
+        QCOMPARE(scene.sa[1]->incidentEdges(Time(1)).size(), (size_t) 1);
+        QCOMPARE(scene.ka->incidentEdges(Time(0)).size(), (size_t) 1);
+    }
+
+    void edgeCreationAndDeletion()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        scene.fillCaches();
+
+        KeyVertex * v = vac.newKeyVertex(Time(-4), Eigen::Vector2d(50, 50));
+        KeyEdge * e1 = vac.newKeyEdge(Time(-4), scene.a, v);
+        QCOMPARE(numCachedFrames(scene.a), (qint64) 0);
+        QVERIFY(scene.isUpToDate());
+        QCOMPARE(scene.a->incidentEdges(Time(-4)).size(), (size_t) 2);
+
+        // Both halfedges of a loop start at a
+        scene.fillCaches();
+        vac.newKeyEdge(Time(-4), scene.a, scene.a);
+        QVERIFY(scene.isUpToDate());
+        QCOMPARE(scene.a->incidentEdges(Time(-4)).size(), (size_t) 4);
+
+        scene.fillCaches();
+        vac.deleteCell(e1);
+        QCOMPARE(numCachedFrames(v), (qint64) 0);
+        QVERIFY(scene.isUpToDate());
+        QCOMPARE(v->incidentEdges(Time(-4)).size(), (size_t) 0);
+        QCOMPARE(scene.a->incidentEdges(Time(-4)).size(), (size_t) 3);
+
+        // Deleting e deletes se, which starts at sa[0] and sa[1]
+        scene.fillCaches();
+        vac.deleteCell(scene.e);
+        QVERIFY(scene.isUpToDate());
+        QCOMPARE(scene.sa[0]->incidentEdges(Time(-2)).size(), (size_t) 0);
+        QCOMPARE(scene.ka->incidentEdges(Time(0)).size(), (size_t) 0);
+    }
+
+    // Updating the boundary of se goes through the star of its boundary,
+    // and keyframing it replaces it in the star of its vertices
+    void inbetweenBoundaryUpdate()
+    {
+        Scene scene;
+        VAC & vac = scene.vac;
+        scene.fillCaches();
+
+        KeyEdge * reversed = vac.newKeyEdge(Time(-4), scene.b, scene.a, 0, 10);
+        scene.fillCaches();
+        scene.se->updateBoundary(KeyHalfedge(scene.e, true), KeyHalfedge(reversed, false));
+        QCOMPARE(numCachedFrames(scene.sa[0]), (qint64) 0);
+        QCOMPARE(numCachedFrames(scene.sb[1]), (qint64) 0);
+        QVERIFY(scene.isUpToDate());
+
+        scene.fillCaches();
+        vac.addToSelection(scene.se, false);
+        vac.keyframeSelection(); // at the active time, which is 0
+        QVERIFY(scene.isUpToDate());
+        const std::vector<Halfedge> & halfedges = scene.sa[0]->incidentEdges(Time(-2));
+        QCOMPARE(halfedges.size(), (size_t) 1);
+        QVERIFY(halfedges[0].edge != scene.se);
+        QCOMPARE(scene.ka->incidentEdges(Time(0)).size(), (size_t) 1);
+        QVERIFY(scene.ka->incidentEdges(Time(0))[0].edge->toKeyEdge());
+    }
+
+    // Moving ka to time 2 makes sa[0] the start of se at time 1
+    void keyTimeChange()
+    {
+        Scene scene;
+        scene.fillCaches();
+
+        scene.ka->setTime(Time(2));
+        QCOMPARE(scene.ka->time(), Time(2));
+        QCOMPARE(numCachedFrames(scene.sa[0]), (qint64) 0);
+        QCOMPARE(numCachedFrames(scene.sa[1]), (qint64) 0);
+        QVERIFY(scene.isUpToDate());
+        QCOMPARE(scene.sa[0]->incidentEdges(Time(1)).size(), (size_t) 1);
+        QCOMPARE(scene.sa[1]->incidentEdges(Time(1)).size(), (size_t) 0);
+    }
+};
+
+VPAINT_TEST_MAIN(TestIncidentEdges)
+#include "tst_IncidentEdges.moc"
@@ -0,0 +1,252 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyframeCorrespondence.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+#include "VectorAnimationComplex/InbetweenEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+
+#include <QElapsedTimer>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+const double pi = 3.14159265358979;
+
+// Synthetic pair of keyframes: the second one is the first one moved by
+// (3,2) plus noise, with its cells created in a different order and half of
+// its edges reversed. Cells are laid out on a jittered grid of 40x40
+// squares, so that each cell is much closer to its counterpart than to any
+// other cell, and the expected correspondence is known.
+struct KeyframePair
+{
+    KeyCellSet cells1;
+    KeyCellSet cells2;
+    QMap<KeyEdge*, KeyEdge*> expectedEdge;
+    QMap<KeyEdge*, bool> expectedSameOrientation;
+    QMap<KeyVertex*, KeyVertex*> expectedVertex;
+
+    KeyframePair(VAC & vac, int numOpenEdges, int numClosedEdges, int numVertices,
+                 unsigned int seed, double fractionMissing = 0)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> jitter(-5, 5);
+        std::uniform_real_distribution<double> noise(-0.5, 0.5);
+        std::uniform_real_distribution<double> angle(0, 2 * pi);
+        std::uniform_real_distribution<double> length(10, 20);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        int numSquares = numOpenEdges + numClosedEdges + numVertices;
+        int n = (int) std::ceil(std::sqrt((double) numSquares));
+        std::vector<int> order(numSquares);
+        for(int k=0; k<numSquares; ++k)
+            order[k] = k;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        // First keyframe, in square order
+        const Eigen::Vector2d d(3, 2);
+        std::vector<Eigen::Vector2d> centers(numSquares);
+        std::vector<double> angles(numSquares);
+        std::vector<double> lengths(numSquares);
+        std::vector<KeyCell*> keyCells1(numSquares);
+        for(int k=0; k<numSquares; ++k)
+        {
+            centers[k] = Eigen::Vector2d(40 * (k % n) + 20 + jitter(rng),
+                                         40 * (k / n) + 20 + jitter(rng));
+            angles[k] = angle(rng);
+            lengths[k] = length(rng);
+            keyCells1[k] = createCell_(vac, Time(0), k, numOpenEdges, numClosedEdges,
+                                       centers[k], angles[k], lengths[k], false);
+            cells1 << keyCells1[k];
+        }
+
+        // Second keyframe, in shuffled order
+        foreach(int k, order)
+        {
+            if(unit(rng) < fractionMissing)
+                continue;
+            Eigen::Vector2d center = centers[k] + d + Eigen::Vector2d(noise(rng), noise(rng));
+            bool reversed = (unit(rng) < 0.5);
+            KeyCell * c2 = createCell_(vac, Time(1), k, numOpenEdges, numClosedEdges,
+                                       center, angles[k] + 0.05 * noise(rng),
+                                       lengths[k] + noise(rng), reversed);
+            cells2 << c2;
+            if(c2->toKeyEdge())
+            {
+                expectedEdge[keyCells1[k]->toKeyEdge()] = c2->toKeyEdge();
+                expectedSameOrientation[keyCells1[k]->toKeyEdge()] = !reversed;
+            }
+            else
+            {
+                expectedVertex[keyCells1[k]->toKeyVertex()] = c2->toKeyVertex();
+            }
+        }
+    }
+
+    // Returns the edge or isolated vertex for square k. Open edges are
+    // inserted with their end vertices.
+    KeyCell * createCell_(VAC & vac, Time time, int k, int numOpenEdges, int numClosedEdges,
+                          const Eigen::Vector2d & center, double theta, double l, bool reversed)
+    {
+        if(k < numOpenEdges)
+        {
+            Eigen::Vector2d u(std::cos(theta), std::sin(theta));
+            Eigen::Vector2d p = center - 0.5 * l * u;
+            Eigen::Vector2d q = center + 0.5 * l * u;
+            if(reversed)
+                std::swap(p, q);
+            KeyVertex * v1 = vac.newKeyVertex(time, p);
+            KeyVertex * v2 = vac.newKeyVertex(time, q);
+            KeyEdge * e = vac.newKeyEdge(time, v1, v2, 0, 2);
+            if(time == Time(0))
+                cells1 << v1 << v2;
+            else
+                cells2 << v1 << v2;
+            return e;
+        }
+        else if(k < numOpenEdges + numClosedEdges)
+        {
+            // Circles of radius l/2, counterclockwise unless reversed
+            const int numPoints = 24;
+            QList<Eigen::Vector2d> points;
+            for(int i=0; i<numPoints; ++i)
+            {
+                double t = theta + 2 * pi * i / numPoints;
+                points << center + 0.5 * l * Eigen::Vector2d(std::cos(t), std::sin(t));
+            }
+            if(reversed)
+                std::reverse(points.begin(), points.end());
+            return vac.newKeyEdge(time, new LinearSpline(points));
+        }
+        else
+        {
+            return vac.newKeyVertex(time, center);
+        }
+    }
+};
+
+int numInbetweenEdges(VAC & vac)
+{
+    int res = 0;
+    foreach(Cell * c, vac.cells())
+        if(c->toInbetweenEdge())
+            ++res;
+    return res;
+}
+
+}
+
+class TestKeyframeCorrespondence: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Each cell is matched with its counterpart, with the right orientation
+    void matchesSyntheticPair()
+    {
+        VAC vac;
+        KeyframePair keyframes(vac, 300, 50, 50, 1);
+        KeyframeCorrespondence correspondence(keyframes.cells1, keyframes.cells2);
+
+        QCOMPARE(correspondence.edgePairs().size(), 350);
+        foreach(const KeyframeCorrespondence::EdgePair & pair, correspondence.edgePairs())
+        {
+            QVERIFY(pair.e2 == keyframes.expectedEdge.value(pair.e1));
+            QCOMPARE(pair.sameOrientation, keyframes.expectedSameOrientation.value(pair.e1));
+        }
+
+        // End vertices of matched edges are not matched again
+        QCOMPARE(correspondence.vertexPairs().size(), 50);
+        foreach(const KeyframeCorrespondence::VertexPair & pair, correspondence.vertexPairs())
+            QVERIFY(pair.v2 == keyframes.expectedVertex.value(pair.v1));
+    }
+
+    // Cells without counterpart don't prevent the others from being matched
+    void missingCells()
+    {
+        VAC vac;
+        KeyframePair keyframes(vac, 300, 50, 50, 2, 0.2);
+        KeyframeCorrespondence correspondence(keyframes.cells1, keyframes.cells2);
+
+        int numMatchedEdges = 0;
+        foreach(const KeyframeCorrespondence::EdgePair & pair, correspondence.edgePairs())
+        {
+            if(keyframes.expectedEdge.contains(pair.e1))
+            {
+                QVERIFY(pair.e2 == keyframes.expectedEdge.value(pair.e1));
+                QCOMPARE(pair.sameOrientation, keyframes.expectedSameOrientation.value(pair.e1));
+                ++numMatchedEdges;
+            }
+        }
+        QCOMPARE(numMatchedEdges, keyframes.expectedEdge.size());
+    }
+
+    // The result doesn't depend on the order of creation of the cells
+    void deterministic()
+    {
+        VAC vac;
+        KeyframePair keyframes(vac, 100, 10, 10, 3);
+        KeyframeCorrespondence c1(keyframes.cells1, keyframes.cells2);
+        KeyframeCorrespondence c2(keyframes.cells1, keyframes.cells2);
+        QCOMPARE(c1.edgePairs().size(), c2.edgePairs().size());
+        for(int i=0; i<c1.edgePairs().size(); ++i)
+            QVERIFY(c1.edgePairs()[i].e2 == c2.edgePairs()[i].e2);
+    }
+
+    // End to end: "Inbetween keyframes" on two keyframes of 10k edges,
+    // including the correspondence and the creation of the inbetween cells
+    // (inserted in the z-ordering one by one)
+    void benchmark10kEdges()
+    {
+        VAC vac;
+        KeyframePair keyframes(vac, 10000, 0, 0, 4);
+        CellSet selection;
+        foreach(KeyCell * c, keyframes.cells1)
+            selection << c;
+        foreach(KeyCell * c, keyframes.cells2)
+            selection << c;
+        vac.addToSelection(selection, false);
+
+        QElapsedTimer timer;
+        timer.start();
+        QBENCHMARK_ONCE
+        {
+            vac.inbetweenKeyframes();
+        }
+        qDebug("Inbetween keyframes, 10k edges: %lld ms", timer.elapsed());
+
+        // All edges are inbetweened with their counterpart, sharing the
+        // inbetween vertices of their end vertices
+        QCOMPARE(numInbetweenEdges(vac), 10000);
+        foreach(Cell * c, vac.cells())
+        {
+            InbetweenEdge * se = c->toInbetweenEdge();
+            if(se)
+            {
+                KeyEdgeList before = se->beforeCells();
+                KeyEdgeList after = se->afterCells();
+                QCOMPARE(before.size(), 1);
+                QCOMPARE(after.size(), 1);
+                QVERIFY(keyframes.expectedEdge.value(before[0]) == after[0]);
+            }
+        }
+    }
+};
+
+VPAINT_TEST_MAIN(TestKeyframeCorrespondence)
+#include "tst_KeyframeCorrespondence.moc"
@@ -0,0 +1,123 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "MemoryUsage.h"
+
+#include <QtTest>
+
+class TestMemoryUsage: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Vectors are counted by capacity, not size
+    void vectorBytes()
+    {
+        std::vector<double> v;
+        QCOMPARE(MemoryUsage::bytes(v), (qint64) 0);
+
+        v.reserve(100);
+        v.resize(10);
+        QCOMPARE(MemoryUsage::bytes(v), (qint64) (100 * sizeof(double)));
+
+        struct Vertex { double x, y, w; };
+        std::vector<Vertex> vertices(7);
+        vertices.shrink_to_fit();
+        QCOMPARE(MemoryUsage::bytes(vertices), (qint64) (7 * 24));
+    }
+
+    void listBytes()
+    {
+        QList<int> list;
+        QCOMPARE(MemoryUsage::bytes(list), (qint64) 0);
+        for(int i=0; i<25; ++i)
+            list << i;
+        QCOMPARE(MemoryUsage::bytes(list), (qint64) (25 * (sizeof(void*) + sizeof(int))));
+    }
+
+    void mapNodeBytes()
+    {
+        QMap<int, double> map;
+        for(int i=0; i<12; ++i)
+            map[i] = i;
+        QCOMPARE(MemoryUsage::mapNodeBytes(map),
+                 (qint64) (12 * (3 * sizeof(void*) + sizeof(int) + sizeof(double))));
+    }
+
+    // Usage added several times to the same category is summed
+    void addAndTotals()
+    {
+        std::vector<float> a(1000);
+        std::vector<float> b(500);
+        a.shrink_to_fit();
+        b.shrink_to_fit();
+
+        MemoryUsage usage;
+        usage.add("Cell caches", "KeyEdge triangles", MemoryUsage::bytes(a));
+        usage.add("Cell caches", "KeyEdge triangles", MemoryUsage::bytes(b));
+        usage.add("Cell caches", "KeyFace triangles", 100, 4);
+        usage.add("Tessellation cache", "Entries", 64, 2);
+
+        MemoryUsage::Entry e = usage.entry("Cell caches", "KeyEdge triangles");
+        QCOMPARE(e.numBytes, (qint64) (1500 * sizeof(float)));
+        QCOMPARE(e.numItems, (qint64) 2);
+        QCOMPARE(usage.entry("Cell caches", "KeyFace triangles").numItems, (qint64) 4);
+
+        QCOMPARE(usage.totalBytes("Cell caches"), (qint64) (1500 * sizeof(float) + 100));
+        QCOMPARE(usage.totalBytes("Tessellation cache"), (qint64) 64);
+        QCOMPARE(usage.totalBytes(), (qint64) (1500 * sizeof(float) + 164));
+        QCOMPARE(usage.totalBytes("Unknown"), (qint64) 0);
+        QCOMPARE(usage.entry("Unknown", "Unknown").numBytes, (qint64) 0);
+
+        QCOMPARE(usage.subsystems(), QList<QString>() << "Cell caches" << "Tessellation cache");
+        QCOMPARE(usage.categories("Cell caches"), QList<QString>() << "KeyEdge triangles" << "KeyFace triangles");
+    }
+
+    // Categories of different subsystems are merged by name
+    void addAsSubsystem()
+    {
+        MemoryUsage documentA;
+        documentA.add("Cell caches", "KeyEdge triangles", 1000, 10);
+        documentA.add("Cell caches", "KeyFace triangles", 200, 1);
+        MemoryUsage documentB;
+        documentB.add("Other caches", "KeyEdge triangles", 24, 1);
+
+        MemoryUsage usage;
+        usage.addAsSubsystem("Undo stack", documentA);
+        usage.addAsSubsystem("Undo stack", documentB);
+
+        QCOMPARE(usage.subsystems(), QList<QString>() << "Undo stack");
+        QCOMPARE(usage.entry("Undo stack", "KeyEdge triangles").numBytes, (qint64) 1024);
+        QCOMPARE(usage.entry("Undo stack", "KeyEdge triangles").numItems, (qint64) 11);
+        QCOMPARE(usage.totalBytes(), (qint64) 1224);
+    }
+
+    void toString()
+    {
+        QCOMPARE(MemoryUsage::toString(0), QString("0 B"));
+        QCOMPARE(MemoryUsage::toString(1023), QString("1023 B"));
+        QCOMPARE(MemoryUsage::toString(1536), QString("1.5 KB"));
+        QCOMPARE(MemoryUsage::toString(3 * 1024 * 1024), QString("3.0 MB"));
+        QCOMPARE(MemoryUsage::toString(Q_INT64_C(5) * 1024 * 1024 * 1024), QString("5.00 GB"));
+    }
+
+    void report()
+    {
+        MemoryUsage usage;
+        usage.add("Cell caches", "KeyEdge triangles", 2048, 3);
+        QString report = usage.report();
+        QVERIFY(report.contains("Cell caches"));
+        QVERIFY(report.contains("KeyEdge triangles"));
+        QVERIFY(report.contains("2.0 KB"));
+        QVERIFY(report.contains("3 items"));
+        QVERIFY(report.contains("Total"));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestMemoryUsage)
+#include "tst_MemoryUsage.moc"
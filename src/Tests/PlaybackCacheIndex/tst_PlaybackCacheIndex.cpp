@@ -0,0 +1,254 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "PlaybackCacheIndex.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <random>
+
+namespace
+{
+
+const qint64 bytesPerFrame = 100;
+
+// Same as PlaybackCache::capture(), with a new texture name instead of a
+// new OpenGL texture
+void capture(PlaybackCacheIndex & index, int frame, quint64 revision, unsigned int & lastTextureId)
+{
+    unsigned int textureId = index.takeTextureFor(frame);
+    if(!textureId)
+        textureId = ++lastTextureId;
+    index.insert(frame, textureId, revision);
+}
+
+// Straightforward index, the frames being kept from the most to the least
+// recently used in a list
+struct Model
+{
+    QList<int> frames;
+    QMap<int, unsigned int> textureIds;
+    QMap<int, quint64> revisions;
+    int maxNumFrames;
+
+    Model() : maxNumFrames(0) {}
+
+    void capture(int frame, quint64 revision, unsigned int & lastTextureId)
+    {
+        unsigned int textureId = 0;
+        if(frames.contains(frame))
+        {
+            textureId = textureIds[frame];
+            frames.removeOne(frame);
+        }
+        else if(frames.size() >= maxNumFrames)
+        {
+            textureId = textureIds[frames.last()];
+            frames.removeLast();
+        }
+        if(!textureId)
+            textureId = ++lastTextureId;
+        frames.prepend(frame);
+        textureIds[frame] = textureId;
+        revisions[frame] = revision;
+    }
+
+    bool contains(int frame, quint64 frameRevision) const
+    {
+        return frames.contains(frame) && revisions[frame] >= frameRevision;
+    }
+
+    unsigned int texture(int frame, quint64 frameRevision)
+    {
+        if(!frames.contains(frame) || revisions[frame] < frameRevision)
+            return 0;
+        frames.removeOne(frame);
+        frames.prepend(frame);
+        return textureIds[frame];
+    }
+
+    QList<unsigned int> setMaxNumFrames(int n)
+    {
+        QList<unsigned int> removedTextures;
+        maxNumFrames = n;
+        while(frames.size() > maxNumFrames)
+        {
+            removedTextures << textureIds[frames.last()];
+            frames.removeLast();
+        }
+        return removedTextures;
+    }
+};
+
+} // end namespace
+
+class TestPlaybackCacheIndex: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty()
+    {
+        PlaybackCacheIndex index;
+        QCOMPARE(index.maxNumFrames(), 0);
+        QCOMPARE(index.numFrames(), 0);
+        QCOMPARE(index.texture(0, 0), 0u);
+        QVERIFY(!index.contains(0, 0));
+        QCOMPARE(index.takeTextureFor(0), 0u);
+
+        // Not even one image fits in the budget
+        QList<unsigned int> removedTextures;
+        index.setBudget(bytesPerFrame - 1, bytesPerFrame, removedTextures);
+        QCOMPARE(index.maxNumFrames(), 0);
+        index.setBudget(10 * bytesPerFrame, 0, removedTextures);
+        QCOMPARE(index.maxNumFrames(), 0);
+        QVERIFY(removedTextures.isEmpty());
+    }
+
+    // Images are returned if they are at least as recent as their frame
+    void revisions()
+    {
+        PlaybackCacheIndex index;
+        QList<unsigned int> removedTextures;
+        index.setBudget(10 * bytesPerFrame, bytesPerFrame, removedTextures);
+        index.insert(3, 42, 10);
+        QVERIFY(index.contains(3, 9));
+        QVERIFY(index.contains(3, 10));
+        QVERIFY(!index.contains(3, 11));
+        QVERIFY(!index.contains(4, 0));
+        QCOMPARE(index.texture(3, 10), 42u);
+        QCOMPARE(index.texture(3, 11), 0u);
+
+        // A new image of the frame reuses the texture of the outdated one
+        QCOMPARE(index.takeTextureFor(3), 42u);
+        QCOMPARE(index.numFrames(), 0);
+        index.insert(3, 42, 12);
+        QCOMPARE(index.texture(3, 11), 42u);
+    }
+
+    // When the index is full, the least recently used image is recycled
+    void leastRecentlyUsed()
+    {
+        PlaybackCacheIndex index;
+        QList<unsigned int> removedTextures;
+        index.setBudget(3 * bytesPerFrame, bytesPerFrame, removedTextures);
+        QCOMPARE(index.maxNumFrames(), 3);
+        unsigned int lastTextureId = 0;
+        capture(index, 0, 1, lastTextureId);
+        capture(index, 1, 1, lastTextureId);
+        capture(index, 2, 1, lastTextureId);
+        QCOMPARE(index.frames(), QList<int>() << 2 << 1 << 0);
+
+        // Looking up an up-to-date image marks it as recently used, but
+        // neither looking up an outdated one nor contains()
+        QCOMPARE(index.texture(0, 1), 1u);
+        QCOMPARE(index.texture(1, 2), 0u);
+        QVERIFY(index.contains(1, 1));
+        QCOMPARE(index.frames(), QList<int>() << 0 << 2 << 1);
+
+        capture(index, 3, 1, lastTextureId);
+        QCOMPARE(index.frames(), QList<int>() << 3 << 0 << 2);
+        QCOMPARE(index.texture(3, 1), 2u);
+        QVERIFY(!index.contains(1, 0));
+        QCOMPARE(lastTextureId, 3u);
+    }
+
+    // Reducing the budget removes the least recently used images
+    void budget()
+    {
+        PlaybackCacheIndex index;
+        QList<unsigned int> removedTextures;
+        index.setBudget(5 * bytesPerFrame, bytesPerFrame, removedTextures);
+        unsigned int lastTextureId = 0;
+        for(int frame=0; frame<5; ++frame)
+            capture(index, frame, 1, lastTextureId);
+        index.texture(0, 1);
+
+        index.setBudget(5 * bytesPerFrame, 2 * bytesPerFrame, removedTextures);
+        QCOMPARE(index.maxNumFrames(), 2);
+        QCOMPARE(removedTextures, QList<unsigned int>() << 2 << 3 << 4);
+        QCOMPARE(index.frames(), QList<int>() << 0 << 4);
+
+        removedTextures.clear();
+        index.setBudget(10 * bytesPerFrame, bytesPerFrame, removedTextures);
+        QVERIFY(removedTextures.isEmpty());
+        QCOMPARE(index.numFrames(), 2);
+
+        index.setBudget(0, bytesPerFrame, removedTextures);
+        QCOMPARE(removedTextures, QList<unsigned int>() << 5 << 1);
+        QCOMPARE(index.numFrames(), 0);
+    }
+
+    void clear()
+    {
+        PlaybackCacheIndex index;
+        QList<unsigned int> removedTextures;
+        index.setBudget(5 * bytesPerFrame, bytesPerFrame, removedTextures);
+        unsigned int lastTextureId = 0;
+        for(int frame=0; frame<3; ++frame)
+            capture(index, frame, 1, lastTextureId);
+
+        index.clear(removedTextures);
+        std::sort(removedTextures.begin(), removedTextures.end());
+        QCOMPARE(removedTextures, QList<unsigned int>() << 1 << 2 << 3);
+        QCOMPARE(index.numFrames(), 0);
+        QVERIFY(index.frames().isEmpty());
+        QCOMPARE(index.maxNumFrames(), 5);
+    }
+
+    // Random captures, lookups and budget changes, compared with a model
+    void random()
+    {
+        std::mt19937 rng(0);
+        std::uniform_int_distribution<int> operation(0, 9);
+        std::uniform_int_distribution<int> frameDistribution(0, 20);
+        std::uniform_int_distribution<int> maxNumFramesDistribution(0, 12);
+        std::uniform_int_distribution<int> revisionDistribution(0, 5);
+
+        PlaybackCacheIndex index;
+        Model model;
+        unsigned int lastTextureId = 0;
+        unsigned int lastModelTextureId = 0;
+        quint64 revision = 0;
+        for(int k=0; k<10000; ++k)
+        {
+            int op = operation(rng);
+            int frame = frameDistribution(rng);
+            if(op == 0)
+            {
+                int maxNumFrames = maxNumFramesDistribution(rng);
+                QList<unsigned int> removedTextures;
+                index.setBudget(maxNumFrames * bytesPerFrame + bytesPerFrame / 2, bytesPerFrame, removedTextures);
+                QCOMPARE(removedTextures, model.setMaxNumFrames(maxNumFrames));
+                QCOMPARE(index.maxNumFrames(), maxNumFrames);
+            }
+            else if(op < 5)
+            {
+                // PlaybackCache doesn't capture anything without budget
+                revision += revisionDistribution(rng);
+                if(index.maxNumFrames() > 0)
+                {
+                    capture(index, frame, revision, lastTextureId);
+                    model.capture(frame, revision, lastModelTextureId);
+                }
+            }
+            else
+            {
+                quint64 frameRevision = revision - std::min<quint64>(revision, revisionDistribution(rng));
+                QCOMPARE(index.contains(frame, frameRevision), model.contains(frame, frameRevision));
+                QCOMPARE(index.texture(frame, frameRevision), model.texture(frame, frameRevision));
+            }
+            QCOMPARE(index.frames(), model.frames);
+            QVERIFY(index.numFrames() <= index.maxNumFrames());
+        }
+        QCOMPARE(lastTextureId, lastModelTextureId);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestPlaybackCacheIndex)
+#include "tst_PlaybackCacheIndex.moc"
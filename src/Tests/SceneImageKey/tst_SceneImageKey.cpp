@@ -0,0 +1,132 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "SceneImageKey.h"
+
+#include <QtTest>
+
+namespace
+{
+
+// Only compared by address
+char vacs[2];
+VectorAnimationComplex::VAC * vac(int i)
+{
+    return reinterpret_cast<VectorAnimationComplex::VAC *>(&vacs[i]);
+}
+
+// Key of a 800x600 drawing at frame 3, with the canvas shown
+SceneImageKey drawingKey()
+{
+    SceneImageKey key;
+    key.width = 800;
+    key.height = 600;
+    key.camera.setX(10);
+    key.camera.setY(20);
+    key.camera.setZoom(1.5);
+    key.time = Time(3);
+    key.vac = vac(0);
+    key.toolMode = 1;
+    key.canvas = QRectF(0, 0, 1280, 720);
+    return key;
+}
+
+// Keys of drawings which can't reuse an image drawn with drawingKey(),
+// whatever their camera
+QList<SceneImageKey> otherDrawingKeys()
+{
+    QList<SceneImageKey> res;
+    SceneImageKey key = drawingKey();
+    key.width = 801;
+    res << key;
+    key = drawingKey();
+    key.height = 599;
+    res << key;
+    key = drawingKey();
+    key.time = Time(4);
+    res << key;
+    key = drawingKey();
+    key.time = Time(3, true);
+    res << key;
+    key = drawingKey();
+    key.time = Time(3.5);
+    res << key;
+    key = drawingKey();
+    key.vac = vac(1);
+    res << key;
+    key = drawingKey();
+    key.toolMode = 2;
+    res << key;
+    key = drawingKey();
+    key.canvas = QRectF();
+    res << key;
+    key = drawingKey();
+    key.canvas = QRectF(0, 0, 1280, 721);
+    res << key;
+    return res;
+}
+
+} // end namespace
+
+class TestSceneImageKey: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sameDrawing()
+    {
+        SceneImageKey key = drawingKey();
+        QVERIFY(key == drawingKey());
+        QVERIFY(!(key != drawingKey()));
+        QVERIFY(key.isReprojectableTo(drawingKey()));
+        QVERIFY(SceneImageKey() == SceneImageKey());
+        QVERIFY(SceneImageKey() != key);
+    }
+
+    // The image is reprojected while the camera moves, but it is only drawn
+    // back as is if the camera didn't move
+    void cameraChange()
+    {
+        SceneImageKey image = drawingKey();
+        for(int i=0; i<3; ++i)
+        {
+            SceneImageKey key = drawingKey();
+            if(i == 0)
+                key.camera.setX(11);
+            else if(i == 1)
+                key.camera.setY(19);
+            else
+                key.camera.setZoom(2.0);
+            QVERIFY(image != key);
+            QVERIFY(key != image);
+            QVERIFY(image.isReprojectableTo(key));
+            QVERIFY(key.isReprojectableTo(image));
+        }
+    }
+
+    // Changing the viewport size, the time, the VAC, the tool mode or the
+    // canvas invalidates the image, even for navigation
+    void otherChanges()
+    {
+        SceneImageKey image = drawingKey();
+        foreach(const SceneImageKey & key, otherDrawingKeys())
+        {
+            QVERIFY(image != key);
+            QVERIFY(key != image);
+            QVERIFY(!image.isReprojectableTo(key));
+            QVERIFY(!key.isReprojectableTo(image));
+
+            SceneImageKey movedKey = key;
+            movedKey.camera.setZoom(2.0);
+            QVERIFY(!image.isReprojectableTo(movedKey));
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(TestSceneImageKey)
+#include "tst_SceneImageKey.moc"
@@ -0,0 +1,226 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/EdgeSample.h"
+#include "VectorAnimationComplex/Triangles.h"
+
+#include <cmath>
+#include <random>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+const double eps = 1e-9;
+
+// Restores the number of subdivisions at the end of a test
+class NumSubGuard
+{
+public:
+    NumSubGuard() : numSub_(DevSettings::getInt("num sub")) {}
+    ~NumSubGuard() { DevSettings::setInt("num sub", numSub_); }
+
+private:
+    int numSub_;
+};
+
+bool fuzzyEqual(const Eigen::Vector2d & p, const Eigen::Vector2d & q)
+{
+    return std::abs(p[0] - q[0]) < eps && std::abs(p[1] - q[1]) < eps;
+}
+
+bool fuzzyEqual(Triangles & t1, Triangles & t2)
+{
+    if(t1.size() != t2.size())
+        return false;
+    for(int i=0; i<t1.size(); ++i)
+        if(!fuzzyEqual(t1[i].a, t2[i].a) || !fuzzyEqual(t1[i].b, t2[i].b) || !fuzzyEqual(t1[i].c, t2[i].c))
+            return false;
+    return true;
+}
+
+bool fuzzyEqual(const BoundingBox & bb1, const BoundingBox & bb2)
+{
+    return std::abs(bb1.xMin() - bb2.xMin()) < eps && std::abs(bb1.xMax() - bb2.xMax()) < eps &&
+           std::abs(bb1.yMin() - bb2.yMin()) < eps && std::abs(bb1.yMax() - bb2.yMax()) < eps;
+}
+
+bool fuzzyContains(const BoundingBox & bb1, const BoundingBox & bb2)
+{
+    return bb1.xMin() < bb2.xMin() + eps && bb1.xMax() > bb2.xMax() - eps &&
+           bb1.yMin() < bb2.yMin() + eps && bb1.yMax() > bb2.yMax() - eps;
+}
+
+// Wavy samples, about 5 apart, with varying widths. Closed curves are
+// circles, whose last sample is equal to the first
+QList<EdgeSample> samples(int n, bool closed)
+{
+    QList<EdgeSample> res;
+    for(int i=0; i<n; ++i)
+    {
+        double width = 3 + std::sin(0.3 * i);
+        if(closed)
+        {
+            double theta = 2 * M_PI * i / (n-1);
+            double r = 5 * (n-1) / (2 * M_PI);
+            res << EdgeSample(r * std::cos(theta), r * std::sin(theta), width);
+        }
+        else
+        {
+            res << EdgeSample(5 * i, 10 * std::sin(0.1 * i), width);
+        }
+    }
+    if(closed)
+        res.last() = res.first();
+    return res;
+}
+
+LinearSpline * newSpline(const QList<EdgeSample> & samples, bool closed)
+{
+    if(!closed)
+        return new LinearSpline(samples);
+
+    LinearSpline spline(samples);
+    return new LinearSpline(spline.curve(), true);
+}
+
+} // end namespace
+
+class TestSculptRetriangulation: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Modifying the samples in a random window, then patching the triangles
+    // of the former samples, gives the triangles of the new samples
+    void randomWindows()
+    {
+        NumSubGuard guard;
+        std::mt19937 rng(7);
+        for(int numSub=0; numSub<=3; ++numSub)
+        {
+            DevSettings::setInt("num sub", numSub);
+            for(int k=0; k<50; ++k)
+            {
+                bool closed = (k % 5 == 4);
+                int n = std::uniform_int_distribution<int>(2, 80)(rng);
+                int first = std::uniform_int_distribution<int>(0, n-1)(rng);
+                int last = std::uniform_int_distribution<int>(first, std::min(n-1, first + 10))(rng);
+
+                QList<EdgeSample> before = samples(n, closed);
+                QList<EdgeSample> after = before;
+                std::uniform_real_distribution<double> offset(-3, 3);
+                for(int i=first; i<=last; ++i)
+                    after[i] = EdgeSample(after[i].x() + offset(rng), after[i].y() + offset(rng),
+                                          after[i].width() + 0.5 * offset(rng));
+
+                LinearSpline * beforeSpline = newSpline(before, closed);
+                LinearSpline * afterSpline = newSpline(after, closed);
+                Triangles patched;
+                Triangles expected;
+                beforeSpline->triangulate(patched);
+                afterSpline->triangulate(expected);
+                BoundingBox beforeBoundingBox = patched.boundingBox();
+
+                BoundingBox changedBoundingBox;
+                bool isPatched = afterSpline->retriangulate(first, last, patched, changedBoundingBox);
+
+                // Closed curves are triangulated from scratch
+                QCOMPARE(isPatched, !closed);
+                if(isPatched)
+                {
+                    QVERIFY(fuzzyEqual(patched, expected));
+                    QVERIFY(fuzzyContains(expected.boundingBox(), changedBoundingBox));
+                    QVERIFY(fuzzyContains(beforeBoundingBox.united(changedBoundingBox), expected.boundingBox()));
+                }
+                delete beforeSpline;
+                delete afterSpline;
+            }
+        }
+    }
+
+    // The triangles and bounding box of a key edge being sculpted, patched
+    // after each step, are those of a full triangulation
+    void sculptedEdges()
+    {
+        NumSubGuard guard;
+        std::mt19937 rng(11);
+        for(int numSub=0; numSub<=2; ++numSub)
+        {
+            DevSettings::setInt("num sub", numSub);
+            for(int k=0; k<12; ++k)
+            {
+                bool closed = (k % 3 == 2);
+                bool width = (k % 2 == 1);
+                VAC vac;
+                QList<EdgeSample> s = samples(60, closed);
+                KeyEdge * edge;
+                if(closed)
+                {
+                    edge = vac.newKeyEdge(Time(0), newSpline(s, true));
+                }
+                else
+                {
+                    KeyVertex * v0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(s.first().x(), s.first().y()));
+                    KeyVertex * v1 = vac.newKeyVertex(Time(0), Eigen::Vector2d(s.last().x(), s.last().y()));
+                    edge = vac.newKeyEdge(Time(0), v0, v1, newSpline(s, false));
+                }
+                edge->triangles(Time(0));
+                edge->boundingBox(Time(0));
+
+                // Sculpt around a random sample, with a random radius
+                EdgeSample c = s[std::uniform_int_distribution<int>(0, s.size()-1)(rng)];
+                double radius = std::uniform_real_distribution<double>(5, 60)(rng);
+                edge->updateSculpt(c.x(), c.y(), radius);
+                if(width)
+                    edge->beginSculptEdgeWidth(c.x(), c.y());
+                else
+                    edge->beginSculptDeform(c.x(), c.y());
+
+                std::uniform_real_distribution<double> offset(-4, 4);
+                double x = c.x();
+                double y = c.y();
+                for(int step=0; step<5; ++step)
+                {
+                    x += offset(rng);
+                    y += offset(rng);
+                    if(width)
+                        edge->continueSculptEdgeWidth(x, y);
+                    else
+                        edge->continueSculptDeform(x, y);
+
+                    Triangles expected;
+                    edge->geometry()->triangulate(expected);
+                    Triangles triangles = edge->triangles(Time(0));
+                    QVERIFY(fuzzyEqual(triangles, expected));
+                    QVERIFY(fuzzyContains(edge->boundingBox(Time(0)), expected.boundingBox()));
+                }
+
+                if(width)
+                    edge->endSculptEdgeWidth();
+                else
+                    edge->endSculptDeform();
+                Triangles expected;
+                edge->geometry()->triangulate(expected);
+                Triangles triangles = edge->triangles(Time(0));
+                QVERIFY(fuzzyEqual(triangles, expected));
+                QVERIFY(fuzzyEqual(edge->boundingBox(Time(0)), expected.boundingBox()));
+            }
+        }
+    }
+};
+
+VPAINT_TEST_MAIN(TestSculptRetriangulation)
+#include "tst_SculptRetriangulation.moc"
@@ -0,0 +1,413 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/KeyHalfedge.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+#include "VectorAnimationComplex/InbetweenEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/EdgeSample.h"
+#include "VectorAnimationComplex/SculptCurve.h"
+#include "VectorAnimationComplex/Path.h"
+#include "VectorAnimationComplex/Cycle.h"
+#include "VectorAnimationComplex/AnimatedVertex.h"
+
+#include <random>
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+typedef SculptCurve::Curve<EdgeSample> Curve;
+typedef SculptCurve::Intersection Intersection;
+typedef std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > EdgeSampleVector;
+
+const double tolerances[] = {15.0, 5.0};
+
+// Curve::intersections(other, tolerance) before the other curve was given
+// as a CurveView, copied verbatim except that the private members of the
+// curves are replaced by their public accessors
+std::vector<Intersection> formerIntersections(const Curve & self, const Curve & other, double tolerance)
+{
+    bool isClosed = self.view().isClosed();
+    bool otherIsClosed = other.view().isClosed();
+
+    std::vector<Intersection> res;
+
+    // Returns in trivial cases
+    int n = self.size();
+    int nOther = other.size();
+    if(n<2 || nOther<2)
+        return res;
+
+    // store min/max
+    double l = self.length();
+    double lOther = other.length();
+    double minS = l;
+    double maxS = 0;
+    double minT = lOther;
+    double maxT = 0;
+
+    double u, v;
+    for(int i=0; i<n-1; ++i)
+    {
+        EdgeSample va = self[i];
+        EdgeSample vb = self[i+1];
+        for(int j=0; j<nOther-1; ++j)
+        {
+            EdgeSample vc = other[j];
+            EdgeSample vd = other[j+1];
+
+            bool doIntersect = Curve::intersects(va, vb, vc, vd, u, v);
+            if(doIntersect)
+            {
+                double s = (1-u)*self.arclength(i) + u*self.arclength(i+1);
+                double t = (1-v)*other.arclength(j) + v*other.arclength(j+1);
+                res.push_back(Intersection(s,t));
+
+                // update min/max
+                if(s<minS)
+                    minS = s;
+                if(s>maxS)
+                    maxS = s;
+                if(t<minT)
+                    minT = t;
+                if(t>maxT)
+                    maxT = t;
+            }
+        }
+    }
+
+    // Compute endpoints intersections
+    if(minS > tolerance && !isClosed) // start of this
+    {
+        EdgeSample va = self.start();
+        EdgeSample ve = self(tolerance);
+        EdgeSample vb = ve.lerp(2.0, va);
+        for(int j=0; j<nOther-1; ++j)
+        {
+            EdgeSample vc = other[j];
+            EdgeSample vd = other[j+1];
+
+            bool doIntersect = Curve::intersects(va, vb, vc, vd, u, v);
+            if(doIntersect)
+            {
+                double s = 0;
+                double t = (1-v)*other.arclength(j) + v*other.arclength(j+1);
+                res.push_back(Intersection(s,t));
+
+                // update min/max
+                if(s<minS)
+                    minS = s;
+                if(s>maxS)
+                    maxS = s;
+                if(t<minT)
+                    minT = t;
+                if(t>maxT)
+                    maxT = t;
+            }
+        }
+    }
+    if(maxS < l-tolerance && !isClosed) // end of this
+    {
+        EdgeSample va = self.end();
+        EdgeSample ve = self(l-tolerance);
+        EdgeSample vb = ve.lerp(2.0, va);
+        for(int j=0; j<nOther-1; ++j)
+        {
+            EdgeSample vc = other[j];
+            EdgeSample vd = other[j+1];
+
+            bool doIntersect = Curve::intersects(va, vb, vc, vd, u, v);
+            if(doIntersect)
+            {
+                double s = l;
+                double t = (1-v)*other.arclength(j) + v*other.arclength(j+1);
+                res.push_back(Intersection(s,t));
+
+                // update min/max
+                if(s<minS)
+                    minS = s;
+                if(s>maxS)
+                    maxS = s;
+                if(t<minT)
+                    minT = t;
+                if(t>maxT)
+                    maxT = t;
+            }
+        }
+    }
+    if(minT > tolerance && !otherIsClosed) // start of other
+    {
+        EdgeSample va = other.start();
+        EdgeSample ve = other(tolerance);
+        EdgeSample vb = ve.lerp(2.0, va);
+        for(int i=0; i<n-1; ++i)
+        {
+            EdgeSample vc = self[i];
+            EdgeSample vd = self[i+1];
+
+            bool doIntersect = Curve::intersects(va, vb, vc, vd, u, v);
+            if(doIntersect)
+            {
+                double t = 0;
+                double s = (1-v)*self.arclength(i) + v*self.arclength(i+1);
+                res.push_back(Intersection(s,t));
+
+                // update min/max
+                if(s<minS)
+                    minS = s;
+                if(s>maxS)
+                    maxS = s;
+                if(t<minT)
+                    minT = t;
+                if(t>maxT)
+                    maxT = t;
+            }
+        }
+    }
+    if(maxS < l-tolerance && !otherIsClosed) // end of this
+    {
+        EdgeSample va = other.end();
+        EdgeSample ve = other(lOther-tolerance);
+        EdgeSample vb = ve.lerp(2.0, va);
+        for(int i=0; i<n-1; ++i)
+        {
+            EdgeSample vc = self[i];
+            EdgeSample vd = self[i+1];
+
+            bool doIntersect = Curve::intersects(va, vb, vc, vd, u, v);
+            if(doIntersect)
+            {
+                double t = lOther;
+                double s = (1-v)*self.arclength(i) + v*self.arclength(i+1);
+                res.push_back(Intersection(s,t));
+
+                // update min/max
+                if(s<minS)
+                    minS = s;
+                if(s>maxS)
+                    maxS = s;
+                if(t<minT)
+                    minT = t;
+                if(t>maxT)
+                    maxT = t;
+            }
+        }
+    }
+
+    return res;
+}
+
+bool isEqual(const std::vector<Intersection> & a, const std::vector<Intersection> & b)
+{
+    if(a.size() != b.size())
+        return false;
+    for(size_t i=0; i<a.size(); ++i)
+        if(a[i].s != b[i].s || a[i].t != b[i].t)
+            return false;
+    return true;
+}
+
+// Whether the sketch has the same intersections with the view of a curve
+// as it used to have with a copy of this curve
+bool isSameAsCopy(const Curve & sketch, const SculptCurve::CurveView<EdgeSample> & view, const Curve & copy)
+{
+    for(double tolerance : tolerances)
+        if(!isEqual(sketch.intersections(view, tolerance), formerIntersections(sketch, copy, tolerance)))
+            return false;
+    return true;
+}
+
+Curve curve(const EdgeSampleVector & samples)
+{
+    Curve res;
+    res.setVertices(samples);
+    return res;
+}
+
+// The curve that insertSketchedEdgeInVAC() used to build from the sampling
+// of an inbetween edge
+Curve formerSamplingCurve(InbetweenEdge * sedge, Time time)
+{
+    QList<EdgeSample> sampling = sedge->getSampling(time);
+    EdgeSampleVector stdSampling;
+    for(int i=0; i<sampling.size(); ++i)
+        stdSampling << sampling[i];
+    return curve(stdSampling);
+}
+
+// Random polyline in [-150, 150]^2
+Curve randomSketch(std::mt19937 & rng)
+{
+    std::uniform_real_distribution<double> coord(-150, 150);
+    int numVertices = std::uniform_int_distribution<int>(2, 8)(rng);
+    EdgeSampleVector samples;
+    for(int i=0; i<numVertices; ++i)
+        samples.push_back(EdgeSample(coord(rng), coord(rng), 10));
+    return curve(samples);
+}
+
+// Short sketch across the extension of the start of the other curve by
+// the given tolerance, near its seam if it is closed: it has a virtual
+// intersection with the other curve only if this curve is open
+Curve seamSketch(const Curve & other, double tolerance)
+{
+    EdgeSample va = other.start();
+    EdgeSample ve = other(tolerance);
+    EdgeSample vb = ve.lerp(2.0, va);
+    EdgeSample m = va.lerp(0.5, vb);
+    double dx = vb.x() - va.x();
+    double dy = vb.y() - va.y();
+    double d = std::sqrt(dx*dx + dy*dy);
+    EdgeSampleVector samples;
+    samples.push_back(EdgeSample(m.x() - 2*dy/d, m.y() + 2*dx/d, 10));
+    samples.push_back(EdgeSample(m.x() + 2*dy/d, m.y() - 2*dx/d, 10));
+    return curve(samples);
+}
+
+// Wavy line from (-100, y) to (100, y)
+EdgeSampleVector wave(double y)
+{
+    EdgeSampleVector res;
+    for(int i=0; i<=40; ++i)
+        res.push_back(EdgeSample(-100 + 5*i, y + 20*std::sin(0.3*i), 10));
+    return res;
+}
+
+// Circle centered at the origin, whose first and last samples are equal
+EdgeSampleVector circle(double radius)
+{
+    EdgeSampleVector res;
+    for(int i=0; i<64; ++i)
+        res.push_back(EdgeSample(radius*std::cos(i*M_PI/32), radius*std::sin(i*M_PI/32), 10));
+    res.push_back(res.front());
+    return res;
+}
+
+// Open key edges e at time -4 and f at time 4, and the inbetween edge se
+// between them. Closed key edges c0 at time -4 and c1 at time 4, and the
+// closed inbetween edge sc between them
+struct Scene
+{
+    VAC vac;
+    KeyEdge * e;
+    KeyEdge * f;
+    KeyEdge * c0;
+    KeyEdge * c1;
+    InbetweenEdge * se;
+    InbetweenEdge * sc;
+
+    Scene()
+    {
+        e = newOpenKeyEdge(Time(-4), wave(-50));
+        f = newOpenKeyEdge(Time(4), wave(50));
+        c0 = vac.newKeyEdge(Time(-4), new LinearSpline(circle(100)));
+        c1 = vac.newKeyEdge(Time(4), new LinearSpline(circle(60)));
+        se = vac.newInbetweenEdge(
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(e, true)),
+                    Path(QList<KeyHalfedge>() << KeyHalfedge(f, true)),
+                    AnimatedVertex(InbetweenVertexList() << vac.newInbetweenVertex(e->startVertex(), f->startVertex())),
+                    AnimatedVertex(InbetweenVertexList() << vac.newInbetweenVertex(e->endVertex(), f->endVertex())));
+        sc = vac.newInbetweenEdge(
+                    Cycle(QList<KeyHalfedge>() << KeyHalfedge(c0, true)),
+                    Cycle(QList<KeyHalfedge>() << KeyHalfedge(c1, true)));
+    }
+
+    KeyEdge * newOpenKeyEdge(Time time, const EdgeSampleVector & samples)
+    {
+        KeyVertex * v0 = vac.newKeyVertex(time, Eigen::Vector2d(samples.front().x(), samples.front().y()));
+        KeyVertex * v1 = vac.newKeyVertex(time, Eigen::Vector2d(samples.back().x(), samples.back().y()));
+        return vac.newKeyEdge(time, v0, v1, new LinearSpline(samples));
+    }
+
+    static QList<Time> times()
+    {
+        return QList<Time>() << Time(-3) << Time(-1.5) << Time(0) << Time(2.5);
+    }
+};
+
+} // end namespace
+
+class TestSketchIntersections: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Key edges are viewed in place instead of being copied
+    void keyEdges()
+    {
+        Scene scene;
+        std::mt19937 rng(0);
+        int numIntersections = 0;
+        foreach(KeyEdge * iedge, QList<KeyEdge *>() << scene.e << scene.f << scene.c0 << scene.c1)
+        {
+            Curve & other = dynamic_cast<LinearSpline *>(iedge->geometry())->curve();
+            Curve copy = other;
+            for(int k=0; k<200; ++k)
+            {
+                Curve sketch = randomSketch(rng);
+                QVERIFY(isSameAsCopy(sketch, other.view(), copy));
+                numIntersections += sketch.intersections(other.view()).size();
+            }
+            QVERIFY(isSameAsCopy(seamSketch(copy, 15.0), other.view(), copy));
+        }
+        QVERIFY(numIntersections > 0);
+    }
+
+    // Inbetween edges are viewed through their cached sampling curve
+    // instead of being sampled again
+    void inbetweenEdges()
+    {
+        Scene scene;
+        std::mt19937 rng(0);
+        int numIntersections = 0;
+        foreach(InbetweenEdge * sedge, QList<InbetweenEdge *>() << scene.se << scene.sc)
+        {
+            foreach(Time t, Scene::times())
+            {
+                Curve copy = formerSamplingCurve(sedge, t);
+                const Curve & other = sedge->samplingCurve(t);
+                for(int k=0; k<100; ++k)
+                {
+                    Curve sketch = randomSketch(rng);
+                    QVERIFY(isSameAsCopy(sketch, other.view(), copy));
+                    numIntersections += sketch.intersections(other.view()).size();
+                }
+                QVERIFY(isSameAsCopy(seamSketch(copy, 15.0), other.view(), copy));
+            }
+        }
+        QVERIFY(numIntersections > 0);
+    }
+
+    // The seam of a closed inbetween edge is an end of its sampling curve:
+    // sketches near it have virtual intersections with it
+    void closedInbetweenEdgeSeam()
+    {
+        Scene scene;
+        foreach(Time t, Scene::times())
+        {
+            const Curve & other = scene.sc->samplingCurve(t);
+            Curve sketch = seamSketch(other, 15.0);
+            bool hasSeamIntersection = false;
+            for(const Intersection & intersection : sketch.intersections(other.view(), 15.0))
+                if(intersection.t == 0)
+                    hasSeamIntersection = true;
+            QVERIFY(hasSeamIntersection);
+        }
+    }
+};
+
+VPAINT_TEST_MAIN(TestSketchIntersections)
+#include "tst_SketchIntersections.moc"
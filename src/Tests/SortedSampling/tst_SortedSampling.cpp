@@ -0,0 +1,357 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/KeyHalfedge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/EdgeSample.h"
+#include "VectorAnimationComplex/SculptCurve.h"
+#include "VectorAnimationComplex/Path.h"
+#include "VectorAnimationComplex/Cycle.h"
+
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+typedef std::vector<EdgeSample,Eigen::aligned_allocator<EdgeSample> > EdgeSampleVector;
+
+// Equal, or both NaN, e.g. when extrapolating a zero-length segment
+bool isSame(double a, double b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+bool isSame(const EdgeSample & a, const EdgeSample & b)
+{
+    return isSame(a.x(), b.x()) && isSame(a.y(), b.y()) && isSame(a.width(), b.width());
+}
+
+bool isSame(const Eigen::Vector2d & a, const Eigen::Vector2d & b)
+{
+    return isSame(a[0], b[0]) && isSame(a[1], b[1]);
+}
+
+template <class T>
+bool isSame(const QList<T> & a, const QList<T> & b)
+{
+    if(a.size() != b.size())
+        return false;
+    for(int i=0; i<a.size(); ++i)
+        if(!isSame(a[i], b[i]))
+            return false;
+    return true;
+}
+
+double uniform(double min, double max, std::mt19937 & rng)
+{
+    return std::uniform_real_distribution<double>(min, max)(rng);
+}
+
+int uniform(int min, int max, std::mt19937 & rng)
+{
+    return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
+// Random samples from start to end, where about one inner sample out of
+// four repeats the previous one, making a zero-length segment. The first
+// and last segments have a non-zero length, so that operator() never
+// divides by zero while searching for a segment.
+EdgeSampleVector randomSamples(const EdgeSample & start, const EdgeSample & end, std::mt19937 & rng)
+{
+    EdgeSampleVector res;
+    res.push_back(start);
+    int numInnerSamples = uniform(0, 20, rng);
+    for(int i=0; i<numInnerSamples; ++i)
+    {
+        if(i > 0 && i+1 < numInnerSamples && uniform(0, 3, rng) == 0)
+            res.push_back(res.back());
+        else
+            res.push_back(EdgeSample(uniform(0.0, 100.0, rng), uniform(0.0, 100.0, rng),
+                                     uniform(0.0, 10.0, rng)));
+    }
+    res.push_back(end);
+    if(res[0].distanceTo(res[1]) == 0 || res[res.size()-2].distanceTo(res.back()) == 0)
+        return randomSamples(start, EdgeSample(end.x() + 1, end.y(), end.width()), rng);
+    return res;
+}
+
+// Arclengths of the vertices, computed like Curve does
+std::vector<double> arclengths(const EdgeSampleVector & vertices)
+{
+    std::vector<double> res(vertices.size(), 0);
+    for(size_t i=1; i<vertices.size(); ++i)
+        res[i] = res[i-1] + vertices[i-1].distanceTo(vertices[i]);
+    return res;
+}
+
+// Sorted arclengths, possibly out of [0, length], possibly equal to the
+// arclengths of vertices, and possibly repeated
+std::vector<double> randomArclengths(const std::vector<double> & vertexArclengths,
+                                     bool increasing, std::mt19937 & rng)
+{
+    double length = vertexArclengths.back();
+    std::vector<double> res;
+    int n = uniform(0, 50, rng);
+    for(int k=0; k<n; ++k)
+    {
+        switch(uniform(0, 4, rng))
+        {
+        case 0:
+            res.push_back(vertexArclengths[uniform(0, (int) vertexArclengths.size()-1, rng)]);
+            break;
+        case 1:
+            res.push_back(uniform(-0.5, 0.0, rng) * (length + 1));
+            break;
+        case 2:
+            res.push_back(length + uniform(0.0, 0.5, rng) * (length + 1));
+            break;
+        case 3:
+            if(!res.empty())
+            {
+                res.push_back(res.back());
+                break;
+            }
+            // else fall through
+        default:
+            res.push_back(uniform(0.0, length, rng));
+            break;
+        }
+    }
+    std::sort(res.begin(), res.end());
+    if(!increasing)
+        std::reverse(res.begin(), res.end());
+    return res;
+}
+
+// Verbatim copy of the loops of Path::sample() and Cycle::sample() before
+// the halfedges were sampled in one batch
+void formerSamples(QList<KeyHalfedge> halfedges_, double length,
+                   int numSamples, QList<EdgeSample> & out)
+{
+    assert(numSamples >= 2);
+    double ds = length/(numSamples-1);
+
+    double cumulativeLength = 0;
+    int indexHe = 0;
+    KeyHalfedge he = halfedges_[indexHe];
+    for(int i=0; i<numSamples; ++i)
+    {
+        double s = i*ds;
+        while ( (s > cumulativeLength + he.length()) && (indexHe+1 < halfedges_.size()) )
+        {
+            cumulativeLength += he.length();
+            he = halfedges_[++indexHe];
+        }
+        out << he.sample(s-cumulativeLength);
+    }
+}
+
+void formerPositions(QList<KeyHalfedge> halfedges_, double length,
+                     int numSamples, QList<Eigen::Vector2d> & out)
+{
+    assert(numSamples >= 2);
+    double ds = length/(numSamples-1);
+
+    double cumulativeLength = 0;
+    int indexHe = 0;
+    KeyHalfedge he = halfedges_[indexHe];
+    for(int i=0; i<numSamples; ++i)
+    {
+        double s = i*ds;
+        while ( (s > cumulativeLength + he.length()) && (indexHe+1 < halfedges_.size()) )
+        {
+            cumulativeLength += he.length();
+            he = halfedges_[++indexHe];
+        }
+        out << he.pos(s-cumulativeLength);
+    }
+}
+
+// Verbatim copy of the offset of Cycle::sample()
+template <class T>
+void applyOffset(double s0_, int numSamples, const QList<T> & outAux, QList<T> & out)
+{
+    int i0 = std::floor( numSamples * s0_ + 0.5);
+    if(i0 < 0)
+        i0 = 0;
+    if(i0 > numSamples - 1)
+        i0 = numSamples - 1;
+    for(int i=i0; i<numSamples; ++i)
+        out << outAux[i];
+    for(int i=0; i<i0; ++i)
+        out << outAux[i];
+}
+
+template <class PathOrCycle>
+QList<KeyHalfedge> halfedges(const PathOrCycle & pathOrCycle)
+{
+    QList<KeyHalfedge> res;
+    for(int i=0; i<pathOrCycle.size(); ++i)
+        res << pathOrCycle[i];
+    return res;
+}
+
+// Key edges between successive vertices of a random polyline at time 0,
+// each traversed in a random direction. The polyline is closed if the last
+// vertex is the first one
+QList<KeyHalfedge> randomHalfedges(VAC & vac, bool closed, std::mt19937 & rng)
+{
+    int numHalfedges = uniform(1, 5, rng);
+    QList<KeyVertex *> vertices;
+    for(int i=0; i<numHalfedges; ++i)
+        vertices << vac.newKeyVertex(Time(0), Eigen::Vector2d(uniform(0.0, 100.0, rng),
+                                                              uniform(0.0, 100.0, rng)));
+    vertices << (closed ? vertices[0] : vac.newKeyVertex(Time(0), Eigen::Vector2d(50, 50)));
+
+    QList<KeyHalfedge> res;
+    for(int i=0; i<numHalfedges; ++i)
+    {
+        bool side = uniform(0, 1, rng);
+        KeyVertex * start = side ? vertices[i] : vertices[i+1];
+        KeyVertex * end = side ? vertices[i+1] : vertices[i];
+        EdgeSampleVector samples = randomSamples(
+                    EdgeSample(start->pos()[0], start->pos()[1], uniform(0.0, 10.0, rng)),
+                    EdgeSample(end->pos()[0], end->pos()[1], uniform(0.0, 10.0, rng)), rng);
+        res << KeyHalfedge(vac.newKeyEdge(Time(0), start, end, new LinearSpline(samples)), side);
+    }
+    return res;
+}
+
+} // end namespace
+
+class TestSortedSampling: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Curve::evaluate() gives the same results as operator() for sorted
+    // arclengths, including ties, values out of [0, length()], values at
+    // vertices, and zero-length segments
+    void evaluate()
+    {
+        std::mt19937 rng(93);
+        for(int i=0; i<2000; ++i)
+        {
+            EdgeSampleVector vertices;
+            if(i % 10 == 0)
+                vertices.push_back(EdgeSample(1, 2, 3));
+            else
+                vertices = randomSamples(EdgeSample(0, 0, 1), EdgeSample(100, 100, 2), rng);
+            SculptCurve::Curve<EdgeSample> curve;
+            curve.setVertices(vertices);
+
+            for(int increasing=0; increasing<2; ++increasing)
+            {
+                std::vector<double> s = randomArclengths(arclengths(vertices), increasing, rng);
+                EdgeSampleVector out(s.size());
+                curve.evaluate(s.data(), s.size(), out.data());
+                for(size_t k=0; k<s.size(); ++k)
+                    QVERIFY(isSame(out[k], curve(s[k])));
+            }
+        }
+    }
+
+    // LinearSpline::sortedPos() forwards to Curve::evaluate(), and
+    // EdgeGeometry::sortedPos() loops over pos()
+    void sortedPos()
+    {
+        std::mt19937 rng(9301);
+        for(int i=0; i<200; ++i)
+        {
+            EdgeSampleVector vertices = randomSamples(EdgeSample(0, 0, 1), EdgeSample(100, 0, 2), rng);
+            LinearSpline spline(vertices);
+            EdgeGeometry straight;
+            std::vector<double> s = randomArclengths(arclengths(vertices), i % 2, rng);
+            EdgeSampleVector out(s.size());
+            spline.sortedPos(s.data(), s.size(), out.data());
+            for(size_t k=0; k<s.size(); ++k)
+                QVERIFY(isSame(out[k], spline.pos(s[k])));
+            straight.sortedPos(s.data(), s.size(), out.data());
+            for(size_t k=0; k<s.size(); ++k)
+                QVERIFY(isSame(out[k], straight.pos(s[k])));
+        }
+    }
+
+    void pathSample()
+    {
+        VAC vac;
+        std::mt19937 rng(9302);
+        for(int i=0; i<300; ++i)
+        {
+            Path path(randomHalfedges(vac, false, rng));
+            QVERIFY(path.isValid());
+            int numSamples = uniform(2, 100, rng);
+
+            QList<EdgeSample> samples;
+            QList<EdgeSample> formerSampleList;
+            path.sample(numSamples, samples);
+            formerSamples(halfedges(path), path.length(), numSamples, formerSampleList);
+            QVERIFY(isSame(samples, formerSampleList));
+
+            QList<Eigen::Vector2d> positions;
+            QList<Eigen::Vector2d> formerPositionList;
+            path.sample(numSamples, positions);
+            formerPositions(halfedges(path), path.length(), numSamples, formerPositionList);
+            QVERIFY(isSame(positions, formerPositionList));
+        }
+    }
+
+    // Cycles of open edges, and of a single closed edge, from a random
+    // starting point
+    void cycleSample()
+    {
+        VAC vac;
+        std::mt19937 rng(9303);
+        for(int i=0; i<300; ++i)
+        {
+            QList<KeyHalfedge> cycleHalfedges;
+            if(i % 5 == 0)
+            {
+                EdgeSampleVector vertices = randomSamples(EdgeSample(0, 0, 1), EdgeSample(100, 0, 2), rng);
+                KeyEdge * closedEdge = vac.newKeyEdge(Time(0), new LinearSpline(vertices));
+                cycleHalfedges << KeyHalfedge(closedEdge, uniform(0, 1, rng));
+            }
+            else
+            {
+                cycleHalfedges = randomHalfedges(vac, true, rng);
+            }
+            Cycle cycle(cycleHalfedges);
+            QVERIFY(cycle.isValid());
+            cycle.setStartingPoint(uniform(0.0, 1.0, rng));
+            int numSamples = uniform(2, 100, rng);
+
+            QList<EdgeSample> samples;
+            QList<EdgeSample> formerAux;
+            QList<EdgeSample> formerSampleList;
+            cycle.sample(numSamples, samples);
+            formerSamples(halfedges(cycle), cycle.length(), numSamples, formerAux);
+            applyOffset(cycle.s0(), numSamples, formerAux, formerSampleList);
+            QVERIFY(isSame(samples, formerSampleList));
+
+            QList<Eigen::Vector2d> positions;
+            QList<Eigen::Vector2d> formerPositionAux;
+            QList<Eigen::Vector2d> formerPositionList;
+            cycle.sample(numSamples, positions);
+            formerPositions(halfedges(cycle), cycle.length(), numSamples, formerPositionAux);
+            applyOffset(cycle.s0(), numSamples, formerPositionAux, formerPositionList);
+            QVERIFY(isSame(positions, formerPositionList));
+        }
+    }
+};
+
+VPAINT_TEST_MAIN(TestSortedSampling)
+#include "tst_SortedSampling.moc"
@@ -0,0 +1,406 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "VectorAnimationComplex/SpaceTimeSurface.h"
+
+#include <QtTest>
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+typedef SpaceTimeSurface::Input Input;
+typedef SpaceTimeSurface::Vector2dList Vector2dList;
+
+// n samples of the segment from p to q
+Vector2dList segment(const Eigen::Vector2d & p, const Eigen::Vector2d & q, int n)
+{
+    Vector2dList res;
+    for(int j=0; j<n; ++j)
+        res.push_back(p + (q - p) * j / (n - 1.0));
+    return res;
+}
+
+// Open edge of n samples from (0,0) to (100,0) at t1, translated by d at t2,
+// not warped
+Input translation(double t1, double t2, const Eigen::Vector2d & d, int n = 11)
+{
+    Input res;
+    res.t1 = t1;
+    res.t2 = t2;
+    res.beforeSampling = segment(Eigen::Vector2d(0, 0), Eigen::Vector2d(100, 0), n);
+    res.afterSampling = segment(d, Eigen::Vector2d(100, 0) + d, n);
+    return res;
+}
+
+bool fuzzyEqual(const Eigen::Vector3d & a, const Eigen::Vector3d & b, double eps = 1e-9)
+{
+    return (a - b).norm() < eps;
+}
+
+bool isFinite(const Eigen::Vector3d & v)
+{
+    return std::isfinite(v[0]) && std::isfinite(v[1]) && std::isfinite(v[2]);
+}
+
+// Checks the invariants of the mesh of any built surface
+void checkMesh(const SpaceTimeSurface & s)
+{
+    const int C = s.numColumns();
+    const int S = s.sliceTimes().size();
+    QVERIFY(s.isBuilt());
+    QCOMPARE((int) s.positions().size(), S * C);
+    QCOMPARE((int) s.normals().size(), S * C);
+    QCOMPARE((int) s.indices().size(), S > 1 && C > 1 ? 6 * (S-1) * (C-1) : 0);
+    for(unsigned int k=0; k<s.indices().size(); ++k)
+        QVERIFY(s.indices()[k] < s.positions().size());
+    for(int i=1; i<S; ++i)
+        QVERIFY(s.sliceTimes()[i-1] < s.sliceTimes()[i]);
+    for(const Eigen::Vector3d & N: s.normals())
+    {
+        QVERIFY(isFinite(N));
+        QVERIFY(N.norm() < 1e-9 || std::abs(N.norm() - 1) < 1e-9);
+    }
+}
+
+void checkEmpty(const SpaceTimeSurface & s)
+{
+    QVERIFY(s.isBuilt());
+    QCOMPARE(s.numColumns(), 0);
+    QVERIFY(s.positions().empty());
+    QVERIFY(s.normals().empty());
+    QVERIFY(s.indices().empty());
+    QVERIFY(s.sliceTimes().empty());
+}
+
+} // end namespace
+
+class TestSpaceTimeSurface: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // A still edge only needs its first and last slices
+    void stillEdge()
+    {
+        Input input = translation(0, 10, Eigen::Vector2d(0, 0));
+        SpaceTimeSurface s;
+        QVERIFY(!s.isBuilt());
+        s.build(input);
+        checkMesh(s);
+
+        QCOMPARE(s.numColumns(), 11);
+        QCOMPARE(s.sliceTimes(), std::vector<double>({0.0, 10.0}));
+        QCOMPARE((int) s.indices().size(), 6 * 10);
+
+        // Vertex (i,j) at index i*numColumns()+j, at time sliceTimes()[i]
+        for(int i=0; i<2; ++i)
+            for(int j=0; j<11; ++j)
+                QVERIFY(fuzzyEqual(s.positions()[i*11+j], Eigen::Vector3d(10*j, 0, 10*i)));
+
+        // Triangles go from the last slice to the first, with the winding
+        // of the quad strips previously drawn by InbetweenEdge
+        QCOMPARE(s.indices()[0], 0u);
+        QCOMPARE(s.indices()[1], 11u);
+        QCOMPARE(s.indices()[2], 1u);
+        for(const Eigen::Vector3d & N: s.normals())
+            QVERIFY(fuzzyEqual(N, Eigen::Vector3d(0, 1, 0)));
+
+        QVERIFY(s.memoryUsage() > 0);
+        s.clear();
+        QVERIFY(!s.isBuilt());
+        QVERIFY(s.positions().empty());
+    }
+
+    // A fast edge keeps all the slices of the grid, interpolated linearly
+    void fastEdge()
+    {
+        Input input = translation(0, 10, Eigen::Vector2d(0, 100));
+        SpaceTimeSurface s;
+        s.build(input);
+        checkMesh(s);
+
+        QCOMPARE((int) s.sliceTimes().size(), 11);
+        for(int i=0; i<=10; ++i)
+        {
+            QCOMPARE(s.sliceTimes()[i], (double) i);
+            for(int j=0; j<11; ++j)
+                QVERIFY(fuzzyEqual(s.positions()[i*11+j], Eigen::Vector3d(10*j, 10*i, i)));
+        }
+        QCOMPARE(s.indices()[0], 9u*11);
+    }
+
+    // Slices are bisected until no sample moves by more than
+    // maxDisplacement in between
+    void adaptiveSlices_data()
+    {
+        QTest::addColumn<double>("maxDisplacement");
+        QTest::newRow("5") << 5.0;
+        QTest::newRow("15") << 15.0;
+        QTest::newRow("25") << 25.0;
+        QTest::newRow("45") << 45.0;
+        QTest::newRow("1000") << 1000.0;
+    }
+
+    void adaptiveSlices()
+    {
+        QFETCH(double, maxDisplacement);
+        Input input = translation(0, 10, Eigen::Vector2d(0, 100));
+        input.parameters.maxDisplacement = maxDisplacement;
+        SpaceTimeSurface s;
+        s.build(input);
+        checkMesh(s);
+
+        const std::vector<double> & times = s.sliceTimes();
+        QCOMPARE(times.front(), 0.0);
+        QCOMPARE(times.back(), 10.0);
+        for(unsigned int i=1; i<times.size(); ++i)
+        {
+            double dt = times[i] - times[i-1];
+            QVERIFY(dt == 1 || 10 * dt <= maxDisplacement);
+            QCOMPARE(dt, std::floor(dt)); // on the grid
+        }
+        // Pairs of intervals are merged as soon as they move by less
+        if(maxDisplacement >= 20)
+            QVERIFY(times.size() < 11);
+        else
+            QCOMPARE((int) times.size(), 11);
+    }
+
+    // Going back and forth between two slices is not mistaken for stillness
+    void backAndForth()
+    {
+        Input input = translation(0, 4, Eigen::Vector2d(0, 0));
+        for(int i=0; i<=4; ++i)
+        {
+            input.startPositions.push_back(Eigen::Vector2d(0, 25 * (2 - std::abs(i - 2))));
+            input.endPositions.push_back(Eigen::Vector2d(100, 0));
+        }
+        SpaceTimeSurface s;
+        s.build(input);
+        checkMesh(s);
+
+        QCOMPARE(s.sliceTimes(), std::vector<double>({0.0, 1.0, 2.0, 3.0, 4.0}));
+
+        // Open edges are warped to follow their end vertices
+        for(int i=0; i<=4; ++i)
+        {
+            QVERIFY(fuzzyEqual(s.positions()[i*11], Eigen::Vector3d(0, 25 * (2 - std::abs(i - 2)), i)));
+            QVERIFY(fuzzyEqual(s.positions()[i*11+10], Eigen::Vector3d(100, 0, i)));
+        }
+
+        // End positions which don't match the grid are ignored
+        input.startPositions.pop_back();
+        s.build(input);
+        checkMesh(s);
+        QCOMPARE(s.sliceTimes(), std::vector<double>({0.0, 4.0}));
+    }
+
+    void sliceTimes_data()
+    {
+        QTest::addColumn<double>("t1");
+        QTest::addColumn<double>("t2");
+        QTest::addColumn<int>("slicesPerFrame");
+        QTest::addColumn<int>("numIntervals");
+
+        QTest::newRow("one frame") << 0.0 << 1.0 << 1 << 1;
+        QTest::newRow("subframes") << 2.0 << 5.0 << 4 << 12;
+        QTest::newRow("fractional") << 0.0 << 2.5 << 1 << 3;
+        QTest::newRow("fractional subframes") << 1.25 << 2.0 << 2 << 2;
+        QTest::newRow("no slices per frame") << 0.0 << 3.0 << 0 << 3;
+        QTest::newRow("negative times") << -3.0 << -1.0 << 1 << 2;
+    }
+
+    // The grid covers [t1, t2], and ends exactly at t2
+    void sliceTimes()
+    {
+        QFETCH(double, t1);
+        QFETCH(double, t2);
+        QFETCH(int, slicesPerFrame);
+        QFETCH(int, numIntervals);
+
+        Input input = translation(t1, t2, Eigen::Vector2d(0, 1000));
+        input.parameters.slicesPerFrame = slicesPerFrame;
+        QCOMPARE(input.numIntervals(), numIntervals);
+        QCOMPARE(input.gridTime(0), t1);
+        QCOMPARE(input.gridTime(numIntervals), t2);
+
+        SpaceTimeSurface s;
+        s.build(input);
+        checkMesh(s);
+        QCOMPARE((int) s.sliceTimes().size(), numIntervals + 1);
+        for(int i=0; i<=numIntervals; ++i)
+            QCOMPARE(s.sliceTimes()[i], input.gridTime(i));
+    }
+
+    // Every columnStride sample is kept, plus the last one
+    void columnStride_data()
+    {
+        QTest::addColumn<int>("numSamples");
+        QTest::addColumn<int>("columnStride");
+        QTest::addColumn<int>("numColumns");
+
+        QTest::newRow("1") << 11 << 1 << 11;
+        QTest::newRow("0 as 1") << 11 << 0 << 11;
+        QTest::newRow("divisor") << 11 << 5 << 3;
+        QTest::newRow("not divisor") << 11 << 3 << 5;
+        QTest::newRow("larger") << 11 << 20 << 2;
+        QTest::newRow("two samples") << 2 << 4 << 2;
+    }
+
+    void columnStride()
+    {
+        QFETCH(int, numSamples);
+        QFETCH(int, columnStride);
+        QFETCH(int, numColumns);
+
+        Input input = translation(0, 1, Eigen::Vector2d(0, 0), numSamples);
+        input.parameters.columnStride = columnStride;
+        SpaceTimeSurface s;
+        s.build(input);
+        checkMesh(s);
+        QCOMPARE(s.numColumns(), numColumns);
+
+        // First and last columns are the end points
+        const int C = numColumns;
+        QVERIFY(fuzzyEqual(s.positions()[0], Eigen::Vector3d(0, 0, 0)));
+        QVERIFY(fuzzyEqual(s.positions()[C-1], Eigen::Vector3d(100, 0, 0)));
+    }
+
+    // Positions are mapped to 3D by scale and offset
+    void scaleAndOffset()
+    {
+        Input input = translation(2, 3, Eigen::Vector2d(0, 0));
+        input.parameters.scale = Eigen::Vector3d(0.5, -2, 10);
+        input.parameters.offset = Eigen::Vector3d(1, 2, 3);
+        SpaceTimeSurface s;
+        s.build(input);
+        checkMesh(s);
+        QVERIFY(fuzzyEqual(s.positions()[10], Eigen::Vector3d(51, 2, 23)));
+        QVERIFY(fuzzyEqual(s.positions()[21], Eigen::Vector3d(51, 2, 33)));
+        QVERIFY(s.parameters() == input.parameters);
+        QVERIFY(s.parameters() != Input().parameters);
+
+        // Slice times are not mapped
+        QCOMPARE(s.sliceTimes(), std::vector<double>({2.0, 3.0}));
+    }
+
+    // Degenerate inputs give an empty or flat mesh, without NaNs
+    void degenerateInputs()
+    {
+        SpaceTimeSurface s;
+
+        Input empty = translation(0, 1, Eigen::Vector2d(0, 0));
+        empty.beforeSampling.clear();
+        empty.afterSampling.clear();
+        s.build(empty);
+        checkEmpty(s);
+
+        Input single = translation(0, 1, Eigen::Vector2d(0, 0));
+        single.beforeSampling.resize(1);
+        single.afterSampling.resize(1);
+        s.build(single);
+        checkEmpty(s);
+
+        Input mismatched = translation(0, 1, Eigen::Vector2d(0, 0));
+        mismatched.afterSampling.pop_back();
+        s.build(mismatched);
+        checkEmpty(s);
+
+        // Zero duration: one interval, at the same time
+        Input instant = translation(3, 3, Eigen::Vector2d(0, 50));
+        QCOMPARE(instant.numIntervals(), 1);
+        s.build(instant);
+        QVERIFY(s.isBuilt());
+        QCOMPARE((int) s.positions().size(), 2 * 11);
+        for(const Eigen::Vector3d & p: s.positions())
+            QVERIFY(isFinite(p) && p[1] == 0 && p[2] == 3);
+        for(const Eigen::Vector3d & N: s.normals())
+            QVERIFY(isFinite(N));
+
+        // All samples at the same position: flat triangles, null normals
+        Input point = translation(0, 1, Eigen::Vector2d(0, 0));
+        point.beforeSampling.assign(11, Eigen::Vector2d(7, 7));
+        point.afterSampling.assign(11, Eigen::Vector2d(7, 7));
+        s.build(point);
+        checkMesh(s);
+        for(const Eigen::Vector3d & N: s.normals())
+            QCOMPARE(N.norm(), 0.0);
+
+        // Rebuilding replaces the previous mesh
+        s.build(empty);
+        checkEmpty(s);
+    }
+
+    // buildAll() gives the same surfaces as sequential calls to build()
+    void buildAllMatchesBuild()
+    {
+        const int n = 57;
+        std::vector<Input> inputs(n);
+        for(int i=0; i<n; ++i)
+        {
+            Input & input = inputs[i];
+            input = translation(i % 5, i % 5 + 1 + i % 7, Eigen::Vector2d(3 * i, 50 - i), 5 + i % 13);
+            input.parameters.slicesPerFrame = 1 + i % 3;
+            input.parameters.columnStride = 1 + i % 4;
+            input.parameters.maxDisplacement = 1 + i % 11;
+            if(i % 2)
+            {
+                for(int k=0; k<=input.numIntervals(); ++k)
+                {
+                    input.startPositions.push_back(Eigen::Vector2d(std::sin(k + i), k));
+                    input.endPositions.push_back(Eigen::Vector2d(100, std::cos(k * i)));
+                }
+            }
+            if(i % 17 == 0)
+                input.afterSampling.clear(); // degenerate
+        }
+
+        std::vector<SpaceTimeSurface> sequential(n);
+        for(int i=0; i<n; ++i)
+            sequential[i].build(inputs[i]);
+
+        std::vector<SpaceTimeSurface> concurrent(n);
+        std::vector<const Input *> inputPointers;
+        std::vector<SpaceTimeSurface *> surfaces;
+        for(int i=0; i<n; ++i)
+        {
+            inputPointers.push_back(&inputs[i]);
+            surfaces.push_back(&concurrent[i]);
+        }
+        SpaceTimeSurface::buildAll(inputPointers, surfaces);
+
+        for(int i=0; i<n; ++i)
+        {
+            const SpaceTimeSurface & a = sequential[i];
+            const SpaceTimeSurface & b = concurrent[i];
+            QVERIFY(b.isBuilt());
+            QVERIFY(a.parameters() == b.parameters());
+            QCOMPARE(a.numColumns(), b.numColumns());
+            QCOMPARE(a.sliceTimes(), b.sliceTimes());
+            QCOMPARE(a.indices(), b.indices());
+            QVERIFY(a.positions() == b.positions());
+            QVERIFY(a.normals() == b.normals());
+        }
+
+        // Only the first min(#inputs, #surfaces) surfaces are built, and
+        // empty lists are fine
+        std::vector<SpaceTimeSurface> extra(2);
+        surfaces.resize(1);
+        surfaces[0] = &extra[0];
+        SpaceTimeSurface::buildAll(inputPointers, surfaces);
+        QVERIFY(extra[0].isBuilt());
+        QVERIFY(!extra[1].isBuilt());
+        SpaceTimeSurface::buildAll(std::vector<const Input *>(), std::vector<SpaceTimeSurface *>());
+    }
+};
+
+QTEST_APPLESS_MAIN(TestSpaceTimeSurface)
+#include "tst_SpaceTimeSurface.moc"
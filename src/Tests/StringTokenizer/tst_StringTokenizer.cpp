@@ -0,0 +1,164 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "StringTokenizer.h"
+#include "CssColor.h"
+
+#include <QtTest>
+#include <QRegExp>
+#include <QStringList>
+
+class TestStringTokenizer: public QObject
+{
+    Q_OBJECT
+
+private:
+    static QStringList tokens(const QString & str, const char * delimiters)
+    {
+        QStringList res;
+        StringTokenizer tokenizer(&str, delimiters);
+        while(!tokenizer.atEnd())
+            res << tokenizer.next().toString();
+        return res;
+    }
+
+private slots:
+    // The tokenizer replaces QString::split() with a character class regular
+    // expression and QString::SkipEmptyParts, as used by the parsers before
+    void splitLikeRegExp_data()
+    {
+        QTest::addColumn<QString>("str");
+        QTest::addColumn<QString>("delimiters");
+        QTest::addColumn<QString>("regexp");
+
+        QTest::newRow("empty") << "" << "" << "\\s";
+        QTest::newRow("spaces only") << "   \t\n " << "" << "\\s";
+        QTest::newRow("ids") << "12 5 7" << "" << "\\s";
+        QTest::newRow("ids, extra spaces") << "  12   5\t7 \n" << "" << "\\s";
+        QTest::newRow("vertex") << "(1.5,-2e-3)" << "(),"  << "[\\(\\)\\,\\s]";
+        QTest::newRow("path") << "[e12+ e3- v7]" << "[]," << "[\\[\\]\\,\\s]";
+        QTest::newRow("animated cycle")
+                << "[1:(15+,2,5,_,_) 2:(12,1,2,3,4)]" << "[],():" << "[\\[\\]\\s\\,\\(\\):]";
+        QTest::newRow("leading and trailing delimiters") << ",,a,,b,," << "," << "[\\,\\s]";
+        QTest::newRow("non ascii") << "été hiver" << "" << "\\s";
+    }
+
+    void splitLikeRegExp()
+    {
+        QFETCH(QString, str);
+        QFETCH(QString, delimiters);
+        QFETCH(QString, regexp);
+
+        QByteArray d = delimiters.toLatin1();
+        QStringList expected = str.split(QRegExp(regexp), QString::SkipEmptyParts);
+        QCOMPARE(tokens(str, d.constData()), expected);
+
+        StringTokenizer tokenizer(&str, d.constData());
+        QCOMPARE(tokenizer.countRemaining(), expected.size());
+    }
+
+    // An empty or blank attribute has no tokens. Note: the former parser of
+    // InbetweenFace's "beforefaces" and "afterfaces" split "" into [""], read
+    // as the face id 0. Documents saved by VPaint never reference a face 0 for
+    // an inbetween face without before/after faces, so the former result was
+    // a dangling id, and the list is now empty instead
+    void emptyAttribute()
+    {
+        QString empty;
+        StringTokenizer tokenizer(&empty);
+        QVERIFY(tokenizer.atEnd());
+        QVERIFY(tokenizer.next().isNull());
+        QCOMPARE(tokenizer.countRemaining(), 0);
+        QCOMPARE(tokens(" ", ""), QStringList());
+    }
+
+    // Writes ids the way InbetweenFace::write() does, and reads them back
+    void idListRoundTrip()
+    {
+        QList< QList<int> > lists;
+        lists << QList<int>() << (QList<int>() << 0) << (QList<int>() << 3 << 14 << 159 << 2653);
+        foreach(const QList<int> & ids, lists)
+        {
+            QString str;
+            for(int i=0; i<ids.size(); ++i)
+            {
+                if(i > 0)
+                    str += " ";
+                str += QString().setNum(ids[i]);
+            }
+
+            QList<int> res;
+            StringTokenizer tokenizer(&str);
+            while(!tokenizer.atEnd())
+                res << tokenizer.next().toInt();
+            QCOMPARE(res, ids);
+        }
+    }
+
+    void countRemainingDoesNotConsume()
+    {
+        QString str = "a b c";
+        StringTokenizer tokenizer(&str);
+        QCOMPARE(tokenizer.next().toString(), QString("a"));
+        QCOMPARE(tokenizer.countRemaining(), 2);
+        QCOMPARE(tokenizer.next().toString(), QString("b"));
+        QCOMPARE(tokenizer.countRemaining(), 1);
+    }
+
+    void rewind()
+    {
+        QString str = "a b";
+        StringTokenizer tokenizer(&str);
+        tokenizer.next();
+        tokenizer.next();
+        QVERIFY(tokenizer.atEnd());
+        tokenizer.rewind();
+        QCOMPARE(tokenizer.next().toString(), QString("a"));
+    }
+
+    // Tokens point into the original string, without copy
+    void zeroCopy()
+    {
+        QString str = "  abc def";
+        StringTokenizer tokenizer(&str);
+        QStringRef token = tokenizer.next();
+        QCOMPARE(token.string(), &str);
+        QCOMPARE(token.position(), 2);
+        QCOMPARE(token.length(), 3);
+    }
+
+    // As used by InbetweenFace to read its cycles
+    void nextEnclosed()
+    {
+        QString str = " [1:(15+,2,5,_,_)] [2:(12,1,2,3,4)] [";
+        StringTokenizer tokenizer(&str);
+        QCOMPARE(tokenizer.nextEnclosed('[', ']').toString(), QString("[1:(15+,2,5,_,_)]"));
+        QCOMPARE(tokenizer.nextEnclosed('[', ']').toString(), QString("[2:(12,1,2,3,4)]"));
+        QVERIFY(tokenizer.nextEnclosed('[', ']').isNull()); // unclosed
+        QVERIFY(tokenizer.nextEnclosed('[', ']').isNull());
+    }
+
+    void cssColorRoundTrip()
+    {
+        CssColor color(12, 200, 255, 0.25);
+        QString str = color.toString();
+        CssColor res(str);
+        QCOMPARE(res.toString(), str);
+        QCOMPARE(res.r(), 12);
+        QCOMPARE(res.g(), 200);
+        QCOMPARE(res.b(), 255);
+        QCOMPARE(res.a(), 0.25);
+
+        // Whitespaces are allowed anywhere
+        CssColor res2(QString("  rgba ( 12,200  , 255, 0.25) "));
+        QCOMPARE(res2.toString(), str);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestStringTokenizer)
+#include "tst_StringTokenizer.moc"
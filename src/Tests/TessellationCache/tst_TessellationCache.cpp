@@ -0,0 +1,191 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/TessellationCache.h"
+
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+Triangles someTriangles(int n)
+{
+    Triangles res;
+    for(int i=0; i<n; ++i)
+        res.append(i, 0, i+1, 0, i, 1);
+    return res;
+}
+
+QList<Eigen::Vector2d> wavyPoints()
+{
+    QList<Eigen::Vector2d> res;
+    for(int i=0; i<=20; ++i)
+        res << Eigen::Vector2d(10 * i, 15 * std::sin(i / 3.0));
+    return res;
+}
+
+// Restores the number of subdivisions at the end of a test
+class NumSubGuard
+{
+public:
+    NumSubGuard() : numSub_(DevSettings::getInt("num sub")) {}
+    ~NumSubGuard() { DevSettings::setInt("num sub", numSub_); }
+
+private:
+    int numSub_;
+};
+
+} // end namespace
+
+class TestTessellationCache: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init()
+    {
+        TessellationCache::instance()->clear();
+        TessellationCache::instance()->resetCounters();
+    }
+
+    void keyEquality()
+    {
+        TessellationKey a(TessellationKey::EdgeTriangles);
+        TessellationKey b(TessellationKey::EdgeTriangles);
+        a.add(1.5); a.add(2.5);
+        b.add(1.5); b.add(2.5);
+        QVERIFY(a == b);
+        QCOMPARE(a.value(), b.value());
+
+        // Order matters
+        TessellationKey permuted(TessellationKey::EdgeTriangles);
+        permuted.add(2.5); permuted.add(1.5);
+        QVERIFY(a != permuted);
+
+        // Prefixes are different keys
+        TessellationKey prefix(TessellationKey::EdgeTriangles);
+        prefix.add(1.5);
+        QVERIFY(a != prefix);
+
+        // Kinds are different keys
+        TessellationKey otherKind(TessellationKey::EdgeTopologyTriangles);
+        otherKind.add(1.5); otherKind.add(2.5);
+        QVERIFY(a != otherKind);
+
+        // 0.0 and -0.0 tessellate the same
+        TessellationKey zero(TessellationKey::FaceTriangles);
+        TessellationKey minusZero(TessellationKey::FaceTriangles);
+        zero.add(0.0);
+        minusZero.add(-0.0);
+        QVERIFY(zero == minusZero);
+        QCOMPARE(zero.value(), minusZero.value());
+    }
+
+    void findAndInsert()
+    {
+        TessellationCache * cache = TessellationCache::instance();
+        TessellationKey key(TessellationKey::FaceTriangles);
+        key.add(42);
+
+        Triangles out = someTriangles(2);
+        QVERIFY(!cache->find(key, out));
+        QCOMPARE(out.size(), 2); // unchanged
+
+        cache->insert(key, someTriangles(5));
+        QVERIFY(cache->find(key, out));
+        QCOMPARE(out.size(), 5);
+
+        // Replaced
+        cache->insert(key, someTriangles(7));
+        QVERIFY(cache->find(key, out));
+        QCOMPARE(out.size(), 7);
+
+        // Empty tessellations are not cached
+        TessellationKey emptyKey(TessellationKey::FaceTriangles);
+        emptyKey.add(43);
+        cache->insert(emptyKey, Triangles());
+        QVERIFY(!cache->find(emptyKey, out));
+
+        QCOMPARE(cache->counters().numHits, 2);
+        QCOMPARE(cache->counters().numMisses, 2);
+        QCOMPARE(cache->counters().numCollisions, 0);
+    }
+
+    // The stored keys are counted in the size of the cache
+    void eviction()
+    {
+        TessellationCache * cache = TessellationCache::instance();
+        qint64 maxBytes = cache->maxBytes();
+
+        TessellationKey small(TessellationKey::FaceTriangles);
+        small.add(1);
+        TessellationKey large(TessellationKey::FaceTriangles);
+        for(int i=0; i<100000; ++i)
+            large.add(i);
+
+        cache->setMaxBytes(large.numBytes());
+        cache->insert(small, someTriangles(1));
+        cache->insert(large, someTriangles(1));
+        Triangles out;
+        QVERIFY(!cache->find(large, out));
+        QVERIFY(!cache->find(small, out));
+        QVERIFY(cache->counters().numEvictions >= 2);
+
+        cache->setMaxBytes(maxBytes);
+    }
+
+    // Edges tessellated with a different number of subdivisions don't share
+    // their triangles
+    void numSubInEdgeKey()
+    {
+        NumSubGuard guard;
+        LinearSpline geometry(wavyPoints());
+
+        DevSettings::setInt("num sub", 2);
+        TessellationKey key2(TessellationKey::EdgeTriangles);
+        QVERIFY(geometry.addToTessellationKey(key2));
+        Triangles expected2;
+        geometry.triangulate(expected2);
+
+        DevSettings::setInt("num sub", 3);
+        TessellationKey key3(TessellationKey::EdgeTriangles);
+        QVERIFY(geometry.addToTessellationKey(key3));
+        Triangles expected3;
+        geometry.triangulate(expected3);
+
+        QVERIFY(key2 != key3);
+        QVERIFY(expected2.size() != expected3.size());
+
+        // Identical edges created after the change, e.g. by undo, are
+        // tessellated with the new number of subdivisions
+        DevSettings::setInt("num sub", 2);
+        VAC vac2;
+        KeyVertex * v0 = vac2.newKeyVertex(Time(0), wavyPoints().first());
+        KeyVertex * v1 = vac2.newKeyVertex(Time(0), wavyPoints().last());
+        KeyEdge * e2 = vac2.newKeyEdge(Time(0), v0, v1, new LinearSpline(wavyPoints()));
+        QCOMPARE(e2->triangles(Time(0)).size(), expected2.size());
+
+        DevSettings::setInt("num sub", 3);
+        VAC vac3;
+        KeyVertex * w0 = vac3.newKeyVertex(Time(0), wavyPoints().first());
+        KeyVertex * w1 = vac3.newKeyVertex(Time(0), wavyPoints().last());
+        KeyEdge * e3 = vac3.newKeyEdge(Time(0), w0, w1, new LinearSpline(wavyPoints()));
+        QCOMPARE(e3->triangles(Time(0)).size(), expected3.size());
+    }
+};
+
+VPAINT_TEST_MAIN(TestTessellationCache)
+#include "tst_TessellationCache.moc"
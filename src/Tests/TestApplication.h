@@ -0,0 +1,43 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#ifndef TESTAPPLICATION_H
+#define TESTAPPLICATION_H
+
+#include <QApplication>
+#include <QtTest>
+
+#include "Global.h"
+#include "DevSettings.h"
+
+/*
+ * TestApplication.h
+ *
+ * Entry point of the unit tests which create a VAC. Cells read the tool
+ * options from global(), and some algorithms read DevSettings, so both
+ * are created, without main window (see Global::initializeHeadless()).
+ *
+ * The offscreen platform is used unless another one is requested, so that
+ * the tests don't need a display.
+ *
+ */
+
+#define VPAINT_TEST_MAIN(TestObject) \
+int main(int argc, char ** argv) \
+{ \
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty()) \
+        qputenv("QT_QPA_PLATFORM", "offscreen"); \
+    QApplication app(argc, argv); \
+    Global::initializeHeadless(); \
+    DevSettings devSettings; \
+    TestObject tc; \
+    QTEST_SET_MAIN_SOURCE_PATH \
+    return QTest::qExec(&tc, argc, argv); \
+}
+
+#endif // TESTAPPLICATION_H
@@ -0,0 +1,27 @@
+# Copyright (C) 2012-2016 The VPaint Developers.
+# See the COPYRIGHT file at the top-level directory of this distribution
+# and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+#
+# This file is part of VPaint, a vector graphics editor. It is subject to the
+# license terms and conditions in the LICENSE.MIT file found in the top-level
+# directory of this distribution and at http://opensource.org/licenses/MIT
+
+# Common configuration of the unit tests. Each test is a QtTest executable
+# which compiles the Gui sources it tests, listed with GUI_DIR as prefix
+
+# Qt configuration
+TEMPLATE = app
+CONFIG += qt console testcase c++11
+CONFIG -= app_bundle
+QT += testlib
+
+# Sources under test. Tests which need a VAC include $$GUI_DIR/Gui.pri,
+# and use VPAINT_TEST_MAIN() from TestApplication.h
+GUI_DIR = $$PWD/../Gui
+INCLUDEPATH += $$GUI_DIR $$PWD
+DEPENDPATH += $$GUI_DIR
+
+# Shipped external libraries
+INCLUDEPATH += $$PWD/../Third/
+DEPENDPATH += $$PWD/../Third/
+!win32: QMAKE_CXXFLAGS += $$QMAKE_CFLAGS_ISYSTEM $$PWD/../Third/
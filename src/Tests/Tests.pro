@@ -0,0 +1,40 @@
+# Copyright (C) 2012-2016 The VPaint Developers.
+# See the COPYRIGHT file at the top-level directory of this distribution
+# and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+#
+# This file is part of VPaint, a vector graphics editor. It is subject to the
+# license terms and conditions in the LICENSE.MIT file found in the top-level
+# directory of this distribution and at http://opensource.org/licenses/MIT
+
+# Unit tests. Build and run them with "make check"
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    StringTokenizer \
+    MemoryUsage \
+    ZOrderedCells \
+    InbetweenBoundingBox \
+    KeyframeCorrespondence \
+    CameraReprojection \
+    Algorithms \
+    EndPointsDrag \
+    CompressedDocument \
+    GeometryChangeTransaction \
+    TessellationCache \
+    SpaceTimeSurface \
+    TransformTool \
+    DirtyRegion \
+    ChangedRegions \
+    GeometryPager \
+    GeometryPaging \
+    DocumentParsing \
+    IdListCopier \
+    SculptRetriangulation \
+    CellMemoryUsage \
+    AnimatedCycleIndex \
+    IncidentEdges \
+    SortedSampling \
+    SketchIntersections \
+    FrameRevisions \
+    PlaybackCacheIndex \
+    SceneImageKey
@@ -0,0 +1,232 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/KeyFace.h"
+#include "VectorAnimationComplex/Cycle.h"
+#include "VectorAnimationComplex/EdgeGeometry.h"
+#include "VectorAnimationComplex/EdgeSample.h"
+#include "VectorAnimationComplex/SculptCurve.h"
+#include "VectorAnimationComplex/TessellationCache.h"
+#include "VectorAnimationComplex/TransformTool.h"
+
+#include <cmath>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+typedef SculptCurve::Curve<EdgeSample> Curve;
+
+bool fuzzyEqual(const Eigen::Vector2d & a, const Eigen::Vector2d & b, double eps = 1e-6)
+{
+    return (a - b).norm() < eps;
+}
+
+bool fuzzyEqual(const BoundingBox & bb1, const BoundingBox & bb2, double eps = 1e-6)
+{
+    return std::abs(bb1.xMin() - bb2.xMin()) < eps && std::abs(bb1.xMax() - bb2.xMax()) < eps &&
+           std::abs(bb1.yMin() - bb2.yMin()) < eps && std::abs(bb1.yMax() - bb2.yMax()) < eps;
+}
+
+bool fuzzyEqual(Triangles a, Triangles b, double eps = 1e-6)
+{
+    if(a.size() != b.size())
+        return false;
+    for(int i=0; i<a.size(); ++i)
+    {
+        if(!fuzzyEqual(a[i].a, b[i].a, eps) ||
+           !fuzzyEqual(a[i].b, b[i].b, eps) ||
+           !fuzzyEqual(a[i].c, b[i].c, eps))
+            return false;
+    }
+    return true;
+}
+
+LinearSpline * spline(KeyEdge * e)
+{
+    return dynamic_cast<LinearSpline *>(e->geometry());
+}
+
+// A square face bounded by the edges e[0..3] between the vertices v[0..3],
+// where e[0] is curved. The square is selected, but not the edge "tail",
+// from v[0] to the vertex "end", which is corrected when v[0] moves
+struct Scene
+{
+    VAC vac;
+    KeyVertex * v[4];
+    KeyEdge * e[4];
+    KeyFace * face;
+    KeyVertex * end;
+    KeyEdge * tail;
+
+    Scene()
+    {
+        const Eigen::Vector2d corners[4] = {
+            Eigen::Vector2d(0, 0), Eigen::Vector2d(100, 0),
+            Eigen::Vector2d(100, 100), Eigen::Vector2d(0, 100) };
+        for(int i=0; i<4; ++i)
+            v[i] = vac.newKeyVertex(Time(0), corners[i]);
+
+        QList<EdgeSample> samples;
+        for(int i=0; i<=50; ++i)
+        {
+            double x = 2.0 * i;
+            samples << EdgeSample(x, x * (100 - x) / 250, 3 + std::cos(x / 20));
+        }
+        e[0] = vac.newKeyEdge(Time(0), v[0], v[1], new LinearSpline(samples));
+        for(int i=1; i<4; ++i)
+            e[i] = vac.newKeyEdge(Time(0), v[i], v[(i+1)%4], 0, 6);
+
+        KeyEdgeSet edges;
+        for(int i=0; i<4; ++i)
+            edges << e[i];
+        face = vac.newKeyFace(Cycle(edges));
+
+        end = vac.newKeyVertex(Time(0), Eigen::Vector2d(-100, -50));
+        tail = vac.newKeyEdge(Time(0), end, v[0], 0, 6);
+
+        CellSet square;
+        for(int i=0; i<4; ++i)
+            square << v[i] << e[i];
+        square << face;
+        vac.addToSelection(square, false);
+
+        // Fill the caches, which are transformed or cleared during the drag
+        foreach(Cell * c, vac.cells())
+        {
+            c->triangles(Time(0));
+            c->boundingBox();
+        }
+    }
+
+    // Hovers the given widget of the transform tool, as picking does
+    void hoverWidget(TransformTool::WidgetId id)
+    {
+        int maxId = 0;
+        foreach(Cell * c, vac.cells())
+            maxId = std::max(maxId, c->id());
+        vac.setHoveredObject(Time(0), maxId + 1 + id - TransformTool::MIN_WIDGET_ID);
+    }
+};
+
+// Checks that the cached geometry of all cells is the same as computed from
+// scratch, by a clone of the VAC
+void checkCachedGeometry(VAC & vac)
+{
+    VAC * clone = vac.clone();
+    TessellationCache::instance()->clear();
+    foreach(Cell * c, vac.cells())
+    {
+        Cell * other = clone->getCell(c->id());
+        QVERIFY(other);
+        QVERIFY(fuzzyEqual(c->triangles(Time(0)), other->triangles(Time(0))));
+        QVERIFY(fuzzyEqual(c->boundingBox(), other->boundingBox()));
+    }
+    delete clone;
+}
+
+} // end namespace
+
+class TestTransformTool: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // A rotation moves the geometry rigidly, and the cached geometry
+    // transformed during the drag is re-computed when it ends
+    void rotate()
+    {
+        Scene scene;
+        Curve rest = spline(scene.e[0])->curve();
+        Eigen::Vector2d p0 = scene.v[0]->pos();
+        Eigen::Vector2d p1 = scene.v[1]->pos();
+
+        // Turn around the center of the square
+        Eigen::Vector2d center(50, 50);
+        Eigen::Vector2d mouse0(-20, -20);
+        scene.hoverWidget(TransformTool::TopLeftRotate);
+        scene.vac.beginTransformSelection(mouse0[0], mouse0[1], Time(0));
+        for(int k=1; k<=6; ++k)
+        {
+            Eigen::Vector2d mouse = center + Eigen::Rotation2Dd(0.1 * k) * (mouse0 - center);
+            scene.vac.continueTransformSelection(mouse[0], mouse[1]);
+        }
+        scene.vac.endTransformSelection();
+
+        // Rotation applied to the selection
+        Eigen::Vector2d d = p1 - p0;
+        Eigen::Vector2d d2 = scene.v[1]->pos() - scene.v[0]->pos();
+        double angle = std::atan2(d2[1], d2[0]) - std::atan2(d[1], d[0]);
+        QVERIFY(std::abs(angle) > 0.1);
+        QVERIFY(std::abs(d2.norm() - d.norm()) < 1e-9);
+        Eigen::Affine2d xf = Eigen::Translation2d(scene.v[0]->pos()) *
+                             Eigen::Rotation2Dd(angle) *
+                             Eigen::Translation2d(-p0);
+
+        // The curved edge is the rotated curve, resampled, which doesn't
+        // move its samples
+        const Curve & curve = spline(scene.e[0])->curve();
+        QCOMPARE(curve.size(), rest.size());
+        for(int i=0; i<curve.size(); ++i)
+        {
+            Eigen::Vector2d expected = xf * Eigen::Vector2d(rest[i].x(), rest[i].y());
+            QVERIFY(fuzzyEqual(Eigen::Vector2d(curve[i].x(), curve[i].y()), expected));
+            QVERIFY(std::abs(curve[i].width() - rest[i].width()) < 1e-9);
+        }
+        QVERIFY(fuzzyEqual(Eigen::Vector2d(curve.start().x(), curve.start().y()), scene.v[0]->pos(), 1e-12));
+        QVERIFY(fuzzyEqual(Eigen::Vector2d(curve.end().x(), curve.end().y()), scene.v[1]->pos(), 1e-12));
+
+        // The edge which is not selected follows v[0]
+        QVERIFY(fuzzyEqual(scene.tail->geometry()->rightPos2d(), scene.v[0]->pos(), 1e-12));
+
+        checkCachedGeometry(scene.vac);
+    }
+
+    // Same for a scale, which can't transform cached triangles during the
+    // drag
+    void scale()
+    {
+        Scene scene;
+        scene.hoverWidget(TransformTool::TopLeftScale);
+        scene.vac.beginTransformSelection(-20, -20, Time(0));
+        for(int k=1; k<=6; ++k)
+            scene.vac.continueTransformSelection(-20 - 5 * k, -20 - 3 * k);
+        scene.vac.endTransformSelection();
+
+        QVERIFY(scene.v[1]->pos()[0] - scene.v[0]->pos()[0] > 110);
+        QVERIFY(fuzzyEqual(scene.tail->geometry()->rightPos2d(), scene.v[0]->pos(), 1e-12));
+        checkCachedGeometry(scene.vac);
+    }
+
+    // Vertices transformed without their incident edges keep exact
+    // geometry too
+    void rotateVertexOnly()
+    {
+        Scene scene;
+        scene.vac.deselectAll();
+        scene.vac.addToSelection(scene.end, false);
+        scene.vac.addToSelection(scene.v[2], false);
+        scene.hoverWidget(TransformTool::BottomRightRotate);
+        scene.vac.beginTransformSelection(150, 150, Time(0));
+        scene.vac.continueTransformSelection(160, 130);
+        scene.vac.continueTransformSelection(170, 100);
+        scene.vac.endTransformSelection();
+
+        QVERIFY(!fuzzyEqual(scene.v[2]->pos(), Eigen::Vector2d(100, 100)));
+        checkCachedGeometry(scene.vac);
+    }
+};
+
+VPAINT_TEST_MAIN(TestTransformTool)
+#include "tst_TransformTool.moc"
@@ -0,0 +1,487 @@
+// Copyright (C) 2012-2016 The VPaint Developers.
+// See the COPYRIGHT file at the top-level directory of this distribution
+// and at https://github.com/dalboris/vpaint/blob/master/COPYRIGHT
+//
+// This file is part of VPaint, a vector graphics editor. It is subject to the
+// license terms and conditions in the LICENSE.MIT file found in the top-level
+// directory of this distribution and at http://opensource.org/licenses/MIT
+
+#include "TestApplication.h"
+
+#include "VectorAnimationComplex/VAC.h"
+#include "VectorAnimationComplex/ZOrderedCells.h"
+#include "VectorAnimationComplex/CellLinkedList.h"
+#include "VectorAnimationComplex/Algorithms.h"
+#include "VectorAnimationComplex/KeyVertex.h"
+#include "VectorAnimationComplex/KeyEdge.h"
+#include "VectorAnimationComplex/InbetweenVertex.h"
+
+#include <random>
+
+using namespace VectorAnimationComplex;
+
+namespace
+{
+
+// Verbatim copy of intersect(), raise(), lower(), altRaise() and altLower()
+// before the spatial index, testing each candidate against each moved cell
+bool intersect(Cell * c, const CellSet & cells)
+{
+    foreach(Cell * c2, cells)
+        if(c->boundingBox().intersects(c2->boundingBox()))
+            return true;
+    return false;
+}
+
+class BaselineZOrder
+{
+public:
+    typedef CellLinkedList::Iterator Iterator;
+    typedef CellLinkedList::ReverseIterator ReverseIterator;
+
+    void append(Cell * c) { list_.append(c); }
+
+    QList<Cell*> cells()
+    {
+        QList<Cell*> res;
+        for(Iterator it = list_.begin(); it != list_.end(); ++it)
+            res << *it;
+        return res;
+    }
+
+    void raise(CellSet cellsToRaise)
+    {
+        int n = cellsToRaise.size();
+        int nFound = 0;
+        if(n == 0) return;
+
+        // Find first cell to raise
+        Iterator it = findFirst(cellsToRaise);
+        if(it == end()) { qDebug() << "void ZOrderedCells::raise(Cell * cell): no cell found";    return;    }
+
+        // List of actually raised cells (incrementally extracted from list_ in the loops that follow)
+        CellLinkedList raisedCells;
+        it = list_.extractTo(it,raisedCells);
+        nFound++;
+
+        // Get cells closure
+        CellSet closure = Algorithms::closure(cellsToRaise);
+
+        // First loop: advance it until we find c1 such that:
+        //   - c1 is after every of the cells to raise (i.e., nFound == n)
+        //   - c1 is not in the closure of the cells to raise
+        //   - c1 intersects at least one cell to raise
+        Cell * c1 = 0;
+        while(it != end())
+        {
+            if(cellsToRaise.contains(*it))
+            {
+                it = list_.extractTo(it,raisedCells);
+                nFound++;
+            }
+            else if(closure.contains(*it))
+            {
+                it = list_.extractTo(it,raisedCells);
+            }
+            else if( (nFound == n) && (intersect(*it,cellsToRaise)) )
+            {
+                c1 = *it;
+                break;
+            }
+            else
+                ++it;
+        }
+        if(!c1) // not found, raise to top.
+        {
+            list_.splice(it,raisedCells);
+            return;
+        }
+
+        // Second loop: find the highest cell c2 such that:
+        //   - c2 is not in the closure of the cells to raise
+        //   - c2 is in the closure of c1
+        CellSet c1Boundary = c1->boundary(); // Note: *it = c1 AND while(it2 != it) => no need for c1Closure
+        Iterator it2 = end(); --it2;
+        while(it2 != it)
+        {
+            if(c1Boundary.contains(*it2) && !closure.contains(*it2))
+                break;
+            else
+                --it2;
+        }
+
+        // Third loop: finish to find cells to raise (i.e., boundary of c up to it2)
+        while(it != it2)
+        {
+            if(closure.contains(*it))
+                it = list_.extractTo(it,raisedCells);
+            else
+                ++it;
+        }
+
+        // Move raised cells above it2
+        ++it2;
+        list_.splice(it2,raisedCells);
+    }
+
+    void lower(CellSet cellsToLower)
+    {
+        int n = cellsToLower.size();
+        int nFound = 0;
+        if(n == 0) return;
+
+        // Find first cell to lower
+        ReverseIterator it = findLast(cellsToLower);
+        if(it == rend()) { qDebug() << "void ZOrderedCells::lower(Cell * cell): no cell found";    return;    }
+
+        // List of actually lowered cells (incrementally extracted from list_ in the loops that follow)
+        CellLinkedList loweredCells;
+        it = list_.extractTo(it,loweredCells);
+        nFound++;
+
+        // Get cells "fullstar" (i.e., star union itself)
+        CellSet fullstar = Algorithms::fullstar(cellsToLower);
+
+        // First loop: advance it until we find c1 such that:
+        //   - c1 is before every of the cells to lower (i.e., nFound == n)
+        //   - c1 is not in the fullstar of the cells to lower
+        //   - c1 intersects at least one cell to lower
+        Cell * c1 = 0;
+        while(it != rend())
+        {
+            if(cellsToLower.contains(*it))
+            {
+                it = list_.extractTo(it,loweredCells);
+                nFound++;
+            }
+            else if(fullstar.contains(*it))
+            {
+                it = list_.extractTo(it,loweredCells);
+            }
+            else if( (nFound == n) && (intersect(*it,cellsToLower)) )
+            {
+                c1 = *it;
+                break;
+            }
+            else
+                ++it;
+        }
+        if(!c1) // not found, raise to top.
+        {
+            list_.splice(it,loweredCells);
+            return;
+        }
+
+        // Second loop: find the lowest cell c2 such that:
+        //   - c2 is not in the fullstar of the cells to lower
+        //   - c2 is in the closure of c1
+        CellSet c1Star = c1->star(); // Note: *it = c1 AND while(it2 != it) => no need for c1Fullstar
+        ReverseIterator it2 = rend(); --it2;
+        while(it2 != it)
+        {
+            if(c1Star.contains(*it2) && !fullstar.contains(*it2))
+                break;
+            else
+                --it2;
+        }
+
+        // Third loop: finish to find cells to lower (i.e., fullstar of c down to it2)
+        while(it != it2)
+        {
+            if(fullstar.contains(*it))
+                it = list_.extractTo(it,loweredCells);
+            else
+                ++it;
+        }
+
+        // Move lowered cells below it2
+        ++it2;
+        list_.splice(it2,loweredCells);
+    }
+
+    void altRaise(CellSet cellsToRaise)
+    {
+        int n = cellsToRaise.size();
+        int nFound = 0;
+        if(n == 0) return;
+
+        // Find first cell to raise
+        Iterator it = findFirst(cellsToRaise);
+        if(it == end()) { qDebug() << "void ZOrderedCells::raise(Cell * cell): no cell found";    return;    }
+
+        // List of actually raised cells
+        CellLinkedList raisedCells;
+        it = list_.extractTo(it,raisedCells);
+        nFound++;
+
+        // First loop: advance it until we find c1 such that:
+        //   - c1 is after every of the cells to raise (i.e., nFound == n)
+        //   - c1 intersects at least one cell to raise
+        Cell * c1 = 0;
+        while(it != end())
+        {
+            if(cellsToRaise.contains(*it))
+            {
+                it = list_.extractTo(it,raisedCells);
+                nFound++;
+            }
+            else if( (nFound == n) && (intersect(*it,cellsToRaise)) )
+            {
+                c1 = *it;
+                break;
+            }
+            else
+                ++it;
+        }
+        if(!c1) // not found, raise to top.
+        {
+            list_.splice(it,raisedCells);
+            return;
+        }
+
+        // Move raised cells above it
+        ++it;
+        list_.splice(it,raisedCells);
+    }
+
+    void altLower(CellSet cellsToLower)
+    {
+        int n = cellsToLower.size();
+        int nFound = 0;
+        if(n == 0) return;
+
+        // Find first cell to lower
+        ReverseIterator it = findLast(cellsToLower);
+        if(it == rend()) { qDebug() << "void ZOrderedCells::lower(Cell * cell): no cell found";    return;    }
+
+        // List of actually lowered cells
+        CellLinkedList loweredCells;
+        it = list_.extractTo(it,loweredCells);
+        nFound++;
+
+        // First loop: advance it until we find c1 such that:
+        //   - c1 is before every of the cells to lower (i.e., nFound == n)
+        //   - c1 intersects at least one cell to lower
+        Cell * c1 = 0;
+        while(it != rend())
+        {
+            if(cellsToLower.contains(*it))
+            {
+                it = list_.extractTo(it,loweredCells);
+                nFound++;
+            }
+            else if( (nFound == n) && (intersect(*it,cellsToLower)) )
+            {
+                c1 = *it;
+                break;
+            }
+            else
+                ++it;
+        }
+        if(!c1) // not found, raise to top.
+        {
+            list_.splice(it,loweredCells);
+            return;
+        }
+
+        // Move lowered cells below it
+        ++it;
+        list_.splice(it,loweredCells);
+    }
+
+private:
+    CellLinkedList list_;
+
+    Iterator end() { return list_.end(); }
+    ReverseIterator rend() { return list_.rend(); }
+
+    Iterator findFirst(const CellSet & cells)
+    {
+        Iterator it = list_.begin();
+        for(; it != end(); ++it)
+            if(cells.contains(*it))
+                break;
+        return it;
+    }
+
+    ReverseIterator findLast(const CellSet & cells)
+    {
+        ReverseIterator it = list_.rbegin();
+        for(; it != rend(); ++it)
+            if(cells.contains(*it))
+                break;
+        return it;
+    }
+};
+
+QList<Cell*> toList(ZOrderedCells & zOrdering)
+{
+    QList<Cell*> res;
+    for(auto it = zOrdering.begin(); it != zOrdering.end(); ++it)
+        res << *it;
+    return res;
+}
+
+}
+
+class TestZOrderedCells: public QObject
+{
+    Q_OBJECT
+
+private:
+    // Random key vertices and straight key edges at the given times, and
+    // inbetween vertices between consecutive times. Returns all cells, in
+    // creation order, which is a valid z-order (boundary below star)
+    static QList<Cell*> createScene_(VAC & vac, std::mt19937 & rng, const QList<int> & times)
+    {
+        std::uniform_real_distribution<double> pos(0, 100);
+        QList<Cell*> res;
+        QList< QList<KeyVertex*> > vertices;
+        foreach(int t, times)
+        {
+            QList<KeyVertex*> tVertices;
+            for(int i=0; i<12; ++i)
+            {
+                KeyVertex * v = vac.newKeyVertex(Time(t), Eigen::Vector2d(pos(rng), pos(rng)));
+                tVertices << v;
+                res << v;
+            }
+            for(int i=0; i<12; ++i)
+            {
+                KeyVertex * v1 = tVertices[rng() % tVertices.size()];
+                KeyVertex * v2 = tVertices[rng() % tVertices.size()];
+                if(v1 != v2)
+                    res << vac.newKeyEdge(Time(t), v1, v2);
+            }
+            vertices << tVertices;
+        }
+        for(int i=1; i<vertices.size(); ++i)
+        {
+            for(int j=0; j<4; ++j)
+            {
+                KeyVertex * before = vertices[i-1][rng() % vertices[i-1].size()];
+                KeyVertex * after = vertices[i][rng() % vertices[i].size()];
+                res << vac.newInbetweenVertex(before, after);
+            }
+        }
+        return res;
+    }
+
+    // Applies the same random operations to ZOrderedCells and to the
+    // baseline, and compares the resulting orders after each operation
+    static void compareRandomOperations_(const QList<int> & times, unsigned int seed)
+    {
+        std::mt19937 rng(seed);
+        VAC vac;
+        QList<Cell*> cells = createScene_(vac, rng, times);
+
+        ZOrderedCells zOrdering;
+        BaselineZOrder baseline;
+        foreach(Cell * c, cells)
+        {
+            zOrdering.insertLast(c);
+            baseline.append(c);
+        }
+
+        for(int i=0; i<200; ++i)
+        {
+            CellSet moved;
+            int numMoved = 1 + rng() % 3;
+            for(int j=0; j<numMoved; ++j)
+                moved << cells[rng() % cells.size()];
+
+            switch(rng() % 4)
+            {
+            case 0: zOrdering.raise(moved); baseline.raise(moved); break;
+            case 1: zOrdering.lower(moved); baseline.lower(moved); break;
+            case 2: zOrdering.altRaise(moved); baseline.altRaise(moved); break;
+            case 3: zOrdering.altLower(moved); baseline.altLower(moved); break;
+            }
+            QCOMPARE(toList(zOrdering), baseline.cells());
+        }
+    }
+
+private slots:
+    void sameAsBaselineAtOneTime()
+    {
+        for(unsigned int seed=1; seed<=20; ++seed)
+            compareRandomOperations_(QList<int>() << 0, seed);
+    }
+
+    // Cells at different times are compared by their all-time bounding
+    // boxes, like before the spatial index
+    void sameAsBaselineAcrossTimes()
+    {
+        for(unsigned int seed=1; seed<=20; ++seed)
+            compareRandomOperations_(QList<int>() << 0 << 1 << 3, seed);
+    }
+
+    // Cells which never exist at the same time still stop raise() and
+    // lower() when their boxes intersect
+    void stopAtCellsAtOtherTimes()
+    {
+        VAC vac;
+        KeyVertex * a1 = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        KeyVertex * a2 = vac.newKeyVertex(Time(0), Eigen::Vector2d(10, 10));
+        KeyVertex * b1 = vac.newKeyVertex(Time(1), Eigen::Vector2d(0, 10));
+        KeyVertex * b2 = vac.newKeyVertex(Time(1), Eigen::Vector2d(10, 0));
+        KeyVertex * c1 = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 5));
+        KeyVertex * c2 = vac.newKeyVertex(Time(0), Eigen::Vector2d(10, 5));
+        KeyEdge * a = vac.newKeyEdge(Time(0), a1, a2);
+        KeyEdge * b = vac.newKeyEdge(Time(1), b1, b2);
+        KeyEdge * c = vac.newKeyEdge(Time(0), c1, c2);
+
+        ZOrderedCells zOrdering;
+        BaselineZOrder baseline;
+        QList<Cell*> cells;
+        cells << a1 << a2 << b1 << b2 << c1 << c2 << a << b << c;
+        foreach(Cell * cell, cells)
+        {
+            zOrdering.insertLast(cell);
+            baseline.append(cell);
+        }
+
+        // a is raised just above b, which it overlaps in space only
+        zOrdering.altRaise(a);
+        baseline.altRaise(CellSet() << a);
+        QList<Cell*> expected;
+        expected << a1 << a2 << b1 << b2 << c1 << c2 << b << a << c;
+        QCOMPARE(toList(zOrdering), expected);
+        QCOMPARE(baseline.cells(), expected);
+
+        // Lowered just below b
+        zOrdering.altLower(a);
+        baseline.altLower(CellSet() << a);
+        expected.clear();
+        expected << a1 << a2 << b1 << b2 << c1 << c2 << a << b << c;
+        QCOMPARE(toList(zOrdering), expected);
+        QCOMPARE(baseline.cells(), expected);
+    }
+
+    // Inbetween cells overlap the cells they are drawn over. They used to
+    // have an empty all-time bounding box, and sv was raised to top
+    void inbetweenCellsOverlap()
+    {
+        VAC vac;
+        KeyVertex * v0 = vac.newKeyVertex(Time(0), Eigen::Vector2d(0, 0));
+        KeyVertex * v2 = vac.newKeyVertex(Time(2), Eigen::Vector2d(10, 0));
+        KeyVertex * k1 = vac.newKeyVertex(Time(1), Eigen::Vector2d(5, 0));
+        KeyVertex * x1 = vac.newKeyVertex(Time(1), Eigen::Vector2d(100, 100));
+        InbetweenVertex * sv = vac.newInbetweenVertex(v0, v2);
+
+        ZOrderedCells zOrdering;
+        zOrdering.insertLast(v0);
+        zOrdering.insertLast(v2);
+        zOrdering.insertLast(sv);
+        zOrdering.insertLast(k1);
+        zOrdering.insertLast(x1);
+
+        zOrdering.altRaise(sv);
+        QList<Cell*> expected;
+        expected << v0 << v2 << k1 << sv << x1;
+        QCOMPARE(toList(zOrdering), expected);
+    }
+};
+
+VPAINT_TEST_MAIN(TestZOrderedCells)
+#include "tst_ZOrderedCells.moc"
@@ -11,6 +11,8 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     Third/GLEW \
-    Gui
+    Gui \
+    Tests
 
 Gui.depends = Third/GLEW
+Tests.depends = Third/GLEW